@@ -0,0 +1,45 @@
+// Writing lines to a file synchronously and through the asynchronous
+// backend. Logging steadily, the queue fills and the async numbers are the
+// background thread's rate; bursts shorter than the queue only pay for the
+// formatting and the copy.
+
+#include <eseed/logging/logger.hpp>
+
+#include "bench.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("esdl_async", argc, argv);
+
+    const char *path = "esdl_async_bench.log";
+    std::ofstream file(path, std::ios::binary);
+    esdl::Logger logger(&file);
+
+    const std::string name = "staging buffer";
+    size_t size = 65536;
+    float ms = 0.25f;
+
+    esdl::AsyncOptions options;
+    options.capacity = 1 << 16;
+
+    suite.compare("info to file", 1,
+        "sync", [&] {
+            logger.info("Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+        },
+        "async", [&] {
+            if (!logger.isAsync()) logger.enableAsync(options);
+            logger.info("Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+        }
+    );
+
+    logger.disableAsync();
+    file.close();
+    std::remove(path);
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+// Cost of a log call writing a binary record, against formatting the same
+// line as text through the asynchronous backend
+
+#include <eseed/logging/logger.hpp>
+
+#include "bench.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("esdl_binary", argc, argv);
+
+    const char *textPath = "esdl_binary_bench.log";
+    const char *binaryPath = "esdl_binary_bench.bin";
+    std::ofstream file(textPath, std::ios::binary);
+    esdl::Logger textLogger(&file);
+    esdl::AsyncOptions options;
+    options.capacity = 1 << 16;
+    options.overflow = esdl::OverflowDrop;
+    textLogger.enableAsync(options);
+
+    esdl::Logger binaryLogger;
+    binaryLogger.enableBinary(binaryPath);
+
+    const std::string name = "staging buffer";
+    size_t size = 65536;
+    float ms = 0.25f;
+
+    suite.compare("info, 3 args", 1,
+        "async text", [&] {
+            textLogger.info("Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+        },
+        "binary", [&] {
+            binaryLogger.info("Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+        }
+    );
+
+    suite.compare("info, 2 ints", 1,
+        "async text", [&] {
+            textLogger.info("Frame {} took {} us", size, size);
+        },
+        "binary", [&] {
+            binaryLogger.info("Frame {} took {} us", size, size);
+        }
+    );
+
+    // The macros keep the format's ID at the call site, the methods look
+    // it up by the format string's address
+    suite.compare("binary info, 3 args", 1,
+        "info()", [&] {
+            binaryLogger.info("Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+        },
+        "ESDL_LOG_INFO", [&] {
+            ESDL_LOG_INFO(binaryLogger, "Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+        }
+    );
+
+    textLogger.disableAsync();
+    binaryLogger.disableBinary();
+    file.close();
+    std::remove(textPath);
+    std::remove(binaryPath);
+
+    return suite.finish();
+}
\ No newline at end of file
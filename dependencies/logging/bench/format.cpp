@@ -0,0 +1,105 @@
+// Compares esdl::format with the per-argument recursive formatter it
+// replaced, kept here as the baseline
+
+#include <eseed/logging/format.hpp>
+
+#include "bench.hpp"
+
+#include <sstream>
+#include <string>
+
+namespace {
+
+// The replaced implementation: one pass and one std::ostringstream per
+// argument, each pass substituting the first "{}" left
+template <typename T>
+std::string legacyFormatOne(const std::string& format, const T& arg) {
+    std::ostringstream out;
+    bool readingArg = false;
+    bool autoArgRead = false;
+    std::string argStr;
+    for (char ch : format) {
+        if (ch == '{' && !readingArg) {
+            readingArg = true;
+            continue;
+        }
+        if (ch == '}' && readingArg) {
+            readingArg = false;
+            if (argStr.empty() && !autoArgRead) {
+                out << arg;
+                autoArgRead = true;
+            } else {
+                out << "{" << argStr << "}";
+            }
+            argStr.clear();
+            continue;
+        }
+        if (readingArg) argStr += ch;
+        else out << ch;
+    }
+    return out.str();
+}
+
+std::string legacyFormat(const std::string& format) {
+    return format;
+}
+
+template <typename T, typename... Ts>
+std::string legacyFormat(const std::string& format, const T& arg, const Ts&... args) {
+    return legacyFormat(legacyFormatOne(format, arg), args...);
+}
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("esdl_format", argc, argv);
+
+    const std::string name = "swapchain";
+    const char *line = "Created {} with {} images of {}x{} at {} Hz, {} ms per frame";
+
+    suite.compare("format 6 args", 1,
+        "legacy", [&] {
+            bench::doNotOptimize(legacyFormat(line, name, 3, 1366, 768, 60, 16.667));
+        },
+        "format", [&] {
+            bench::doNotOptimize(esdl::format("Created {} with {} images of {}x{} at {} Hz, {} ms per frame", name, 3, 1366, 768, 60, 16.667));
+        }
+    );
+
+    std::string buffer;
+    suite.compare("format 6 args, reused buffer", 1,
+        "legacy", [&] {
+            bench::doNotOptimize(legacyFormat(line, name, 3, 1366, 768, 60, 16.667));
+        },
+        "formatTo", [&] {
+            buffer.clear();
+            esdl::formatTo(buffer, "Created {} with {} images of {}x{} at {} Hz, {} ms per frame", name, 3, 1366, 768, 60, 16.667);
+            bench::doNotOptimize(buffer.data());
+        }
+    );
+
+    suite.compare("format no args", 1,
+        "legacy", [&] {
+            bench::doNotOptimize(legacyFormat("Initialized render context swapchain manager"));
+        },
+        "formatView", [&] {
+            bench::doNotOptimize(esdl::formatView("Initialized render context swapchain manager").data());
+        }
+    );
+
+    suite.compare("format float", 1,
+        "ostringstream", [&] {
+            std::ostringstream out;
+            out.precision(3);
+            out << std::fixed << 3.14159265;
+            bench::doNotOptimize(out.str());
+        },
+        "formatView", [&] {
+            bench::doNotOptimize(esdl::formatView("{:.3f}", 3.14159265).data());
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+// Cost of log calls whose level is disabled
+
+#include <eseed/logging/logger.hpp>
+
+#include "bench.hpp"
+
+#include <sstream>
+#include <string>
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("esdl_logger", argc, argv);
+
+    std::ostringstream sink;
+    esdl::Logger logger(&sink);
+    logger.setMinLogLevel(esdl::Logger::LogLevelInfo);
+
+    const std::string name = "staging buffer";
+    size_t size = 65536;
+    float ms = 0.25f;
+
+    suite.compare("disabled debug, 3 args", 1,
+        "eager", [&] {
+            // What debug() did before: format, then check the level
+            std::string line = esdl::format("Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+            if (logger.isLevelEnabled(esdl::Logger::LogLevelDebug)) sink << line;
+            bench::doNotOptimize(line);
+        },
+        "debug", [&] {
+            logger.debug("Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+            bench::clobberMemory();
+        }
+    );
+
+    suite.compare("disabled debug, computed arg", 1,
+        "debug", [&] {
+            logger.debug("Contents {}", std::to_string(size));
+            bench::clobberMemory();
+        },
+        "ESDL_LOG_DEBUG", [&] {
+            ESDL_LOG_DEBUG(logger, "Contents {}", std::to_string(size));
+            bench::clobberMemory();
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+// Writing lines to a file through the sinks: flushing every line, buffering
+// 64 KiB, and copying into a memory mapping. A verbose file log next to a
+// console at warn only costs the file's share.
+
+#include <eseed/logging/sink.hpp>
+
+#include "bench.hpp"
+
+#include <cstdio>
+#include <string>
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("esdl_sinks", argc, argv);
+
+    const char *unbufferedPath = "esdl_sinks_bench_unbuffered.log";
+    const char *bufferedPath = "esdl_sinks_bench_buffered.log";
+    const char *mappedPath = "esdl_sinks_bench_mapped.log";
+
+    auto unbuffered = std::make_shared<esdl::FileSink>(unbufferedPath, false);
+    unbuffered->setBuffering(0);
+    auto buffered = std::make_shared<esdl::FileSink>(bufferedPath, false);
+    auto mapped = std::make_shared<esdl::MappedFileSink>(mappedPath, false);
+
+    auto console = std::make_shared<esdl::StdoutSink>();
+    console->setMinLevel(esdl::Logger::LogLevelWarn);
+
+    esdl::Logger unbufferedLogger({ unbuffered, console });
+    esdl::Logger bufferedLogger({ buffered, console });
+    esdl::Logger mappedLogger({ mapped, console });
+    for (auto logger : { &unbufferedLogger, &bufferedLogger, &mappedLogger }) {
+        logger->setMinLogLevel(esdl::Logger::LogLevelDebug);
+    }
+
+    const std::string name = "staging buffer";
+    size_t size = 65536;
+    float ms = 0.25f;
+
+    suite.compare("debug to file", 1,
+        "unbuffered", [&] {
+            unbufferedLogger.debug("Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+        },
+        "buffered", [&] {
+            bufferedLogger.debug("Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+        }
+    );
+
+    suite.compare("debug to file", 1,
+        "buffered", [&] {
+            bufferedLogger.debug("Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+        },
+        "mapped", [&] {
+            mappedLogger.debug("Uploaded {} ({} bytes) in {:.3f} ms", name, size, ms);
+        }
+    );
+
+    unbuffered.reset();
+    buffered.reset();
+    mapped.reset();
+    unbufferedLogger = esdl::Logger(std::vector<std::shared_ptr<esdl::LogSink>>());
+    bufferedLogger = unbufferedLogger;
+    mappedLogger = unbufferedLogger;
+    std::remove(unbufferedPath);
+    std::remove(bufferedPath);
+    std::remove(mappedPath);
+
+    return suite.finish();
+}
\ No newline at end of file
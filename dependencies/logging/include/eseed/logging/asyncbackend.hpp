@@ -0,0 +1,98 @@
+#pragma once
+
+#include <eseed/logging/logger.hpp>
+#include <eseed/logging/mpscring.hpp>
+#include <eseed/logging/sink.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace esdl::detail {
+
+// A queued line, sized so a ring cell fills 256 bytes
+struct AsyncRecord {
+    static constexpr size_t inlineCapacity = 216;
+
+    std::chrono::system_clock::time_point time;
+    // Negative without monotonic offsets
+    std::chrono::nanoseconds offset;
+    // Lines longer than inlineCapacity, owned by the record until popped
+    std::string* longText;
+    uint32_t length;
+    Logger::LogLevel level;
+    char text[inlineCapacity];
+};
+
+// Background thread of an asynchronous Logger
+class AsyncBackend {
+public:
+    // Discarded lines are added to "dropped", which the Logger keeps past
+    // the backend
+    AsyncBackend(
+        std::vector<std::shared_ptr<LogSink>> sinks, 
+        const AsyncOptions& options, 
+        std::shared_ptr<std::atomic<size_t>> dropped
+    );
+
+    // Writes out whatever is still queued
+    ~AsyncBackend();
+
+    AsyncBackend(const AsyncBackend&) = delete;
+    AsyncBackend& operator=(const AsyncBackend&) = delete;
+
+    void push(
+        Logger::LogLevel level, 
+        std::chrono::system_clock::time_point time, 
+        std::chrono::nanoseconds offset, 
+        std::string_view line
+    );
+
+    void flush();
+
+private:
+    MpscRing<AsyncRecord> ring;
+    std::vector<std::shared_ptr<LogSink>> sinks;
+    AsyncOptions options;
+
+    std::shared_ptr<std::atomic<size_t>> dropped;
+    std::atomic<bool> stopping { false };
+
+    // Guards wakeRequested, writtenCount and the flush counts
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable written;
+    bool wakeRequested = false;
+    // Ring positions handed to the sinks
+    size_t writtenCount = 0;
+    // flush() calls made, and the ones the sinks have been flushed for
+    size_t flushRequests = 0;
+    size_t flushedRequests = 0;
+
+    // Only used by the background thread
+    std::string line;
+    size_t batchLength = 0;
+    size_t reportedDropped = 0;
+    // Of the last line, which the dropped line warning reuses
+    std::chrono::nanoseconds lastOffset { -1 };
+
+    std::thread thread;
+
+    void requestWake();
+    void run();
+    void drain();
+    void writeLine(
+        Logger::LogLevel level, 
+        std::chrono::system_clock::time_point time, 
+        std::chrono::nanoseconds offset, 
+        std::string_view text
+    );
+    void endBatch();
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <eseed/logging/format.hpp>
+#include <eseed/logging/mappedfile.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Binary log files: instead of text, each line is a record holding the ID
+// of its format string, its level, a timestamp and the raw bytes of its
+// arguments, written straight into a memory-mapped file. esdl_decode turns
+// the file back into the usual text.
+//
+// File layout, little endian, everything 8 byte aligned:
+//   FileHeader at offset 0, then records
+//   The file grows in chunks of FileHeader::chunkSize bytes, and no record
+//   crosses a chunk boundary. A chunk's records end at a Padding record or
+//   at a zero size (space reserved but not written, after a crash).
+//
+// Records start with RecordHeader. The arguments are packed without
+// padding: bool and char 1 byte, integers and pointers 8, float 4, double
+// 8, and text a uint32_t length then the bytes. Types written with
+// operator<< are stored as their text.
+
+namespace esdl {
+
+namespace binary {
+
+constexpr char magic[8] = { 'E', 'S', 'D', 'L', 'B', 'I', 'N', 0 };
+constexpr uint32_t version = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t chunkSize;
+    // Clocks when the file was opened
+    int64_t wallNs; // system_clock, since the epoch
+    int64_t steadyNs;
+    uint64_t ticks;
+    // Measured over a few milliseconds at open, Sync records refine it
+    double ticksPerSecond;
+};
+
+struct RecordHeader {
+    // Whole record, header included, rounded up to 8 bytes
+    uint32_t size;
+    // Format ID in the low 24 bits, level in the high 8
+    uint32_t tag;
+    uint64_t ticks;
+};
+
+// Format IDs with a special meaning
+enum RecordId : uint32_t {
+    // Fills the rest of a chunk, only size and tag are written
+    RecordPadding = 0,
+    // Payload: uint32_t id, argCount and formatLength, argCount ArgKind
+    // bytes, then the format string
+    RecordDefinition = 0xFFFFFF,
+    // Payload: int64_t steady_clock ns, taken with the header's ticks
+    RecordSync = 0xFFFFFE,
+    // First ID given to format strings
+    RecordFirstFormat = 1,
+};
+
+constexpr uint32_t makeTag(uint32_t id, int level) {
+    return id | uint32_t(level) << 24;
+}
+
+constexpr uint32_t getTagId(uint32_t tag) {
+    return tag & 0xFFFFFF;
+}
+
+constexpr int getTagLevel(uint32_t tag) {
+    return int(tag >> 24);
+}
+
+constexpr size_t alignRecord(size_t size) {
+    return (size + 7) & ~size_t(7);
+}
+
+// Timestamp source: the TSC where there is one, steady_clock ns otherwise
+uint64_t readTicks();
+
+}
+
+// A call site's format ID, kept in a function-local static by the ESDL_LOG_*
+// macros so their lines skip the lookup in BinaryLog's table. Tagged with
+// the BinaryLog it came from, since each file numbers its formats anew.
+class FormatSite {
+private:
+    friend class BinaryLog;
+
+    // BinaryLog::generation in the high 40 bits, the ID in the low 24
+    std::atomic<uint64_t> cached { 0 };
+};
+
+// Writer for a binary log file, used by Logger::enableBinary
+//
+// Any number of threads can write at once: a record's space is reserved
+// with one atomic add on the current chunk, and only mapping the next
+// chunk takes a lock. A format string's ID comes from its FormatSite when
+// there is one, and is otherwise looked up by its pointer in a lock-free
+// table, which is why only literal format strings are stored as IDs; other
+// lines are formatted and stored as text.
+class BinaryLog {
+public:
+    // Creates or truncates the file at "path", throws std::runtime_error if
+    // it can't be created or mapped. "chunkSize" is rounded up to 64 KiB.
+    BinaryLog(const std::string& path, size_t chunkSize = 16 << 20);
+
+    // Trims the file to what was written; no thread may still be writing
+    ~BinaryLog();
+
+    BinaryLog(const BinaryLog&) = delete;
+    BinaryLog& operator=(const BinaryLog&) = delete;
+
+    // "site" may be null; otherwise it must only ever see this one format
+    // string with these argument types
+    template <typename... Ts>
+    void write(int level, FormatSite* site, FormatString<Ts...> format, const Ts&... args) {
+        const detail::FormatArg packed[] = { detail::makeArg(args)..., detail::FormatArg() };
+        write(level, site, format.get(), format.isLiteral(), packed, sizeof...(Ts));
+    }
+
+    void write(
+        int level, 
+        FormatSite* site, 
+        std::string_view format, 
+        bool literal, 
+        const detail::FormatArg* args, 
+        size_t count
+    );
+
+    // Ask the OS to write the current chunk's pages to disk now; finished
+    // chunks were already synced and unmapped
+    void flush();
+
+    // Records that didn't fit in any chunk (only if mapping a chunk failed)
+    size_t getDroppedCount() const;
+
+private:
+    // Chunks stay allocated for the life of the log, since a writer that
+    // lost the race for the end of one may still touch "used", but their
+    // pages are unmapped once every byte has been written
+    struct Chunk {
+        char* base;
+        size_t size;
+        uint64_t fileOffset;
+        // Bytes reserved, past "size" once the chunk is full
+        std::atomic<size_t> used;
+        // Bytes of finished records and padding, "size" once nothing more
+        // will be written
+        std::atomic<size_t> written;
+    };
+
+    struct FormatEntry {
+        std::atomic<const char*> key { nullptr };
+        uint32_t id = 0;
+        // The registered copy and argument kinds, since one address can hold
+        // different text over time, and one literal can be used with
+        // different argument types
+        std::string text;
+        std::vector<detail::ArgKind> kinds;
+    };
+
+    static constexpr size_t tableSize = 4096;
+
+    std::unique_ptr<detail::MappedFile> file;
+
+    // Unique to this log, so a FormatSite can tell its ID is still valid
+    const uint64_t generation;
+    size_t chunkSize;
+    std::atomic<Chunk*> current { nullptr };
+    std::atomic<size_t> dropped { 0 };
+
+    // Guards chunks and mapped
+    std::mutex chunkMutex;
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    // Chunks whose pages are still mapped, the current one last
+    std::vector<Chunk*> mapped;
+
+    // Guards nextId and the table inserts
+    std::mutex formatMutex;
+    uint32_t nextId = binary::RecordFirstFormat;
+    uint32_t textId = 0;
+    std::unique_ptr<FormatEntry[]> table;
+
+    uint32_t findFormat(std::string_view format, const detail::FormatArg* args, size_t count);
+    uint32_t defineFormat(std::string_view format, const detail::ArgKind* kinds, size_t count);
+    // Space for a record in "chunk", to be passed to commit() once written
+    char* reserve(size_t size, Chunk*& chunk);
+    void commit(Chunk* chunk, size_t size);
+    Chunk* mapChunk(uint64_t fileOffset);
+    // Sync and unmap the finished chunks, with chunkMutex held
+    void retireChunks();
+    void writeSync();
+};
+
+}
\ No newline at end of file
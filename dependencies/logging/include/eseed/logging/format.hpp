@@ -1,25 +1,222 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <type_traits>
+
+// Placeholders in a format string are replaced by the arguments in a single
+// pass over it:
+//   {}        the next argument
+//   {1}       argument 1, counting from 0
+//   {:spec}   {1:spec}, with spec being [[fill]align][sign][#][0][width][.precision][type]
+//             align  < left, > right, ^ centered
+//             sign   + always, space for a space before positives, - (default) negatives only
+//             #      0x / 0X / 0b / 0 prefix for x / X / b / o
+//             0      pads numbers with zeros after the sign and prefix
+//             type   d x X b o c for integers (and bool / char), f F e E g G
+//                    for floats, s for text and bool, p for pointers
+// A null char pointer is written as "(null)", both as an argument and as
+// the format string itself.
+// "{{" and "}}" are literal braces. Placeholders that don't parse, don't
+// fit their argument or name a missing argument are written unchanged.
+//
+// Numbers go through std::to_chars. Other types are written with their
+// operator<<, through an std::ostringstream. Width is counted in bytes.
+//
+// Literal format strings are checked against the arguments at compile time
+// in C++20 builds; in C++17 isValidFormat does the same for a static_assert,
+// which the ESDL_LOG_* macros make for theirs.
+
+#if defined(__cpp_consteval) && __cpp_consteval >= 201811L
+#define ESDL_CONSTEVAL consteval
+#define ESDL_CHECKED_FORMAT_STRINGS
+#else
+#define ESDL_CONSTEVAL constexpr
+#endif
 
 namespace esdl {
 
-template <typename... Ts>
-std::string format(const std::string& format, const Ts&... args);
+namespace detail {
+
+// How an argument is written, decided by its type
+enum class ArgKind : uint8_t {
+    Bool,
+    Char,
+    Int,
+    UInt,
+    Float,
+    Double,
+    String,
+    Pointer,
+    Custom
+};
+
+struct FormatSpec {
+    char fill = ' ';
+    char align = 0; // 0 for the default of the argument
+    char sign = '-';
+    bool alternate = false;
+    bool zeroPad = false;
+    int width = 0;
+    int precision = -1;
+    char type = 0;
+};
+
+struct Placeholder {
+    size_t end = 0; // One past the closing '}'
+    size_t argIndex = 0;
+    bool automatic = true; // No index given, so the next argument
+    FormatSpec spec;
+};
+
+// Parses a spec, the part of a placeholder after ':'
+constexpr bool parseSpec(std::string_view spec, FormatSpec& out);
+
+// Parses the placeholder whose '{' is at format[begin]
+constexpr bool parsePlaceholder(std::string_view format, size_t begin, Placeholder& out);
+
+// Whether an argument of "kind" can be written as "spec" asks
+constexpr bool specFits(const FormatSpec& spec, ArgKind kind);
+
+// Whether every placeholder parses and fits its argument
+constexpr bool checkFormat(std::string_view format, const ArgKind* kinds, size_t count);
+
+template <typename T>
+constexpr ArgKind argKind();
+
+struct StringArg {
+    const char* data;
+    size_t size;
+};
+
+struct CustomArg {
+    const void* object;
+    void (*write)(std::string& out, const void* object);
+};
 
-template <typename T, typename... Ts>
-std::string format(
-    size_t argIndex, 
-    const std::string& format, 
-    const T& arg, 
-    const Ts&... args
-);
+// Type erased argument, so the formatting itself isn't a template
+struct FormatArg {
+    ArgKind kind;
+    union {
+        bool b;
+        char c;
+        long long i;
+        unsigned long long u;
+        float f;
+        double d;
+        StringArg s;
+        const void* p;
+        CustomArg custom;
+    };
+};
 
 template <typename T>
-std::string format(size_t argIndex, const std::string& format, const T& arg);
+FormatArg makeArg(const T& arg);
+
+void formatTo(std::string& out, std::string_view format, const FormatArg* args, size_t count);
+
+std::string& threadFormatBuffer();
+
+// Called from the compile time check when it fails, so the compiler names
+// it in the error
+void formatStringDoesNotMatchArguments();
+
+template <typename T>
+struct TypeIdentity {
+    using Type = T;
+};
+
+template <typename... Ts>
+struct TypeList {};
+
+// The argument types of a call taking a format then Ts, for decltype only
+template <typename F, typename... Ts>
+TypeList<Ts...> formatArgTypes(const F& format, const Ts&... args);
 
-std::string format(size_t argIndex, const std::string& format);
+// isValidFormat for a char array format, which C++20 builds would check
+// too, and true for anything else, which might not be a constant
+template <typename... Ts, size_t N>
+constexpr bool isValidLiteralFormat(TypeList<Ts...>, const char (&format)[N]);
+
+template <typename... Ts, typename F>
+constexpr bool isValidLiteralFormat(TypeList<Ts...>, const F& format);
+
+}
+
+// Format string for arguments of types Ts
+template <typename... Ts>
+class BasicFormatString {
+public:
+    template <size_t N>
+    ESDL_CONSTEVAL BasicFormatString(const char (&format)[N]) : str(format), literal(true) {
+#if defined(ESDL_CHECKED_FORMAT_STRINGS)
+        constexpr detail::ArgKind kinds[] = { detail::argKind<Ts>()..., detail::ArgKind::Custom };
+        if (!detail::checkFormat(str, kinds, sizeof...(Ts)))
+            detail::formatStringDoesNotMatchArguments();
+#endif
+    }
+
+    template <
+        typename T, 
+        typename = std::enable_if_t<std::is_same_v<T, const char*> || std::is_same_v<T, char*>>
+    >
+    BasicFormatString(const T& format) : str(format ? format : "(null)") {}
+
+    BasicFormatString(std::string_view format) : str(format) {}
+
+    BasicFormatString(const std::string& format) : str(format) {}
+
+    constexpr std::string_view get() const { return str; }
+
+    // Whether it came from a char array, usually a literal, so the same
+    // pointer probably means the same text next time
+    constexpr bool isLiteral() const { return literal; }
+
+private:
+    std::string_view str;
+    bool literal = false;
+};
+
+// Keeps the format string out of deducing Ts, which come from the arguments
+template <typename... Ts>
+using FormatString = BasicFormatString<typename detail::TypeIdentity<Ts>::Type...>;
+
+// Format "args" into a new string
+template <typename... Ts>
+std::string format(FormatString<Ts...> format, const Ts&... args);
+
+// Append the formatted text to "out", reusing its capacity
+template <typename... Ts>
+void formatTo(std::string& out, FormatString<Ts...> format, const Ts&... args);
+
+// Format into a buffer owned by the calling thread, which stays valid until
+// the thread's next formatView (so not from an argument's operator<<)
+template <typename... Ts>
+std::string_view formatView(FormatString<Ts...> format, const Ts&... args);
+
+// For checking a format string in C++17 builds
+// static_assert(esdl::isValidFormat<int, float>("{} {:.3f}"));
+template <typename... Ts>
+constexpr bool isValidFormat(std::string_view format);
     
 }
 
+// Checks a literal format against the arguments after it, given as
+// "format, args...", in C++17 builds, where the constructor can't
+#if defined(ESDL_CHECKED_FORMAT_STRINGS)
+#define ESDL_CHECK_FORMAT(...) static_assert(true, "")
+#else
+#define ESDL_CHECK_FORMAT(...) \
+    static_assert( \
+        esdl::detail::isValidLiteralFormat( \
+            decltype(esdl::detail::formatArgTypes(__VA_ARGS__))(), \
+            ESDL_FIRST_ARG(__VA_ARGS__, unused) \
+        ), \
+        "Format string does not match the arguments" \
+    )
+#define ESDL_FIRST_ARG(first, ...) first
+#endif
+
 #include "format.inl"
\ No newline at end of file
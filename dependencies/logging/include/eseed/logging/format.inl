@@ -4,63 +4,281 @@
 
 #include <sstream>
 
-template <typename... Ts>
-std::string esdl::format(const std::string& format, const Ts&... args) {
-    return esdl::format(0, format, args...);
+namespace esdl::detail {
+
+constexpr bool isDigit(char ch) {
+    return ch >= '0' && ch <= '9';
 }
 
-template <typename T, typename... Ts>
-std::string esdl::format(
-    size_t argIndex, 
-    const std::string& format, 
-    const T& arg, 
-    const Ts&... args
-) {
-    std::string f = esdl::format(argIndex, format, arg);
-    return esdl::format(argIndex + 1, f, args...);
+constexpr bool isAlign(char ch) {
+    return ch == '<' || ch == '>' || ch == '^';
 }
 
-template <typename T>
-std::string esdl::format(
-    size_t argIndex, 
-    const std::string& format, 
-    const T& arg
-) {
-    std::ostringstream out;
-    bool readingArg = false;
-    std::string argStr;
+// Reads a decimal number at s[i], capped so widths can't run away
+constexpr int parseNumber(std::string_view s, size_t& i) {
+    int value = 0;
+    while (i < s.length() && isDigit(s[i])) {
+        if (value < 65536) value = value * 10 + (s[i] - '0');
+        i++;
+    }
+    return value;
+}
 
-    bool autoArgRead = false;
-    
-    for (size_t i = 0; i < format.length(); i++) {
-        const char& ch = format[i];
+}
 
-        if (ch == '{' && !readingArg) {
-            readingArg = true;
-            continue;
+constexpr bool esdl::detail::parseSpec(std::string_view spec, FormatSpec& out) {
+    size_t i = 0;
+
+    if (spec.length() >= 2 && isAlign(spec[1])) {
+        if (spec[0] == '{' || spec[0] == '}') return false;
+        out.fill = spec[0];
+        out.align = spec[1];
+        i = 2;
+    } else if (spec.length() >= 1 && isAlign(spec[0])) {
+        out.align = spec[0];
+        i = 1;
+    }
+
+    if (i < spec.length() && (spec[i] == '+' || spec[i] == '-' || spec[i] == ' ')) {
+        out.sign = spec[i++];
+    }
+
+    if (i < spec.length() && spec[i] == '#') {
+        out.alternate = true;
+        i++;
+    }
+
+    if (i < spec.length() && spec[i] == '0') {
+        out.zeroPad = true;
+        i++;
+    }
+
+    out.width = parseNumber(spec, i);
+
+    if (i < spec.length() && spec[i] == '.') {
+        i++;
+        if (i == spec.length() || !isDigit(spec[i])) return false;
+        out.precision = parseNumber(spec, i);
+    }
+
+    if (i < spec.length()) {
+        switch (spec[i]) {
+        case 'd': case 'x': case 'X': case 'b': case 'o': case 'c':
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+        case 's': case 'p':
+            out.type = spec[i++];
+            break;
+        default:
+            return false;
         }
+    }
+
+    return i == spec.length();
+}
+
+constexpr bool esdl::detail::parsePlaceholder(
+    std::string_view format, 
+    size_t begin, 
+    Placeholder& out
+) {
+    size_t close = format.find('}', begin + 1);
+    if (close == std::string_view::npos) return false;
 
-        if (ch == '}' && readingArg) {
-            readingArg = false;
+    std::string_view inner = format.substr(begin + 1, close - begin - 1);
+    if (inner.find('{') != std::string_view::npos) return false;
+
+    size_t i = 0;
+    out.automatic = inner.empty() || !isDigit(inner[0]);
+    if (!out.automatic) {
+        // No leading zeros, like std::format
+        if (inner[0] == '0' && inner.length() > 1 && isDigit(inner[1])) return false;
+        out.argIndex = size_t(parseNumber(inner, i));
+    }
 
-            if (argStr == "" && !autoArgRead) {
-                (std::ostream&)out << arg;
-                autoArgRead = true;
-            } else {
-                out << "{" << argStr << "}";
+    out.end = close + 1;
+    out.spec = FormatSpec();
+    if (i == inner.length()) return true;
+    if (inner[i] != ':') return false;
+    return parseSpec(inner.substr(i + 1), out.spec);
+}
+
+constexpr bool esdl::detail::specFits(const FormatSpec& spec, ArgKind kind) {
+    const char t = spec.type;
+    const bool integerType = t == 'd' || t == 'x' || t == 'X' || t == 'b' || t == 'o';
+    const bool floatType = t == 'f' || t == 'F' || t == 'e' || t == 'E' || t == 'g' || t == 'G';
+    const bool numeric = spec.sign != '-' || spec.alternate || spec.zeroPad;
+
+    switch (kind) {
+    case ArgKind::Bool:
+        return spec.precision < 0 && 
+            (integerType || (!numeric && (t == 0 || t == 's')));
+    case ArgKind::Char:
+        return spec.precision < 0 && 
+            (integerType || (!numeric && (t == 0 || t == 'c')));
+    case ArgKind::Int:
+    case ArgKind::UInt:
+        return spec.precision < 0 && 
+            (integerType || t == 0 || (!numeric && t == 'c'));
+    case ArgKind::Float:
+    case ArgKind::Double:
+        return !spec.alternate && (floatType || t == 0);
+    case ArgKind::String:
+        return !numeric && (t == 0 || t == 's');
+    case ArgKind::Pointer:
+        return !numeric && spec.precision < 0 && (t == 0 || t == 'p');
+    case ArgKind::Custom:
+        return !numeric && spec.precision < 0 && (t == 0 || t == 's');
+    }
+    return false;
+}
+
+constexpr bool esdl::detail::checkFormat(
+    std::string_view format, 
+    const ArgKind* kinds, 
+    size_t count
+) {
+    size_t next = 0;
+    for (size_t i = 0; i < format.length(); i++) {
+        if (format[i] == '}') {
+            if (i + 1 < format.length() && format[i + 1] == '}') {
+                i++;
+                continue;
             }
+            return false;
+        }
 
-            argStr = "";
-            
+        if (format[i] != '{') continue;
+
+        if (i + 1 < format.length() && format[i + 1] == '{') {
+            i++;
             continue;
         }
 
-        if (readingArg) {
-            argStr += ch;
-        } else {
-            out << ch;
-        }
+        Placeholder placeholder;
+        if (!parsePlaceholder(format, i, placeholder)) return false;
+
+        size_t index = placeholder.automatic ? next++ : placeholder.argIndex;
+        if (index >= count || !specFits(placeholder.spec, kinds[index])) return false;
+
+        i = placeholder.end - 1;
     }
+    return true;
+}
+
+namespace esdl::detail {
+
+template <typename T, typename = void>
+struct IsStreamable : std::false_type {};
+
+template <typename T>
+struct IsStreamable<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const T&>())>> : std::true_type {};
+
+template <typename T>
+void writeStreamed(std::string& out, const void* object) {
+    std::ostringstream stream;
+    stream << *static_cast<const T*>(object);
+    out += stream.str();
+}
+
+}
+
+template <typename T>
+constexpr esdl::detail::ArgKind esdl::detail::argKind() {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool>) {
+        return ArgKind::Bool;
+    } else if constexpr (std::is_same_v<U, char>) {
+        return ArgKind::Char;
+    } else if constexpr (std::is_same_v<U, float>) {
+        return ArgKind::Float;
+    } else if constexpr (std::is_floating_point_v<U>) {
+        return ArgKind::Double;
+    } else if constexpr (std::is_integral_v<U>) {
+        return std::is_signed_v<U> ? ArgKind::Int : ArgKind::UInt;
+    } else if constexpr (
+        std::is_same_v<U, const char*> || std::is_same_v<U, char*> || 
+        std::is_same_v<U, std::string> || std::is_same_v<U, std::string_view>
+    ) {
+        return ArgKind::String;
+    } else if constexpr (std::is_enum_v<U> && !IsStreamable<U>::value) {
+        return argKind<std::underlying_type_t<U>>();
+    } else if constexpr (std::is_pointer_v<U> || std::is_null_pointer_v<U>) {
+        return ArgKind::Pointer;
+    } else {
+        static_assert(IsStreamable<U>::value, "esdl::format arguments need an operator<< for std::ostream");
+        return ArgKind::Custom;
+    }
+}
+
+template <typename T>
+esdl::detail::FormatArg esdl::detail::makeArg(const T& arg) {
+    using U = std::decay_t<T>;
+    constexpr ArgKind kind = argKind<T>();
+
+    FormatArg out;
+    out.kind = kind;
+    if constexpr (kind == ArgKind::Bool) {
+        out.b = arg;
+    } else if constexpr (kind == ArgKind::Char) {
+        out.c = arg;
+    } else if constexpr (kind == ArgKind::Int) {
+        out.i = (long long)arg;
+    } else if constexpr (kind == ArgKind::UInt) {
+        out.u = (unsigned long long)arg;
+    } else if constexpr (kind == ArgKind::Float) {
+        out.f = arg;
+    } else if constexpr (kind == ArgKind::Double) {
+        out.d = double(arg);
+    } else if constexpr (kind == ArgKind::String) {
+        std::string_view view;
+        if constexpr (std::is_pointer_v<T>)
+            view = arg ? std::string_view(arg) : std::string_view("(null)");
+        else
+            view = arg;
+        out.s = { view.data(), view.length() };
+    } else if constexpr (kind == ArgKind::Pointer) {
+        out.p = (const void*)arg;
+    } else {
+        out.custom = { &arg, &writeStreamed<U> };
+    }
+    return out;
+}
+
+template <typename... Ts>
+std::string esdl::format(FormatString<Ts...> format, const Ts&... args) {
+    // Room for short arguments, so most lines allocate once
+    std::string out;
+    out.reserve(format.get().length() + 16 * sizeof...(Ts));
+    esdl::formatTo<Ts...>(out, format, args...);
+    return out;
+}
+
+template <typename... Ts>
+void esdl::formatTo(std::string& out, FormatString<Ts...> format, const Ts&... args) {
+    const detail::FormatArg packed[] = { detail::makeArg(args)..., detail::FormatArg() };
+    detail::formatTo(out, format.get(), packed, sizeof...(Ts));
+}
+
+template <typename... Ts>
+std::string_view esdl::formatView(FormatString<Ts...> format, const Ts&... args) {
+    std::string& buffer = detail::threadFormatBuffer();
+    buffer.clear();
+    esdl::formatTo<Ts...>(buffer, format, args...);
+    return buffer;
+}
+
+template <typename... Ts>
+constexpr bool esdl::isValidFormat(std::string_view format) {
+    constexpr detail::ArgKind kinds[] = { detail::argKind<Ts>()..., detail::ArgKind::Custom };
+    return detail::checkFormat(format, kinds, sizeof...(Ts));
+}
+
+template <typename... Ts, size_t N>
+constexpr bool esdl::detail::isValidLiteralFormat(TypeList<Ts...>, const char (&format)[N]) {
+    return isValidFormat<Ts...>(format);
+}
 
-    return out.str();
+template <typename... Ts, typename F>
+constexpr bool esdl::detail::isValidLiteralFormat(TypeList<Ts...>, const F&) {
+    return true;
 }
\ No newline at end of file
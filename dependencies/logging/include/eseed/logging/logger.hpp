@@ -1,14 +1,57 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <ctime>
 #include <vector>
 #include <ostream>
 #include <iostream>
 #include <memory>
 #include <eseed/logging/format.hpp>
+#include <eseed/logging/binarylog.hpp>
+
+// Levels below this are compiled out, from 0 (trace) to 5 (fatal); e.g.
+// -DESDL_COMPILE_MIN_LEVEL=2 keeps info and above
+#ifndef ESDL_COMPILE_MIN_LEVEL
+#define ESDL_COMPILE_MIN_LEVEL 0
+#endif
 
 namespace esdl {
 
+namespace detail {
+
+class AsyncBackend;
+
+}
+
+class LogSink;
+
+// What an asynchronous logger does with a line when its queue is full
+enum OverflowPolicy {
+    // Wait for the background thread to make room
+    OverflowBlock,
+    // Discard the line
+    OverflowDrop,
+    // Discard the line, and write how many were discarded once there's room
+    OverflowDropAndReport
+};
+
+struct AsyncOptions {
+    // Lines the queue holds, rounded up to a power of two
+    size_t capacity = 8192;
+
+    OverflowPolicy overflow = OverflowBlock;
+
+    // How long the background thread sleeps once the queue is empty, so
+    // about the longest a line waits before it's written
+    std::chrono::milliseconds interval = std::chrono::milliseconds(5);
+};
+
+// Logging is thread-safe. Lines are formatted in per-thread buffers with
+// no lock held; a sink only locks to copy a finished line into its buffer
+// or write it out, and an unbuffered StdoutSink or FileSink not even that,
+// see LogSink. With enableAsync() the logging thread just hands the line
+// to a lock-free queue.
 class Logger {
 public:
     enum LogLevel {
@@ -20,7 +63,7 @@ public:
         LogLevelFatal
     };
 
-    // Construct logger to std::cout
+    // Construct logger to stdout, see StdoutSink
     Logger();
 
     // Construct logger to a single output
@@ -29,53 +72,132 @@ public:
     // Construct logger to multiple outputs 
     Logger(std::vector<std::ostream*> outputs);
 
+    // Construct logger to sinks from sink.hpp, e.g. a FileSink at trace and
+    // a StdoutSink at warn
+    Logger(std::vector<std::shared_ptr<LogSink>> sinks);
+
+    // Copies share the sinks, backends and start time
+    Logger(const Logger& other);
+    Logger& operator=(const Logger& other);
+
+    // Add before other threads use the logger and before enableAsync()
+    void addSink(std::shared_ptr<LogSink> sink);
+
     // Check if "level" is equal to or above the minimum log level
-    bool isLevelEnabled(LogLevel level) const;
+    bool isLevelEnabled(LogLevel level) const {
+        return level >= ESDL_COMPILE_MIN_LEVEL && level >= minLogLevel.load(std::memory_order_relaxed);
+    }
 
-    // All log levels at and above "level" will be outputted 
+    // All log levels at and above "level" will be outputted, to the sinks
+    // whose own minimum level they also reach
     void setMinLogLevel(LogLevel level);
 
+    // Hand lines to a background thread, which writes them to the sinks
+    // in batches. Logging threads only copy the line into a lock-free queue.
+    // Fatal lines are written and flushed before fatal() returns.
+    // Enable and disable before and after other threads use the logger.
+    void enableAsync(const AsyncOptions& options = AsyncOptions());
+
+    // Write out the queued lines and go back to writing on the calling thread
+    void disableAsync();
+
+    bool isAsync() const;
+
+    // Follow the date of each line with the time since the logger was
+    // created, "+12.345678", from the monotonic clock: orders lines and
+    // measures the gaps between them to the microsecond, unaffected by
+    // the wall clock being adjusted.
+    // Enable and disable before other threads use the logger.
+    void setMonotonicOffsets(bool enabled);
+
+    bool hasMonotonicOffsets() const;
+
+    // Write binary records to a memory-mapped file at "path" instead of
+    // text to the sinks, see binarylog.hpp; esdl_decode turns the file
+    // back into text. Throws std::runtime_error if the file can't be made.
+    // Enable and disable before and after other threads use the logger.
+    void enableBinary(const std::string& path, size_t chunkSize = 16 << 20);
+
+    // Close the binary file and go back to text
+    void disableBinary();
+
+    bool isBinary() const;
+
+    // Wait until every line logged so far is written and the sinks flushed
+    void flush() const;
+
+    // Lines discarded by OverflowDrop / OverflowDropAndReport, including
+    // while async was enabled before, or that the binary file had no room
+    // for
+    size_t getDroppedCount() const;
+
+    // Append a line prefixed with date and level, and a newline. A
+    // non-negative "offset" follows the date, see setMonotonicOffsets().
+    // The date is cached per thread, and only formatted again once the
+    // second changes.
+    static void appendLine(
+        std::string& out, 
+        LogLevel level, 
+        std::chrono::system_clock::time_point time, 
+        std::string_view line, 
+        std::chrono::nanoseconds offset = std::chrono::nanoseconds(-1)
+    );
+
+    // Levels below the minimum cost one compare: the arguments are only
+    // formatted for lines that get written. Use the ESDL_LOG_* macros to
+    // skip evaluating the arguments too.
+
     // For the most verbose and insignificant of details
     template <typename... Ts>
-    void trace(const std::string& format, const Ts&... args) const {
-        return printlnLevel(LogLevelTrace, format, args...);
+    void trace(FormatString<Ts...> format, const Ts&... args) const {
+        printlnLevel(nullptr, LogLevelTrace, format, args...);
     }
 
     // For minor details to help with debugging
     template <typename... Ts>
-    std::string debug(const std::string& format, const Ts&... args) const {
-        return printlnLevel(LogLevelDebug, format, args...);
+    void debug(FormatString<Ts...> format, const Ts&... args) const {
+        printlnLevel(nullptr, LogLevelDebug, format, args...);
     }
 
     // For general information
     template <typename... Ts>
-    std::string info(const std::string& format, const Ts&... args) const {
-        return printlnLevel(LogLevelInfo, format, args...);
+    void info(FormatString<Ts...> format, const Ts&... args) const {
+        printlnLevel(nullptr, LogLevelInfo, format, args...);
     }
 
     // For unexpected but non-threatening circumstances
     template <typename... Ts>
-    std::string warn(const std::string& format, const Ts&... args) const {
-        return printlnLevel(LogLevelWarn, format, args...);
+    void warn(FormatString<Ts...> format, const Ts&... args) const {
+        printlnLevel(nullptr, LogLevelWarn, format, args...);
     }
 
+    // Error and fatal return the line even when their level is disabled,
+    // for throw std::runtime_error(mainLogger.error(...))
+
     // For a recoverable problem
     template <typename... Ts>
-    std::string error(const std::string& format, const Ts&... args) const {
-        return printlnLevel(LogLevelError, format, args...);
+    std::string error(FormatString<Ts...> format, const Ts&... args) const {
+        return printlnLevelString(LogLevelError, format, args...);
     }
 
     // For a problem that cannot be recovered from
     template <typename... Ts>
-    std::string fatal(const std::string& format, const Ts&... args) const {
-        return printlnLevel(LogLevelFatal, format, args...);
+    std::string fatal(FormatString<Ts...> format, const Ts&... args) const {
+        return printlnLevelString(LogLevelFatal, format, args...);
+    }
+
+    // What the ESDL_LOG_* macros call: logs at "level" like the methods
+    // above, with "site" caching the format's ID for a binary log
+    template <typename... Ts>
+    void log(FormatSite& site, LogLevel level, FormatString<Ts...> format, const Ts&... args) const {
+        printlnLevel(&site, level, format, args...);
     }
 
     // Assert a condition, crash the program and output a message if false
     template <typename... Ts>
     void fatalAssert(
         bool condition, 
-        const std::string& format, 
+        FormatString<Ts...> format, 
         const Ts&... args
     ) const {
         if (!condition) {
@@ -85,27 +207,111 @@ public:
     }
 
 private:
-    LogLevel minLogLevel = LogLevelInfo;
-    std::vector<std::ostream*> outputs;
+    friend class detail::AsyncBackend;
+
+    std::atomic<LogLevel> minLogLevel { LogLevelInfo };
+    std::vector<std::shared_ptr<LogSink>> sinks;
+    bool monotonicOffsets = false;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Shared by copies of the logger
+    std::shared_ptr<detail::AsyncBackend> async;
+    std::shared_ptr<std::atomic<size_t>> asyncDropped = std::make_shared<std::atomic<size_t>>(0);
+    std::shared_ptr<BinaryLog> binary;
 
-    static std::string getLogLevelString(LogLevel level);
+    static const char* getLogLevelString(LogLevel level);
+
+    // Format and print, if the level is enabled
+    template <typename... Ts>
+    void printlnLevel(
+        FormatSite* site, 
+        LogLevel level, 
+        FormatString<Ts...> format, 
+        const Ts&... args
+    ) const {
+        if (!isLevelEnabled(level)) return;
+        if (binary) {
+            binary->write(level, site, format, args...);
+            if (level == LogLevelFatal) binary->flush();
+            return;
+        }
+        println(level, esdl::formatView<Ts...>(format, args...));
+    }
 
-    // Condense arguments to pass to println function
+    // Format, print if the level is enabled and return the line
     template <typename... Ts>
-    std::string printlnLevel(
+    std::string printlnLevelString(
         LogLevel level, 
-        const std::string& format, 
+        FormatString<Ts...> format, 
         const Ts&... args
     ) const {
-        std::string line = esdl::format(format, args...);
-        if (isLevelEnabled(level)) println(getLogLevelString(level), line);
+        std::string line = esdl::format<Ts...>(format, args...);
+        if (!isLevelEnabled(level)) return line;
+        if (binary) {
+            binary->write(level, nullptr, format, args...);
+            if (level == LogLevelFatal) binary->flush();
+            return line;
+        }
+        println(level, line);
         return line;
     }
     
     // Print a line of text prefixed with date and level
-    void println(const std::string& level, const std::string& line) const;
+    void println(LogLevel level, std::string_view line) const;
 };
 
 inline Logger mainLogger;
 
-}
\ No newline at end of file
+}
+
+// Log only if the level is enabled, without evaluating the arguments
+// otherwise; levels below ESDL_COMPILE_MIN_LEVEL expand to nothing
+// ESDL_LOG_DEBUG(esdl::mainLogger, "Created {} buffers", countBuffers());
+// Each call site keeps its format's binary log ID in a static FormatSite,
+// so a format given as a char array must be a literal, not a buffer whose
+// text changes (C++20 builds reject those anyway). C++17 builds check a
+// literal against the arguments with ESDL_CHECK_FORMAT.
+// Unlike error() and fatal(), ESDL_LOG_ERROR and ESDL_LOG_FATAL don't
+// return the line; call those directly to throw it.
+#define ESDL_LOG_LEVEL(logger, level, ...) \
+    do { \
+        ESDL_CHECK_FORMAT(__VA_ARGS__); \
+        static esdl::FormatSite esdlFormatSite; \
+        if ((logger).isLevelEnabled(esdl::Logger::level)) (logger).log(esdlFormatSite, esdl::Logger::level, __VA_ARGS__); \
+    } while (false)
+
+#if ESDL_COMPILE_MIN_LEVEL <= 0
+#define ESDL_LOG_TRACE(logger, ...) ESDL_LOG_LEVEL(logger, LogLevelTrace, __VA_ARGS__)
+#else
+#define ESDL_LOG_TRACE(logger, ...) do {} while (false)
+#endif
+
+#if ESDL_COMPILE_MIN_LEVEL <= 1
+#define ESDL_LOG_DEBUG(logger, ...) ESDL_LOG_LEVEL(logger, LogLevelDebug, __VA_ARGS__)
+#else
+#define ESDL_LOG_DEBUG(logger, ...) do {} while (false)
+#endif
+
+#if ESDL_COMPILE_MIN_LEVEL <= 2
+#define ESDL_LOG_INFO(logger, ...) ESDL_LOG_LEVEL(logger, LogLevelInfo, __VA_ARGS__)
+#else
+#define ESDL_LOG_INFO(logger, ...) do {} while (false)
+#endif
+
+#if ESDL_COMPILE_MIN_LEVEL <= 3
+#define ESDL_LOG_WARN(logger, ...) ESDL_LOG_LEVEL(logger, LogLevelWarn, __VA_ARGS__)
+#else
+#define ESDL_LOG_WARN(logger, ...) do {} while (false)
+#endif
+
+#if ESDL_COMPILE_MIN_LEVEL <= 4
+#define ESDL_LOG_ERROR(logger, ...) ESDL_LOG_LEVEL(logger, LogLevelError, __VA_ARGS__)
+#else
+#define ESDL_LOG_ERROR(logger, ...) do {} while (false)
+#endif
+
+#if ESDL_COMPILE_MIN_LEVEL <= 5
+#define ESDL_LOG_FATAL(logger, ...) ESDL_LOG_LEVEL(logger, LogLevelFatal, __VA_ARGS__)
+#else
+#define ESDL_LOG_FATAL(logger, ...) do {} while (false)
+#endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace esdl::detail {
+
+// A file written through memory mappings of parts of it, for the binary
+// log and MappedFileSink
+class MappedFile {
+public:
+    // Mapping offsets must be multiples of this (the Windows allocation
+    // granularity, which covers every page size in use)
+    static constexpr size_t granularity = 64 * 1024;
+
+    MappedFile() = default;
+
+    // Closes without changing the size
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Open or create "path", emptying it if "truncate"; false on failure
+    bool open(const std::string& path, bool truncate);
+
+    bool isOpen() const;
+
+    uint64_t getSize() const;
+
+    bool resize(uint64_t size);
+
+    // Map [offset, offset + size) for writing, nullptr on failure
+    // The file must already reach offset + size
+    char* map(uint64_t offset, size_t size);
+
+    void unmap(char* base, size_t size);
+
+    // Start writing the mapped pages to disk
+    void flush(char* base, size_t size);
+
+    // Close, first setting the size to "size"; everything must be unmapped
+    void close(uint64_t size);
+
+    void close();
+
+private:
+#if defined(_WIN32)
+    void* file = nullptr;
+#else
+    int file = -1;
+#endif
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace esdl {
+
+// Bounded lock-free queue for many producer threads and one consumer
+//
+// Each cell carries a sequence number saying whose turn it is: producers
+// claim a position with a CAS on the tail and publish the cell by bumping
+// its sequence, the consumer takes cells in order once they are published
+// (D. Vyukov's bounded queue, with the consumer side unsynchronized). A
+// producer that stalls between claiming and publishing holds up the
+// consumer at its cell, but never the other producers.
+template <typename T>
+class MpscRing {
+public:
+    // "capacity" is rounded up to a power of two
+    explicit MpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        mask = size - 1;
+        cells = std::make_unique<Cell[]>(size);
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    size_t getCapacity() const { return mask + 1; }
+
+    // Positions claimed so far, including pushes not published yet
+    size_t getPushCount() const { return tail.load(std::memory_order_acquire); }
+
+    // Positions taken by the consumer so far
+    size_t getPopCount() const { return head.load(std::memory_order_acquire); }
+
+    // Claim a cell, fill it with write(T&) and publish it
+    // False without calling write when the ring is full
+    template <typename F>
+    bool tryPush(F&& write) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            ptrdiff_t diff = ptrdiff_t(sequence) - ptrdiff_t(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                // The consumer hasn't freed this cell from the last lap
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        write(cell->value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only: hand up to "max" published cells to read(T&) in order
+    // Returns how many were read
+    template <typename F>
+    size_t pop(F&& read, size_t max) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        size_t count = 0;
+        while (count < max) {
+            Cell& cell = cells[pos & mask];
+            if (cell.sequence.load(std::memory_order_acquire) != pos + 1) break;
+            read(cell.value);
+            cell.sequence.store(pos + mask + 1, std::memory_order_release);
+            pos++;
+            count++;
+        }
+        head.store(pos, std::memory_order_release);
+        return count;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    // Producers and the consumer each get their own cache line
+    alignas(64) std::atomic<size_t> tail { 0 };
+    alignas(64) std::atomic<size_t> head { 0 };
+    alignas(64) size_t mask = 0;
+    std::unique_ptr<Cell[]> cells;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <eseed/logging/logger.hpp>
+#include <eseed/logging/mappedfile.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace esdl {
+
+// Destination for a Logger's lines, with its own level and buffering
+//
+// Lines collect in the sink's buffer and are written out:
+// - when the buffer reaches the buffer size
+// - when a line at or above the flush level arrives (which also flushes)
+// - at the end of each batch if the buffer size is 0: after every line
+//   when logging synchronously, after every drain of the async queue
+// - on Logger::flush() and when the sink is destroyed
+// Derived sinks call flush() in their destructors, while they can still
+// write.
+//
+// A sink is safe to use from several threads. Lines are formatted by the
+// Logger and rendered by appendLine() into a per-thread buffer, outside
+// any lock; the sink's mutex is only held to copy the result into the
+// shared buffer or write it out, so lines never interleave. Unbuffered
+// sinks whose writes are atomic on their own (see writesAtomically()) skip
+// the mutex for lines written straight through. Logger::enableAsync()
+// takes the sinks off the logging threads altogether.
+class LogSink {
+public:
+    virtual ~LogSink() = default;
+
+    // Lines below "level" are skipped
+    void setMinLevel(Logger::LogLevel level);
+
+    Logger::LogLevel getMinLevel() const;
+
+    bool accepts(Logger::LogLevel level) const { 
+        return level >= minLevel.load(std::memory_order_relaxed); 
+    }
+
+    void setBuffering(size_t bufferSize, Logger::LogLevel flushLevel = Logger::LogLevelError);
+
+    // A whole line, prefix and newline included; "lastInBatch" also ends
+    // the batch
+    void write(Logger::LogLevel level, std::string_view line, bool lastInBatch = false);
+
+    // The Logger is done with a group of lines
+    void endBatch();
+
+    // Write out the buffer and flush the destination
+    void flush();
+
+protected:
+    // Append a line to the buffer, e.g. with escape codes around it
+    // Called without the mutex held, so it mustn't touch the sink's state
+    virtual void appendLine(std::string& buffer, Logger::LogLevel level, std::string_view line);
+
+    // Write whole lines to the destination
+    virtual void writeData(std::string_view data) = 0;
+
+    // Push what's been written to the OS
+    virtual void flushData() {}
+
+    // Whether writeData() and flushData() may be called from several
+    // threads at once, each write landing whole (e.g. one stdio call on a
+    // stream that locks itself)
+    virtual bool writesAtomically() const { return false; }
+
+private:
+    std::atomic<Logger::LogLevel> minLevel { Logger::LogLevelTrace };
+
+    std::atomic<Logger::LogLevel> flushLevel { Logger::LogLevelError };
+    std::atomic<size_t> bufferSize { 0 };
+
+    // Guards the buffer, and the derived sinks' state through the virtual
+    // functions above
+    std::mutex mutex;
+    std::string buffer;
+
+    void writeBuffer();
+    void flushBuffer();
+};
+
+// Any std::ostream, unbuffered by default
+class StreamSink : public LogSink {
+public:
+    explicit StreamSink(std::ostream* out);
+
+    ~StreamSink() override;
+
+protected:
+    void writeData(std::string_view data) override;
+    void flushData() override;
+
+private:
+    std::ostream* out;
+};
+
+// Standard output, with the lines colored by level on terminals
+class StdoutSink : public LogSink {
+public:
+    enum ColorMode {
+        ColorAuto, // Colors if stdout is a terminal
+        ColorAlways,
+        ColorNever
+    };
+
+    explicit StdoutSink(ColorMode mode = ColorAuto);
+
+    ~StdoutSink() override;
+
+    bool hasColors() const { return colors; }
+
+protected:
+    void appendLine(std::string& buffer, Logger::LogLevel level, std::string_view line) override;
+    void writeData(std::string_view data) override;
+    void flushData() override;
+    bool writesAtomically() const override { return true; }
+
+private:
+    bool colors;
+};
+
+// Appends to a file, buffering 64 KiB by default
+class FileSink : public LogSink {
+public:
+    // Throws std::runtime_error if the file can't be opened
+    explicit FileSink(const std::string& path, bool append = true);
+
+    ~FileSink() override;
+
+protected:
+    void writeData(std::string_view data) override;
+    void flushData() override;
+    bool writesAtomically() const override { return true; }
+
+    // Throws std::runtime_error if the file can't be opened
+    void openFile(bool append);
+
+    void closeFile();
+
+    const std::string& getPath() const { return path; }
+
+private:
+    std::string path;
+    std::FILE* file = nullptr;
+};
+
+// FileSink that moves the file aside once it's too big or too old:
+// "log.txt" becomes "log.txt.1", "log.txt.1" becomes "log.txt.2" and so
+// on, keeping "keep" old files
+class RotatingFileSink : public FileSink {
+public:
+    // 0 for no size or age limit
+    RotatingFileSink(
+        const std::string& path, 
+        uint64_t maxSize, 
+        std::chrono::seconds maxAge = std::chrono::seconds(0), 
+        size_t keep = 5
+    );
+
+    ~RotatingFileSink() override;
+
+protected:
+    void writeData(std::string_view data) override;
+    // Tracks the size and may reopen the file
+    bool writesAtomically() const override { return false; }
+
+private:
+    uint64_t maxSize;
+    std::chrono::seconds maxAge;
+    size_t keep;
+    uint64_t size = 0;
+    std::chrono::steady_clock::time_point opened;
+
+    void rotate();
+};
+
+// Appends through a memory mapping of the file, so writing out is a copy;
+// the OS writes the pages back on its own schedule, and flush() asks it to
+// start now. Buffers 16 KiB by default.
+class MappedFileSink : public LogSink {
+public:
+    // Throws std::runtime_error if the file can't be opened or mapped
+    // "chunkSize" is how much is mapped at once, rounded up to 64 KiB
+    explicit MappedFileSink(const std::string& path, bool append = true, size_t chunkSize = 4 << 20);
+
+    // Trims the file to what was written
+    ~MappedFileSink() override;
+
+protected:
+    void writeData(std::string_view data) override;
+    void flushData() override;
+
+private:
+    detail::MappedFile file;
+    size_t chunkSize;
+    char* chunk = nullptr;
+    uint64_t chunkOffset = 0;
+    // File offset of the next byte
+    uint64_t end = 0;
+
+    void mapChunk(uint64_t offset);
+
+    // Move "end" back over the zeros a sink that didn't close cleanly
+    // left at the end of the file
+    void trimZeros();
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include <eseed/logging/asyncbackend.hpp>
+
+#include <cstring>
+
+using namespace esdl;
+using namespace esdl::detail;
+
+namespace {
+
+// Records per pop, and the batch size after which the sinks end a batch
+// early
+constexpr size_t popSize = 256;
+constexpr size_t batchSize = 64 * 1024;
+
+}
+
+AsyncBackend::AsyncBackend(
+    std::vector<std::shared_ptr<LogSink>> sinks, 
+    const AsyncOptions& options, 
+    std::shared_ptr<std::atomic<size_t>> dropped
+) : ring(options.capacity), sinks(sinks), options(options), dropped(dropped) {
+    // Lines dropped by an earlier backend were reported by it
+    reportedDropped = dropped->load(std::memory_order_relaxed);
+    thread = std::thread([this] { run(); });
+}
+
+AsyncBackend::~AsyncBackend() {
+    stopping.store(true, std::memory_order_release);
+    requestWake();
+    thread.join();
+}
+
+void AsyncBackend::push(
+    Logger::LogLevel level, 
+    std::chrono::system_clock::time_point time, 
+    std::chrono::nanoseconds offset, 
+    std::string_view line
+) {
+    auto write = [&](AsyncRecord& record) {
+        record.time = time;
+        record.offset = offset;
+        record.level = level;
+        record.length = uint32_t(line.length());
+        if (line.length() <= AsyncRecord::inlineCapacity) {
+            record.longText = nullptr;
+            std::memcpy(record.text, line.data(), line.length());
+        } else {
+            record.longText = new std::string(line);
+        }
+    };
+
+    if (ring.tryPush(write)) return;
+
+    // Fatal lines always wait, so they're never lost
+    if (options.overflow != OverflowBlock && level != Logger::LogLevelFatal) {
+        dropped->fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    requestWake();
+    while (!ring.tryPush(write)) {
+        std::this_thread::yield();
+    }
+}
+
+void AsyncBackend::flush() {
+    size_t target = ring.getPushCount();
+    size_t request;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request = ++flushRequests;
+    }
+    requestWake();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [&] { return writtenCount >= target && flushedRequests >= request; });
+}
+
+void AsyncBackend::requestWake() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        wakeRequested = true;
+    }
+    wake.notify_one();
+}
+
+void AsyncBackend::run() {
+    while (true) {
+        // Anything pushed before stopping was set is drained below
+        bool stop = stopping.load(std::memory_order_acquire);
+        drain();
+        if (stop) return;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait_for(lock, options.interval, [&] { return wakeRequested; });
+        wakeRequested = false;
+    }
+}
+
+void AsyncBackend::drain() {
+    size_t requests;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests = flushRequests;
+    }
+
+    auto read = [&](AsyncRecord& record) {
+        std::string_view text = record.longText 
+            ? std::string_view(*record.longText) 
+            : std::string_view(record.text, record.length);
+        writeLine(record.level, record.time, record.offset, text);
+        delete record.longText;
+    };
+
+    while (ring.pop(read, popSize) > 0) {
+        if (batchLength >= batchSize) endBatch();
+    }
+
+    if (options.overflow == OverflowDropAndReport) {
+        size_t droppedNow = dropped->load(std::memory_order_relaxed);
+        if (droppedNow != reportedDropped) {
+            std::string message = esdl::format("Dropped {} log lines, the queue was full", droppedNow - reportedDropped);
+            writeLine(Logger::LogLevelWarn, std::chrono::system_clock::now(), lastOffset, message);
+            reportedDropped = droppedNow;
+        }
+    }
+
+    if (batchLength > 0) endBatch();
+
+    if (requests != flushedRequests) {
+        for (auto& sink : sinks) {
+            sink->flush();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        writtenCount = ring.getPopCount();
+        flushedRequests = requests;
+    }
+    written.notify_all();
+}
+
+void AsyncBackend::writeLine(
+    Logger::LogLevel level, 
+    std::chrono::system_clock::time_point time, 
+    std::chrono::nanoseconds offset, 
+    std::string_view text
+) {
+    line.clear();
+    Logger::appendLine(line, level, time, text, offset);
+    lastOffset = offset;
+    for (auto& sink : sinks) {
+        if (sink->accepts(level)) sink->write(level, line);
+    }
+    batchLength += line.length();
+}
+
+void AsyncBackend::endBatch() {
+    for (auto& sink : sinks) {
+        sink->endBatch();
+    }
+    batchLength = 0;
+}
\ No newline at end of file
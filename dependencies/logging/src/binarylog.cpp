@@ -0,0 +1,382 @@
+#include <eseed/logging/binarylog.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+using namespace esdl;
+using namespace esdl::detail;
+
+namespace {
+
+constexpr size_t headerSize = binary::alignRecord(sizeof(binary::FileHeader));
+
+std::atomic<uint64_t> nextGeneration { 1 };
+
+int64_t nowNs(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+size_t argSize(const FormatArg& arg) {
+    switch (arg.kind) {
+    case ArgKind::Bool:
+    case ArgKind::Char:
+        return 1;
+    case ArgKind::Float:
+        return 4;
+    case ArgKind::String:
+        return 4 + arg.s.size;
+    default:
+        return 8;
+    }
+}
+
+char* writeArg(char* out, const FormatArg& arg) {
+    switch (arg.kind) {
+    case ArgKind::Bool: *out = char(arg.b); return out + 1;
+    case ArgKind::Char: *out = arg.c; return out + 1;
+    case ArgKind::Int: std::memcpy(out, &arg.i, 8); return out + 8;
+    case ArgKind::UInt: std::memcpy(out, &arg.u, 8); return out + 8;
+    case ArgKind::Float: std::memcpy(out, &arg.f, 4); return out + 4;
+    case ArgKind::Double: std::memcpy(out, &arg.d, 8); return out + 8;
+    case ArgKind::Pointer: {
+        uint64_t p = uint64_t(uintptr_t(arg.p));
+        std::memcpy(out, &p, 8);
+        return out + 8;
+    }
+    case ArgKind::String: {
+        uint32_t length = uint32_t(arg.s.size);
+        std::memcpy(out, &length, 4);
+        std::memcpy(out + 4, arg.s.data, arg.s.size);
+        return out + 4 + arg.s.size;
+    }
+    default:
+        return out;
+    }
+}
+
+// Custom arguments as text, since operator<< isn't available to the decoder
+const FormatArg* renderCustom(const FormatArg* args, size_t count) {
+    size_t custom = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (args[i].kind == ArgKind::Custom) custom++;
+    }
+    if (custom == 0) return args;
+
+    thread_local std::string text;
+    thread_local std::vector<size_t> ends;
+    thread_local std::vector<FormatArg> converted;
+    text.clear();
+    ends.clear();
+    for (size_t i = 0; i < count; i++) {
+        if (args[i].kind == ArgKind::Custom) args[i].custom.write(text, args[i].custom.object);
+        ends.push_back(text.length());
+    }
+
+    converted.assign(args, args + count);
+    size_t begin = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (args[i].kind == ArgKind::Custom) {
+            converted[i].kind = ArgKind::String;
+            converted[i].s = { text.data() + begin, ends[i] - begin };
+        }
+        begin = ends[i];
+    }
+    return converted.data();
+}
+
+}
+
+uint64_t esdl::binary::readTicks() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return uint64_t(steadyNs());
+#endif
+}
+
+BinaryLog::BinaryLog(const std::string& path, size_t chunkSize) 
+: file(std::make_unique<MappedFile>()),
+generation(nextGeneration.fetch_add(1, std::memory_order_relaxed)),
+chunkSize((std::max(chunkSize, MappedFile::granularity) + MappedFile::granularity - 1) / MappedFile::granularity * MappedFile::granularity),
+table(std::make_unique<FormatEntry[]>(tableSize)) {
+    if (!file->open(path, true)) {
+        throw std::runtime_error(esdl::format("Could not create binary log \"{}\"", path));
+    }
+
+    Chunk* first = mapChunk(0);
+    if (!first) {
+        file->close(0);
+        throw std::runtime_error(esdl::format("Could not map binary log \"{}\"", path));
+    }
+
+    // Ticks per second, measured against steady_clock for a few ms
+    binary::FileHeader header = {};
+    std::memcpy(header.magic, binary::magic, sizeof(header.magic));
+    header.version = binary::version;
+    header.headerSize = uint32_t(headerSize);
+    header.chunkSize = this->chunkSize;
+    header.wallNs = nowNs(std::chrono::system_clock::now());
+    header.steadyNs = steadyNs();
+    header.ticks = binary::readTicks();
+    int64_t endNs;
+    uint64_t endTicks;
+    do {
+        std::this_thread::yield();
+        endNs = steadyNs();
+        endTicks = binary::readTicks();
+    } while (endNs - header.steadyNs < 5000000);
+    header.ticksPerSecond = double(endTicks - header.ticks) * 1e9 / double(endNs - header.steadyNs);
+    std::memcpy(first->base, &header, sizeof(header));
+    first->used.store(headerSize, std::memory_order_relaxed);
+    first->written.store(headerSize, std::memory_order_relaxed);
+
+    chunks.emplace_back(first);
+    mapped.push_back(first);
+    current.store(first, std::memory_order_release);
+
+    const ArgKind textKind = ArgKind::String;
+    textId = defineFormat("{}", &textKind, 1);
+}
+
+BinaryLog::~BinaryLog() {
+    writeSync();
+
+    Chunk* last = current.load(std::memory_order_acquire);
+    uint64_t size = last->fileOffset + std::min(last->used.load(std::memory_order_relaxed), last->size);
+    for (Chunk* chunk : mapped) {
+        file->unmap(chunk->base, chunk->size);
+    }
+    file->close(size);
+}
+
+void BinaryLog::write(
+    int level, 
+    FormatSite* site, 
+    std::string_view format, 
+    bool literal, 
+    const FormatArg* args, 
+    size_t count
+) {
+    uint64_t ticks = binary::readTicks();
+
+    uint32_t id = 0;
+    if (literal && site) {
+        const uint64_t cached = site->cached.load(std::memory_order_relaxed);
+        if (cached >> 24 == generation) {
+            id = uint32_t(cached & 0xFFFFFF);
+        } else {
+            id = findFormat(format, args, count);
+            if (id != 0) site->cached.store(generation << 24 | id, std::memory_order_relaxed);
+        }
+    } else if (literal) {
+        id = findFormat(format, args, count);
+    }
+    FormatArg textArg;
+    if (id == 0) {
+        // Not worth an ID, so formatted now and stored as text
+        thread_local std::string text;
+        text.clear();
+        detail::formatTo(text, format, args, count);
+        textArg.kind = ArgKind::String;
+        textArg.s = { text.data(), text.length() };
+        args = &textArg;
+        count = 1;
+        id = textId;
+    }
+
+    args = renderCustom(args, count);
+
+    size_t size = sizeof(binary::RecordHeader);
+    for (size_t i = 0; i < count; i++) {
+        size += argSize(args[i]);
+    }
+    size = binary::alignRecord(size);
+
+    Chunk* chunk;
+    char* out = reserve(size, chunk);
+    if (!out) return;
+
+    binary::RecordHeader header = { uint32_t(size), binary::makeTag(id, level), ticks };
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    for (size_t i = 0; i < count; i++) {
+        out = writeArg(out, args[i]);
+    }
+    commit(chunk, size);
+}
+
+void BinaryLog::flush() {
+    std::lock_guard<std::mutex> lock(chunkMutex);
+    retireChunks();
+    // Normally only the current chunk, unless a writer is still finishing
+    // a record in the one before
+    for (Chunk* chunk : mapped) {
+        file->flush(chunk->base, chunk->size);
+    }
+}
+
+size_t BinaryLog::getDroppedCount() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+uint32_t BinaryLog::findFormat(std::string_view format, const FormatArg* args, size_t count) {
+    auto matches = [&](const FormatEntry& entry) {
+        if (entry.text != format || entry.kinds.size() != count) return false;
+        for (size_t i = 0; i < count; i++) {
+            ArgKind kind = args[i].kind == ArgKind::Custom ? ArgKind::String : args[i].kind;
+            if (entry.kinds[i] != kind) return false;
+        }
+        return true;
+    };
+
+    const size_t mask = tableSize - 1;
+    const size_t hash = size_t((uint64_t(uintptr_t(format.data())) * 0x9E3779B97F4A7C15ull) >> 40);
+    for (size_t probe = 0; probe < tableSize; probe++) {
+        FormatEntry& entry = table[(hash + probe) & mask];
+        const char* key = entry.key.load(std::memory_order_acquire);
+        if (!key) break;
+        if (key == format.data() && matches(entry)) return entry.id;
+    }
+
+    // First use, register it
+    std::lock_guard<std::mutex> lock(formatMutex);
+    for (size_t probe = 0; probe < tableSize * 3 / 4; probe++) {
+        FormatEntry& entry = table[(hash + probe) & mask];
+        const char* key = entry.key.load(std::memory_order_relaxed);
+        if (key == format.data() && matches(entry)) return entry.id;
+        if (key) continue;
+
+        if (nextId >= binary::RecordSync) return 0;
+        entry.text = std::string(format);
+        entry.kinds.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            entry.kinds[i] = args[i].kind == ArgKind::Custom ? ArgKind::String : args[i].kind;
+        }
+        entry.id = defineFormat(entry.text, entry.kinds.data(), count);
+        entry.key.store(format.data(), std::memory_order_release);
+        return entry.id;
+    }
+
+    // The table is too full to probe quickly
+    return 0;
+}
+
+uint32_t BinaryLog::defineFormat(std::string_view format, const ArgKind* kinds, size_t count) {
+    uint32_t id = nextId++;
+
+    uint32_t fields[3] = { id, uint32_t(count), uint32_t(format.length()) };
+    size_t size = binary::alignRecord(sizeof(binary::RecordHeader) + sizeof(fields) + count + format.length());
+    Chunk* chunk;
+    char* out = reserve(size, chunk);
+    if (!out) return id;
+
+    binary::RecordHeader header = { uint32_t(size), binary::makeTag(binary::RecordDefinition, 0), binary::readTicks() };
+    std::memcpy(out, &header, sizeof(header));
+    std::memcpy(out + sizeof(header), fields, sizeof(fields));
+    std::memcpy(out + sizeof(header) + sizeof(fields), kinds, count);
+    std::memcpy(out + sizeof(header) + sizeof(fields) + count, format.data(), format.length());
+    commit(chunk, size);
+    return id;
+}
+
+char* BinaryLog::reserve(size_t size, Chunk*& chunkOut) {
+    if (size > chunkSize - headerSize) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    while (true) {
+        Chunk* chunk = current.load(std::memory_order_acquire);
+        size_t offset = chunk->used.fetch_add(size, std::memory_order_relaxed);
+        if (offset + size <= chunk->size) {
+            chunkOut = chunk;
+            return chunk->base + offset;
+        }
+
+        // The reservation that crosses the end pads out the chunk
+        if (offset < chunk->size) {
+            uint32_t padding[2] = { uint32_t(chunk->size - offset), binary::RecordPadding };
+            std::memcpy(chunk->base + offset, padding, sizeof(padding));
+            commit(chunk, chunk->size - offset);
+        }
+
+        bool mapped = false;
+        {
+            std::lock_guard<std::mutex> lock(chunkMutex);
+            if (current.load(std::memory_order_relaxed) == chunk) {
+                Chunk* next = mapChunk(chunk->fileOffset + chunk->size);
+                if (!next) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                chunks.emplace_back(next);
+                this->mapped.push_back(next);
+                current.store(next, std::memory_order_release);
+                retireChunks();
+                mapped = true;
+            }
+        }
+
+        // Gives the decoder a fresh point to measure the tick rate from
+        if (mapped) writeSync();
+    }
+}
+
+void BinaryLog::commit(Chunk* chunk, size_t size) {
+    chunk->written.fetch_add(size, std::memory_order_release);
+}
+
+BinaryLog::Chunk* BinaryLog::mapChunk(uint64_t fileOffset) {
+    if (!file->resize(fileOffset + chunkSize)) return nullptr;
+    char* base = file->map(fileOffset, chunkSize);
+    if (!base) return nullptr;
+
+    Chunk* chunk = new Chunk();
+    chunk->base = base;
+    chunk->size = chunkSize;
+    chunk->fileOffset = fileOffset;
+    chunk->used.store(0, std::memory_order_relaxed);
+    chunk->written.store(0, std::memory_order_relaxed);
+    return chunk;
+}
+
+void BinaryLog::retireChunks() {
+    Chunk* last = current.load(std::memory_order_relaxed);
+    auto finished = [&](Chunk* chunk) {
+        if (chunk == last || chunk->written.load(std::memory_order_acquire) != chunk->size) return false;
+        file->flush(chunk->base, chunk->size);
+        file->unmap(chunk->base, chunk->size);
+        chunk->base = nullptr;
+        return true;
+    };
+    mapped.erase(std::remove_if(mapped.begin(), mapped.end(), finished), mapped.end());
+}
+
+void BinaryLog::writeSync() {
+    const size_t size = binary::alignRecord(sizeof(binary::RecordHeader) + 8);
+    Chunk* chunk;
+    char* out = reserve(size, chunk);
+    if (!out) return;
+
+    int64_t ns = steadyNs();
+    binary::RecordHeader header = { uint32_t(size), binary::makeTag(binary::RecordSync, 0), binary::readTicks() };
+    std::memcpy(out, &header, sizeof(header));
+    std::memcpy(out + sizeof(header), &ns, sizeof(ns));
+    commit(chunk, size);
+}
\ No newline at end of file
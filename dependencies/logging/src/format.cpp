@@ -1,5 +1,257 @@
 #include <eseed/logging/format.hpp>
 
-std::string esdl::format(size_t argIndex, const std::string& format) {
-    return format;
-}
\ No newline at end of file
+#include <charconv>
+#include <cmath>
+
+using namespace esdl;
+using namespace esdl::detail;
+
+namespace {
+
+// Writes "body" padded out to the spec's width
+void writePadded(
+    std::string& out, 
+    std::string_view body, 
+    const FormatSpec& spec, 
+    char defaultAlign
+) {
+    size_t width = size_t(spec.width);
+    if (body.length() >= width) {
+        out += body;
+        return;
+    }
+
+    size_t fill = width - body.length();
+    char align = spec.align ? spec.align : defaultAlign;
+    size_t before = align == '>' ? fill : align == '^' ? fill / 2 : 0;
+    out.append(before, spec.fill);
+    out += body;
+    out.append(fill - before, spec.fill);
+}
+
+// Writes a number already split into sign / prefix and digits, which zero
+// padding goes between
+void writeNumber(
+    std::string& out, 
+    std::string_view prefix, 
+    std::string_view digits, 
+    const FormatSpec& spec
+) {
+    size_t length = prefix.length() + digits.length();
+    size_t fill = length < size_t(spec.width) ? size_t(spec.width) - length : 0;
+
+    if (spec.zeroPad && !spec.align) {
+        out += prefix;
+        out.append(fill, '0');
+        out += digits;
+        return;
+    }
+
+    char align = spec.align ? spec.align : '>';
+    size_t before = align == '>' ? fill : align == '^' ? fill / 2 : 0;
+    out.append(before, spec.fill);
+    out += prefix;
+    out += digits;
+    out.append(fill - before, spec.fill);
+}
+
+void writeInteger(
+    std::string& out, 
+    unsigned long long magnitude, 
+    bool negative, 
+    const FormatSpec& spec
+) {
+    char prefix[3];
+    size_t prefixLength = 0;
+    if (negative) prefix[prefixLength++] = '-';
+    else if (spec.sign == '+' || spec.sign == ' ') prefix[prefixLength++] = spec.sign;
+
+    int base = 10;
+    switch (spec.type) {
+    case 'x': case 'X': base = 16; break;
+    case 'b': base = 2; break;
+    case 'o': base = 8; break;
+    }
+
+    if (spec.alternate && base != 10) {
+        prefix[prefixLength++] = '0';
+        if (base != 8) prefix[prefixLength++] = spec.type;
+    }
+
+    char digits[64];
+    char* end = std::to_chars(digits, digits + sizeof(digits), magnitude, base).ptr;
+    if (spec.type == 'X') {
+        for (char* ch = digits; ch != end; ch++) {
+            if (*ch >= 'a') *ch -= 'a' - 'A';
+        }
+    }
+
+    writeNumber(
+        out, 
+        std::string_view(prefix, prefixLength), 
+        std::string_view(digits, size_t(end - digits)), 
+        spec
+    );
+}
+
+void writeSigned(std::string& out, long long value, const FormatSpec& spec) {
+    unsigned long long magnitude = value < 0 ? 0 - (unsigned long long)value : (unsigned long long)value;
+    writeInteger(out, magnitude, value < 0, spec);
+}
+
+void writeChar(std::string& out, char ch, const FormatSpec& spec) {
+    writePadded(out, std::string_view(&ch, 1), spec, '<');
+}
+
+template <typename T>
+std::to_chars_result floatToChars(char* first, char* last, T value, const FormatSpec& spec) {
+    int precision = spec.precision;
+    switch (spec.type) {
+    case 'f': case 'F':
+        return std::to_chars(first, last, value, std::chars_format::fixed, precision < 0 ? 6 : precision);
+    case 'e': case 'E':
+        return std::to_chars(first, last, value, std::chars_format::scientific, precision < 0 ? 6 : precision);
+    case 'g': case 'G':
+        return std::to_chars(first, last, value, std::chars_format::general, precision < 0 ? 6 : precision);
+    default:
+        // Shortest text that reads back as the same value
+        if (precision < 0) return std::to_chars(first, last, value);
+        return std::to_chars(first, last, value, std::chars_format::general, precision);
+    }
+}
+
+template <typename T>
+void writeFloat(std::string& out, T value, const FormatSpec& spec) {
+    // Fixed notation of large values can run to hundreds of digits
+    char small[64];
+    std::string large;
+    char* first = small;
+    std::to_chars_result result = floatToChars(small, small + sizeof(small), value, spec);
+    if (result.ec == std::errc::value_too_large) {
+        large.resize(size_t(400 + spec.precision));
+        first = large.data();
+        result = floatToChars(first, first + large.length(), value, spec);
+    }
+
+    bool negative = *first == '-';
+    if (negative) first++;
+
+    if (spec.type == 'F' || spec.type == 'E' || spec.type == 'G') {
+        for (char* ch = first; ch != result.ptr; ch++) {
+            if (*ch >= 'a' && *ch <= 'z') *ch -= 'a' - 'A';
+        }
+    }
+
+    char sign = negative ? '-' : (spec.sign == '+' || spec.sign == ' ') ? spec.sign : 0;
+    std::string_view digits(first, size_t(result.ptr - first));
+
+    FormatSpec numberSpec = spec;
+    if (!std::isfinite(value)) numberSpec.zeroPad = false;
+    writeNumber(out, std::string_view(&sign, sign ? 1 : 0), digits, numberSpec);
+}
+
+void writeString(std::string& out, std::string_view str, const FormatSpec& spec) {
+    if (spec.precision >= 0 && size_t(spec.precision) < str.length()) {
+        str = str.substr(0, size_t(spec.precision));
+    }
+    writePadded(out, str, spec, '<');
+}
+
+void writeArg(std::string& out, const FormatArg& arg, const FormatSpec& spec) {
+    const bool asInteger = spec.type != 0 && spec.type != 's' && spec.type != 'c';
+
+    switch (arg.kind) {
+    case ArgKind::Bool:
+        if (asInteger) writeInteger(out, arg.b, false, spec);
+        else writeString(out, arg.b ? "true" : "false", spec);
+        break;
+    case ArgKind::Char:
+        if (asInteger) writeSigned(out, arg.c, spec);
+        else writeChar(out, arg.c, spec);
+        break;
+    case ArgKind::Int:
+        if (spec.type == 'c') writeChar(out, char(arg.i), spec);
+        else writeSigned(out, arg.i, spec);
+        break;
+    case ArgKind::UInt:
+        if (spec.type == 'c') writeChar(out, char(arg.u), spec);
+        else writeInteger(out, arg.u, false, spec);
+        break;
+    case ArgKind::Float:
+        writeFloat(out, arg.f, spec);
+        break;
+    case ArgKind::Double:
+        writeFloat(out, arg.d, spec);
+        break;
+    case ArgKind::String:
+        writeString(out, std::string_view(arg.s.data, arg.s.size), spec);
+        break;
+    case ArgKind::Pointer: {
+        FormatSpec hexSpec = spec;
+        hexSpec.type = 'x';
+        hexSpec.alternate = true;
+        writeInteger(out, (unsigned long long)(uintptr_t)arg.p, false, hexSpec);
+        break;
+    }
+    case ArgKind::Custom:
+        if (spec.width == 0) {
+            arg.custom.write(out, arg.custom.object);
+        } else {
+            std::string body;
+            arg.custom.write(body, arg.custom.object);
+            writePadded(out, body, spec, '<');
+        }
+        break;
+    }
+}
+
+}
+
+void esdl::detail::formatTo(
+    std::string& out, 
+    std::string_view format, 
+    const FormatArg* args, 
+    size_t count
+) {
+    size_t next = 0;
+    size_t literal = 0; // Start of the text not written yet
+
+    for (size_t i = 0; i < format.length(); i++) {
+        const char ch = format[i];
+        if (ch != '{' && ch != '}') continue;
+
+        // Escaped brace, written as one
+        if (i + 1 < format.length() && format[i + 1] == ch) {
+            out.append(format, literal, i + 1 - literal);
+            literal = i + 2;
+            i++;
+            continue;
+        }
+
+        // Lone '}' stays as text
+        if (ch == '}') continue;
+
+        Placeholder placeholder;
+        if (!parsePlaceholder(format, i, placeholder)) continue;
+
+        size_t index = placeholder.automatic ? next++ : placeholder.argIndex;
+        if (index >= count || !specFits(placeholder.spec, args[index].kind)) {
+            i = placeholder.end - 1;
+            continue;
+        }
+
+        out.append(format, literal, i - literal);
+        writeArg(out, args[index], placeholder.spec);
+        literal = placeholder.end;
+        i = placeholder.end - 1;
+    }
+
+    out.append(format, literal, format.length() - literal);
+}
+
+std::string& esdl::detail::threadFormatBuffer() {
+    thread_local std::string buffer;
+    return buffer;
+}
+
+void esdl::detail::formatStringDoesNotMatchArguments() {}
\ No newline at end of file
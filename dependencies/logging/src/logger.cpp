@@ -1,27 +1,107 @@
 #include <eseed/logging/logger.hpp>
+#include <eseed/logging/asyncbackend.hpp>
+#include <eseed/logging/sink.hpp>
+
+#include <cstdio>
 
 using namespace esdl;
 
 Logger::Logger() {
-    outputs.push_back(&std::cout);
+    sinks.push_back(std::make_shared<StdoutSink>());
 }
 
 Logger::Logger(std::ostream* destination) {
-    outputs.push_back(destination);
+    sinks.push_back(std::make_shared<StreamSink>(destination));
+}
+
+Logger::Logger(std::vector<std::ostream*> outputs) {
+    for (auto out : outputs) {
+        sinks.push_back(std::make_shared<StreamSink>(out));
+    }
 }
 
-Logger::Logger(std::vector<std::ostream*> outputs) 
-: outputs(outputs) {}
+Logger::Logger(std::vector<std::shared_ptr<LogSink>> sinks) 
+: sinks(sinks) {}
+
+Logger::Logger(const Logger& other) 
+: minLogLevel(other.minLogLevel.load(std::memory_order_relaxed)), 
+  sinks(other.sinks), 
+  monotonicOffsets(other.monotonicOffsets), 
+  start(other.start), 
+  async(other.async), 
+  asyncDropped(other.asyncDropped), 
+  binary(other.binary) {}
 
-bool Logger::isLevelEnabled(LogLevel level) const {
-    return level >= minLogLevel;
+Logger& Logger::operator=(const Logger& other) {
+    minLogLevel.store(other.minLogLevel.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    sinks = other.sinks;
+    monotonicOffsets = other.monotonicOffsets;
+    start = other.start;
+    async = other.async;
+    asyncDropped = other.asyncDropped;
+    binary = other.binary;
+    return *this;
+}
+
+void Logger::addSink(std::shared_ptr<LogSink> sink) {
+    sinks.push_back(sink);
 }
 
 void Logger::setMinLogLevel(LogLevel level) {
-    minLogLevel = level;
+    minLogLevel.store(level, std::memory_order_relaxed);
+}
+
+void Logger::enableAsync(const AsyncOptions& options) {
+    async = std::make_shared<detail::AsyncBackend>(sinks, options, asyncDropped);
+}
+
+void Logger::disableAsync() {
+    async.reset();
+}
+
+bool Logger::isAsync() const {
+    return async != nullptr;
+}
+
+void Logger::setMonotonicOffsets(bool enabled) {
+    monotonicOffsets = enabled;
+}
+
+bool Logger::hasMonotonicOffsets() const {
+    return monotonicOffsets;
+}
+
+void Logger::enableBinary(const std::string& path, size_t chunkSize) {
+    binary = std::make_shared<BinaryLog>(path, chunkSize);
+}
+
+void Logger::disableBinary() {
+    binary.reset();
 }
 
-std::string Logger::getLogLevelString(LogLevel level) {
+bool Logger::isBinary() const {
+    return binary != nullptr;
+}
+
+void Logger::flush() const {
+    if (binary) {
+        binary->flush();
+        return;
+    }
+    if (async) {
+        async->flush();
+        return;
+    }
+    for (auto& sink : sinks) {
+        sink->flush();
+    }
+}
+
+size_t Logger::getDroppedCount() const {
+    return asyncDropped->load(std::memory_order_relaxed) + (binary ? binary->getDroppedCount() : 0);
+}
+
+const char* Logger::getLogLevelString(LogLevel level) {
     switch (level) {
     case LogLevelTrace: return "TRACE";
     case LogLevelDebug: return "DEBUG";
@@ -33,21 +113,67 @@ std::string Logger::getLogLevelString(LogLevel level) {
     }
 }
 
-void Logger::println(
-    const std::string &level, 
-    const std::string &line
-) const {
-    time_t tt;
-    time(&tt);
-    tm ti;
-    localtime_s(&ti, &tt);
+namespace {
+
+// "yy-mm-dd HH:MM:SS" of the last second a thread logged in
+struct DateCache {
+    time_t second = -1;
+    char text[18] = {};
+    size_t length = 0;
+};
+
+std::string_view getDate(std::chrono::system_clock::time_point time) {
+    thread_local DateCache cache;
 
-    char timeStr[18];
-    strftime(timeStr, sizeof(timeStr), "%y-%m-%d %H:%M:%S", &ti);
+    time_t tt = std::chrono::system_clock::to_time_t(time);
+    if (tt != cache.second) {
+        tm ti;
+#if defined(_WIN32)
+        localtime_s(&ti, &tt);
+#else
+        localtime_r(&tt, &ti);
+#endif
+        cache.length = strftime(cache.text, sizeof(cache.text), "%y-%m-%d %H:%M:%S", &ti);
+        cache.second = tt;
+    }
+    return std::string_view(cache.text, cache.length);
+}
+
+}
+
+void Logger::appendLine(
+    std::string& out, 
+    LogLevel level, 
+    std::chrono::system_clock::time_point time, 
+    std::string_view line, 
+    std::chrono::nanoseconds offset
+) {
+    out += getDate(time);
+    if (offset.count() >= 0) {
+        const int64_t us = offset.count() / 1000;
+        esdl::formatTo(out, " +{}.{:06}", us / 1000000, us % 1000000);
+    }
+    out += " [";
+    out += getLogLevelString(level);
+    out += "]: ";
+    out += line;
+    out += '\n';
+}
+
+void Logger::println(LogLevel level, std::string_view line) const {
+    auto now = std::chrono::system_clock::now();
+    auto offset = monotonicOffsets ? std::chrono::steady_clock::now() - start : std::chrono::nanoseconds(-1);
+
+    if (async) {
+        async->push(level, now, offset, line);
+        if (level == LogLevelFatal) async->flush();
+        return;
+    }
 
-    std::string outLine = std::string(timeStr) + " [" + level + "]: " + line;
-    for (auto out : outputs)
-    {
-        *out << outLine << std::endl;
+    thread_local std::string outLine;
+    outLine.clear();
+    appendLine(outLine, level, now, line, offset);
+    for (auto& sink : sinks) {
+        if (sink->accepts(level)) sink->write(level, outLine, true);
     }
 }
\ No newline at end of file
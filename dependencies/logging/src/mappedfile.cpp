@@ -0,0 +1,124 @@
+#include <eseed/logging/mappedfile.hpp>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace esdl::detail;
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string& path, bool truncate) {
+    HANDLE handle = CreateFileA(
+        path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, 
+        nullptr, truncate ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    file = handle;
+    return true;
+}
+
+bool MappedFile::isOpen() const {
+    return file != nullptr;
+}
+
+uint64_t MappedFile::getSize() const {
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) return 0;
+    return uint64_t(size.QuadPart);
+}
+
+bool MappedFile::resize(uint64_t size) {
+    LARGE_INTEGER end;
+    end.QuadPart = LONGLONG(size);
+    return SetFilePointerEx(file, end, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+}
+
+char* MappedFile::map(uint64_t offset, size_t size) {
+    uint64_t end = offset + size;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, DWORD(end >> 32), DWORD(end), nullptr);
+    if (!mapping) return nullptr;
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, DWORD(offset >> 32), DWORD(offset), size);
+    // The view keeps the mapping object alive
+    CloseHandle(mapping);
+    return static_cast<char*>(view);
+}
+
+void MappedFile::unmap(char* base, size_t) {
+    UnmapViewOfFile(base);
+}
+
+void MappedFile::flush(char* base, size_t size) {
+    FlushViewOfFile(base, size);
+}
+
+void MappedFile::close(uint64_t size) {
+    if (!file) return;
+    resize(size);
+    close();
+}
+
+void MappedFile::close() {
+    if (!file) return;
+    CloseHandle(file);
+    file = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, bool truncate) {
+    file = ::open(path.c_str(), O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+    return file >= 0;
+}
+
+bool MappedFile::isOpen() const {
+    return file >= 0;
+}
+
+uint64_t MappedFile::getSize() const {
+    struct stat info;
+    if (fstat(file, &info) != 0) return 0;
+    return uint64_t(info.st_size);
+}
+
+bool MappedFile::resize(uint64_t size) {
+    return ftruncate(file, off_t(size)) == 0;
+}
+
+char* MappedFile::map(uint64_t offset, size_t size) {
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, off_t(offset));
+    return view == MAP_FAILED ? nullptr : static_cast<char*>(view);
+}
+
+void MappedFile::unmap(char* base, size_t size) {
+    munmap(base, size);
+}
+
+void MappedFile::flush(char* base, size_t size) {
+    msync(base, size, MS_ASYNC);
+}
+
+void MappedFile::close(uint64_t size) {
+    if (file < 0) return;
+    resize(size);
+    close();
+}
+
+void MappedFile::close() {
+    if (file < 0) return;
+    ::close(file);
+    file = -1;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include <eseed/logging/sink.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace esdl;
+
+void LogSink::setMinLevel(Logger::LogLevel level) {
+    minLevel.store(level, std::memory_order_relaxed);
+}
+
+Logger::LogLevel LogSink::getMinLevel() const {
+    return minLevel.load(std::memory_order_relaxed);
+}
+
+void LogSink::setBuffering(size_t bufferSize, Logger::LogLevel flushLevel) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Nothing may be left behind once lines start going straight through
+    if (!buffer.empty()) flushBuffer();
+    this->bufferSize.store(bufferSize, std::memory_order_relaxed);
+    this->flushLevel.store(flushLevel, std::memory_order_relaxed);
+    buffer.reserve(bufferSize);
+}
+
+void LogSink::write(Logger::LogLevel level, std::string_view line, bool lastInBatch) {
+    thread_local std::string rendered;
+    rendered.clear();
+    appendLine(rendered, level, line);
+
+    size_t bufferSize = this->bufferSize.load(std::memory_order_relaxed);
+
+    // Unbuffered and not batched: the buffer is empty, so the line can go
+    // straight out
+    if (lastInBatch && bufferSize == 0 && writesAtomically()) {
+        writeData(rendered);
+        flushData();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer += rendered;
+    if (level >= flushLevel.load(std::memory_order_relaxed) || (lastInBatch && bufferSize == 0)) {
+        flushBuffer();
+    } else if (bufferSize > 0 && buffer.length() >= bufferSize) {
+        writeBuffer();
+    }
+}
+
+void LogSink::endBatch() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (bufferSize.load(std::memory_order_relaxed) == 0 && !buffer.empty()) flushBuffer();
+}
+
+void LogSink::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    flushBuffer();
+}
+
+void LogSink::appendLine(std::string& buffer, Logger::LogLevel, std::string_view line) {
+    buffer += line;
+}
+
+void LogSink::writeBuffer() {
+    if (buffer.empty()) return;
+    writeData(buffer);
+    buffer.clear();
+}
+
+void LogSink::flushBuffer() {
+    writeBuffer();
+    flushData();
+}
+
+StreamSink::StreamSink(std::ostream* out) : out(out) {}
+
+StreamSink::~StreamSink() {
+    flush();
+}
+
+void StreamSink::writeData(std::string_view data) {
+    out->write(data.data(), std::streamsize(data.length()));
+}
+
+void StreamSink::flushData() {
+    out->flush();
+}
+
+namespace {
+
+bool enableTerminalColors() {
+#if defined(_WIN32)
+    if (!_isatty(_fileno(stdout))) return false;
+    // Windows 10 consoles understand the escape codes once asked to
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode;
+    if (!GetConsoleMode(console, &mode)) return false;
+    return SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
+#else
+    return isatty(fileno(stdout)) != 0;
+#endif
+}
+
+std::string_view getLevelColor(Logger::LogLevel level) {
+    switch (level) {
+    case Logger::LogLevelTrace: return "\x1b[90m";
+    case Logger::LogLevelDebug: return "\x1b[36m";
+    case Logger::LogLevelWarn: return "\x1b[33m";
+    case Logger::LogLevelError: return "\x1b[31m";
+    case Logger::LogLevelFatal: return "\x1b[1;31m";
+    default: return "";
+    }
+}
+
+}
+
+StdoutSink::StdoutSink(ColorMode mode) 
+: colors(mode == ColorAlways || (mode == ColorAuto && enableTerminalColors())) {}
+
+StdoutSink::~StdoutSink() {
+    flush();
+}
+
+void StdoutSink::appendLine(std::string& buffer, Logger::LogLevel level, std::string_view line) {
+    std::string_view color = colors ? getLevelColor(level) : "";
+    if (color.empty()) {
+        buffer += line;
+        return;
+    }
+
+    // Reset before the newline, so a line cut short can't bleed color
+    if (!line.empty() && line.back() == '\n') line.remove_suffix(1);
+    buffer += color;
+    buffer += line;
+    buffer += "\x1b[0m\n";
+}
+
+void StdoutSink::writeData(std::string_view data) {
+    std::fwrite(data.data(), 1, data.length(), stdout);
+}
+
+void StdoutSink::flushData() {
+    std::fflush(stdout);
+}
+
+FileSink::FileSink(const std::string& path, bool append) : path(path) {
+    setBuffering(64 * 1024);
+    openFile(append);
+}
+
+FileSink::~FileSink() {
+    flush();
+    closeFile();
+}
+
+void FileSink::writeData(std::string_view data) {
+    if (file) std::fwrite(data.data(), 1, data.length(), file);
+}
+
+void FileSink::flushData() {
+    if (file) std::fflush(file);
+}
+
+void FileSink::openFile(bool append) {
+    file = std::fopen(path.c_str(), append ? "ab" : "wb");
+    if (!file) throw std::runtime_error(esdl::format("Could not open log file \"{}\"", path));
+    // The sink buffers already
+    std::setvbuf(file, nullptr, _IONBF, 0);
+}
+
+void FileSink::closeFile() {
+    if (file) std::fclose(file);
+    file = nullptr;
+}
+
+RotatingFileSink::RotatingFileSink(
+    const std::string& path, 
+    uint64_t maxSize, 
+    std::chrono::seconds maxAge, 
+    size_t keep
+) : FileSink(path, true), maxSize(maxSize), maxAge(maxAge), keep(keep), opened(std::chrono::steady_clock::now()) {
+    std::error_code error;
+    size = std::filesystem::file_size(path, error);
+    if (error) size = 0;
+}
+
+RotatingFileSink::~RotatingFileSink() {
+    flush();
+}
+
+void RotatingFileSink::writeData(std::string_view data) {
+    if (size > 0 && maxAge.count() > 0 && std::chrono::steady_clock::now() - opened >= maxAge) rotate();
+
+    // The buffer holds many lines, split it at the last one that fits
+    while (maxSize > 0 && size + data.length() > maxSize) {
+        size_t room = size_t(std::min<uint64_t>(maxSize - std::min(size, maxSize), data.length()));
+        size_t split = room > 0 ? data.rfind('\n', room - 1) : std::string_view::npos;
+        if (split != std::string_view::npos || size == 0) {
+            // A line longer than maxSize gets a file of its own
+            if (split == std::string_view::npos) split = data.find('\n');
+            size_t count = split == std::string_view::npos ? data.length() : split + 1;
+            FileSink::writeData(data.substr(0, count));
+            size += count;
+            data.remove_prefix(count);
+            if (data.empty()) return;
+        }
+        rotate();
+    }
+
+    FileSink::writeData(data);
+    size += data.length();
+}
+
+void RotatingFileSink::rotate() {
+    namespace fs = std::filesystem;
+    const std::string& path = getPath();
+    auto numbered = [&](size_t n) { return esdl::format("{}.{}", path, n); };
+
+    closeFile();
+
+    // Failing to move a file only costs that old log, never the new lines
+    std::error_code error;
+    if (keep > 0) {
+        fs::remove(numbered(keep), error);
+        for (size_t n = keep - 1; n > 0; n--) {
+            if (fs::exists(numbered(n), error)) fs::rename(numbered(n), numbered(n + 1), error);
+        }
+        fs::rename(path, numbered(1), error);
+    }
+
+    try {
+        openFile(false);
+    } catch (const std::runtime_error&) {
+        // Lines are dropped until the next rotation manages to open it
+    }
+    size = 0;
+    opened = std::chrono::steady_clock::now();
+}
+
+MappedFileSink::MappedFileSink(const std::string& path, bool append, size_t chunkSize) 
+: chunkSize((std::max(chunkSize, detail::MappedFile::granularity) + detail::MappedFile::granularity - 1) / detail::MappedFile::granularity * detail::MappedFile::granularity) {
+    // Copying into the mapping is cheap, asking the OS to write it back
+    // after every line isn't
+    setBuffering(16 * 1024);
+
+    if (!file.open(path, !append)) {
+        throw std::runtime_error(esdl::format("Could not open log file \"{}\"", path));
+    }
+
+    end = file.getSize();
+    // Closing trims the file to what was written, so only a sink that
+    // didn't close cleanly leaves it at a whole number of mappings
+    if (end % detail::MappedFile::granularity == 0) trimZeros();
+
+    mapChunk(end / detail::MappedFile::granularity * detail::MappedFile::granularity);
+    if (!chunk) {
+        throw std::runtime_error(esdl::format("Could not map log file \"{}\"", path));
+    }
+}
+
+MappedFileSink::~MappedFileSink() {
+    flush();
+    if (chunk) file.unmap(chunk, chunkSize);
+    file.close(end);
+}
+
+void MappedFileSink::writeData(std::string_view data) {
+    while (!data.empty() && chunk) {
+        size_t at = size_t(end - chunkOffset);
+        if (at == chunkSize) {
+            mapChunk(chunkOffset + chunkSize);
+            continue;
+        }
+
+        size_t count = std::min(chunkSize - at, data.length());
+        std::memcpy(chunk + at, data.data(), count);
+        end += count;
+        data.remove_prefix(count);
+    }
+}
+
+void MappedFileSink::flushData() {
+    if (chunk) file.flush(chunk, chunkSize);
+}
+
+void MappedFileSink::trimZeros() {
+    // The zeros can span several chunks, so scan back a mapping at a time
+    const size_t window = detail::MappedFile::granularity;
+    while (end > 0) {
+        uint64_t offset = (end - 1) / window * window;
+        char* data = file.map(offset, window);
+        if (!data) return;
+        while (end > offset && data[end - 1 - offset] == 0) end--;
+        file.unmap(data, window);
+        if (end > offset) return;
+    }
+}
+
+void MappedFileSink::mapChunk(uint64_t offset) {
+    if (chunk) file.unmap(chunk, chunkSize);
+    chunk = nullptr;
+    chunkOffset = offset;
+
+    if (file.getSize() < offset + chunkSize && !file.resize(offset + chunkSize)) return;
+    chunk = file.map(offset, chunkSize);
+}
\ No newline at end of file
@@ -0,0 +1,514 @@
+// Tests for eseed_logging, run by ctest
+//
+// eseed_logging_tests [esdl_decode path]
+// The binary log round trip is skipped without the path to esdl_decode.
+
+#include <eseed/logging/binarylog.hpp>
+#include <eseed/logging/logger.hpp>
+#include <eseed/logging/sink.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace esdl;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* expression, const char* file, int line) {
+    if (condition) return;
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    failures++;
+}
+
+#define CHECK(...) check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+std::string tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("esdl_test_" + name)).string();
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    size_t begin = 0;
+    while (begin < text.length()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos) end = text.length();
+        lines.push_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return lines;
+}
+
+// What follows "[LEVEL]: ", empty if the line isn't prefixed like one
+std::string getMessage(const std::string& line) {
+    size_t at = line.find("]: ");
+    return at == std::string::npos ? std::string() : line.substr(at + 3);
+}
+
+// Every other message is long enough to be kept outside the async record
+std::string getThreadMessage(int thread, int index) {
+    std::string message = esdl::format("thread {} line {} ", thread, index);
+    message.append(index % 2 ? 300 : 20, char('a' + thread));
+    return message;
+}
+
+// Logs from several threads, then checks every line arrived whole and in
+// order per thread
+void checkThreads(bool async) {
+    const int threadCount = 4;
+    const int lineCount = 5000;
+
+    std::ostringstream out;
+    Logger logger({ std::make_shared<StreamSink>(&out) });
+    if (async) {
+        AsyncOptions options;
+        options.capacity = 256;
+        logger.enableAsync(options);
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < lineCount; i++) logger.info("{}", getThreadMessage(t, i));
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    if (async) logger.disableAsync();
+
+    std::vector<int> next(threadCount, 0);
+    size_t badLines = 0;
+    std::vector<std::string> lines = splitLines(out.str());
+    for (const std::string& line : lines) {
+        int t = -1;
+        int i = -1;
+        std::string message = getMessage(line);
+        if (std::sscanf(message.c_str(), "thread %d line %d", &t, &i) != 2
+            || t < 0 || t >= threadCount || i != next[t]
+            || message != getThreadMessage(t, i)) {
+            badLines++;
+            continue;
+        }
+        next[t]++;
+    }
+
+    CHECK(badLines == 0);
+    CHECK(lines.size() == size_t(threadCount * lineCount));
+    for (int t = 0; t < threadCount; t++) CHECK(next[t] == lineCount);
+    CHECK(logger.getDroppedCount() == 0);
+}
+
+void testSyncThreads() {
+    checkThreads(false);
+}
+
+void testAsyncThreads() {
+    checkThreads(true);
+}
+
+// A small queue with several threads filling it: nothing is lost
+void testOverflowBlock() {
+    const int threadCount = 4;
+    const int lineCount = 2000;
+
+    std::ostringstream out;
+    Logger logger({ std::make_shared<StreamSink>(&out) });
+    AsyncOptions options;
+    options.capacity = 16;
+    options.overflow = OverflowBlock;
+    options.interval = std::chrono::milliseconds(50);
+    logger.enableAsync(options);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < lineCount; i++) logger.info("{}", getThreadMessage(t, i));
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    logger.disableAsync();
+
+    CHECK(splitLines(out.str()).size() == size_t(threadCount * lineCount));
+    CHECK(logger.getDroppedCount() == 0);
+}
+
+// Logs far more than the queue holds while the background thread sleeps;
+// what's written plus what's dropped is everything, and with
+// OverflowDropAndReport the dropped lines are counted in the log too
+void checkOverflowDrop(OverflowPolicy policy) {
+    const size_t lineCount = 1000;
+
+    std::ostringstream out;
+    Logger logger({ std::make_shared<StreamSink>(&out) });
+    AsyncOptions options;
+    options.capacity = 16;
+    options.overflow = policy;
+    options.interval = std::chrono::seconds(1);
+    logger.enableAsync(options);
+
+    for (size_t i = 0; i < lineCount; i++) logger.info("line {}", i);
+    logger.disableAsync();
+
+    size_t written = 0;
+    size_t reported = 0;
+    for (const std::string& line : splitLines(out.str())) {
+        std::string message = getMessage(line);
+        size_t count = 0;
+        if (message.rfind("line ", 0) == 0) {
+            written++;
+        } else if (std::sscanf(message.c_str(), "Dropped %zu log lines", &count) == 1) {
+            reported += count;
+        }
+    }
+
+    size_t dropped = logger.getDroppedCount();
+    CHECK(dropped > 0);
+    CHECK(written + dropped == lineCount);
+    CHECK(reported == (policy == OverflowDropAndReport ? dropped : 0));
+}
+
+void testOverflowDrop() {
+    checkOverflowDrop(OverflowDrop);
+}
+
+void testOverflowDropAndReport() {
+    checkOverflowDrop(OverflowDropAndReport);
+}
+
+// A fatal line is in the file when fatal() returns, along with everything
+// before it, though the sink buffers 64 KiB and the background thread
+// would otherwise sleep for a minute
+void checkFatalFlushed(bool async) {
+    std::string path = tempPath(async ? "fatal_async.txt" : "fatal_sync.txt");
+    std::remove(path.c_str());
+
+    Logger logger({ std::make_shared<FileSink>(path, false) });
+    if (async) {
+        AsyncOptions options;
+        options.interval = std::chrono::seconds(60);
+        logger.enableAsync(options);
+    }
+
+    logger.info("before {}", 1);
+    logger.warn("before {}", 2);
+    logger.fatal("fatal {}", 3);
+
+    std::vector<std::string> lines = splitLines(readFile(path));
+    CHECK(lines.size() == 3);
+    if (lines.size() == 3) {
+        CHECK(getMessage(lines[0]) == "before 1");
+        CHECK(getMessage(lines[1]) == "before 2");
+        CHECK(lines[2].find("[FATAL]: fatal 3") != std::string::npos);
+    }
+
+    if (async) logger.disableAsync();
+    std::remove(path.c_str());
+}
+
+void testSyncFatalFlushed() {
+    checkFatalFlushed(false);
+}
+
+void testAsyncFatalFlushed() {
+    checkFatalFlushed(true);
+}
+
+// The ESDL_LOG_* macros, error and fatal included, write enabled levels and
+// skip evaluating the arguments of disabled ones
+void testLogMacros() {
+    std::ostringstream out;
+    Logger logger({ std::make_shared<StreamSink>(&out) });
+    logger.setMinLogLevel(Logger::LogLevelWarn);
+
+    int evaluated = 0;
+    auto count = [&] { return ++evaluated; };
+    ESDL_LOG_TRACE(logger, "trace {}", count());
+    ESDL_LOG_DEBUG(logger, "debug {}", count());
+    ESDL_LOG_INFO(logger, "info {}", count());
+    ESDL_LOG_WARN(logger, "warn {}", count());
+    ESDL_LOG_ERROR(logger, "error {}", count());
+    ESDL_LOG_FATAL(logger, "fatal {}", count());
+    logger.flush();
+
+    // Formats that aren't literals skip the compile time check
+    const std::string runtimeFormat = "runtime {}";
+    ESDL_LOG_WARN(logger, runtimeFormat, 4);
+    logger.flush();
+
+    CHECK(evaluated == 3);
+    std::vector<std::string> lines = splitLines(out.str());
+    CHECK(lines.size() == 4);
+    if (lines.size() == 4) {
+        CHECK(lines[0].find("[WARN]: warn 1") != std::string::npos);
+        CHECK(lines[1].find("[ERROR]: error 2") != std::string::npos);
+        CHECK(lines[2].find("[FATAL]: fatal 3") != std::string::npos);
+        CHECK(lines[3].find("[WARN]: runtime 4") != std::string::npos);
+    }
+}
+
+// What the macros' static_assert sees in C++17 builds
+static_assert(detail::isValidLiteralFormat(decltype(detail::formatArgTypes("{} {:.3f}", 1, 2.f))(), "{} {:.3f}"));
+static_assert(!detail::isValidLiteralFormat(decltype(detail::formatArgTypes("{} {}", 1))(), "{} {}"));
+static_assert(!detail::isValidLiteralFormat(detail::TypeList<float>(), "{:x}"));
+static_assert(detail::isValidLiteralFormat(detail::TypeList<>(), std::string_view("{:x}")));
+
+// Null char pointers, as arguments and as the format, are written as
+// "(null)" rather than read
+void testNullStrings() {
+    const char* none = nullptr;
+    char* noneMutable = nullptr;
+    CHECK(esdl::format("{} {} {}", none, noneMutable, "text") == "(null) (null) text");
+    CHECK(esdl::format("[{:>8}]", none) == "[  (null)]");
+    CHECK(esdl::format(none) == "(null)");
+
+    std::ostringstream out;
+    Logger logger({ std::make_shared<StreamSink>(&out) });
+    ESDL_LOG_INFO(logger, "name {}", none);
+    logger.flush();
+    CHECK(out.str().find("[INFO]: name (null)") != std::string::npos);
+}
+
+// Reopens a file the way a MappedFileSink leaves it when the process dies:
+// grown to a whole chunk, the rest of it zeros. The zeros are trimmed and
+// new lines follow straight on from the old ones.
+void checkMappedReopen(size_t textSize) {
+    const size_t chunkSize = 4 << 20;
+    std::string path = tempPath("mapped_reopen.txt");
+
+    std::string before;
+    for (size_t i = 0; before.length() < textSize; i++) {
+        before += esdl::format("line {}\n", i);
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << before;
+        out << std::string(chunkSize - before.length(), '\0');
+    }
+
+    {
+        Logger logger({ std::make_shared<MappedFileSink>(path, true, chunkSize) });
+        logger.info("after {}", 1);
+    }
+
+    std::string text = readFile(path);
+    CHECK(text.find('\0') == std::string::npos);
+    CHECK(text.compare(0, before.length(), before) == 0);
+    std::vector<std::string> lines = splitLines(text.substr(std::min(before.length(), text.length())));
+    CHECK(lines.size() == 1 && getMessage(lines[0]) == "after 1");
+
+    std::remove(path.c_str());
+}
+
+void testMappedReopen() {
+    // Zeros across all but the first mapping, then from within a later one
+    checkMappedReopen(100);
+    checkMappedReopen(300 * 1024 + 7);
+}
+
+// Runs esdl_decode, true if it succeeded
+bool decode(const std::string& decoder, const std::string& binaryPath, const std::string& textPath) {
+    std::string command = "\"" + decoder + "\" \"" + binaryPath + "\" \"" + textPath + "\"";
+    return std::system(command.c_str()) == 0;
+}
+
+// Writes a binary log from several threads, runs esdl_decode on it and
+// compares each line with the text the same call formats to
+void testBinaryRoundTrip(const std::string& decoder) {
+    const int threadCount = 4;
+    const int lineCount = 2000;
+
+    std::string binaryPath = tempPath("roundtrip.bin");
+    std::string textPath = tempPath("roundtrip.txt");
+    std::remove(binaryPath.c_str());
+    std::remove(textPath.c_str());
+
+    Logger logger;
+    logger.setMinLogLevel(Logger::LogLevelTrace);
+    logger.enableBinary(binaryPath, 64 << 10);
+
+    auto logLine = [&](int t, int i) {
+        std::string text = getThreadMessage(t, i);
+        switch (i % 4) {
+        case 0: logger.trace("{} {} {}", t, i, text); break;
+        case 1: ESDL_LOG_INFO(logger, "{} {} {:.3f} {}", t, i, i * 0.5, i % 3 == 0); break;
+        case 2: logger.warn("{} {} {} {:x}", t, i, char('a' + t), uint64_t(i) << 40); break;
+        default: logger.error("{} {} {:>8} {}", t, i, -i, text.c_str()); break;
+        }
+    };
+    auto expectLine = [&](int t, int i) {
+        std::string text = getThreadMessage(t, i);
+        switch (i % 4) {
+        case 0: return esdl::format("[TRACE]: {} {} {}", t, i, text);
+        case 1: return esdl::format("[INFO]: {} {} {:.3f} {}", t, i, i * 0.5, i % 3 == 0);
+        case 2: return esdl::format("[WARN]: {} {} {} {:x}", t, i, char('a' + t), uint64_t(i) << 40);
+        default: return esdl::format("[ERROR]: {} {} {:>8} {}", t, i, -i, text.c_str());
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < lineCount; i++) logLine(t, i);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    logger.disableBinary();
+    CHECK(logger.getDroppedCount() == 0);
+
+    CHECK(decode(decoder, binaryPath, textPath));
+
+    std::vector<int> next(threadCount, 0);
+    size_t badLines = 0;
+    std::vector<std::string> lines = splitLines(readFile(textPath));
+    for (const std::string& line : lines) {
+        size_t at = line.find(" [");
+        int t = -1;
+        int i = -1;
+        if (at == std::string::npos
+            || std::sscanf(line.c_str() + line.find("]: ") + 3, "%d %d", &t, &i) != 2
+            || t < 0 || t >= threadCount || i != next[t]
+            || line.substr(at + 1) != expectLine(t, i)) {
+            badLines++;
+            continue;
+        }
+        next[t]++;
+    }
+
+    CHECK(badLines == 0);
+    CHECK(lines.size() == size_t(threadCount * lineCount));
+
+    std::remove(binaryPath.c_str());
+    std::remove(textPath.c_str());
+}
+
+}
+
+// One call site logging to two binary logs in turn, whose IDs for its
+// format differ, so the ID it cached from the first is stale in the second
+void testBinarySiteReused(const std::string& decoder) {
+    std::string textPath = tempPath("site.txt");
+    Logger logger;
+
+    auto logFile = [&](int file) {
+        ESDL_LOG_WARN(logger, "file {} line {}", file, 0);
+    };
+    for (int file = 0; file < 2; file++) {
+        std::string binaryPath = tempPath("site.bin");
+        std::remove(binaryPath.c_str());
+        logger.enableBinary(binaryPath, 64 << 10);
+        if (file == 1) logger.warn("taking the next ID {}", file);
+        logFile(file);
+        logger.disableBinary();
+
+        CHECK(decode(decoder, binaryPath, textPath));
+        std::vector<std::string> lines = splitLines(readFile(textPath));
+        CHECK(!lines.empty() && getMessage(lines.back()) == esdl::format("file {} line 0", file));
+
+        std::remove(binaryPath.c_str());
+        std::remove(textPath.c_str());
+    }
+}
+
+// A definition record whose lengths run past its end is an error, not
+// read out of bounds
+void testDecodeMalformed(const std::string& decoder) {
+    std::string binaryPath = tempPath("malformed.bin");
+    std::string textPath = tempPath("malformed.txt");
+
+    binary::FileHeader header = {};
+    std::memcpy(header.magic, binary::magic, sizeof(header.magic));
+    header.version = binary::version;
+    header.headerSize = uint32_t(binary::alignRecord(sizeof(header)));
+    header.chunkSize = 64 << 10;
+    header.ticksPerSecond = 1e9;
+
+    const uint32_t fields[3] = { binary::RecordFirstFormat, 1000, 1000 };
+    binary::RecordHeader record = {
+        uint32_t(binary::alignRecord(sizeof(record) + sizeof(fields))), 
+        binary::makeTag(binary::RecordDefinition, 0), 
+        0
+    };
+    std::string file(header.headerSize, '\0');
+    std::memcpy(&file[0], &header, sizeof(header));
+    file.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    file.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+    file.resize(header.headerSize + record.size);
+    {
+        std::ofstream out(binaryPath, std::ios::binary | std::ios::trunc);
+        out << file;
+    }
+
+    CHECK(!decode(decoder, binaryPath, textPath));
+
+    // Too short to hold the three fields at all
+    record.size = sizeof(record) + 8;
+    std::memcpy(&file[header.headerSize], &record, sizeof(record));
+    {
+        std::ofstream out(binaryPath, std::ios::binary | std::ios::trunc);
+        out << file;
+    }
+    CHECK(!decode(decoder, binaryPath, textPath));
+
+    std::remove(binaryPath.c_str());
+    std::remove(textPath.c_str());
+}
+
+int main(int argc, char** argv) {
+    struct Test {
+        const char* name;
+        void (*run)();
+    };
+    const Test tests[] = {
+        { "sync threads", testSyncThreads },
+        { "async threads", testAsyncThreads },
+        { "overflow block", testOverflowBlock },
+        { "overflow drop", testOverflowDrop },
+        { "overflow drop and report", testOverflowDropAndReport },
+        { "sync fatal flushed", testSyncFatalFlushed },
+        { "async fatal flushed", testAsyncFatalFlushed },
+        { "log macros", testLogMacros },
+        { "null strings", testNullStrings },
+        { "mapped file reopened after a crash", testMappedReopen },
+    };
+
+    for (const Test& test : tests) {
+        int before = failures;
+        test.run();
+        std::printf("%s: %s\n", failures == before ? "passed" : "FAILED", test.name);
+    }
+
+    struct DecoderTest {
+        const char* name;
+        void (*run)(const std::string& decoder);
+    };
+    const DecoderTest decoderTests[] = {
+        { "binary round trip", testBinaryRoundTrip },
+        { "binary call site reused", testBinarySiteReused },
+        { "decode malformed definition", testDecodeMalformed },
+    };
+
+    for (const DecoderTest& test : decoderTests) {
+        if (argc < 2) {
+            std::printf("skipped: %s, no esdl_decode given\n", test.name);
+            continue;
+        }
+        int before = failures;
+        test.run(argv[1]);
+        std::printf("%s: %s\n", failures == before ? "passed" : "FAILED", test.name);
+    }
+
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,219 @@
+// esdl_decode: turns a binary log (Logger::enableBinary) back into text
+//
+// esdl_decode <log file> [output file]
+// Writes to stdout without an output file. Lines come out in timestamp
+// order, in the same "yy-mm-dd HH:MM:SS [LEVEL]: ..." form as text logs.
+
+#include <eseed/logging/binarylog.hpp>
+#include <eseed/logging/logger.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace esdl;
+
+namespace {
+
+struct Definition {
+    std::string_view format;
+    std::vector<detail::ArgKind> kinds;
+};
+
+struct Line {
+    uint64_t ticks;
+    uint32_t tag;
+    const char* args;
+    const char* end;
+};
+
+template <typename T>
+T read(const char* at) {
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    return value;
+}
+
+// Unpacks the arguments of a record, false if they run past its end
+bool readArgs(
+    const Definition& definition, 
+    const char* at, 
+    const char* end, 
+    std::vector<detail::FormatArg>& args
+) {
+    args.resize(definition.kinds.size());
+    for (size_t i = 0; i < args.size(); i++) {
+        detail::FormatArg& arg = args[i];
+        arg.kind = definition.kinds[i];
+        size_t size;
+        switch (arg.kind) {
+        case detail::ArgKind::Bool: size = 1; break;
+        case detail::ArgKind::Char: size = 1; break;
+        case detail::ArgKind::Float: size = 4; break;
+        case detail::ArgKind::String: size = 4; break;
+        default: size = 8; break;
+        }
+        if (size_t(end - at) < size) return false;
+
+        switch (arg.kind) {
+        case detail::ArgKind::Bool: arg.b = *at != 0; break;
+        case detail::ArgKind::Char: arg.c = *at; break;
+        case detail::ArgKind::Int: arg.i = read<long long>(at); break;
+        case detail::ArgKind::UInt: arg.u = read<unsigned long long>(at); break;
+        case detail::ArgKind::Float: arg.f = read<float>(at); break;
+        case detail::ArgKind::Double: arg.d = read<double>(at); break;
+        case detail::ArgKind::Pointer: arg.p = (const void*)uintptr_t(read<uint64_t>(at)); break;
+        case detail::ArgKind::String: {
+            uint32_t length = read<uint32_t>(at);
+            if (size_t(end - at) - 4 < length) return false;
+            arg.s = { at + 4, length };
+            size += length;
+            break;
+        }
+        default:
+            return false;
+        }
+        at += size;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "Usage: esdl_decode <log file> [output file]\n");
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "Could not open %s\n", argv[1]);
+        return 1;
+    }
+    const std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    binary::FileHeader header;
+    if (
+        file.size() < sizeof(header) || 
+        (std::memcpy(&header, file.data(), sizeof(header)), std::memcmp(header.magic, binary::magic, sizeof(header.magic)) != 0)
+    ) {
+        std::fprintf(stderr, "%s is not an esdl binary log\n", argv[1]);
+        return 1;
+    }
+    if (header.version != binary::version || header.chunkSize == 0) {
+        std::fprintf(stderr, "%s has unsupported version %u\n", argv[1], header.version);
+        return 1;
+    }
+
+    std::unordered_map<uint32_t, Definition> definitions;
+    std::vector<Line> lines;
+    uint64_t syncTicks = header.ticks;
+    int64_t syncNs = header.steadyNs;
+
+    for (uint64_t chunk = 0; chunk < file.size(); chunk += header.chunkSize) {
+        const char* at = file.data() + chunk + (chunk == 0 ? header.headerSize : 0);
+        const char* chunkEnd = file.data() + std::min<uint64_t>(chunk + header.chunkSize, file.size());
+
+        while (size_t(chunkEnd - at) >= 8) {
+            const uint32_t size = read<uint32_t>(at);
+            const uint32_t tag = read<uint32_t>(at + 4);
+            const uint32_t id = binary::getTagId(tag);
+            // Unwritten space or padding ends the chunk
+            if (size == 0 || id == binary::RecordPadding) break;
+            if (size < sizeof(binary::RecordHeader) || size > size_t(chunkEnd - at)) break;
+
+            const uint64_t ticks = read<uint64_t>(at + 8);
+            const char* payload = at + sizeof(binary::RecordHeader);
+            const char* end = at + size;
+
+            if (id == binary::RecordDefinition) {
+                // Three uint32_t fields, then the kinds and format they
+                // give the lengths of; a definition that doesn't fit leaves
+                // every line using it unreadable, so the file can't be
+                // trusted
+                const size_t payloadSize = size_t(end - payload);
+                if (
+                    payloadSize < 12 || 
+                    payloadSize - 12 < size_t(read<uint32_t>(payload + 4)) + read<uint32_t>(payload + 8)
+                ) {
+                    std::fprintf(stderr, "%s has a malformed definition record at offset %zu\n", argv[1], size_t(at - file.data()));
+                    return 1;
+                }
+                const uint32_t newId = read<uint32_t>(payload);
+                const uint32_t count = read<uint32_t>(payload + 4);
+                const uint32_t formatLength = read<uint32_t>(payload + 8);
+                const char* kinds = payload + 12;
+
+                Definition& definition = definitions[newId];
+                for (uint32_t i = 0; i < count; i++) {
+                    definition.kinds.push_back(detail::ArgKind(kinds[i]));
+                }
+                definition.format = std::string_view(kinds + count, formatLength);
+            } else if (id == binary::RecordSync) {
+                syncTicks = ticks;
+                syncNs = read<int64_t>(payload);
+            } else {
+                lines.push_back({ ticks, tag, payload, end });
+            }
+
+            at = end;
+        }
+    }
+
+    // The last sync gives the tick rate over the whole file, the estimate
+    // from opening is used until there is one
+    double ticksPerNs = header.ticksPerSecond / 1e9;
+    if (syncNs - header.steadyNs > 100000000) {
+        ticksPerNs = double(syncTicks - header.ticks) / double(syncNs - header.steadyNs);
+    }
+
+    std::stable_sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) {
+        return a.ticks < b.ticks;
+    });
+
+    FILE* out = argc == 3 ? std::fopen(argv[2], "wb") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "Could not open %s\n", argv[2]);
+        return 1;
+    }
+
+    std::string text;
+    std::string output;
+    std::vector<detail::FormatArg> args;
+    size_t bad = 0;
+    for (const Line& line : lines) {
+        auto definition = definitions.find(binary::getTagId(line.tag));
+        if (definition == definitions.end() || !readArgs(definition->second, line.args, line.end, args)) {
+            bad++;
+            continue;
+        }
+
+        text.clear();
+        detail::formatTo(text, definition->second.format, args.data(), args.size());
+
+        const int64_t ns = header.wallNs + int64_t(double(int64_t(line.ticks - header.ticks)) / ticksPerNs);
+        const auto time = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns))
+        );
+        Logger::appendLine(output, Logger::LogLevel(binary::getTagLevel(line.tag)), time, text);
+
+        if (output.length() >= 1 << 16) {
+            std::fwrite(output.data(), 1, output.length(), out);
+            output.clear();
+        }
+    }
+    std::fwrite(output.data(), 1, output.length(), out);
+
+    if (out != stdout) std::fclose(out);
+
+    if (bad) {
+        std::fprintf(stderr, "Skipped %zu records that didn't match their format\n", bad);
+    }
+    return 0;
+}
\ No newline at end of file
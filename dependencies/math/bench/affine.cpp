@@ -0,0 +1,92 @@
+// Compares per-instance transform work through Mat4 against Affine3
+
+#include <eseed/math/affine.hpp>
+#include <eseed/math/matops.hpp>
+
+#include "bench.hpp"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr size_t count = 1024;
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("affine", argc, argv);
+
+    std::vector<Mat4<float>> mats(count), parents(count), matOut(count);
+    std::vector<Affine3<float>> affines(count), affineParents(count), affineOut(count);
+    std::vector<Vec3<float>> points(count), pointOut(count);
+    for (size_t i = 0; i < count; i++) {
+        float f = float(i);
+        mats[i] = matmul(matRotate(normalize(Vec3<float>(1.f, f, 2.f)), f * 0.01f), matTranslate(Vec3<float>(f, 1.f, -f)));
+        parents[i] = matmul(matRotate(Vec3<float>(0.f, 1.f, 0.f), f * -0.02f), matTranslate(Vec3<float>(0.f, f, 3.f)));
+        affines[i] = Affine3<float>(mats[i]);
+        affineParents[i] = Affine3<float>(parents[i]);
+        points[i] = Vec3<float>(f, 0.5f, -1.f);
+    }
+
+    std::printf("sizeof Mat4<float> %zu, Affine3<float> %zu\n", sizeof(Mat4<float>), sizeof(Affine3<float>));
+
+    suite.compare("compose", count,
+        "mat4", [&] {
+            for (size_t i = 0; i < count; i++)
+                matOut[i] = matmul(mats[i], parents[i]);
+            bench::doNotOptimize(matOut[count / 2].data[3][0]);
+        },
+        "affine3", [&] {
+            for (size_t i = 0; i < count; i++)
+                affineOut[i] = matmul(affines[i], affineParents[i]);
+            bench::doNotOptimize(affineOut[count / 2].data[0][3]);
+        }
+    );
+
+    suite.compare("transform point", count,
+        "mat4", [&] {
+            for (size_t i = 0; i < count; i++) {
+                const Vec3<float> &p = points[i];
+                pointOut[i] = Vec3<float>(matmul(Vec4<float>(p.x, p.y, p.z, 1.f), mats[i]));
+            }
+            bench::doNotOptimize(pointOut[count / 2].x);
+        },
+        "affine3", [&] {
+            for (size_t i = 0; i < count; i++)
+                pointOut[i] = transformPoint(affines[i], points[i]);
+            bench::doNotOptimize(pointOut[count / 2].x);
+        }
+    );
+
+    suite.compare("rigid inverse", count,
+        "mat4", [&] {
+            for (size_t i = 0; i < count; i++)
+                matOut[i] = inverseRigid(mats[i]);
+            bench::doNotOptimize(matOut[count / 2].data[3][0]);
+        },
+        "affine3", [&] {
+            for (size_t i = 0; i < count; i++)
+                affineOut[i] = inverseRigid(affines[i]);
+            bench::doNotOptimize(affineOut[count / 2].data[0][3]);
+        }
+    );
+
+    // Includes the conversion needed before upload
+    suite.compare("compose + toMat4", count,
+        "mat4", [&] {
+            for (size_t i = 0; i < count; i++)
+                matOut[i] = matmul(mats[i], parents[i]);
+            bench::doNotOptimize(matOut[count / 2].data[3][0]);
+        },
+        "affine3", [&] {
+            for (size_t i = 0; i < count; i++)
+                matOut[i] = toMat4(matmul(affines[i], affineParents[i]));
+            bench::doNotOptimize(matOut[count / 2].data[3][0]);
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+// Compares walking a voxel volume with hand-written loops against the
+// ArrayView iteration, and a neighborhood stencil across the layouts
+
+#include <eseed/math/array.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+constexpr size_t side = 128;
+constexpr size_t count = side * side * side;
+
+// Sum of the 6 face neighbors of every interior voxel, walked z, y, x like
+// chunk meshing does
+template <typename A>
+float stencil(const A &a) {
+    float sum = 0.f;
+    for (size_t z = 1; z < side - 1; z++)
+        for (size_t y = 1; y < side - 1; y++)
+            for (size_t x = 1; x < side - 1; x++)
+                sum += a(x - 1, y, z) + a(x + 1, y, z) + a(x, y - 1, z) + a(x, y + 1, z) + a(x, y, z - 1) + a(x, y, z + 1);
+    return sum;
+}
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("array", argc, argv);
+
+    const Index<3> extents(side, side, side);
+    Array3D<float> in(extents), out(extents);
+    forEach(in.view(), [](float &v, const Index<3> &c) {
+        v = float((c[0] ^ c[1] ^ c[2]) & 15);
+    });
+
+    suite.compare("transform 128^3", count,
+        "loops", [&] {
+            for (size_t z = 0; z < side; z++)
+                for (size_t y = 0; y < side; y++)
+                    for (size_t x = 0; x < side; x++)
+                        out(x, y, z) = in(x, y, z) * 0.5f + 1.f;
+            bench::doNotOptimize(out(1, 2, 3));
+        },
+        "transform", [&] {
+            transform(in.view(), out.view(), [](float v) { return v * 0.5f + 1.f; });
+            bench::doNotOptimize(out(1, 2, 3));
+        }
+    );
+
+    Array3D<float, LayoutTiled<3>> tiled(extents);
+    Array3D<float, LayoutMorton<3>> morton(extents);
+    transform(in.view(), tiled.view(), [](float v) { return v; });
+    transform(in.view(), morton.view(), [](float v) { return v; });
+
+    const size_t interior = (side - 2) * (side - 2) * (side - 2);
+    suite.run("stencil/linear", interior, [&] { bench::doNotOptimize(stencil(in)); });
+    suite.run("stencil/tiled", interior, [&] { bench::doNotOptimize(stencil(tiled)); });
+    suite.run("stencil/morton", interior, [&] { bench::doNotOptimize(stencil(morton)); });
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,236 @@
+#pragma once
+
+// Minimal microbenchmark harness shared by the esdm benchmarks, using only
+// the standard library
+//
+// A benchmark is a callable doing "ops" operations per call. Each one is
+// warmed up, then the calls per sample are doubled until a sample takes at
+// least Options::sampleTime, and Options::samples samples are timed. The
+// reported min / median / p99 are per operation; cycles are TSC ticks per
+// operation (median sample), 0 where no cycle counter is available.
+//
+// Command line, parsed by Suite:
+//   --filter <text>  only run benchmarks whose name contains text
+//   --json <path>    also write the results as JSON, "-" for stdout
+//   --quick          fewer, shorter samples for smoke runs
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace esdm {
+
+namespace bench {
+
+// Makes the compiler assume value is read, so the work producing it can't
+// be removed
+template <typename T>
+inline void doNotOptimize(const T &value) {
+#if defined(_MSC_VER)
+    static volatile const void *sink;
+    sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+// Makes the compiler assume all memory is read and written here, so
+// pending stores happen and loads aren't hoisted across it
+inline void clobberMemory() {
+#if defined(_MSC_VER)
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : : "memory");
+#endif
+}
+
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+constexpr bool hasCycleCounter = true;
+
+inline uint64_t readCycles() {
+    return __rdtsc();
+}
+#else
+constexpr bool hasCycleCounter = false;
+
+inline uint64_t readCycles() {
+    return 0;
+}
+#endif
+
+struct Options {
+    std::chrono::nanoseconds warmupTime = std::chrono::milliseconds(20);
+    std::chrono::nanoseconds sampleTime = std::chrono::microseconds(500);
+    size_t samples = 101;
+    std::string filter;
+    std::string jsonPath;
+};
+
+struct Result {
+    std::string name;
+    size_t opsPerSample;
+    size_t samples;
+    double minNs;
+    double medianNs;
+    double p99Ns;
+    double cyclesPerOp;
+};
+
+class Suite {
+public:
+    Suite(std::string name, int argc, char **argv) : name(std::move(name)) {
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+                options.filter = argv[++i];
+            } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+                options.jsonPath = argv[++i];
+            } else if (std::strcmp(argv[i], "--quick") == 0) {
+                options.warmupTime = std::chrono::milliseconds(2);
+                options.sampleTime = std::chrono::microseconds(100);
+                options.samples = 11;
+            } else {
+                std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+            }
+        }
+        // The table goes to stderr when the JSON takes stdout
+        table = options.jsonPath == "-" ? stderr : stdout;
+    }
+
+    const Options &getOptions() const {
+        return options;
+    }
+
+    const std::vector<Result> &getResults() const {
+        return results;
+    }
+
+    // Runs fn, which does "ops" operations per call, and records the result
+    // Returns nullptr when the filter skips it
+    template <typename F>
+    const Result *run(const std::string &benchName, size_t ops, F &&fn) {
+        if (!options.filter.empty() && benchName.find(options.filter) == std::string::npos)
+            return nullptr;
+
+        using Clock = std::chrono::steady_clock;
+
+        // Warm up while doubling the calls per sample up to sampleTime
+        size_t calls = 1;
+        const auto warmupEnd = Clock::now() + options.warmupTime;
+        while (true) {
+            auto start = Clock::now();
+            for (size_t c = 0; c < calls; c++)
+                fn();
+            clobberMemory();
+            auto elapsed = Clock::now() - start;
+            if (elapsed >= options.sampleTime && Clock::now() >= warmupEnd)
+                break;
+            if (elapsed < options.sampleTime)
+                calls *= 2;
+        }
+
+        std::vector<double> ns(options.samples);
+        std::vector<double> cycles(options.samples);
+        const double opCount = double(calls) * double(ops);
+        for (size_t s = 0; s < options.samples; s++) {
+            auto start = Clock::now();
+            uint64_t startCycles = readCycles();
+            for (size_t c = 0; c < calls; c++)
+                fn();
+            clobberMemory();
+            uint64_t endCycles = readCycles();
+            auto end = Clock::now();
+            ns[s] = std::chrono::duration<double, std::nano>(end - start).count() / opCount;
+            cycles[s] = double(endCycles - startCycles) / opCount;
+        }
+        std::sort(ns.begin(), ns.end());
+        std::sort(cycles.begin(), cycles.end());
+
+        Result result;
+        result.name = benchName;
+        result.opsPerSample = calls * ops;
+        result.samples = options.samples;
+        result.minNs = ns.front();
+        result.medianNs = percentile(ns, 0.5);
+        result.p99Ns = percentile(ns, 0.99);
+        result.cyclesPerOp = percentile(cycles, 0.5);
+        results.push_back(result);
+
+        std::fprintf(table, "%-48s min %9.3f ns  median %9.3f ns  p99 %9.3f ns  %8.2f cycles\n",
+            benchName.c_str(), result.minNs, result.medianNs, result.p99Ns, result.cyclesPerOp);
+        return &results.back();
+    }
+
+    // Runs "name/baseline" and "name/candidate" and prints the median speedup
+    template <typename F, typename G>
+    void compare(const std::string &benchName, size_t ops, const char *baselineLabel, F &&baseline, const char *candidateLabel, G &&candidate) {
+        const Result *a = run(benchName + "/" + baselineLabel, ops, baseline);
+        if (!a)
+            return;
+        const double baselineNs = a->medianNs;
+        const Result *b = run(benchName + "/" + candidateLabel, ops, candidate);
+        if (b)
+            std::fprintf(table, "%-48s x%.2f\n", "", baselineNs / b->medianNs);
+    }
+
+    // Writes the JSON if requested, returns the process exit code
+    int finish() const {
+        if (options.jsonPath.empty())
+            return 0;
+        FILE *out = options.jsonPath == "-" ? stdout : std::fopen(options.jsonPath.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "Failed to open %s\n", options.jsonPath.c_str());
+            return 1;
+        }
+        writeJson(out);
+        if (out != stdout)
+            std::fclose(out);
+        return 0;
+    }
+
+    void writeJson(FILE *out) const {
+        std::fprintf(out, "{\n  \"suite\": \"%s\",\n  \"cycleCounter\": %s,\n  \"results\": [", escape(name).c_str(), hasCycleCounter ? "true" : "false");
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result &r = results[i];
+            std::fprintf(out, "%s\n    { \"name\": \"%s\", \"opsPerSample\": %zu, \"samples\": %zu, \"minNs\": %.4f, \"medianNs\": %.4f, \"p99Ns\": %.4f, \"cyclesPerOp\": %.3f }",
+                i == 0 ? "" : ",", escape(r.name).c_str(), r.opsPerSample, r.samples, r.minNs, r.medianNs, r.p99Ns, r.cyclesPerOp);
+        }
+        std::fprintf(out, "\n  ]\n}\n");
+    }
+
+private:
+    std::string name;
+    Options options;
+    std::vector<Result> results;
+    FILE *table;
+
+    // Nearest-rank percentile of sorted values
+    static double percentile(const std::vector<double> &sorted, double p) {
+        size_t rank = size_t(p * double(sorted.size()) + 0.999999);
+        return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    static std::string escape(const std::string &s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+        return out;
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+// Compares culling boxes one at a time against the batch cullAABBs
+
+#include <eseed/math/bounds.hpp>
+#include <eseed/math/matops.hpp>
+
+#include "bench.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr size_t count = 1 << 18;
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("bounds", argc, argv);
+
+    const Mat4<float> rotation = matRotate(normalize(Vec3<float>(1.f, 2.f, 3.f)), 0.7f);
+    const Frustum<float> frustum = frustumFromCamera(Vec3<float>(0.f, 0.f, 0.f), rotation, 16.f / 9.f, 1.5707963f, 0.1f, 500.f);
+
+    // Boxes scattered on a grid around the camera, some inside the frustum
+    std::vector<AABB<float>> boxes(count);
+    for (size_t i = 0; i < count; i++) {
+        const Vec3<float> c(float(i % 64) * 8.f - 256.f, float(i / 64 % 64) * 8.f - 256.f, float(i / 4096) * 8.f - 256.f);
+        const Vec3<float> e(1.f + float(i % 3), 1.f, 1.f + float(i % 5));
+        boxes[i] = AABB<float>(c - e, c + e);
+    }
+    std::vector<uint64_t> visible((count + 63) / 64);
+
+    suite.compare("cull AABBs", count,
+        "scalar", [&] {
+            for (size_t w = 0; w < visible.size(); w++)
+                visible[w] = 0;
+            for (size_t i = 0; i < count; i++)
+                visible[i / 64] |= uint64_t(intersects(frustum, boxes[i])) << (i % 64);
+            bench::doNotOptimize(visible[visible.size() / 2]);
+        },
+        "batch", [&] {
+            cullAABBs(frustum, boxes, visible);
+            bench::doNotOptimize(visible[visible.size() / 2]);
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+// Compares the std functions applied element by element against the
+// esdm::fast array functions
+
+#include <eseed/math/fastops.hpp>
+
+#include "bench.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+constexpr size_t count = 4096;
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("fastops", argc, argv);
+
+    std::vector<float> angles(count), positive(count), exps(count), out(count), out2(count);
+    std::vector<int32_t> ints(count);
+    for (size_t i = 0; i < count; i++) {
+        angles[i] = (float(i) - float(count) / 2.f) * 0.01f;
+        positive[i] = float(i) * 0.37f + 0.01f;
+        exps[i] = (float(i) - float(count) / 2.f) * 0.02f;
+    }
+
+#define ESDM_BENCH_UNARY(name, in) \
+    suite.compare(#name, count, \
+        "std", [&] { \
+            for (size_t i = 0; i < count; i++) \
+                out[i] = std::name(in[i]); \
+            bench::doNotOptimize(out[count / 2]); \
+        }, \
+        "fast", [&] { \
+            fast::name(in.data(), out.data(), count); \
+            bench::doNotOptimize(out[count / 2]); \
+        } \
+    );
+
+    ESDM_BENCH_UNARY(sin, angles)
+    ESDM_BENCH_UNARY(cos, angles)
+    ESDM_BENCH_UNARY(exp2, exps)
+    ESDM_BENCH_UNARY(log2, positive)
+
+#undef ESDM_BENCH_UNARY
+
+    suite.compare("sincos", count,
+        "std", [&] {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = std::sin(angles[i]);
+                out2[i] = std::cos(angles[i]);
+            }
+            bench::doNotOptimize(out[count / 2] + out2[count / 2]);
+        },
+        "fast", [&] {
+            fast::sincos(angles.data(), out.data(), out2.data(), count);
+            bench::doNotOptimize(out[count / 2] + out2[count / 2]);
+        }
+    );
+
+    suite.compare("rsqrt", count,
+        "std", [&] {
+            for (size_t i = 0; i < count; i++)
+                out[i] = 1.f / std::sqrt(positive[i]);
+            bench::doNotOptimize(out[count / 2]);
+        },
+        "fast", [&] {
+            fast::rsqrt(positive.data(), out.data(), count);
+            bench::doNotOptimize(out[count / 2]);
+        }
+    );
+
+    suite.compare("rcp", count,
+        "std", [&] {
+            for (size_t i = 0; i < count; i++)
+                out[i] = 1.f / positive[i];
+            bench::doNotOptimize(out[count / 2]);
+        },
+        "fast", [&] {
+            fast::rcp(positive.data(), out.data(), count);
+            bench::doNotOptimize(out[count / 2]);
+        }
+    );
+
+    suite.compare("atan2", count,
+        "std", [&] {
+            for (size_t i = 0; i < count; i++)
+                out[i] = std::atan2(angles[i], exps[i]);
+            bench::doNotOptimize(out[count / 2]);
+        },
+        "fast", [&] {
+            fast::atan2(angles.data(), exps.data(), out.data(), count);
+            bench::doNotOptimize(out[count / 2]);
+        }
+    );
+
+    suite.compare("ifloor", count,
+        "std", [&] {
+            for (size_t i = 0; i < count; i++)
+                ints[i] = ifloor<int32_t>(exps[i]);
+            bench::doNotOptimize(float(ints[count / 2]));
+        },
+        "fast", [&] {
+            ifloor(exps.data(), ints.data(), count);
+            bench::doNotOptimize(float(ints[count / 2]));
+        }
+    );
+
+    suite.compare("iround", count,
+        "std", [&] {
+            for (size_t i = 0; i < count; i++)
+                ints[i] = iround<int32_t>(exps[i]);
+            bench::doNotOptimize(float(ints[count / 2]));
+        },
+        "fast", [&] {
+            iround(exps.data(), ints.data(), count);
+            bench::doNotOptimize(float(ints[count / 2]));
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,213 @@
+// Baseline timings for the core esdm operations, meant to be run before and
+// after a math change with --json and diffed
+
+#include <eseed/math/vec.hpp>
+#include <eseed/math/mat.hpp>
+#include <eseed/math/matops.hpp>
+#include <eseed/math/fastops.hpp>
+
+#include "bench.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr size_t count = 1024;
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("eseed_math", argc, argv);
+
+    std::vector<Vec3<float>> a3(count), b3(count), o3(count);
+    std::vector<Vec4<float>> a4(count), b4(count), o4(count);
+    std::vector<Vec4<double>> a4d(count), b4d(count), o4d(count);
+    std::vector<Vec4<int32_t>> ai(count), bi(count), oi(count);
+    std::vector<Mat3<float>> am3(count), bm3(count), om3(count);
+    std::vector<Mat4<float>> am4(count), bm4(count), om4(count);
+    std::vector<Mat4<double>> am4d(count), bm4d(count), om4d(count);
+    std::vector<float> angles(count), reals(count);
+    std::vector<int32_t> ints(count);
+    for (size_t i = 0; i < count; i++) {
+        float f = float(i);
+        a3[i] = Vec3<float>(f, 1.f, -f);
+        b3[i] = Vec3<float>(0.5f, f, 2.f);
+        a4[i] = Vec4<float>(f, f + 1.f, f + 2.f, f + 3.f);
+        b4[i] = Vec4<float>(0.5f, 0.25f, 2.f, 1.f);
+        a4d[i] = Vec4<double>(a4[i][0], a4[i][1], a4[i][2], a4[i][3]);
+        b4d[i] = Vec4<double>(b4[i][0], b4[i][1], b4[i][2], b4[i][3]);
+        ai[i] = Vec4<int32_t>(int32_t(i), 3, -int32_t(i), 7);
+        bi[i] = Vec4<int32_t>(1, int32_t(i), 5, -2);
+        angles[i] = f * 0.01f;
+        reals[i] = (f - float(count) / 2.f) * 0.37f;
+        am4[i] = matRotate(normalize(Vec3<float>(1.f, f, 2.f)), angles[i]);
+        bm4[i] = matTranslate(Vec3<float>(f, 1.f, -f));
+        for (size_t r = 0; r < 3; r++) {
+            for (size_t c = 0; c < 3; c++) {
+                am3[i].data[r][c] = am4[i].data[r][c];
+                bm3[i].data[r][c] = am4[i].data[c][r];
+            }
+        }
+        for (size_t r = 0; r < 4; r++) {
+            for (size_t c = 0; c < 4; c++) {
+                am4d[i].data[r][c] = am4[i].data[r][c];
+                bm4d[i].data[r][c] = bm4[i].data[r][c];
+            }
+        }
+    }
+
+    // Vec operators
+
+    suite.run("Vec3f a + b", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            o3[i] = a3[i] + b3[i];
+        bench::doNotOptimize(o3[count / 2]);
+    });
+
+    suite.run("Vec3f cross", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            o3[i] = cross(a3[i], b3[i]);
+        bench::doNotOptimize(o3[count / 2]);
+    });
+
+    suite.run("Vec3f normalize", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            o3[i] = normalize(a3[i] + b3[i]);
+        bench::doNotOptimize(o3[count / 2]);
+    });
+
+    suite.run("Vec4f a * b + a", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            o4[i] = a4[i] * b4[i] + a4[i];
+        bench::doNotOptimize(o4[count / 2]);
+    });
+
+    suite.run("Vec4f a / s", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            o4[i] = a4[i] / 3.f;
+        bench::doNotOptimize(o4[count / 2]);
+    });
+
+    suite.run("Vec4f dot", count, [&] {
+        float sum = 0.f;
+        for (size_t i = 0; i < count; i++)
+            sum += dot(a4[i], b4[i]);
+        bench::doNotOptimize(sum);
+    });
+
+    suite.run("Vec4d a * b + a", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            o4d[i] = a4d[i] * b4d[i] + a4d[i];
+        bench::doNotOptimize(o4d[count / 2]);
+    });
+
+    suite.run("Vec4i (a + b) ^ (a << 2)", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            oi[i] = (ai[i] + bi[i]) ^ (ai[i] << 2);
+        bench::doNotOptimize(oi[count / 2]);
+    });
+
+    // Mat operators
+
+    suite.run("Mat4f a + b", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            om4[i] = am4[i] + bm4[i];
+        bench::doNotOptimize(om4[count / 2]);
+    });
+
+    suite.run("Mat4f a * s", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            om4[i] = am4[i] * 0.5f;
+        bench::doNotOptimize(om4[count / 2]);
+    });
+
+    suite.run("Mat4f transpose", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            om4[i] = transpose(am4[i]);
+        bench::doNotOptimize(om4[count / 2]);
+    });
+
+    suite.run("Mat4f inverse", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            om4[i] = inverse(am4[i]);
+        bench::doNotOptimize(om4[count / 2]);
+    });
+
+    // matmul
+
+    suite.run("matmul Mat3f", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            om3[i] = matmul(am3[i], bm3[i]);
+        bench::doNotOptimize(om3[count / 2]);
+    });
+
+    suite.run("matmul Mat4f", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            om4[i] = matmul(am4[i], bm4[i]);
+        bench::doNotOptimize(om4[count / 2]);
+    });
+
+    suite.run("matmul Mat4d", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            om4d[i] = matmul(am4d[i], bm4d[i]);
+        bench::doNotOptimize(om4d[count / 2]);
+    });
+
+    suite.run("matmul Vec4f * Mat4f", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            o4[i] = matmul(a4[i], am4[i]);
+        bench::doNotOptimize(o4[count / 2]);
+    });
+
+    // Rotation matrices
+
+    const Vec3<float> axis = normalize(Vec3<float>(1.f, 2.f, 3.f));
+
+    suite.run("matRotate", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            om4[i] = matRotate(axis, angles[i]);
+        bench::doNotOptimize(om4[count / 2]);
+    });
+
+    suite.run("rotateX", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            om4[i] = rotateX(angles[i]);
+        bench::doNotOptimize(om4[count / 2]);
+    });
+
+    // "i" rounding functions
+
+#define ESDM_BENCH_ROUNDING(func) \
+    suite.run(#func " float -> int32", count, [&] { \
+        for (size_t i = 0; i < count; i++) \
+            ints[i] = func<int32_t>(reals[i]); \
+        bench::doNotOptimize(ints[count / 2]); \
+    }); \
+    suite.run(#func " Vec4f -> Vec4i", count, [&] { \
+        for (size_t i = 0; i < count; i++) \
+            oi[i] = func<int32_t>(a4[i] * -0.37f); \
+        bench::doNotOptimize(oi[count / 2]); \
+    });
+
+    ESDM_BENCH_ROUNDING(itrunc)
+    ESDM_BENCH_ROUNDING(ifloor)
+    ESDM_BENCH_ROUNDING(iceil)
+    ESDM_BENCH_ROUNDING(iround)
+
+#undef ESDM_BENCH_ROUNDING
+
+    suite.run("ifloor float array", count, [&] {
+        ifloor(reals.data(), ints.data(), count);
+        bench::doNotOptimize(ints[count / 2]);
+    });
+
+    suite.run("iround float array", count, [&] {
+        iround(reals.data(), ints.data(), count);
+        bench::doNotOptimize(ints[count / 2]);
+    });
+
+    return suite.finish();
+}
\ No newline at end of file
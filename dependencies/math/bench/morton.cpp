@@ -0,0 +1,204 @@
+// Compares the Morton encode / decode paths, and chunk meshing and DDA
+// raycasts over a Morton ordered chunk against an x-major one
+
+#include <eseed/math/chunk.hpp>
+
+#include "bench.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr size_t count = 4096;
+constexpr size_t side = 128;
+constexpr size_t rayCount = 1024;
+
+// Sparse solid cells, about 1 in 64
+uint8_t solid(size_t x, size_t y, size_t z) {
+    uint32_t h = uint32_t(x * 73856093u ^ y * 19349663u ^ z * 83492791u);
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return (h & 63) == 0;
+}
+
+struct RayStart {
+    int32_t pos[3];
+    float dir[3];
+};
+
+// Walks cells like rayVoxel until a solid one or the chunk edge, through
+// "Grid", which tracks the current cell
+template <typename Grid>
+size_t march(Grid grid, const RayStart &ray) {
+    float tMax[3], tDelta[3];
+    int step[3];
+    for (size_t i = 0; i < 3; i++) {
+        step[i] = ray.dir[i] < 0.f ? -1 : 1;
+        tDelta[i] = 1.f / std::abs(ray.dir[i]);
+        tMax[i] = tDelta[i] * 0.5f;
+    }
+    for (size_t n = 0; n < 3 * side; n++) {
+        size_t axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+        if (!grid.step(axis, step[axis]))
+            return n;
+        tMax[axis] += tDelta[axis];
+        if (grid.solid())
+            return n;
+    }
+    return 3 * side;
+}
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("morton", argc, argv);
+
+#if !defined(ESDM_SIMD_BMI2)
+    std::printf("BMI2 disabled, both encode columns measure magic bits\n");
+#endif
+
+    std::vector<uint32_t> xs(count), ys(count), zs(count);
+    std::vector<uint64_t> codes(count);
+    for (size_t i = 0; i < count; i++) {
+        xs[i] = uint32_t(i * 7 % 1024);
+        ys[i] = uint32_t(i * 13 % 1024);
+        zs[i] = uint32_t(i * 29 % 1024);
+    }
+
+    suite.compare("encode 3D", count,
+        "magic", [&] {
+            for (size_t i = 0; i < count; i++)
+                codes[i] = morton::detail::spreadMagic<3>(xs[i]) | morton::detail::spreadMagic<3>(ys[i]) << 1 | morton::detail::spreadMagic<3>(zs[i]) << 2;
+            bench::doNotOptimize(codes[count / 2]);
+        },
+        "encode", [&] {
+            for (size_t i = 0; i < count; i++)
+                codes[i] = morton::encode(xs[i], ys[i], zs[i]);
+            bench::doNotOptimize(codes[count / 2]);
+        }
+    );
+
+    suite.compare("decode 3D", count,
+        "magic", [&] {
+            for (size_t i = 0; i < count; i++)
+                xs[i] = uint32_t(morton::detail::compactMagic<3>(codes[i]) + morton::detail::compactMagic<3>(codes[i] >> 1) + morton::detail::compactMagic<3>(codes[i] >> 2));
+            bench::doNotOptimize(xs[count / 2]);
+        },
+        "decode", [&] {
+            for (size_t i = 0; i < count; i++) {
+                const Vec3<uint32_t> c = morton::decode3(codes[i]);
+                xs[i] = c[0] + c[1] + c[2];
+            }
+            bench::doNotOptimize(xs[count / 2]);
+        }
+    );
+
+    Array3D<uint8_t> linear{ Index<3>(side) };
+    MortonChunk<uint8_t, side> chunk;
+    for (uint32_t z = 0; z < side; z++)
+        for (uint32_t y = 0; y < side; y++)
+            for (uint32_t x = 0; x < side; x++)
+                linear(x, y, z) = chunk(x, y, z) = solid(x, y, z);
+
+    // Faces of solid cells against empty ones or the chunk edge, as meshing
+    // counts them
+    const size_t volume = side * side * side;
+    suite.compare("mesh faces 128^3", volume,
+        "linear", [&] {
+            const uint8_t *cells = linear.data();
+            const size_t stride[3] = { 1, side, side * side };
+            size_t faces = 0;
+            for (size_t z = 0; z < side; z++)
+                for (size_t y = 0; y < side; y++)
+                    for (size_t x = 0; x < side; x++) {
+                        const size_t i = x + y * stride[1] + z * stride[2];
+                        if (!cells[i])
+                            continue;
+                        const size_t c[3] = { x, y, z };
+                        for (size_t axis = 0; axis < 3; axis++) {
+                            faces += c[axis] == 0 || !cells[i - stride[axis]];
+                            faces += c[axis] == side - 1 || !cells[i + stride[axis]];
+                        }
+                    }
+            bench::doNotOptimize(faces);
+        },
+        "morton", [&] {
+            size_t faces = 0;
+            for (uint64_t code = 0; code < volume; code++) {
+                if (!chunk[code])
+                    continue;
+                for (size_t axis = 0; axis < 3; axis++) {
+                    const uint64_t back = chunk.neighbor(code, axis, -1);
+                    const uint64_t forward = chunk.neighbor(code, axis, 1);
+                    faces += !chunk.contains(back) || !chunk[back];
+                    faces += !chunk.contains(forward) || !chunk[forward];
+                }
+            }
+            bench::doNotOptimize(faces);
+        }
+    );
+
+    std::vector<RayStart> rays(rayCount);
+    for (size_t i = 0; i < rayCount; i++) {
+        const float a = float(i) * 2.39996f, b = float(i) * 0.7548f;
+        const float s = std::sin(b);
+        rays[i] = { { int32_t(i * 37 % side), int32_t(i * 53 % side), int32_t(i * 71 % side) }, { std::cos(a) * s + 1e-4f, std::sin(a) * s + 1e-4f, std::cos(b) + 1e-4f } };
+    }
+
+    struct LinearCursor {
+        const uint8_t *cells;
+        int32_t pos[3];
+        size_t index;
+
+        bool step(size_t axis, int dir) {
+            pos[axis] += dir;
+            if (uint32_t(pos[axis]) >= side)
+                return false;
+            const int64_t stride[3] = { 1, int64_t(side), int64_t(side * side) };
+            index += dir * stride[axis];
+            return true;
+        }
+
+        bool solid() const {
+            return cells[index] != 0;
+        }
+    };
+
+    struct MortonCursor {
+        const MortonChunk<uint8_t, side> *chunk;
+        uint64_t code;
+
+        bool step(size_t axis, int dir) {
+            code = chunk->neighbor(code, axis, dir);
+            return chunk->contains(code);
+        }
+
+        bool solid() const {
+            return (*chunk)[code] != 0;
+        }
+    };
+
+    suite.compare("raycast 128^3", rayCount,
+        "linear", [&] {
+            size_t steps = 0;
+            for (const RayStart &ray : rays) {
+                const size_t index = size_t(ray.pos[0]) + size_t(ray.pos[1]) * side + size_t(ray.pos[2]) * side * side;
+                steps += march(LinearCursor{ linear.data(), { ray.pos[0], ray.pos[1], ray.pos[2] }, index }, ray);
+            }
+            bench::doNotOptimize(steps);
+        },
+        "morton", [&] {
+            size_t steps = 0;
+            for (const RayStart &ray : rays)
+                steps += march(MortonCursor{ &chunk, chunk.code(uint32_t(ray.pos[0]), uint32_t(ray.pos[1]), uint32_t(ray.pos[2])) }, ray);
+            bench::doNotOptimize(steps);
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+// Compares sampling the test.frag terrain one column at a time against
+// filling the same tile with noise::fillHeightmap
+
+#include <eseed/math/noise.hpp>
+
+#include "bench.hpp"
+
+#include <vector>
+
+namespace {
+
+constexpr size_t tileSize = 256;
+constexpr size_t count = tileSize * tileSize;
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("noise", argc, argv);
+
+    const std::vector<noise::HeightLayer> layers = noise::shaderTerrain();
+    const Vec2<int32_t> origin(-128, 512);
+    std::vector<float> heights(count);
+
+    suite.compare("terrain tile 256x256", count,
+        "scalar", [&] {
+            for (size_t z = 0; z < tileSize; z++)
+                for (size_t x = 0; x < tileSize; x++)
+                    heights[z * tileSize + x] = noise::height(layers, origin[0] + int32_t(x), origin[1] + int32_t(z));
+            bench::doNotOptimize(heights[count / 2]);
+        },
+        "batch", [&] {
+            noise::fillHeightmap(layers, origin, tileSize, tileSize, heights);
+            bench::doNotOptimize(heights[count / 2]);
+        }
+    );
+
+    VecBatch<3, float> points(count);
+    for (size_t i = 0; i < count; i++)
+        points.set(i, Vec3<float>(float(i % tileSize) * 0.031f, float(i / tileSize) * 0.027f, 0.5f));
+    std::vector<float> out(count);
+
+    suite.compare("fbm3, 4 octaves", count,
+        "scalar", [&] {
+            for (size_t i = 0; i < count; i++)
+                out[i] = noise::fbm3(points.get(i), 4);
+            bench::doNotOptimize(out[count / 2]);
+        },
+        "batch", [&] {
+            noise::fbm3(points, out, 4);
+            bench::doNotOptimize(out[count / 2]);
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
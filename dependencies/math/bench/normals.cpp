@@ -0,0 +1,95 @@
+// Compares encoding and decoding normals and tangent frames one element at
+// a time against the batch kernels
+
+#include <eseed/math/normals.hpp>
+
+#include "bench.hpp"
+
+#include <vector>
+
+namespace {
+
+constexpr size_t count = 4096;
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("normals", argc, argv);
+
+    std::vector<Vec3<float>> normals(count), tangents(count), out(count), tangentsOut(count);
+    std::vector<float> handedness(count), handednessOut(count);
+    for (size_t i = 0; i < count; i++) {
+        const float a = float(i) * 0.37f, b = float(i) * 0.11f;
+        normals[i] = normalize(Vec3<float>(sin(a) * cos(b), cos(a), sin(a) * sin(b)));
+        tangents[i] = normalize(cross(normals[i], Vec3<float>(0.f, 0.f, 1.f)) + Vec3<float>(0.01f, 0.f, 0.f));
+        handedness[i] = i % 3 == 0 ? -1.f : 1.f;
+    }
+    const VecBatch<3, float> normalBatch(normals), tangentBatch(tangents);
+    VecBatch<3, float> normalOut, tangentOut;
+
+    std::vector<Oct16> oct16(count);
+    std::vector<Oct32> oct32(count);
+    std::vector<QTangent> qtangents(count);
+
+#define ESDM_BENCH_OCT(name, packed) \
+    suite.compare("Vec3 -> " name, count, \
+        "scalar", [&] { \
+            for (size_t i = 0; i < count; i++) \
+                packed[i] = normals[i]; \
+            bench::doNotOptimize(packed[count / 2]); \
+        }, \
+        "batch", [&] { \
+            encodeOct(normalBatch, packed.data()); \
+            bench::doNotOptimize(packed[count / 2]); \
+        } \
+    ); \
+    suite.compare(name " -> Vec3", count, \
+        "scalar", [&] { \
+            for (size_t i = 0; i < count; i++) \
+                out[i] = packed[i]; \
+            bench::doNotOptimize(out[count / 2]); \
+        }, \
+        "batch", [&] { \
+            decodeOct(packed.data(), count, normalOut); \
+            bench::doNotOptimize(normalOut.x()[count / 2]); \
+        } \
+    );
+
+    ESDM_BENCH_OCT("Oct16", oct16)
+    ESDM_BENCH_OCT("Oct32", oct32)
+
+#undef ESDM_BENCH_OCT
+
+    suite.compare("frame -> QTangent", count,
+        "scalar", [&] {
+            for (size_t i = 0; i < count; i++)
+                qtangents[i] = QTangent(normals[i], tangents[i], handedness[i]);
+            bench::doNotOptimize(qtangents[count / 2]);
+        },
+        "batch", [&] {
+            encodeQTangents(normalBatch, tangentBatch, handedness.data(), qtangents.data());
+            bench::doNotOptimize(qtangents[count / 2]);
+        }
+    );
+
+    suite.compare("QTangent -> frame", count,
+        "scalar", [&] {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = qtangents[i].normal();
+                tangentsOut[i] = qtangents[i].tangent();
+                handednessOut[i] = qtangents[i].handedness();
+            }
+            bench::doNotOptimize(out[count / 2]);
+            bench::doNotOptimize(tangentsOut[count / 2]);
+        },
+        "batch", [&] {
+            decodeQTangents(qtangents.data(), count, normalOut, tangentOut, handednessOut.data());
+            bench::doNotOptimize(normalOut.x()[count / 2]);
+            bench::doNotOptimize(tangentOut.x()[count / 2]);
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
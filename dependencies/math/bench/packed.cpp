@@ -0,0 +1,59 @@
+// Compares converting to and from the packed types one element at a time
+// against the bulk convert functions
+
+#include <eseed/math/packed.hpp>
+
+#include "bench.hpp"
+
+#include <vector>
+
+namespace {
+
+constexpr size_t count = 4096;
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("packed", argc, argv);
+
+    std::vector<float> floats(count), out(count);
+    std::vector<F16> halves(count);
+    std::vector<UNorm8> unorms(count);
+    std::vector<SNorm16> snorms(count);
+    for (size_t i = 0; i < count; i++)
+        floats[i] = (float(i) - float(count) / 2.f) * (1.f / float(count)) * 2.5f;
+
+#define ESDM_BENCH_CONVERT(name, packed) \
+    suite.compare("float -> " name, count, \
+        "scalar", [&] { \
+            for (size_t i = 0; i < count; i++) \
+                packed[i] = floats[i]; \
+            bench::doNotOptimize(packed[count / 2]); \
+        }, \
+        "convert", [&] { \
+            convert(floats.data(), packed.data(), count); \
+            bench::doNotOptimize(packed[count / 2]); \
+        } \
+    ); \
+    suite.compare(name " -> float", count, \
+        "scalar", [&] { \
+            for (size_t i = 0; i < count; i++) \
+                out[i] = packed[i]; \
+            bench::doNotOptimize(out[count / 2]); \
+        }, \
+        "convert", [&] { \
+            convert(packed.data(), out.data(), count); \
+            bench::doNotOptimize(out[count / 2]); \
+        } \
+    );
+
+    ESDM_BENCH_CONVERT("F16", halves)
+    ESDM_BENCH_CONVERT("UNorm8", unorms)
+    ESDM_BENCH_CONVERT("SNorm16", snorms)
+
+#undef ESDM_BENCH_CONVERT
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+// Compares rotation composition and interpolation through Mat4 (matRotate
+// + matmul) against the same work through Quat
+
+#include <eseed/math/quat.hpp>
+#include <eseed/math/matops.hpp>
+
+#include "bench.hpp"
+
+#include <vector>
+
+namespace {
+
+constexpr size_t count = 1024;
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("quat", argc, argv);
+
+    const Vec3<float> xAxis(1.f, 0.f, 0.f);
+    const Vec3<float> yAxis(0.f, 1.f, 0.f);
+
+    std::vector<float> yaw(count), pitch(count);
+    std::vector<Mat4<float>> mats(count), matsB(count), matOut(count);
+    std::vector<Quat<float>> quats(count), quatsB(count), quatOut(count);
+    std::vector<Vec3<float>> points(count), pointOut(count);
+    for (size_t i = 0; i < count; i++) {
+        yaw[i] = float(i) * 0.01f;
+        pitch[i] = float(i) * -0.003f;
+        mats[i] = matRotate(yAxis, yaw[i]);
+        matsB[i] = matRotate(xAxis, pitch[i]);
+        quats[i] = quatRotate(yAxis, yaw[i]);
+        quatsB[i] = quatRotate(xAxis, pitch[i]);
+        points[i] = Vec3<float>(float(i), 1.f, -2.f);
+    }
+
+    // The camera orientation in main.cpp, rebuilt every frame
+    suite.compare("camera yaw * pitch -> Mat4", count,
+        "mat", [&] {
+            for (size_t i = 0; i < count; i++)
+                matOut[i] = matmul(matRotate(xAxis, pitch[i]), matRotate(yAxis, yaw[i]));
+            bench::doNotOptimize(matOut[count / 2].data[0][0]);
+        },
+        "quat", [&] {
+            for (size_t i = 0; i < count; i++)
+                matOut[i] = toMat4(quatRotate(yAxis, yaw[i]) * quatRotate(xAxis, pitch[i]));
+            bench::doNotOptimize(matOut[count / 2].data[0][0]);
+        }
+    );
+
+    suite.compare("compose", count,
+        "mat", [&] {
+            for (size_t i = 0; i < count; i++)
+                matOut[i] = matmul(mats[i], matsB[i]);
+            bench::doNotOptimize(matOut[count / 2].data[0][0]);
+        },
+        "quat", [&] {
+            for (size_t i = 0; i < count; i++)
+                quatOut[i] = quatsB[i] * quats[i];
+            bench::doNotOptimize(quatOut[count / 2].x);
+        }
+    );
+
+    suite.compare("rotate point", count,
+        "mat", [&] {
+            for (size_t i = 0; i < count; i++) {
+                const Vec3<float> &p = points[i];
+                pointOut[i] = Vec3<float>(matmul(Vec4<float>(p.x, p.y, p.z, 0.f), mats[i]));
+            }
+            bench::doNotOptimize(pointOut[count / 2].x);
+        },
+        "quat", [&] {
+            for (size_t i = 0; i < count; i++)
+                pointOut[i] = quats[i].rotate(points[i]);
+            bench::doNotOptimize(pointOut[count / 2].x);
+        }
+    );
+
+    // Matrices have no real interpolation, lerping components is the
+    // cheapest (and wrong) stand-in
+    suite.compare("interpolate (lerp vs nlerp)", count,
+        "mat", [&] {
+            for (size_t i = 0; i < count; i++)
+                for (size_t r = 0; r < 4; r++)
+                    matOut[i].data[r] = lerp(mats[i].data[r], matsB[i].data[r], 0.3f);
+            bench::doNotOptimize(matOut[count / 2].data[0][0]);
+        },
+        "quat", [&] {
+            for (size_t i = 0; i < count; i++)
+                quatOut[i] = nlerp(quats[i], quatsB[i], 0.3f);
+            bench::doNotOptimize(quatOut[count / 2].x);
+        }
+    );
+
+    suite.compare("interpolate (lerp vs slerp)", count,
+        "mat", [&] {
+            for (size_t i = 0; i < count; i++)
+                for (size_t r = 0; r < 4; r++)
+                    matOut[i].data[r] = lerp(mats[i].data[r], matsB[i].data[r], 0.3f);
+            bench::doNotOptimize(matOut[count / 2].data[0][0]);
+        },
+        "quat", [&] {
+            for (size_t i = 0; i < count; i++)
+                quatOut[i] = slerp(quats[i], quatsB[i], 0.3f);
+            bench::doNotOptimize(quatOut[count / 2].x);
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
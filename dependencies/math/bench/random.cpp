@@ -0,0 +1,89 @@
+// Compares std::mt19937 against the esdm::rng generators and fills
+
+#include <eseed/math/random.hpp>
+
+#include "bench.hpp"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr size_t count = 4096;
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("random", argc, argv);
+
+    std::vector<uint32_t> bits(count);
+    std::vector<float> floats(count);
+    std::vector<Vec3<float>> vecs(count);
+
+    std::mt19937 mt(1);
+    rng::Philox philox(1);
+    rng::Squares squares(1);
+    rng::Xoshiro256pp xoshiro(1);
+    uint64_t first = 0;
+
+    suite.run("bits/mt19937", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            bits[i] = mt();
+        bench::doNotOptimize(bits[count / 2]);
+    });
+
+    suite.run("bits/xoshiro256++", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            bits[i] = uint32_t(xoshiro() >> 32);
+        bench::doNotOptimize(bits[count / 2]);
+    });
+
+    suite.run("bits/squares fill", count, [&] {
+        rng::fill(squares, first, bits.data(), count);
+        first += count;
+        bench::doNotOptimize(bits[count / 2]);
+    });
+
+    suite.run("bits/philox sequential", count, [&] {
+        for (size_t i = 0; i < count; i++)
+            bits[i] = philox();
+        bench::doNotOptimize(bits[count / 2]);
+    });
+
+    suite.run("bits/philox fill", count, [&] {
+        rng::fill(philox, first, bits.data(), count);
+        first += count;
+        bench::doNotOptimize(bits[count / 2]);
+    });
+
+    suite.compare("uniform float", count,
+        "mt19937", [&] {
+            std::uniform_real_distribution<float> dist;
+            for (size_t i = 0; i < count; i++)
+                floats[i] = dist(mt);
+            bench::doNotOptimize(floats[count / 2]);
+        },
+        "philox fill", [&] {
+            rng::fillUniform(philox, first, floats.data(), count);
+            first += count;
+            bench::doNotOptimize(floats[count / 2]);
+        }
+    );
+
+    suite.compare("unit Vec3", count,
+        "mt19937", [&] {
+            for (size_t i = 0; i < count; i++)
+                vecs[i] = rng::randomUnitVec3(mt);
+            bench::doNotOptimize(vecs[count / 2]);
+        },
+        "philox fill", [&] {
+            rng::fillUnitVec3(philox, first, vecs.data(), count);
+            first += count;
+            bench::doNotOptimize(vecs[count / 2]);
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+// Compares testing rays one at a time against 8 ray packets
+
+#include <eseed/math/ray.hpp>
+
+#include "bench.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr size_t rayCount = 1024;
+constexpr size_t triangleCount = 64;
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("ray", argc, argv);
+
+    // A grid of rays from the origin into a field of triangles and boxes
+    std::vector<Ray<float>> rays(rayCount);
+    for (size_t i = 0; i < rayCount; i++)
+        rays[i] = Ray<float>(Vec3<float>(0.f, 0.f, 0.f), normalize(Vec3<float>(float(i % 32) / 16.f - 1.f, float(i / 32) / 16.f - 1.f, -1.f)));
+
+    std::vector<Vec3<float>> vertices(triangleCount * 3);
+    std::vector<AABB<float>> boxes(triangleCount);
+    for (size_t i = 0; i < triangleCount; i++) {
+        const Vec3<float> c(float(i % 8) - 4.f, float(i / 8) - 4.f, -6.f - float(i % 3));
+        vertices[i * 3] = c + Vec3<float>(-0.6f, -0.5f, 0.f);
+        vertices[i * 3 + 1] = c + Vec3<float>(0.6f, -0.5f, 0.2f);
+        vertices[i * 3 + 2] = c + Vec3<float>(0.f, 0.7f, -0.2f);
+        boxes[i] = AABB<float>(c - Vec3<float>(0.4f, 0.4f, 0.4f), c + Vec3<float>(0.4f, 0.4f, 0.4f));
+    }
+
+    std::vector<RayPacket<float, 8>> packets;
+    for (size_t i = 0; i < rayCount; i += 8)
+        packets.emplace_back(rays.data() + i);
+    std::vector<float> t(rayCount), tNear(rayCount);
+
+    const size_t tests = rayCount * triangleCount;
+
+    suite.compare("ray-triangle", tests,
+        "single", [&] {
+            for (size_t r = 0; r < rayCount; r++) {
+                const RayPacket<float, 1> ray(&rays[r]);
+                t[r] = 1e30f;
+                for (size_t i = 0; i < triangleCount; i++)
+                    intersect(ray, vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2], &t[r]);
+            }
+            bench::doNotOptimize(t[rayCount / 2]);
+        },
+        "packet8", [&] {
+            for (size_t p = 0; p < packets.size(); p++) {
+                float *pt = &t[p * 8];
+                for (size_t l = 0; l < 8; l++)
+                    pt[l] = 1e30f;
+                for (size_t i = 0; i < triangleCount; i++)
+                    intersect(packets[p], vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2], pt);
+            }
+            bench::doNotOptimize(t[rayCount / 2]);
+        }
+    );
+
+    for (size_t r = 0; r < rayCount; r++)
+        t[r] = 1e30f;
+    uint32_t hits = 0;
+
+    suite.compare("ray-AABB", tests,
+        "single", [&] {
+            for (size_t r = 0; r < rayCount; r++) {
+                const RayPacket<float, 1> ray(&rays[r]);
+                for (size_t i = 0; i < triangleCount; i++)
+                    hits += intersect(ray, boxes[i], &t[r], &tNear[r]);
+            }
+            bench::doNotOptimize(hits);
+        },
+        "packet8", [&] {
+            for (size_t p = 0; p < packets.size(); p++)
+                for (size_t i = 0; i < triangleCount; i++)
+                    hits += intersect(packets[p], boxes[i], &t[p * 8], &tNear[p * 8]);
+            bench::doNotOptimize(hits);
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+// Compares long element-wise operator chains evaluated eagerly (one Vec /
+// Mat temporary per operator) against the same chain through esdm::lazy
+// The compiler fuses the eager chain on small operands by itself; lazy
+// starts to win once the temporaries outgrow the registers
+
+#include <eseed/math/expr.hpp>
+
+#include "bench.hpp"
+
+#include <vector>
+
+namespace {
+
+constexpr size_t count = 1024;
+
+template <size_t L, typename T>
+double first(const esdm::Vec<L, T> &v) {
+    return v.data[0];
+}
+
+template <size_t M, size_t N, typename T>
+double first(const esdm::Mat<M, N, T> &m) {
+    return m.data[0].data[0];
+}
+
+template <typename V>
+void chain(esdm::bench::Suite &suite, const char *name, const std::vector<V> &a, const std::vector<V> &b, const std::vector<V> &c, const std::vector<V> &d) {
+    using namespace esdm;
+    const size_t n = a.size();
+    std::vector<V> out(n);
+
+    suite.compare(name, n,
+        "eager", [&] {
+            for (size_t i = 0; i < n; i++)
+                out[i] = a[i] * b[i] + c[i] * d[i] - (a[i] - d[i]) * 0.5f + b[i] / 3.f;
+            bench::doNotOptimize(first(out[n / 2]));
+        },
+        "lazy", [&] {
+            for (size_t i = 0; i < n; i++)
+                assign(out[i], lazy(a[i]) * b[i] + lazy(c[i]) * d[i] - (lazy(a[i]) - d[i]) * 0.5f + lazy(b[i]) / 3.f);
+            bench::doNotOptimize(first(out[n / 2]));
+        }
+    );
+}
+
+template <typename V>
+void accumulate(esdm::bench::Suite &suite, const char *name, const std::vector<V> &vel) {
+    using namespace esdm;
+    std::vector<V> pos(count);
+    float delta = 1.f / 60.f;
+
+    suite.compare(name, count,
+        "eager", [&] {
+            for (size_t i = 0; i < count; i++)
+                pos[i] += vel[i] * delta;
+        },
+        "lazy", [&] {
+            for (size_t i = 0; i < count; i++)
+                pos[i] += lazy(vel[i]) * delta;
+        }
+    );
+}
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("vecexpr", argc, argv);
+
+    std::vector<Vec<8, float>> a8(count), b8(count), c8(count), d8(count);
+    std::vector<Mat4<double>> am(count), bm(count), cm(count), dm(count);
+    for (size_t i = 0; i < count; i++) {
+        a8[i] = Vec<8, float>(float(i));
+        b8[i] = Vec<8, float>(2.f);
+        c8[i] = Vec<8, float>(-1.f);
+        d8[i] = Vec<8, float>(float(i) * 0.5f);
+        am[i] = Mat4<double>(double(i));
+        bm[i] = Mat4<double>(2.0);
+        cm[i] = Mat4<double>(-1.0);
+        dm[i] = Mat4<double>(0.5);
+    }
+
+    chain(suite, "Vec<8, float> 7-op chain", a8, b8, c8, d8);
+    chain(suite, "Mat4<double> 7-op chain", am, bm, cm, dm);
+
+    // Fewer of the large ones, to stay in cache like the small ones do
+    std::vector<Mat<8, 8, float>> a64(count / 16), b64(count / 16), c64(count / 16), d64(count / 16);
+    std::vector<Vec<256, float>> a256(count / 64), b256(count / 64), c256(count / 64), d256(count / 64);
+    for (size_t i = 0; i < a64.size(); i++) {
+        a64[i] = Mat<8, 8, float>(float(i));
+        b64[i] = Mat<8, 8, float>(2.f);
+        c64[i] = Mat<8, 8, float>(-1.f);
+        d64[i] = Mat<8, 8, float>(.5f);
+    }
+    for (size_t i = 0; i < a256.size(); i++) {
+        a256[i] = Vec<256, float>(float(i));
+        b256[i] = Vec<256, float>(2.f);
+        c256[i] = Vec<256, float>(-1.f);
+        d256[i] = Vec<256, float>(.5f);
+    }
+    chain(suite, "Mat<8, 8, float> 7-op chain", a64, b64, c64, d64);
+    chain(suite, "Vec<256, float> 7-op chain", a256, b256, c256, d256);
+    accumulate(suite, "Vec<8, float> pos += vel * dt", a8);
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+// Compares the SIMD Vec overloads (vecsimd.hpp) against the generic
+// ESEED_VEC_* templates, which are forced by naming them explicitly
+
+#include <eseed/math/vec.hpp>
+
+#include "bench.hpp"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr size_t count = 4096;
+
+}
+
+int main(int argc, char **argv) {
+    using namespace esdm;
+
+    bench::Suite suite("vecsimd", argc, argv);
+
+#if !defined(ESDM_SIMD_SSE2)
+    std::printf("SIMD disabled, both columns measure the generic template\n");
+#endif
+
+    std::vector<Vec4<float>> a4(count), b4(count), c4(count), o4(count);
+    std::vector<Vec3<float>> a3(count), b3(count), o3(count);
+    std::vector<Vec4<int32_t>> ai(count), bi(count), oi(count);
+    for (size_t i = 0; i < count; i++) {
+        float f = float(i);
+        a4[i] = Vec4<float>(f, f + 1, f + 2, f + 3);
+        b4[i] = Vec4<float>(0.5f, 0.25f, 2.f, 1.f);
+        c4[i] = Vec4<float>(1.f, -1.f, f, -f);
+        a3[i] = Vec3<float>(f, 1.f, -f);
+        b3[i] = Vec3<float>(0.f, f, 2.f);
+        ai[i] = Vec4<int32_t>(int32_t(i), 3, -int32_t(i), 7);
+        bi[i] = Vec4<int32_t>(1, int32_t(i), 5, -2);
+    }
+
+    suite.compare("Vec4f a * b + c", count,
+        "generic", [&] {
+            for (size_t i = 0; i < count; i++)
+                o4[i] = operator+<4, float, float>(operator*<4, float, float>(a4[i], b4[i]), c4[i]);
+            bench::doNotOptimize(o4[count / 2].x);
+        },
+        "simd", [&] {
+            for (size_t i = 0; i < count; i++)
+                o4[i] = a4[i] * b4[i] + c4[i];
+            bench::doNotOptimize(o4[count / 2].x);
+        }
+    );
+
+    suite.compare("Vec4f a += b * s", count,
+        "generic", [&] {
+            for (size_t i = 0; i < count; i++)
+                operator+=<4, float, float>(o4[i], operator*<4, float, float>(b4[i], 0.5f));
+            bench::doNotOptimize(o4[count / 2].x);
+        },
+        "simd", [&] {
+            for (size_t i = 0; i < count; i++)
+                o4[i] += b4[i] * 0.5f;
+            bench::doNotOptimize(o4[count / 2].x);
+        }
+    );
+
+    suite.compare("Vec4f dot", count,
+        "generic", [&] {
+            float sum = 0;
+            for (size_t i = 0; i < count; i++)
+                sum += dot<4, float, float>(a4[i], b4[i]);
+            bench::doNotOptimize(sum);
+        },
+        "simd", [&] {
+            float sum = 0;
+            for (size_t i = 0; i < count; i++)
+                sum += dot(a4[i], b4[i]);
+            bench::doNotOptimize(sum);
+        }
+    );
+
+    suite.compare("Vec3f cross * s", count,
+        "generic", [&] {
+            for (size_t i = 0; i < count; i++)
+                o3[i] = operator*<3, float, float>(cross<float, float>(a3[i], b3[i]), 0.5f);
+            bench::doNotOptimize(o3[count / 2].y);
+        },
+        "simd", [&] {
+            for (size_t i = 0; i < count; i++)
+                o3[i] = cross(a3[i], b3[i]) * 0.5f;
+            bench::doNotOptimize(o3[count / 2].y);
+        }
+    );
+
+    suite.compare("Vec4i (a + b) ^ (a << 2)", count,
+        "generic", [&] {
+            for (size_t i = 0; i < count; i++)
+                oi[i] = operator^<4, int32_t, int32_t>(
+                    operator+<4, int32_t, int32_t>(ai[i], bi[i]),
+                    operator<<<4, int32_t, int32_t>(ai[i], 2)
+                );
+            bench::doNotOptimize(oi[count / 2].z);
+        },
+        "simd", [&] {
+            for (size_t i = 0; i < count; i++)
+                oi[i] = (ai[i] + bi[i]) ^ (ai[i] << 2);
+            bench::doNotOptimize(oi[count / 2].z);
+        }
+    );
+
+    // Swizzles against the same components written out by hand
+    suite.compare("Vec4f zyx + Vec3f", count,
+        "manual", [&] {
+            for (size_t i = 0; i < count; i++)
+                o3[i] = Vec3<float>(a4[i].z, a4[i].y, a4[i].x) + b3[i];
+            bench::doNotOptimize(o3[count / 2].x);
+        },
+        "swizzle", [&] {
+            for (size_t i = 0; i < count; i++)
+                o3[i] = a4[i].zyx() + b3[i];
+            bench::doNotOptimize(o3[count / 2].x);
+        }
+    );
+
+    suite.compare("Vec4f swizzleRef<3, 2, 1, 0>() = Vec4f", count,
+        "manual", [&] {
+            for (size_t i = 0; i < count; i++) {
+                o4[i].w = b4[i].x;
+                o4[i].z = b4[i].y;
+                o4[i].y = b4[i].z;
+                o4[i].x = b4[i].w;
+            }
+            bench::doNotOptimize(o4[count / 2].x);
+        },
+        "swizzle", [&] {
+            for (size_t i = 0; i < count; i++)
+                o4[i].swizzleRef<3, 2, 1, 0>() = b4[i];
+            bench::doNotOptimize(o4[count / 2].x);
+        }
+    );
+
+    return suite.finish();
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "mat.hpp"
+#include "quat.hpp"
+
+#include <array>
+
+namespace esdm {
+
+// Affine transform [ R | t ] stored as three rows of four components,
+// 48 bytes for float where a Mat4<float> takes 64
+//
+// Row r holds column r of the equivalent Mat4 (whose last column is always
+// 0, 0, 0, 1 for the matrices built by matRotate / matTranslate), so
+// toMat4(a) is lossless and transforms row vectors the same way:
+// transformPoint(a, p) == [ p, 1 ] * toMat4(a)
+template <typename T>
+class Affine3 {
+public:
+    std::array<Vec4<T>, 3> data;
+
+    // Identity transform
+    constexpr Affine3() : data{} {
+        for (size_t r = 0; r < 3; r++)
+            data[r][r] = T(1);
+    }
+
+    // Upper 3x3 laid out like matRotate / toMat3, then translation,
+    // same as matmul(linear as Mat4, matTranslate(translation))
+    constexpr Affine3(const Mat3<T> &linear, const Vec3<T> &translation) : data{} {
+        for (size_t r = 0; r < 3; r++) {
+            for (size_t i = 0; i < 3; i++)
+                data[r][i] = linear.data[i][r];
+            data[r][3] = translation[r];
+        }
+    }
+
+    constexpr Affine3(const Quat<T> &rotation, const Vec3<T> &translation) : Affine3(toMat3(rotation), translation) {}
+
+    // Drops the last column of m, which must be 0, 0, 0, 1
+    constexpr explicit Affine3(const Mat4<T> &m) : data{} {
+        for (size_t r = 0; r < 3; r++)
+            for (size_t i = 0; i < 4; i++)
+                data[r][i] = m.data[i][r];
+    }
+
+    constexpr Vec3<T> getTranslation() const {
+        return Vec3<T>(data[0][3], data[1][3], data[2][3]);
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const Affine3 &a) {
+        return out << toMat4(a);
+    }
+};
+
+// Functions
+
+template <typename T>
+constexpr Mat4<T> toMat4(const Affine3<T> &a) {
+    Mat4<T> out;
+    for (size_t i = 0; i < 4; i++)
+        for (size_t r = 0; r < 3; r++)
+            out.data[i][r] = a.data[r][i];
+    out.data[3][3] = T(1);
+    return out;
+}
+
+// Applies a, then b, same as matmul(toMat4(a), toMat4(b))
+template <typename T>
+constexpr Affine3<T> matmul(const Affine3<T> &a, const Affine3<T> &b) {
+    Affine3<T> out;
+    for (size_t r = 0; r < 3; r++) {
+        for (size_t j = 0; j < 4; j++) {
+            T sum = j == 3 ? b.data[r][3] : T(0);
+            for (size_t k = 0; k < 3; k++)
+                sum += b.data[r][k] * a.data[k][j];
+            out.data[r][j] = sum;
+        }
+    }
+    return out;
+}
+
+// [ p, 1 ] * toMat4(a)
+template <typename T>
+constexpr Vec3<T> transformPoint(const Affine3<T> &a, const Vec3<T> &p) {
+    Vec3<T> out;
+    for (size_t r = 0; r < 3; r++)
+        out[r] = a.data[r][0] * p[0] + a.data[r][1] * p[1] + a.data[r][2] * p[2] + a.data[r][3];
+    return out;
+}
+
+// [ d, 0 ] * toMat4(a), ignoring translation
+template <typename T>
+constexpr Vec3<T> transformDirection(const Affine3<T> &a, const Vec3<T> &d) {
+    Vec3<T> out;
+    for (size_t r = 0; r < 3; r++)
+        out[r] = a.data[r][0] * d[0] + a.data[r][1] * d[1] + a.data[r][2] * d[2];
+    return out;
+}
+
+// Inverse of a rotation + translation, using R^-1 = R^T
+// Any scale or shear gives a wrong result, see inverse for those
+template <typename T>
+constexpr Affine3<T> inverseRigid(const Affine3<T> &a) {
+    Affine3<T> out;
+    for (size_t r = 0; r < 3; r++) {
+        for (size_t i = 0; i < 3; i++)
+            out.data[r][i] = a.data[i][r];
+        out.data[r][3] = -(a.data[0][r] * a.data[0][3] + a.data[1][r] * a.data[1][3] + a.data[2][r] * a.data[2][3]);
+    }
+    return out;
+}
+
+// General affine inverse through the inverse of the 3x3 part
+// A singular matrix produces non-finite components
+template <typename T>
+constexpr Affine3<T> inverse(const Affine3<T> &a) {
+    Mat3<T> linear;
+    for (size_t r = 0; r < 3; r++)
+        for (size_t i = 0; i < 3; i++)
+            linear.data[r][i] = a.data[r][i];
+    const Mat3<T> linearInv = inverse(linear);
+
+    Affine3<T> out;
+    for (size_t r = 0; r < 3; r++) {
+        T t = T(0);
+        for (size_t i = 0; i < 3; i++) {
+            out.data[r][i] = linearInv.data[r][i];
+            t -= linearInv.data[r][i] * a.data[i][3];
+        }
+        out.data[r][3] = t;
+    }
+    return out;
+}
+
+}
+
+#include "affinesimd.hpp"
\ No newline at end of file
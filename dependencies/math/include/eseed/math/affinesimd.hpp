@@ -0,0 +1,99 @@
+#pragma once
+
+#include "affine.hpp"
+
+// SIMD overloads for Affine3<float>, one __m128 per row (see vecsimd.hpp
+// for how these take priority over the generic templates)
+
+#if defined(ESDM_SIMD_SSE2)
+
+namespace esdm {
+
+namespace simd {
+
+// Lane mask keeping only w
+inline __m128 maskW() {
+    return _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+}
+
+// [ dot(r0, v), dot(r1, v), dot(r2, v), 0 ], the products are transposed
+// so the three horizontal sums become three adds
+inline __m128 affineMul(const Affine3<float> &a, __m128 v) {
+    __m128 r0 = _mm_mul_ps(a.data[0].simd, v);
+    __m128 r1 = _mm_mul_ps(a.data[1].simd, v);
+    __m128 r2 = _mm_mul_ps(a.data[2].simd, v);
+    __m128 r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    return _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3));
+}
+
+}
+
+constexpr Mat4<float> toMat4(const Affine3<float> &a) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return toMat4<float>(a);
+    Mat4<float> out;
+    out.data[0].simd = a.data[0].simd;
+    out.data[1].simd = a.data[1].simd;
+    out.data[2].simd = a.data[2].simd;
+    out.data[3].simd = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+    _MM_TRANSPOSE4_PS(out.data[0].simd, out.data[1].simd, out.data[2].simd, out.data[3].simd);
+    return out;
+}
+
+// Each output row is b's row applied to a's rows, plus b's translation
+constexpr Affine3<float> matmul(const Affine3<float> &a, const Affine3<float> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return matmul<float>(a, b);
+    Affine3<float> out;
+    for (size_t r = 0; r < 3; r++) {
+        const __m128 row = b.data[r].simd;
+        __m128 o = _mm_and_ps(row, simd::maskW());
+        o = simd::madd(simd::splat<0>(row), a.data[0].simd, o);
+        o = simd::madd(simd::splat<1>(row), a.data[1].simd, o);
+        out.data[r].simd = simd::madd(simd::splat<2>(row), a.data[2].simd, o);
+    }
+    return out;
+}
+
+constexpr Vec3<float> transformPoint(const Affine3<float> &a, const Vec3<float> &p) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return transformPoint<float>(a, p);
+    // The Vec3 pad lane is 0, so this is [ p, 1 ]
+    return simd::toVec3(simd::affineMul(a, _mm_add_ps(p.simd, _mm_setr_ps(0.f, 0.f, 0.f, 1.f))));
+}
+
+constexpr Vec3<float> transformDirection(const Affine3<float> &a, const Vec3<float> &d) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return transformDirection<float>(a, d);
+    return simd::toVec3(simd::affineMul(a, d.simd));
+}
+
+constexpr Affine3<float> inverseRigid(const Affine3<float> &a) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return inverseRigid<float>(a);
+    const __m128 r0 = a.data[0].simd;
+    const __m128 r1 = a.data[1].simd;
+    const __m128 r2 = a.data[2].simd;
+
+    // -R^T t, as t.x * R row 0 + t.y * R row 1 + t.z * R row 2
+    __m128 t = _mm_mul_ps(simd::splat<3>(r0), r0);
+    t = simd::madd(simd::splat<3>(r1), r1, t);
+    t = simd::madd(simd::splat<3>(r2), r2, t);
+
+    // Rows of the result are the columns of [ R^T rows..., -R^T t ]
+    Affine3<float> out;
+    __m128 c0 = _mm_andnot_ps(simd::maskW(), r0);
+    __m128 c1 = _mm_andnot_ps(simd::maskW(), r1);
+    __m128 c2 = _mm_andnot_ps(simd::maskW(), r2);
+    __m128 c3 = simd::neg(t);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    out.data[0].simd = c0;
+    out.data[1].simd = c1;
+    out.data[2].simd = c2;
+    return out;
+}
+
+}
+
+#endif
\ No newline at end of file
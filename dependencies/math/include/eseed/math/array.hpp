@@ -0,0 +1,387 @@
+#pragma once
+
+#include "vec.hpp"
+#include "pack.hpp"
+#include "parallel.hpp"
+#include "morton.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// N-dimensional arrays for voxel volumes and other grids
+//
+// Axis 0 (x) is the innermost one and the last axis the outermost, so a
+// linear Array3D is x-major like CHUNK_SIZE volumes indexed as
+// x + y * size + z * size * size. How coordinates map to memory is up to
+// the layout:
+//   LayoutStrided  one stride per axis, contiguous x rows by default
+//   LayoutTiled    Tile^Rank bricks, each one linear, bricks linear
+//   LayoutMorton   Z-order curve over a power of two cube
+//
+// ArrayView is a non-owning window into any of them (sub-views keep the
+// layout and just move the origin), Array owns its storage. Element access
+// isn't bounds checked.
+//
+// forEach, forEachSpan and transform split the outermost axis across
+// threads, and hand the innermost loop out as runs of contiguous elements
+// so it can be vectorized.
+
+namespace esdm {
+
+template <size_t Rank>
+using Index = Vec<Rank, size_t>;
+
+namespace detail {
+
+template <size_t Rank>
+constexpr size_t product(const Index<Rank> &extents) {
+    size_t out = 1;
+    for (size_t i = 0; i < Rank; i++)
+        out *= extents.data[i];
+    return out;
+}
+
+// Offset of c among the extents, axis 0 fastest
+template <size_t Rank>
+constexpr size_t linearOffset(const Index<Rank> &c, const Index<Rank> &extents) {
+    size_t out = 0;
+    for (size_t i = Rank; i-- > 0;)
+        out = out * extents.data[i] + c.data[i];
+    return out;
+}
+
+}
+
+// Layouts
+// Each maps an index inside the extents it was made for to an element
+// offset, and says how many elements from an index on are contiguous along
+// axis 0
+
+template <size_t Rank>
+class LayoutStrided {
+public:
+    Index<Rank> strides;
+
+    constexpr LayoutStrided() : strides() {}
+
+    // Contiguous, axis 0 fastest
+    constexpr explicit LayoutStrided(const Index<Rank> &extents) : strides(), storage(detail::product(extents)) {
+        size_t stride = 1;
+        for (size_t i = 0; i < Rank; i++) {
+            strides.data[i] = stride;
+            stride *= extents.data[i];
+        }
+    }
+
+    constexpr LayoutStrided(const Index<Rank> &strides, size_t storage) : strides(strides), storage(storage) {}
+
+    // Elements of storage needed
+    constexpr size_t size() const {
+        return storage;
+    }
+
+    constexpr size_t offset(const Index<Rank> &c) const {
+        size_t out = 0;
+        for (size_t i = 0; i < Rank; i++)
+            out += c.data[i] * strides.data[i];
+        return out;
+    }
+
+    // Contiguous elements from c, up to "limit" along axis 0
+    constexpr size_t run(const Index<Rank> &, size_t limit) const {
+        return strides.data[0] == 1 ? limit : 1;
+    }
+
+private:
+    size_t storage = 0;
+};
+
+// Cubic bricks of Tile elements per side, Tile being a power of two, so a
+// small neighborhood shares cache lines whichever way it is walked
+template <size_t Rank, size_t Tile = 8>
+class LayoutTiled {
+public:
+    static_assert(Tile > 0 && (Tile & (Tile - 1)) == 0, "Tile size must be a power of two");
+
+    static constexpr size_t tileVolume = detail::product(Index<Rank>(Tile));
+
+    // Tiles along each axis
+    Index<Rank> tiles;
+
+    constexpr LayoutTiled() : tiles() {}
+
+    constexpr explicit LayoutTiled(const Index<Rank> &extents) : tiles() {
+        for (size_t i = 0; i < Rank; i++)
+            tiles.data[i] = (extents.data[i] + Tile - 1) / Tile;
+    }
+
+    constexpr size_t size() const {
+        return detail::product(tiles) * tileVolume;
+    }
+
+    constexpr size_t offset(const Index<Rank> &c) const {
+        Index<Rank> tile, inner;
+        for (size_t i = 0; i < Rank; i++) {
+            tile.data[i] = c.data[i] / Tile;
+            inner.data[i] = c.data[i] % Tile;
+        }
+        return detail::linearOffset(tile, tiles) * tileVolume + detail::linearOffset(inner, Index<Rank>(Tile));
+    }
+
+    constexpr size_t run(const Index<Rank> &c, size_t limit) const {
+        const size_t inTile = Tile - c.data[0] % Tile;
+        return inTile < limit ? inTile : limit;
+    }
+};
+
+// Z-order over the smallest power of two cube holding the extents, see
+// morton.hpp
+template <size_t Rank>
+class LayoutMorton {
+public:
+    static_assert(Rank == 2 || Rank == 3, "Morton order is only defined for 2 and 3 dimensions");
+
+    // Side of the cube
+    size_t side;
+
+    constexpr LayoutMorton() : side(0) {}
+
+    constexpr explicit LayoutMorton(const Index<Rank> &extents) : side(1) {
+        for (size_t i = 0; i < Rank; i++)
+            while (side < extents.data[i])
+                side *= 2;
+    }
+
+    constexpr size_t size() const {
+        return detail::product(Index<Rank>(side));
+    }
+
+    constexpr size_t offset(const Index<Rank> &c) const {
+        uint64_t out = 0;
+        for (size_t i = 0; i < Rank; i++)
+            out |= morton::detail::spread<Rank>(c.data[i]) << i;
+        return size_t(out);
+    }
+
+    // Only x pairs are adjacent
+    constexpr size_t run(const Index<Rank> &c, size_t limit) const {
+        const size_t inPair = 2 - (c.data[0] & 1);
+        return inPair < limit ? inPair : limit;
+    }
+};
+
+// Non-owning view of "extents" elements of a layout, starting at "origin"
+template <typename T, size_t Rank, typename Layout = LayoutStrided<Rank>>
+class ArrayView {
+public:
+    using Element = T;
+
+    constexpr ArrayView() : base(nullptr), layout(), origin(), extents() {}
+
+    constexpr ArrayView(T *base, const Layout &layout, const Index<Rank> &extents) : base(base), layout(layout), origin(), extents(extents) {}
+
+    constexpr ArrayView(T *base, const Layout &layout, const Index<Rank> &origin, const Index<Rank> &extents) : base(base), layout(layout), origin(origin), extents(extents) {}
+
+    // Read-only view of a writable one
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    constexpr ArrayView(const ArrayView<U, Rank, Layout> &other) : base(other.getBase()), layout(other.getLayout()), origin(other.getOrigin()), extents(other.getExtents()) {}
+
+    constexpr const Index<Rank> &getExtents() const { return extents; }
+    constexpr const Index<Rank> &getOrigin() const { return origin; }
+    constexpr const Layout &getLayout() const { return layout; }
+    constexpr T *getBase() const { return base; }
+
+    constexpr size_t size() const {
+        return detail::product(extents);
+    }
+
+    constexpr T &operator[](const Index<Rank> &c) const {
+        return base[layout.offset(origin + c)];
+    }
+
+    // view(x, y, z)
+    template <typename... Is, typename = std::enable_if_t<sizeof...(Is) == Rank>>
+    constexpr T &operator()(Is... c) const {
+        return (*this)[Index<Rank>(size_t(c)...)];
+    }
+
+    // Elements [origin, origin + extents) of this view
+    constexpr ArrayView subview(const Index<Rank> &subOrigin, const Index<Rank> &subExtents) const {
+        for (size_t i = 0; i < Rank; i++)
+            if (subOrigin.data[i] + subExtents.data[i] > extents.data[i])
+                throw std::out_of_range("Subview is larger than its ArrayView");
+        return ArrayView(base, layout, origin + subOrigin, subExtents);
+    }
+
+    // Contiguous elements from c along axis 0, at most to the end of the
+    // view
+    constexpr size_t run(const Index<Rank> &c) const {
+        return layout.run(origin + c, extents.data[0] - c.data[0]);
+    }
+
+private:
+    T *base;
+    Layout layout;
+    Index<Rank> origin;
+    Index<Rank> extents;
+};
+
+// Owning array, storage sized by the layout
+template <typename T, size_t Rank, typename Layout = LayoutStrided<Rank>>
+class Array {
+public:
+    Array() : layout(), extents() {}
+
+    explicit Array(const Index<Rank> &extents) : layout(extents), extents(extents), storage(layout.size()) {}
+
+    Array(const Index<Rank> &extents, const T &value) : layout(extents), extents(extents), storage(layout.size(), value) {}
+
+    const Index<Rank> &getExtents() const { return extents; }
+    const Layout &getLayout() const { return layout; }
+
+    size_t size() const {
+        return detail::product(extents);
+    }
+
+    // Whole storage in layout order, padding included
+    T *data() { return storage.data(); }
+    const T *data() const { return storage.data(); }
+    size_t storageSize() const { return storage.size(); }
+
+    ArrayView<T, Rank, Layout> view() {
+        return ArrayView<T, Rank, Layout>(storage.data(), layout, extents);
+    }
+
+    ArrayView<const T, Rank, Layout> view() const {
+        return ArrayView<const T, Rank, Layout>(storage.data(), layout, extents);
+    }
+
+    operator ArrayView<T, Rank, Layout>() { return view(); }
+    operator ArrayView<const T, Rank, Layout>() const { return view(); }
+
+    T &operator[](const Index<Rank> &c) { return storage[layout.offset(c)]; }
+    const T &operator[](const Index<Rank> &c) const { return storage[layout.offset(c)]; }
+
+    template <typename... Is, typename = std::enable_if_t<sizeof...(Is) == Rank>>
+    T &operator()(Is... c) { return (*this)[Index<Rank>(size_t(c)...)]; }
+
+    template <typename... Is, typename = std::enable_if_t<sizeof...(Is) == Rank>>
+    const T &operator()(Is... c) const { return (*this)[Index<Rank>(size_t(c)...)]; }
+
+private:
+    Layout layout;
+    Index<Rank> extents;
+    std::vector<T> storage;
+};
+
+template <typename T, typename Layout = LayoutStrided<3>>
+using Array3D = Array<T, 3, Layout>;
+
+template <typename T, typename Layout = LayoutStrided<3>>
+using ArrayView3D = ArrayView<T, 3, Layout>;
+
+// Parallel iteration
+// Each splits the outermost axis into ranges for parallelFor, so fn runs on
+// several threads at once for large views and must be safe to call that
+// way. Within a range, rows along axis 0 are visited in order.
+
+namespace detail {
+
+// Calls fn(c, n) for every run of n contiguous elements starting at c,
+// threaded over the outermost axis
+template <typename T, size_t Rank, typename Layout, typename F>
+void forEachRun(const ArrayView<T, Rank, Layout> &view, F &&fn) {
+    const Index<Rank> &extents = view.getExtents();
+    const size_t outer = extents.data[Rank - 1];
+    const size_t slice = product(extents) / std::max<size_t>(outer, 1);
+    if (slice == 0)
+        return;
+
+    parallelFor(outer, std::max<size_t>(1, batchGrain / slice), [&](size_t begin, size_t end) {
+        // A 1D view splits axis 0 itself
+        if constexpr (Rank == 1) {
+            for (Index<1> c(begin); c.data[0] < end;) {
+                const size_t n = std::min(view.run(c), end - c.data[0]);
+                fn(c, n);
+                c.data[0] += n;
+            }
+            return;
+        }
+
+        // Rows along axis 0, counted through axes 1 ... Rank - 2
+        size_t rows = 1;
+        for (size_t i = 1; i + 1 < Rank; i++)
+            rows *= extents.data[i];
+        for (size_t o = begin; o < end; o++) {
+            for (size_t row = 0; row < rows; row++) {
+                Index<Rank> c;
+                size_t r = row;
+                for (size_t i = 1; i + 1 < Rank; i++) {
+                    c.data[i] = r % extents.data[i];
+                    r /= extents.data[i];
+                }
+                c.data[Rank - 1] = o;
+                while (c.data[0] < extents.data[0]) {
+                    const size_t n = view.run(c);
+                    fn(c, n);
+                    c.data[0] += n;
+                }
+            }
+        }
+    });
+}
+
+}
+
+// fn(T *p, size_t n, const Index<Rank> &c) for runs p[0 .. n) of the view,
+// p[0] being the element at c and p[i] the one at c + i along axis 0
+template <typename T, size_t Rank, typename Layout, typename F>
+void forEachSpan(const ArrayView<T, Rank, Layout> &view, F &&fn) {
+    detail::forEachRun(view, [&](const Index<Rank> &c, size_t n) {
+        fn(&view[c], n, c);
+    });
+}
+
+// fn(T &element, const Index<Rank> &c) for every element
+template <typename T, size_t Rank, typename Layout, typename F>
+void forEach(const ArrayView<T, Rank, Layout> &view, F &&fn) {
+    forEachSpan(view, [&](T *p, size_t n, Index<Rank> c) {
+        for (size_t i = 0; i < n; i++, c.data[0]++)
+            fn(p[i], c);
+    });
+}
+
+// out[c] = fn(in[c]) for every c, where in and out have the same extents
+// but may have different layouts
+template <typename T, typename U, size_t Rank, typename LayoutIn, typename LayoutOut, typename F>
+void transform(const ArrayView<T, Rank, LayoutIn> &in, const ArrayView<U, Rank, LayoutOut> &out, F &&fn) {
+    for (size_t i = 0; i < Rank; i++)
+        if (in.getExtents().data[i] != out.getExtents().data[i])
+            throw std::invalid_argument("transform needs views with the same extents");
+
+    detail::forEachRun(in, [&](Index<Rank> c, size_t n) {
+        // Runs of the output can be shorter when the layouts differ
+        while (n > 0) {
+            const size_t m = std::min(n, out.run(c));
+            const T *src = &in[c];
+            U *dst = &out[c];
+            for (size_t i = 0; i < m; i++)
+                dst[i] = fn(src[i]);
+            c.data[0] += m;
+            n -= m;
+        }
+    });
+}
+
+template <typename T, size_t Rank, typename Layout>
+void fill(const ArrayView<T, Rank, Layout> &view, const T &value) {
+    forEachSpan(view, [&](T *p, size_t n, const Index<Rank> &) {
+        std::fill(p, p + n, value);
+    });
+}
+
+}
\ No newline at end of file
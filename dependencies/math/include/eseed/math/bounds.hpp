@@ -0,0 +1,283 @@
+#pragma once
+
+#include "mat.hpp"
+#include "pack.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace esdm {
+
+// Axis aligned box between min and max (inclusive)
+template <typename T>
+class AABB {
+public:
+    Vec3<T> min;
+    Vec3<T> max;
+
+    // Empty box, min > max, so merging anything into it gives that thing
+    constexpr AABB() :
+        min(std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), std::numeric_limits<T>::max()),
+        max(std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest()) {}
+
+    constexpr AABB(const Vec3<T> &min, const Vec3<T> &max) : min(min), max(max) {}
+
+    constexpr Vec3<T> getCenter() const {
+        return (min + max) * T(0.5);
+    }
+
+    // Half the size along each axis
+    constexpr Vec3<T> getExtents() const {
+        return (max - min) * T(0.5);
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const AABB &box) {
+        return out << "[" << box.min << ", " << box.max << "]";
+    }
+};
+
+template <typename T>
+class Sphere {
+public:
+    Vec3<T> center;
+    T radius;
+
+    constexpr Sphere() : center(), radius(T(0)) {}
+
+    constexpr Sphere(const Vec3<T> &center, T radius) : center(center), radius(radius) {}
+
+    friend std::ostream &operator<<(std::ostream &out, const Sphere &sphere) {
+        return out << "[" << sphere.center << ", " << sphere.radius << "]";
+    }
+};
+
+// Six planes [ n, d ], a point p being inside a plane when dot(n, p) + d >= 0
+// Planes are in the order of the clip space bounds -x, +x, -y, +y, near,
+// far, with unit normals pointing into the frustum. Vulkan clip space has +y
+// down, so -y is the top of the view.
+template <typename T>
+class Frustum {
+public:
+    std::array<Vec4<T>, 6> planes;
+
+    constexpr Frustum() : planes{} {}
+
+    // Planes of a view-projection matrix (row vectors, clip = [ p, 1 ] * m)
+    // with clip depth in [0, w] like Vulkan. With reversed depth the near
+    // and far planes trade places, and a plane at infinity comes out as
+    // 0, 0, 0, d with d > 0, which every point passes
+    constexpr explicit Frustum(const Mat4<T> &viewProj) : planes{} {
+        Vec4<T> col[4];
+        for (size_t j = 0; j < 4; j++)
+            for (size_t i = 0; i < 4; i++)
+                col[j][i] = viewProj.data[i][j];
+
+        planes[0] = col[3] + col[0];
+        planes[1] = col[3] - col[0];
+        planes[2] = col[3] + col[1];
+        planes[3] = col[3] - col[1];
+        planes[4] = col[2];
+        planes[5] = col[3] - col[2];
+
+        for (auto &plane : planes) {
+            const T normalLength = sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            if (normalLength > T(0))
+                plane = plane / normalLength;
+        }
+    }
+};
+
+// Functions
+
+template <typename T>
+constexpr AABB<T> merge(const AABB<T> &a, const AABB<T> &b) {
+    AABB<T> out;
+    for (size_t i = 0; i < 3; i++) {
+        out.min[i] = a.min[i] < b.min[i] ? a.min[i] : b.min[i];
+        out.max[i] = a.max[i] > b.max[i] ? a.max[i] : b.max[i];
+    }
+    return out;
+}
+
+template <typename T>
+constexpr AABB<T> merge(const AABB<T> &a, const Vec3<T> &p) {
+    return merge(a, AABB<T>(p, p));
+}
+
+template <typename T>
+constexpr bool contains(const AABB<T> &a, const Vec3<T> &p) {
+    for (size_t i = 0; i < 3; i++)
+        if (p[i] < a.min[i] || p[i] > a.max[i])
+            return false;
+    return true;
+}
+
+template <typename T>
+constexpr bool intersects(const AABB<T> &a, const AABB<T> &b) {
+    for (size_t i = 0; i < 3; i++)
+        if (a.max[i] < b.min[i] || b.max[i] < a.min[i])
+            return false;
+    return true;
+}
+
+// Sphere around the box's corners, not the smallest around its contents
+template <typename T>
+constexpr Sphere<T> boundingSphere(const AABB<T> &a) {
+    return Sphere<T>(a.getCenter(), length(a.getExtents()));
+}
+
+template <typename T>
+constexpr bool contains(const Sphere<T> &s, const Vec3<T> &p) {
+    const Vec3<T> d = p - s.center;
+    return dot(d, d) <= s.radius * s.radius;
+}
+
+template <typename T>
+constexpr bool intersects(const Sphere<T> &a, const Sphere<T> &b) {
+    const Vec3<T> d = a.center - b.center;
+    const T r = a.radius + b.radius;
+    return dot(d, d) <= r * r;
+}
+
+// Frustum of a camera at "position" looking down -z of "rotation", the way
+// test.frag casts rays: fov is the horizontal field of view, and the
+// vertical one follows from aspect (width / height)
+// Gives the same planes as Frustum(matmul(view, perspective(...)))
+// A far plane of infinity never culls anything
+template <typename T>
+constexpr Frustum<T> frustumFromCamera(const Vec3<T> &position, const Mat4<T> &rotation, T aspect, T fov, T zNear = T(0), T zFar = std::numeric_limits<T>::infinity()) {
+    const T tanX = tan(fov / T(2));
+    const T tanY = tanX / aspect;
+
+    // Camera space planes, sides through the origin
+    const Vec4<T> local[6] = {
+        Vec4<T>(T(1), T(0), -tanX, T(0)),
+        Vec4<T>(T(-1), T(0), -tanX, T(0)),
+        Vec4<T>(T(0), T(-1), -tanY, T(0)),
+        Vec4<T>(T(0), T(1), -tanY, T(0)),
+        Vec4<T>(T(0), T(0), T(-1), -zNear),
+        Vec4<T>(T(0), T(0), T(1), zFar),
+    };
+
+    Frustum<T> out;
+    for (size_t i = 0; i < 6; i++) {
+        Vec3<T> n(local[i][0], local[i][1], local[i][2]);
+        n = n / length(n);
+        Vec3<T> world;
+        for (size_t j = 0; j < 3; j++)
+            world[j] = n[0] * rotation.data[0][j] + n[1] * rotation.data[1][j] + n[2] * rotation.data[2][j];
+        out.planes[i] = Vec4<T>(world[0], world[1], world[2], local[i][3] - dot(world, position));
+    }
+    return out;
+}
+
+template <typename T>
+constexpr T planeDistance(const Vec4<T> &plane, const Vec3<T> &p) {
+    return plane[0] * p[0] + plane[1] * p[1] + plane[2] * p[2] + plane[3];
+}
+
+template <typename T>
+constexpr bool contains(const Frustum<T> &f, const Vec3<T> &p) {
+    for (const auto &plane : f.planes)
+        if (planeDistance(plane, p) < T(0))
+            return false;
+    return true;
+}
+
+// False only when the box is fully outside one plane, so boxes near the
+// frustum's edges can pass while being outside (conservative, like the
+// usual renderer culling test)
+template <typename T>
+constexpr bool intersects(const Frustum<T> &f, const AABB<T> &box) {
+    const Vec3<T> c = box.getCenter();
+    const Vec3<T> e = box.getExtents();
+    for (const auto &plane : f.planes) {
+        const T r = abs(plane[0]) * e[0] + abs(plane[1]) * e[1] + abs(plane[2]) * e[2];
+        if (planeDistance(plane, c) + r < T(0))
+            return false;
+    }
+    return true;
+}
+
+template <typename T>
+constexpr bool intersects(const Frustum<T> &f, const Sphere<T> &s) {
+    for (const auto &plane : f.planes)
+        if (planeDistance(plane, s.center) + s.radius < T(0))
+            return false;
+    return true;
+}
+
+// Batch culling
+
+namespace simd {
+
+// Bits 0 to P::width - 1 set for the boxes (starting at "boxes") that
+// intersect f, agreeing with intersects(f, box) bit for bit: the sums run
+// in the same order, with separate multiplies and adds rather than madd.
+// A compiler free to contract the scalar version into FMAs (GCC with -mfma
+// and -std=gnu++*) can still round it differently, so the two can disagree
+// on boxes within rounding of touching a plane.
+template <typename P>
+inline uint32_t cullAABBs(const Frustum<float> &f, const AABB<float> *boxes) {
+    // Box corners are interleaved in memory, so gather them per component
+    float corners[6][P::width];
+    for (size_t i = 0; i < P::width; i++) {
+        for (size_t c = 0; c < 3; c++) {
+            corners[c][i] = boxes[i].min[c];
+            corners[c + 3][i] = boxes[i].max[c];
+        }
+    }
+
+    const P half = P::splat(.5f);
+    P c[3], e[3];
+    for (size_t i = 0; i < 3; i++) {
+        const P lo = P::load(corners[i]);
+        const P hi = P::load(corners[i + 3]);
+        c[i] = (lo + hi) * half;
+        e[i] = (hi - lo) * half;
+    }
+
+    // Smallest (plane distance + projected radius) over the six planes,
+    // each summed like planeDistance and intersects(f, box) do
+    P nearest = P::splat(std::numeric_limits<float>::infinity());
+    for (const auto &plane : f.planes) {
+        P d = P::splat(plane[0]) * c[0] + P::splat(plane[1]) * c[1] + P::splat(plane[2]) * c[2] + P::splat(plane[3]);
+        P r = P::splat(esdm::abs(plane[0])) * e[0] + P::splat(esdm::abs(plane[1])) * e[1] + P::splat(esdm::abs(plane[2])) * e[2];
+        nearest = min(nearest, d + r);
+    }
+
+    return ~lessBits(nearest, P::splat(0.f)) & ((1u << P::width) - 1u);
+}
+
+}
+
+// Sets bit i % 64 of visible[i / 64] when boxes[i] intersects f (see
+// intersects(f, box)), clearing the others; visible must have room for
+// (count + 63) / 64 words
+// Large inputs are split across threads, each owning whole words
+inline void cullAABBs(const Frustum<float> &f, const AABB<float> *boxes, size_t count, uint64_t *visible) {
+    using P = simd::NativePack<float>;
+    using P1 = simd::Pack<float, 1>;
+    static_assert(64 % P::width == 0, "Pack width must divide 64");
+
+    parallelFor(count, batchGrain, [&](size_t begin, size_t end) {
+        for (size_t w = begin / 64; w < (end + 63) / 64; w++)
+            visible[w] = 0;
+
+        size_t i = begin;
+        for (; i + P::width <= end; i += P::width)
+            visible[i / 64] |= uint64_t(simd::cullAABBs<P>(f, boxes + i)) << (i % 64);
+        for (; i < end; i++)
+            visible[i / 64] |= uint64_t(simd::cullAABBs<P1>(f, boxes + i)) << (i % 64);
+    }, 64);
+}
+
+inline void cullAABBs(const Frustum<float> &f, const std::vector<AABB<float>> &boxes, std::vector<uint64_t> &visible) {
+    visible.resize((boxes.size() + 63) / 64);
+    cullAABBs(f, boxes.data(), boxes.size(), visible.data());
+}
+
+}
\ No newline at end of file
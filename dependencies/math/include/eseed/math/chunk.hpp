@@ -0,0 +1,73 @@
+#pragma once
+
+#include "array.hpp"
+#include "morton.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esdm {
+
+// Cubic voxel chunk of Side^3 cells stored in Morton order
+//
+// Cells are addressed by their Morton code as well as by x, y, z, and
+// neighbor() moves a code one cell along an axis without decoding it, so
+// traversals (a DDA raycast like rayVoxel in test.frag, or the 6 neighbor
+// checks of meshing) can run on codes alone. A step that leaves the chunk
+// gives a code for which contains() is false.
+template <typename T, size_t Side = 32>
+class MortonChunk {
+public:
+    static_assert(Side > 0 && (Side & (Side - 1)) == 0 && Side < (1 << 21), "Chunk side must be a power of two below 2^21");
+
+    static constexpr size_t side = Side;
+    static constexpr size_t volume = Side * Side * Side;
+
+    MortonChunk() : cells(volume) {}
+
+    explicit MortonChunk(const T &value) : cells(volume, value) {}
+
+    static constexpr uint64_t code(uint32_t x, uint32_t y, uint32_t z) {
+        return morton::encode(x, y, z);
+    }
+
+    static constexpr Vec3<uint32_t> position(uint64_t code) {
+        return morton::decode3(code);
+    }
+
+    // Stepping below 0 wraps the axis to all ones and stepping past the end
+    // sets a bit above the chunk, so both leave the [0, volume) range
+    static constexpr bool contains(uint64_t code) {
+        return code < volume;
+    }
+
+    // One cell along axis 0 - 2, forward for dir >= 0 and back otherwise
+    static constexpr uint64_t neighbor(uint64_t code, size_t axis, int dir) {
+        return dir >= 0 ? morton::increment<3>(code, axis) : morton::decrement<3>(code, axis);
+    }
+
+    T &operator[](uint64_t code) { return cells[code]; }
+    const T &operator[](uint64_t code) const { return cells[code]; }
+
+    T &operator()(uint32_t x, uint32_t y, uint32_t z) { return cells[code(x, y, z)]; }
+    const T &operator()(uint32_t x, uint32_t y, uint32_t z) const { return cells[code(x, y, z)]; }
+
+    // Cells in Morton order
+    T *data() { return cells.data(); }
+    const T *data() const { return cells.data(); }
+
+    // For forEach / transform / fill from array.hpp
+    ArrayView<T, 3, LayoutMorton<3>> view() {
+        return ArrayView<T, 3, LayoutMorton<3>>(cells.data(), LayoutMorton<3>(Index<3>(Side)), Index<3>(Side));
+    }
+
+    ArrayView<const T, 3, LayoutMorton<3>> view() const {
+        return ArrayView<const T, 3, LayoutMorton<3>>(cells.data(), LayoutMorton<3>(Index<3>(Side)), Index<3>(Side));
+    }
+
+private:
+    std::vector<T> cells;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// True while the compiler is evaluating a constant expression, which lets a
+// constexpr function take a compile-time path instead of intrinsics or libm
+// Without compiler support it is always false, and those functions can
+// then only be evaluated at runtime
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define ESDM_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+
+#if !defined(ESDM_IS_CONSTANT_EVALUATED)
+#if (defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define ESDM_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define ESDM_IS_CONSTANT_EVALUATED() false
+#endif
+#endif
+
+// Compile-time implementations of the ops.hpp functions
+// esdm::sin, esdm::sqrt, etc. use these automatically during constant
+// evaluation, and the std versions at runtime. They can also be called
+// directly. Everything is computed in long double and rounded once, so
+// results are within 1 ulp of the std functions for float and double
+// (sin / cos / tan lose precision for angles beyond +-2^31 radians).
+
+namespace esdm {
+
+namespace cx {
+
+using Wide = long double;
+
+constexpr Wide widePi = 3.141592653589793238462643383279502884L;
+
+template <typename T>
+constexpr bool isNan(T n) {
+    return n != n;
+}
+
+template <typename T>
+constexpr T abs(T n) {
+    return n < 0 ? -n : n;
+}
+
+template <typename T>
+constexpr T trunc(T n) {
+    if constexpr (std::is_integral_v<T>) {
+        return n;
+    } else {
+        // At and beyond 1 / epsilon every value is integral
+        if (isNan(n) || n == 0 || abs(n) >= T(1) / std::numeric_limits<T>::epsilon())
+            return n;
+        // Keeps the sign of zero, as std::trunc(-0.5) is -0
+        T t = T(int64_t(n));
+        return t == 0 && n < 0 ? -t : t;
+    }
+}
+
+template <typename T>
+constexpr T floor(T n) {
+    T t = trunc(n);
+    return t > n ? t - T(1) : t;
+}
+
+template <typename T>
+constexpr T ceil(T n) {
+    T t = trunc(n);
+    return t < n ? t + T(1) : t;
+}
+
+// Halfway cases round away from zero, like std::round
+template <typename T>
+constexpr T round(T n) {
+    T t = trunc(n);
+    T diff = n - t;
+    if (diff >= T(0.5))
+        return t + T(1);
+    if (diff <= T(-0.5))
+        return t - T(1);
+    return t;
+}
+
+// Newton-Raphson after scaling the input into [0.25, 4]
+template <typename T>
+constexpr T sqrt(T n) {
+    if (isNan(n) || n < 0)
+        return std::numeric_limits<T>::quiet_NaN();
+    if (n == 0 || n == std::numeric_limits<T>::infinity())
+        return n;
+
+    Wide x = n;
+    Wide scale = 1;
+    while (x > 4) {
+        x /= 4;
+        scale *= 2;
+    }
+    while (x < Wide(0.25)) {
+        x *= 4;
+        scale /= 2;
+    }
+
+    Wide g = 1;
+    for (int i = 0; i < 8; i++)
+        g = (g + x / g) / 2;
+    return T(g * scale);
+}
+
+// pi / 2 split in three: the first two parts have 32 significant bits
+// each, so their multiples by any quadrant count below 2^31 are exact, and
+// the last carries the bits beyond what one long double holds
+constexpr Wide halfPiHi = 1.570796326734125614166259765625L;
+constexpr Wide halfPiMid = 6.077100506303965976595549136618501506745815277099609375e-11L;
+constexpr Wide halfPiLo = 2.022266248795950732399684620094757716476e-21L;
+
+// x = quadrant * pi / 2 + r, with r in [-pi / 4, pi / 4] and the quadrant
+// taken mod 4
+struct ReducedAngle {
+    Wide r;
+    int quadrant;
+};
+
+constexpr ReducedAngle reduceAngle(Wide x) {
+    Wide q = round(x / (halfPiHi + halfPiMid));
+    Wide r = ((x - q * halfPiHi) - q * halfPiMid) - q * halfPiLo;
+    return { r, int(q - 4 * floor(q / 4)) };
+}
+
+// Taylor series, accurate to long double precision for |x| <= pi / 4
+constexpr Wide sinSeries(Wide x) {
+    Wide x2 = x * x;
+    Wide term = x;
+    Wide sum = x;
+    for (int i = 1; i < 14; i++) {
+        term *= -x2 / Wide((2 * i) * (2 * i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr Wide cosSeries(Wide x) {
+    Wide x2 = x * x;
+    Wide term = 1;
+    Wide sum = 1;
+    for (int i = 1; i < 14; i++) {
+        term *= -x2 / Wide((2 * i - 1) * (2 * i));
+        sum += term;
+    }
+    return sum;
+}
+
+template <typename T>
+constexpr T sin(T n) {
+    ReducedAngle a = reduceAngle(n);
+    switch (a.quadrant) {
+    case 0: return T(sinSeries(a.r));
+    case 1: return T(cosSeries(a.r));
+    case 2: return T(-sinSeries(a.r));
+    default: return T(-cosSeries(a.r));
+    }
+}
+
+template <typename T>
+constexpr T cos(T n) {
+    ReducedAngle a = reduceAngle(n);
+    switch (a.quadrant) {
+    case 0: return T(cosSeries(a.r));
+    case 1: return T(-sinSeries(a.r));
+    case 2: return T(-cosSeries(a.r));
+    default: return T(sinSeries(a.r));
+    }
+}
+
+template <typename T>
+constexpr T tan(T n) {
+    ReducedAngle a = reduceAngle(n);
+    Wide s = sinSeries(a.r);
+    Wide c = cosSeries(a.r);
+    return T(a.quadrant % 2 == 0 ? s / c : -c / s);
+}
+
+template <typename T>
+constexpr T atan(T n) {
+    if (isNan(n))
+        return n;
+    if (n < 0)
+        return -atan(-n);
+    if (n == std::numeric_limits<T>::infinity())
+        return T(widePi / 2);
+
+    Wide x = n;
+    // atan(x) = pi / 2 - atan(1 / x)
+    bool inverted = x > 1;
+    if (inverted)
+        x = 1 / x;
+
+    // atan(x) = 2 atan(x / (1 + sqrt(1 + x^2))), twice brings x below 0.2
+    x = x / (1 + sqrt(1 + x * x));
+    x = x / (1 + sqrt(1 + x * x));
+
+    Wide x2 = x * x;
+    Wide power = x;
+    Wide sum = x;
+    for (int i = 1; i < 30; i++) {
+        power *= -x2;
+        sum += power / Wide(2 * i + 1);
+    }
+    sum *= 4;
+
+    return T(inverted ? widePi / 2 - sum : sum);
+}
+
+template <typename T>
+constexpr T asin(T n) {
+    if (isNan(n) || abs(n) > 1)
+        return std::numeric_limits<T>::quiet_NaN();
+    if (abs(n) == 1)
+        return T(n * (widePi / 2));
+    // (1 - x) (1 + x) rather than 1 - x^2, which cancels near |x| = 1
+    Wide x = n;
+    return T(atan(x / sqrt((1 - x) * (1 + x))));
+}
+
+template <typename T>
+constexpr T acos(T n) {
+    if (isNan(n) || abs(n) > 1)
+        return std::numeric_limits<T>::quiet_NaN();
+    if (n == -1)
+        return T(widePi);
+    // acos(x) = 2 atan(sqrt((1 - x) / (1 + x))), stable near x = 1
+    Wide x = n;
+    return T(2 * atan(sqrt((1 - x) / (1 + x))));
+}
+
+}
+
+}
\ No newline at end of file
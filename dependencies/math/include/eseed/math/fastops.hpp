@@ -0,0 +1,312 @@
+#pragma once
+
+#include "ops.hpp"
+#include "pack.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Fast float approximations for bulk math, written once over simd::Pack so
+// the scalar functions, the SSE / AVX packs and the array functions all
+// produce the same results for the same input within a build
+//
+// Errors below were measured against double precision libm over dense
+// sweeps of the stated domain, with and without FMA. "ulp" is relative to
+// the exact result, "abs" is absolute. NaN and infinite inputs are not
+// handled unless stated.
+
+namespace esdm {
+
+namespace fast {
+
+namespace detail {
+
+// Cody-Waite split of pi, the first two parts have few enough bits that
+// k * part is exact for the k reached below |x| = 8192
+constexpr float pi1 = 3.140625f;
+constexpr float pi2 = 9.67502593994140625e-4f;
+constexpr float pi3 = 1.509957990978376432e-7f;
+
+// x - k * pi
+template <typename P>
+inline P reducePi(P x, P k) {
+    x = madd(k, P::splat(-pi1), x);
+    x = madd(k, P::splat(-pi2), x);
+    return madd(k, P::splat(-pi3), x);
+}
+
+// (-1)^k as +-1 for an integral k
+template <typename P>
+inline P signOfParity(P k) {
+    P parity = k - simd::floor(k * P::splat(.5f)) * P::splat(2.f);
+    return madd(parity, P::splat(-2.f), P::splat(1.f));
+}
+
+// sin(r) for |r| <= pi / 2, minimax odd polynomial of degree 11
+template <typename P>
+inline P sinPoly(P r) {
+    P r2 = r * r;
+    P p = P::splat(2.60584363e-06f);
+    p = madd(p, r2, P::splat(-1.980963e-04f));
+    p = madd(p, r2, P::splat(8.3330666e-03f));
+    p = madd(p, r2, P::splat(-1.66666596e-01f));
+    return madd(p * r2, r, r);
+}
+
+// sin(r) and cos(r) for |r| <= pi / 4, minimax polynomials of degree 7
+// and 8, short enough to evaluate both for about the cost of sinPoly
+template <typename P>
+inline P sinPolyQuarter(P r) {
+    P r2 = r * r;
+    P p = P::splat(-1.9515295891e-4f);
+    p = madd(p, r2, P::splat(8.3321608736e-3f));
+    p = madd(p, r2, P::splat(-1.6666654611e-1f));
+    return madd(p * r2, r, r);
+}
+
+template <typename P>
+inline P cosPolyQuarter(P r) {
+    P r2 = r * r;
+    P p = P::splat(2.443315711809948e-5f);
+    p = madd(p, r2, P::splat(-1.388731625493765e-3f));
+    p = madd(p, r2, P::splat(4.166664568298827e-2f));
+    p = madd(p, r2, P::splat(-.5f));
+    return madd(p, r2, P::splat(1.f));
+}
+
+// atan(t) for t in [0, 1], minimax odd polynomial of degree 15
+template <typename P>
+inline P atanPoly(P t) {
+    P t2 = t * t;
+    P p = P::splat(-4.05903698e-03f);
+    p = madd(p, t2, P::splat(2.18785877e-02f));
+    p = madd(p, t2, P::splat(-5.59340731e-02f));
+    p = madd(p, t2, P::splat(9.64372876e-02f));
+    p = madd(p, t2, P::splat(-1.3909203e-01f));
+    p = madd(p, t2, P::splat(1.99466749e-01f));
+    p = madd(p, t2, P::splat(-3.33298699e-01f));
+    p = madd(p, t2, P::splat(9.99999338e-01f));
+    return p * t;
+}
+
+}
+
+// Pack versions
+// These take any simd::Pack<float, W>, the scalar and array versions below
+// are thin wrappers around them
+
+// Max error 1.3e-7 abs for |x| <= 8192, growing with |x| past that
+template <typename T, size_t W>
+inline simd::Pack<T, W> sin(simd::Pack<T, W> x) {
+    using P = simd::Pack<T, W>;
+    P k = simd::round(x * P::splat(1.f / pi<float>()));
+    return detail::sinPoly(detail::reducePi(x, k)) * detail::signOfParity(k);
+}
+
+// Max error 1.3e-7 abs for |x| <= 8192, growing with |x| past that
+template <typename T, size_t W>
+inline simd::Pack<T, W> cos(simd::Pack<T, W> x) {
+    using P = simd::Pack<T, W>;
+    // x = r + (k - 1/2) pi with |r| <= pi / 2, and cos(x) = (-1)^k sin(r)
+    P k = simd::round(madd(x, P::splat(1.f / pi<float>()), P::splat(.5f)));
+    P r = detail::reducePi(x, k - P::splat(.5f));
+    return detail::sinPoly(r) * detail::signOfParity(k);
+}
+
+// Max error 1e-7 abs for |x| <= 8192, growing with |x| past that
+// One reduction to a quadrant shared by both, so results can differ from
+// sin and cos in the last bit
+template <typename T, size_t W>
+inline void sincos(simd::Pack<T, W> x, simd::Pack<T, W> &s, simd::Pack<T, W> &c) {
+    using P = simd::Pack<T, W>;
+    // x = r + q pi / 2 with |r| <= pi / 4; halving the pi split keeps
+    // q * part exact for the q reached below |x| = 8192
+    P q = simd::round(x * P::splat(2.f / pi<float>()));
+    P r = madd(q, P::splat(-.5f * detail::pi1), x);
+    r = madd(q, P::splat(-.5f * detail::pi2), r);
+    r = madd(q, P::splat(-.5f * detail::pi3), r);
+    P sr = detail::sinPolyQuarter(r);
+    P cr = detail::cosPolyQuarter(r);
+
+    // Quadrant q mod 4 = 2 * high + odd: odd quadrants swap sin and cos,
+    // sin is negative in quadrants 2 and 3, cos in 1 and 2
+    P half = simd::floor(q * P::splat(.5f));
+    P odd = q - half * P::splat(2.f);
+    P high = half - simd::floor(half * P::splat(.5f)) * P::splat(2.f);
+    P cosNegative = (odd - high) * (odd - high);
+    s = simd::selectLess(odd, P::splat(.5f), sr, cr) * madd(high, P::splat(-2.f), P::splat(1.f));
+    c = simd::selectLess(odd, P::splat(.5f), cr, sr) * madd(cosNegative, P::splat(-2.f), P::splat(1.f));
+}
+
+// Max error 3e-7 relative (5 ulp) for positive normal x
+// One Newton step on the hardware estimate
+template <typename T, size_t W>
+inline simd::Pack<T, W> rsqrt(simd::Pack<T, W> x) {
+    using P = simd::Pack<T, W>;
+    P y = simd::rsqrtEstimate(x);
+    P hxy = x * P::splat(.5f) * y;
+    return y * (P::splat(1.5f) - hxy * y);
+}
+
+// Max error 2e-7 relative (3.5 ulp) for normal x with |x| < 2^126
+// One Newton step on the hardware estimate
+template <typename T, size_t W>
+inline simd::Pack<T, W> rcp(simd::Pack<T, W> x) {
+    using P = simd::Pack<T, W>;
+    P y = simd::rcpEstimate(x);
+    return y * (P::splat(2.f) - x * y);
+}
+
+// Max error 1.2 ulp; x is clamped to [-126, 127], so the result is never
+// denormal or infinite
+template <typename T, size_t W>
+inline simd::Pack<T, W> exp2(simd::Pack<T, W> x) {
+    using P = simd::Pack<T, W>;
+    x = simd::min(simd::max(x, P::splat(-126.f)), P::splat(127.f));
+    P n = simd::round(x);
+    P f = x - n;
+    // 2^f - 1 for f in [-1/2, 1/2], minimax polynomial of degree 6
+    P p = P::splat(1.53534038e-04f);
+    p = madd(p, f, P::splat(1.33988215e-03f));
+    p = madd(p, f, P::splat(9.61843684e-03f));
+    p = madd(p, f, P::splat(5.5503326e-02f));
+    p = madd(p, f, P::splat(2.40226479e-01f));
+    p = madd(p, f, P::splat(6.93147203e-01f));
+    return madd(p, f, P::splat(1.f)) * simd::pow2(n);
+}
+
+// Max error 3 ulp for positive normal x
+template <typename T, size_t W>
+inline simd::Pack<T, W> log2(simd::Pack<T, W> x) {
+    using P = simd::Pack<T, W>;
+    P e = simd::exponent(x);
+    P m = simd::mantissa(x);
+    // Move m into [sqrt(1/2), sqrt(2)) so the series below stays short
+    P big = simd::selectLess(m, P::splat(1.41421356f), P::splat(0.f), P::splat(1.f));
+    m = m * madd(big, P::splat(-.5f), P::splat(1.f));
+    e = e + big;
+    // log2(m) = 2 / ln(2) * atanh(t), t = (m - 1) / (m + 1)
+    P t = (m - P::splat(1.f)) / (m + P::splat(1.f));
+    P t2 = t * t;
+    P p = P::splat(4.34239807e-01f);
+    p = madd(p, t2, P::splat(5.76585263e-01f));
+    p = madd(p, t2, P::splat(9.6180075e-01f));
+    p = madd(p, t2, P::splat(2.88539007f));
+    return madd(p, t, e);
+}
+
+// Max error 3.3e-7 abs for finite x, y
+// atan2(0, 0) is 0, and -0 is treated as +0 for x
+template <typename T, size_t W>
+inline simd::Pack<T, W> atan2(simd::Pack<T, W> y, simd::Pack<T, W> x) {
+    using P = simd::Pack<T, W>;
+    P ax = simd::abs(x);
+    P ay = simd::abs(y);
+    P lo = simd::min(ax, ay);
+    P hi = simd::max(simd::max(ax, ay), P::splat(1.17549435e-38f));
+    P r = detail::atanPoly(lo / hi);
+    r = simd::selectLess(ax, ay, P::splat(pi<float>() / 2.f) - r, r);
+    r = simd::selectLess(x, P::splat(0.f), P::splat(pi<float>()) - r, r);
+    return simd::copysign(r, y);
+}
+
+// Scalar versions
+
+inline float sin(float x) {
+    return sin(simd::Pack<float, 1>{x}).v;
+}
+
+inline float cos(float x) {
+    return cos(simd::Pack<float, 1>{x}).v;
+}
+
+inline void sincos(float x, float &s, float &c) {
+    simd::Pack<float, 1> sp, cp;
+    sincos(simd::Pack<float, 1>{x}, sp, cp);
+    s = sp.v;
+    c = cp.v;
+}
+
+inline float rsqrt(float x) {
+    return rsqrt(simd::Pack<float, 1>{x}).v;
+}
+
+inline float rcp(float x) {
+    return rcp(simd::Pack<float, 1>{x}).v;
+}
+
+inline float exp2(float x) {
+    return exp2(simd::Pack<float, 1>{x}).v;
+}
+
+inline float log2(float x) {
+    return log2(simd::Pack<float, 1>{x}).v;
+}
+
+inline float atan2(float y, float x) {
+    return atan2(simd::Pack<float, 1>{y}, simd::Pack<float, 1>{x}).v;
+}
+
+// Array versions
+// out[i] = f(in[i]) for i in [0, count), threaded like the VecBatch kernels
+// Outputs may alias inputs
+
+#define ESDM_FAST_ARRAY_FUNC(func) \
+inline void func(const float *in, float *out, size_t count) { \
+    batchFor<float>(count, [&](auto pack, size_t i) { \
+        using P = decltype(pack); \
+        func(P::load(in + i)).store(out + i); \
+    }); \
+}
+
+ESDM_FAST_ARRAY_FUNC(sin)
+ESDM_FAST_ARRAY_FUNC(cos)
+ESDM_FAST_ARRAY_FUNC(rsqrt)
+ESDM_FAST_ARRAY_FUNC(rcp)
+ESDM_FAST_ARRAY_FUNC(exp2)
+ESDM_FAST_ARRAY_FUNC(log2)
+
+#undef ESDM_FAST_ARRAY_FUNC
+
+inline void sincos(const float *in, float *sinOut, float *cosOut, size_t count) {
+    batchFor<float>(count, [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        P s, c;
+        sincos(P::load(in + i), s, c);
+        s.store(sinOut + i);
+        c.store(cosOut + i);
+    });
+}
+
+inline void atan2(const float *y, const float *x, float *out, size_t count) {
+    batchFor<float>(count, [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        atan2(P::load(y + i), P::load(x + i)).store(out + i);
+    });
+}
+
+}
+
+// Exact, branchless array versions of ifloor / iround for |in[i]| < 2^31
+// iround rounds halfway cases away from zero, like the scalar iround
+
+inline void ifloor(const float *in, int32_t *out, size_t count) {
+    batchFor<float>(count, [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        simd::storeTrunc(simd::floor(P::load(in + i)), out + i);
+    });
+}
+
+inline void iround(const float *in, int32_t *out, size_t count) {
+    batchFor<float>(count, [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        P x = P::load(in + i);
+        P ax = simd::abs(x);
+        P n = simd::floor(ax);
+        // ax - n is exact, unlike adding 0.5 before truncating
+        n = n + simd::selectLess(ax - n, P::splat(.5f), P::splat(0.f), P::splat(1.f));
+        simd::storeTrunc(simd::copysign(n, x), out + i);
+    });
+}
+
+}
\ No newline at end of file
@@ -81,6 +81,15 @@ using Mat3 = Mat3x3<T>;
 template <typename T>
 using Mat4 = Mat4x4<T>;
 
+template <size_t M, size_t N, typename T>
+constexpr Mat<N, M, T> transpose(const Mat<M, N, T> &m);
+
+template <size_t N, typename T>
+constexpr Mat<N, N, T> inverse(const Mat<N, N, T> &m);
+
+template <size_t N, typename T>
+constexpr T determinant(const Mat<N, N, T> &m);
+
 template <size_t M, size_t N, typename T>
 class Mat : public MatData<M, N, T> {
 public:
@@ -90,67 +99,79 @@ public:
     // Mat<2, 2, T>() =>
     // [ 0, 0 ]
     // [ 0, 0 ]
-    Mat() {}
+    constexpr Mat() : MatData<M, N, T>{} {}
 
     // Mat<2, 2, T>(arr) =>
     // [ arr[0], arr[2] ]
     // [ arr[1], arr[3] ]
-    Mat(const T* arr) {
-
-        std::copy(arr, arr + M * N, &data[0][0]);
+    constexpr Mat(const T* arr) : MatData<M, N, T>{} {
+        for (size_t i = 0; i < M; i++)
+            for (size_t j = 0; j < N; j++)
+                this->data[i][j] = arr[i * N + j];
     }
 
     // Mat<2, 2, T>(a, b, c, d) =>
     // [ a, c ]
     // [ b, d ]
     template <typename... Ts, typename std::enable_if_t<std::conjunction_v<std::is_same<Ts, T>...> && (sizeof...(Ts) == M * N)> * = nullptr>
-    Mat(const Ts &... components) {
+    constexpr Mat(const Ts &... components) : MatData<M, N, T>{} {
         std::array<T, M * N> arr{((T)components)...};
-        std::copy(arr.begin(), arr.end(), &data[0][0]);
+        for (size_t i = 0; i < M; i++)
+            for (size_t j = 0; j < N; j++)
+                this->data[i][j] = arr[i * N + j];
     }
 
     // Mat<2, 2, T>(v) =>
     // [ v, 0 ]
     // [ 0, v ]
-    explicit Mat(T component) {
-        for (size_t i = 0; i < (M > N ? M : N); i++)
-            data[i][i] = component;
+    // Non-square matrices get v down the leading diagonal
+    constexpr explicit Mat(T component) : MatData<M, N, T>{} {
+        for (size_t i = 0; i < (M < N ? M : N); i++)
+            this->data[i][i] = component;
     }
 
-    Col getCol(size_t j) const {
+    constexpr Col getCol(size_t j) const {
         Col col;
         for (size_t i = 0; i < M; i++)
-            col[i] = data[i][j];
+            col[i] = this->data[i][j];
         return col;
     }
 
-    Row getRow(size_t i) const {
+    constexpr Row getRow(size_t i) const {
         Row row;
         for (size_t j = 0; j < N; j++)
-            row[j] = data[i][j];
+            row[j] = this->data[i][j];
         return row;
     }
 
-    const Col &operator[](size_t i) const {
+    constexpr const Row &operator[](size_t i) const {
         if (i >= M)
             throw std::out_of_range("Index is larger than Vec column");
-        return data[i];
+        return this->data[i];
     }
 
-    Col &operator[](size_t i) {
+    constexpr Row &operator[](size_t i) {
         if (i >= M)
             throw std::out_of_range("Index is larger than Vec column");
-        return data[i];
+        return this->data[i];
     }
 
-    Mat inverse() const {
-        Mat<M, N, T> out;
-        for (size_t i = 0; i < M; i++) {
-            for (size_t j = 0; j < N; j++) {
-                out[i][j] = *this[j][i];
-            }
-        }
-        return out;
+    constexpr Mat<N, M, T> transpose() const {
+        using esdm::transpose;
+        return transpose(*this);
+    }
+
+    // Only defined for square matrices, see esdm::inverse
+    // (the using-declaration lets ADL pick up the SIMD overloads)
+    constexpr Mat inverse() const {
+        using esdm::inverse;
+        return inverse(*this);
+    }
+
+    // Only defined for square matrices, see esdm::determinant
+    constexpr T determinant() const {
+        using esdm::determinant;
+        return determinant(*this);
     }
 
     friend std::ostream &operator<<(std::ostream &out, const Mat &m)     {
@@ -166,27 +187,119 @@ public:
 // Functions
 
 template <size_t M, size_t N, size_t MN, typename T0, typename T1>
-Mat<M, N, decltype(T0(0) * T1(0))> matmul(const Mat<M, MN, T0> &a, const Mat<MN, N, T1> &b) {
+constexpr Mat<M, N, decltype(T0(0) * T1(0))> matmul(const Mat<M, MN, T0> &a, const Mat<MN, N, T1> &b) {
     Mat<M, N, decltype(T0(0) * T1(0))> out;
-    for (size_t i = 0; i < N; i++)
-        for (size_t j = 0; j < M; j++)
-            out[i][j] = dot(a.getRow(i), b.getCol(j));
+    for (size_t i = 0; i < M; i++)
+        for (size_t k = 0; k < MN; k++)
+            for (size_t j = 0; j < N; j++)
+                out.data[i][j] += a.data[i][k] * b.data[k][j];
     return out;
 }
 
 template <size_t M, size_t N, typename T0, typename T1>
-Vec<M, decltype(T0(0), T1(0))> matmul(const Mat<M, N, T0> &a, const Vec<N, T1> &b) {
+constexpr Vec<M, decltype(T0(0) * T1(0))> matmul(const Mat<M, N, T0> &a, const Vec<N, T1> &b) {
     Vec<M, decltype(T0(0) * T1(0))> out;
     for (size_t i = 0; i < M; i++)
-        out[i] = dot(a.getRow(i), b);
+        out[i] = dot(a.data[i], b);
     return out;
 }
 
 template <size_t M, size_t N, typename T0, typename T1>
-Vec<N, decltype(T0(0), T1(0))> matmul(const Vec<M, T0> &a, const Mat<M, N, T1> &b) {
+constexpr Vec<N, decltype(T0(0) * T1(0))> matmul(const Vec<M, T0> &a, const Mat<M, N, T1> &b) {
     Vec<N, decltype(T0(0) * T1(0))> out;
-    for (size_t j = 0; j < N; j++)
-        out[j] = dot(a, b.getCol(j));
+    for (size_t i = 0; i < M; i++)
+        for (size_t j = 0; j < N; j++)
+            out[j] += a[i] * b.data[i][j];
+    return out;
+}
+
+template <size_t M, size_t N, typename T>
+constexpr Mat<N, M, T> transpose(const Mat<M, N, T> &m) {
+    Mat<N, M, T> out;
+    for (size_t i = 0; i < M; i++)
+        for (size_t j = 0; j < N; j++)
+            out.data[j][i] = m.data[i][j];
+    return out;
+}
+
+// std::swap is only constexpr from C++20
+template <size_t M, size_t N, typename T>
+constexpr void swapRows(Mat<M, N, T> &m, size_t i0, size_t i1) {
+    Vec<N, T> row = m.data[i0];
+    m.data[i0] = m.data[i1];
+    m.data[i1] = row;
+}
+
+// Gaussian elimination with partial pivoting
+template <size_t N, typename T>
+constexpr T determinant(const Mat<N, N, T> &m) {
+    Mat<N, N, T> a = m;
+    T det = T(1);
+    for (size_t c = 0; c < N; c++) {
+        size_t pivot = c;
+        for (size_t i = c + 1; i < N; i++)
+            if (abs(a.data[i][c]) > abs(a.data[pivot][c]))
+                pivot = i;
+        if (a.data[pivot][c] == T(0))
+            return T(0);
+        if (pivot != c) {
+            swapRows(a, pivot, c);
+            det = -det;
+        }
+        det *= a.data[c][c];
+        for (size_t i = c + 1; i < N; i++) {
+            T f = a.data[i][c] / a.data[c][c];
+            for (size_t j = c; j < N; j++)
+                a.data[i][j] -= f * a.data[c][j];
+        }
+    }
+    return det;
+}
+
+// Gauss-Jordan elimination with partial pivoting
+// A singular matrix produces non-finite components, same as the SIMD path
+template <size_t N, typename T>
+constexpr Mat<N, N, T> inverse(const Mat<N, N, T> &m) {
+    Mat<N, N, T> a = m;
+    Mat<N, N, T> out(T(1));
+    for (size_t c = 0; c < N; c++) {
+        size_t pivot = c;
+        for (size_t i = c + 1; i < N; i++)
+            if (abs(a.data[i][c]) > abs(a.data[pivot][c]))
+                pivot = i;
+        swapRows(a, pivot, c);
+        swapRows(out, pivot, c);
+
+        T rcp = T(1) / a.data[c][c];
+        for (size_t j = 0; j < N; j++) {
+            a.data[c][j] *= rcp;
+            out.data[c][j] *= rcp;
+        }
+        for (size_t i = 0; i < N; i++) {
+            if (i == c)
+                continue;
+            T f = a.data[i][c];
+            for (size_t j = 0; j < N; j++) {
+                a.data[i][j] -= f * a.data[c][j];
+                out.data[i][j] -= f * out.data[c][j];
+            }
+        }
+    }
+    return out;
+}
+
+// Inverse of a rotation + translation matrix (as built by matRotate and
+// matTranslate), using R^-1 = R^T instead of a general inverse
+// Any scale or shear in the upper 3x3 gives a wrong result
+template <typename T>
+constexpr Mat4<T> inverseRigid(const Mat4<T> &m) {
+    Mat4<T> out;
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+            out.data[i][j] = m.data[j][i];
+    for (size_t j = 0; j < 3; j++)
+        out.data[3][j] = -(m.data[3][0] * out.data[0][j] + m.data[3][1] * out.data[1][j] + m.data[3][2] * out.data[2][j]);
+    out.data[3][3] = T(1);
     return out;
 }
 
@@ -194,7 +307,7 @@ Vec<N, decltype(T0(0), T1(0))> matmul(const Vec<M, T0> &a, const Mat<M, N, T1> &
 
 #define ESEED_MAT_PRE(op)                        \
     template <size_t M, size_t N, typename T>    \
-    Mat<M, N, T> &operator op(Mat<M, N, T> &m) { \
+    constexpr Mat<M, N, T> &operator op(Mat<M, N, T> &m) { \
         for (size_t i = 0; i < M; i++)           \
             op m[i];                             \
         return m;                                \
@@ -202,7 +315,7 @@ Vec<N, decltype(T0(0), T1(0))> matmul(const Vec<M, T0> &a, const Mat<M, N, T1> &
 
 #define ESEED_MAT_POST(op)                           \
     template <size_t M, size_t N, typename T>        \
-    Mat<M, N, T> operator op(Mat<M, N, T> &m, int) { \
+    constexpr Mat<M, N, T> operator op(Mat<M, N, T> &m, int) { \
         Mat<M, N, T> out = m;                        \
         for (size_t i = 0; i < M; i++)               \
             m[i] op;                                 \
@@ -211,16 +324,16 @@ Vec<N, decltype(T0(0), T1(0))> matmul(const Vec<M, T0> &a, const Mat<M, N, T1> &
 
 #define ESEED_MAT_UN(op)                              \
     template <size_t M, size_t N, typename T>         \
-    Mat<M, N, T> operator op(const Mat<M, N, T> &m) { \
+    constexpr Mat<M, N, T> operator op(const Mat<M, N, T> &m) { \
         Mat<M, N, T> out;                             \
         for (size_t i = 0; i < M; i++)                \
-            op m[i];                                  \
+            out[i] = op m[i];                         \
         return out;                                   \
     }
 
 #define ESEED_MAT_BIN_MM(op)                                                                          \
     template <size_t M, size_t N, typename T0, typename T1>                                           \
-    Mat<M, N, decltype(T0(0) op T1(0))> operator op(const Mat<M, N, T0> &a, const Mat<M, N, T1> &b) { \
+    constexpr Mat<M, N, decltype(T0(0) op T1(0))> operator op(const Mat<M, N, T0> &a, const Mat<M, N, T1> &b) { \
         Mat<M, N, decltype(T0(0) op T1(0))> out;                                                      \
         for (size_t i = 0; i < M; i++)                                                                \
             out[i] = a[i] op b[i];                                                                    \
@@ -229,7 +342,7 @@ Vec<N, decltype(T0(0), T1(0))> matmul(const Vec<M, T0> &a, const Mat<M, N, T1> &
 
 #define ESEED_MAT_BIN_MS(op)                                                        \
     template <size_t M, size_t N, typename T0, typename T1>                         \
-    Mat<M, N, decltype(T0(0) op T1(0))> operator op(const Mat<M, N, T0> &a, T1 b) { \
+    constexpr Mat<M, N, decltype(T0(0) op T1(0))> operator op(const Mat<M, N, T0> &a, T1 b) { \
         Mat<M, N, decltype(T0(0) op T1(0))> out;                                    \
         for (size_t i = 0; i < M; i++)                                              \
             out[i] = a[i] op b;                                                     \
@@ -238,7 +351,7 @@ Vec<N, decltype(T0(0), T1(0))> matmul(const Vec<M, T0> &a, const Mat<M, N, T1> &
 
 #define ESEED_MAT_BIN_SM(op)                                                               \
     template <size_t M, size_t N, typename T0, typename T1>                                \
-    Mat<M, N, decltype(T0(0) op T1(0))> operator op(const T0 &a, const Mat<M, N, T1> &b) { \
+    constexpr Mat<M, N, decltype(T0(0) op T1(0))> operator op(const T0 &a, const Mat<M, N, T1> &b) { \
         Mat<M, N, decltype(T0(0) op T1(0))> out;                                           \
         for (size_t i = 0; i < M; i++)                                                     \
             out[i] = a op b[i];                                                            \
@@ -247,15 +360,15 @@ Vec<N, decltype(T0(0), T1(0))> matmul(const Vec<M, T0> &a, const Mat<M, N, T1> &
 
 #define ESEED_MAT_ASSN_MM(op)                                                                    \
     template <size_t M, size_t N, typename T0, typename T1>                                      \
-    Mat<M, N, decltype(T0(0) op T1(0))> &operator op(Mat<M, N, T0> &a, const Mat<M, N, T1> &b) { \
+    constexpr Mat<M, N, T0> &operator op(Mat<M, N, T0> &a, const Mat<M, N, T1> &b) {            \
         for (size_t i = 0; i < M; i++)                                                           \
             a[i] op b[i];                                                                        \
         return a;                                                                                \
     }
 
 #define ESEED_MAT_ASSN_MS(op)                                                  \
-    template <size_t M, size_t N, typename T0, typename T1>                    \
-    Mat<M, N, decltype(T0(0) op T1(0))> &operator op(Mat<M, N, T0> &a, T1 b) { \
+    template <size_t M, size_t N, typename T0, typename T1, typename = decltype(std::declval<T0 &>() op T1(0))> \
+    constexpr Mat<M, N, T0> &operator op(Mat<M, N, T0> &a, T1 b) {            \
         for (size_t i = 0; i < M; i++)                                         \
             a[i] op b;                                                         \
         return a;                                                              \
@@ -333,4 +446,6 @@ ESEED_MAT_ASSN_MS(^=)
 ESEED_MAT_ASSN_MS(<<=)
 ESEED_MAT_ASSN_MS(>>=)
 
-}
\ No newline at end of file
+}
+
+#include "matsimd.hpp"
\ No newline at end of file
@@ -1,17 +1,20 @@
 #pragma once
 
 #include <eseed/math/ops.hpp>
+#include <eseed/math/mat.hpp>
+
+#include <type_traits>
 
 namespace esdm {
 
 template <typename T>
-Mat4<T> matTranslate(const Vec3<T> &translation) {
+constexpr Mat4<T> matTranslate(const Vec3<T> &translation) {
 
     constexpr T n0 = T(0);
     constexpr T n1 = T(1);
-    const T nx = translation.x;
-    const T ny = translation.y;
-    const T nz = translation.z;
+    const T nx = translation[0];
+    const T ny = translation[1];
+    const T nz = translation[2];
     
     return Mat4<T> {
         n1, n0, n0, n0,
@@ -22,14 +25,14 @@ Mat4<T> matTranslate(const Vec3<T> &translation) {
 }
 
 template <typename T>
-Mat4<T> matRotate(const Vec3<T>& axis, T angle) {
+constexpr Mat4<T> matRotate(const Vec3<T>& axis, T angle) {
 
     const T c = cos(angle);
     const T s = sin(angle);
     const T t = 1 - c;
-    const T x = axis.x;
-    const T y = axis.y;
-    const T z = axis.z;
+    const T x = axis[0];
+    const T y = axis[1];
+    const T z = axis[2];
 
     constexpr T n0 = 0;
     constexpr T n1 = 1;
@@ -52,32 +55,195 @@ Mat4<T> matRotate(const Vec3<T>& axis, T angle) {
 }
 
 template <typename T>
-Mat4<T> rotateX(const T &xAngle) {
+constexpr Mat4<T> rotateX(const T &xAngle) {
+    constexpr T n0 = T(0);
+    constexpr T n1 = T(1);
+    const T c = cos(xAngle);
+    const T s = sin(xAngle);
+
     return Mat4<T> {
-        1, 0, 0, 0,
-        0, cos(xAngle), -sin(xAngle), 0,
-        0, sin(xAngle), cos(xAngle), 0,
-        0, 0, 0, 1
+        n1, n0, n0, n0,
+        n0, c, -s, n0,
+        n0, s, c, n0,
+        n0, n0, n0, n1
     };
 }
 
 template <typename T>
-Mat4<T> rotateY(const T &yAngle) {
+constexpr Mat4<T> rotateY(const T &yAngle) {
+    constexpr T n0 = T(0);
+    constexpr T n1 = T(1);
+    const T c = cos(yAngle);
+    const T s = sin(yAngle);
+
     return Mat4<T> {
-        cos(yAngle), 0, sin(yAngle), 0,
-        0, 1, 0, 0,
-        -sin(yAngle), 0, cos(yAngle), 0,
-        0, 0, 0, 1
+        c, n0, s, n0,
+        n0, n1, n0, n0,
+        -s, n0, c, n0,
+        n0, n0, n0, n1
     };
 }
 
 template <typename T>
-Mat4<T> rotateZ(const T &zAngle) {
+constexpr Mat4<T> rotateZ(const T &zAngle) {
+    constexpr T n0 = T(0);
+    constexpr T n1 = T(1);
+    const T c = cos(zAngle);
+    const T s = sin(zAngle);
+
+    return Mat4<T> {
+        c, -s, n0, n0,
+        s, c, n0, n0,
+        n0, n0, n1, n0,
+        n0, n0, n0, n1
+    };
+}
+
+// Projections
+//
+// All of these follow the camera in test.frag: view space looks down -z with
+// +y up, clip = [ p, 1 ] * m, and the result is in Vulkan clip space, so y
+// is flipped (+y down) and depth runs from 0 to w. fovX is the horizontal
+// field of view like Camera::fov, and aspect is width / height.
+// Each has an "Inverse" companion built directly from the same parameters,
+// taking clip (or NDC with w = 1) back to view space up to the usual divide
+// by w, with none of the precision loss of inverse(m).
+
+template <typename T>
+constexpr Mat4<T> perspective(T fovX, T aspect, T zNear, T zFar) {
+    static_assert(std::is_floating_point_v<T>, "Projections need float or double");
+    constexpr T n0 = T(0);
+    const T tx = tan(fovX / T(2));
+    const T ty = tx / aspect;
+    const T a = zFar / (zNear - zFar);
+    const T b = zNear * a;
+
+    return Mat4<T> {
+        T(1) / tx, n0, n0, n0,
+        n0, T(-1) / ty, n0, n0,
+        n0, n0, a, T(-1),
+        n0, n0, b, n0
+    };
+}
+
+template <typename T>
+constexpr Mat4<T> perspectiveInverse(T fovX, T aspect, T zNear, T zFar) {
+    static_assert(std::is_floating_point_v<T>, "Projections need float or double");
+    constexpr T n0 = T(0);
+    const T tx = tan(fovX / T(2));
+    const T ty = tx / aspect;
+    const T a = zFar / (zNear - zFar);
+    const T b = zNear * a;
+
+    return Mat4<T> {
+        tx, n0, n0, n0,
+        n0, -ty, n0, n0,
+        n0, n0, n0, T(1) / b,
+        n0, n0, T(-1), a / b
+    };
+}
+
+// Depth 1 at zNear falling to 0 at infinity, which spreads float depth
+// precision evenly over distance instead of bunching it at the near plane
+// Needs a depth clear to 0 and a "greater" depth test
+template <typename T>
+constexpr Mat4<T> perspectiveReverseZInfinite(T fovX, T aspect, T zNear) {
+    static_assert(std::is_floating_point_v<T>, "Projections need float or double");
+    constexpr T n0 = T(0);
+    const T tx = tan(fovX / T(2));
+    const T ty = tx / aspect;
+
+    return Mat4<T> {
+        T(1) / tx, n0, n0, n0,
+        n0, T(-1) / ty, n0, n0,
+        n0, n0, n0, T(-1),
+        n0, n0, zNear, n0
+    };
+}
+
+template <typename T>
+constexpr Mat4<T> perspectiveReverseZInfiniteInverse(T fovX, T aspect, T zNear) {
+    static_assert(std::is_floating_point_v<T>, "Projections need float or double");
+    constexpr T n0 = T(0);
+    const T tx = tan(fovX / T(2));
+    const T ty = tx / aspect;
+
+    return Mat4<T> {
+        tx, n0, n0, n0,
+        n0, -ty, n0, n0,
+        n0, n0, n0, T(1) / zNear,
+        n0, n0, T(-1), n0
+    };
+}
+
+// Maps the view space box [left, right] x [bottom, top] x [-zNear, -zFar]
+// to clip space
+template <typename T>
+constexpr Mat4<T> orthographic(T left, T right, T bottom, T top, T zNear, T zFar) {
+    static_assert(std::is_floating_point_v<T>, "Projections need float or double");
+    constexpr T n0 = T(0);
+    constexpr T n1 = T(1);
+    const T w = right - left;
+    const T h = top - bottom;
+    const T d = zFar - zNear;
+
+    return Mat4<T> {
+        T(2) / w, n0, n0, n0,
+        n0, T(-2) / h, n0, n0,
+        n0, n0, T(-1) / d, n0,
+        -(right + left) / w, (top + bottom) / h, -zNear / d, n1
+    };
+}
+
+template <typename T>
+constexpr Mat4<T> orthographicInverse(T left, T right, T bottom, T top, T zNear, T zFar) {
+    static_assert(std::is_floating_point_v<T>, "Projections need float or double");
+    constexpr T n0 = T(0);
+    constexpr T n1 = T(1);
+
+    return Mat4<T> {
+        (right - left) / T(2), n0, n0, n0,
+        n0, (bottom - top) / T(2), n0, n0,
+        n0, n0, zNear - zFar, n0,
+        (right + left) / T(2), (top + bottom) / T(2), -zNear, n1
+    };
+}
+
+// View matrix for a camera at eye looking at target, up being any vector
+// not parallel to the view direction
+template <typename T>
+constexpr Mat4<T> lookAt(const Vec3<T> &eye, const Vec3<T> &target, const Vec3<T> &up) {
+    static_assert(std::is_floating_point_v<T>, "Projections need float or double");
+    constexpr T n0 = T(0);
+    constexpr T n1 = T(1);
+    const Vec3<T> f = normalize(target - eye);
+    const Vec3<T> s = normalize(cross(f, up));
+    const Vec3<T> u = cross(s, f);
+
+    return Mat4<T> {
+        s[0], u[0], -f[0], n0,
+        s[1], u[1], -f[1], n0,
+        s[2], u[2], -f[2], n0,
+        -dot(s, eye), -dot(u, eye), dot(f, eye), n1
+    };
+}
+
+// Camera to world transform, whose upper 3x3 is the Camera::rotation that
+// looks from eye at target
+template <typename T>
+constexpr Mat4<T> lookAtInverse(const Vec3<T> &eye, const Vec3<T> &target, const Vec3<T> &up) {
+    static_assert(std::is_floating_point_v<T>, "Projections need float or double");
+    constexpr T n0 = T(0);
+    constexpr T n1 = T(1);
+    const Vec3<T> f = normalize(target - eye);
+    const Vec3<T> s = normalize(cross(f, up));
+    const Vec3<T> u = cross(s, f);
+
     return Mat4<T> {
-        cos(zAngle), -sin(zAngle), 0, 0,
-        sin(zAngle), cos(zAngle), 0, 0,
-        0, 0, 1, 0,
-        0, 0, 0, 1
+        s[0], s[1], s[2], n0,
+        u[0], u[1], u[2], n0,
+        -f[0], -f[1], -f[2], n0,
+        eye[0], eye[1], eye[2], n1
     };
 }
 
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "mat.hpp"
+
+// SIMD overloads for Mat4<float>, one __m128 per row (see vecsimd.hpp for
+// how these take priority over the generic templates and fall back to them
+// during constant evaluation)
+
+#if defined(ESDM_SIMD_SSE2)
+
+namespace esdm {
+
+namespace simd {
+
+inline __m128 madd(__m128 a, __m128 b, __m128 c) {
+#if defined(ESDM_SIMD_FMA)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+template <int I>
+inline __m128 splat(__m128 v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(I, I, I, I));
+}
+
+// Row vector times matrix rows: v.x * r0 + v.y * r1 + v.z * r2 + v.w * r3
+inline __m128 rowMul(__m128 v, const Mat4<float> &m) {
+    __m128 out = _mm_mul_ps(splat<0>(v), m.data[0].simd);
+    out = madd(splat<1>(v), m.data[1].simd, out);
+    out = madd(splat<2>(v), m.data[2].simd, out);
+    return madd(splat<3>(v), m.data[3].simd, out);
+}
+
+// 2x2 blocks packed as [ m00, m01, m10, m11 ] for the block-wise inverse
+
+inline __m128 mat2Mul(__m128 a, __m128 b) {
+    return _mm_add_ps(
+        _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+        _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2)))
+    );
+}
+
+// adj(a) * b
+inline __m128 mat2AdjMul(__m128 a, __m128 b) {
+    return _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+        _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)))
+    );
+}
+
+// a * adj(b)
+inline __m128 mat2MulAdj(__m128 a, __m128 b) {
+    return _mm_sub_ps(
+        _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+        _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2)))
+    );
+}
+
+// Intermediate values shared by determinant and inverse
+// m = [ A B ]
+//     [ C D ]
+struct Mat4Blocks {
+    __m128 a, b, c, d;
+    __m128 detA, detB, detC, detD;
+    __m128 adjAB, adjDC;
+    __m128 det;
+
+    explicit Mat4Blocks(const Mat4<float> &m) {
+        const __m128 r0 = m.data[0].simd;
+        const __m128 r1 = m.data[1].simd;
+        const __m128 r2 = m.data[2].simd;
+        const __m128 r3 = m.data[3].simd;
+
+        a = _mm_movelh_ps(r0, r1);
+        b = _mm_movehl_ps(r1, r0);
+        c = _mm_movelh_ps(r2, r3);
+        d = _mm_movehl_ps(r3, r2);
+
+        // [ |A|, |B|, |C|, |D| ]
+        __m128 detSub = _mm_sub_ps(
+            _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+            _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0)))
+        );
+        detA = splat<0>(detSub);
+        detB = splat<1>(detSub);
+        detC = splat<2>(detSub);
+        detD = splat<3>(detSub);
+
+        adjDC = mat2AdjMul(d, c);
+        adjAB = mat2AdjMul(a, b);
+
+        // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+        __m128 tr = _mm_mul_ps(adjAB, _mm_shuffle_ps(adjDC, adjDC, _MM_SHUFFLE(3, 1, 2, 0)));
+        det = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+        det = _mm_sub_ps(det, _mm_set1_ps(hsum(tr)));
+    }
+};
+
+// Runtime body of esdm::inverse(Mat4<float>), kept out of the constexpr
+// overload since Mat4Blocks isn't a literal type
+inline Mat4<float> inverse(const Mat4<float> &m) {
+    Mat4Blocks k(m);
+
+    // inverse(M) = 1 / |M| * [ X Y ]
+    //                        [ Z W ]
+    // computed here as adjugates X# = |D|A - B(D#C), etc.
+    __m128 x = _mm_sub_ps(_mm_mul_ps(k.detD, k.a), mat2Mul(k.b, k.adjDC));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(k.detA, k.d), mat2Mul(k.c, k.adjAB));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(k.detB, k.c), mat2MulAdj(k.d, k.adjAB));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(k.detC, k.b), mat2MulAdj(k.a, k.adjDC));
+
+    // Sign pattern of the 2x2 adjugate folded into the reciprocal
+    __m128 rcpDet = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), k.det);
+    x = _mm_mul_ps(x, rcpDet);
+    y = _mm_mul_ps(y, rcpDet);
+    z = _mm_mul_ps(z, rcpDet);
+    w = _mm_mul_ps(w, rcpDet);
+
+    // Undo the adjugate shuffle and re-interleave the blocks into rows
+    Mat4<float> out;
+    out.data[0].simd = _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3));
+    out.data[1].simd = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2));
+    out.data[2].simd = _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3));
+    out.data[3].simd = _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2));
+    return out;
+}
+
+}
+
+constexpr Mat4<float> matmul(const Mat4<float> &a, const Mat4<float> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return matmul<4, 4, 4, float, float>(a, b);
+    Mat4<float> out;
+    for (size_t i = 0; i < 4; i++)
+        out.data[i].simd = simd::rowMul(a.data[i].simd, b);
+    return out;
+}
+
+constexpr Vec4<float> matmul(const Vec4<float> &a, const Mat4<float> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return matmul<4, 4, float, float>(a, b);
+    return simd::toVec4(simd::rowMul(a.simd, b));
+}
+
+constexpr Vec4<float> matmul(const Mat4<float> &a, const Vec4<float> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return matmul<4, 4, float, float>(a, b);
+    __m128 r0 = _mm_mul_ps(a.data[0].simd, b.simd);
+    __m128 r1 = _mm_mul_ps(a.data[1].simd, b.simd);
+    __m128 r2 = _mm_mul_ps(a.data[2].simd, b.simd);
+    __m128 r3 = _mm_mul_ps(a.data[3].simd, b.simd);
+    // Transposing the products turns four horizontal sums into three adds
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    return simd::toVec4(_mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3)));
+}
+
+constexpr Mat4<float> transpose(const Mat4<float> &m) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return transpose<4, 4, float>(m);
+    Mat4<float> out = m;
+    _MM_TRANSPOSE4_PS(out.data[0].simd, out.data[1].simd, out.data[2].simd, out.data[3].simd);
+    return out;
+}
+
+constexpr float determinant(const Mat4<float> &m) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return determinant<4, float>(m);
+    return _mm_cvtss_f32(simd::Mat4Blocks(m).det);
+}
+
+// Block-wise inverse through 2x2 adjugates
+// A singular matrix produces non-finite components
+constexpr Mat4<float> inverse(const Mat4<float> &m) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return inverse<4, float>(m);
+    return simd::inverse(m);
+}
+
+constexpr Mat4<float> inverseRigid(const Mat4<float> &m) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return inverseRigid<float>(m);
+    __m128 r0 = m.data[0].simd;
+    __m128 r1 = m.data[1].simd;
+    __m128 r2 = m.data[2].simd;
+    __m128 r3 = _mm_setzero_ps();
+    // Rows 0-2 become R^T with w = 0
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    __m128 t = m.data[3].simd;
+    __m128 tInv = _mm_mul_ps(simd::splat<0>(t), r0);
+    tInv = simd::madd(simd::splat<1>(t), r1, tInv);
+    tInv = simd::madd(simd::splat<2>(t), r2, tInv);
+
+    Mat4<float> out;
+    out.data[0].simd = r0;
+    out.data[1].simd = r1;
+    out.data[2].simd = r2;
+    out.data[3].simd = _mm_sub_ps(_mm_setr_ps(0.f, 0.f, 0.f, 1.f), tInv);
+    return out;
+}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "vec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Morton (Z-order) codes: the bits of x, y (and z) interleaved, x in the
+// lowest bit, so cells close in space are mostly close in memory
+//
+// 2D codes hold 32 bits per axis and 3D codes 21, in a uint64_t. Encoding
+// and decoding use BMI2 pdep / pext where the build enables it (one
+// instruction each way on Intel and on AMD from Zen 3; older AMD parts
+// microcode them and are faster with the fallback), and the magic bits
+// shift / mask sequence otherwise.
+//
+// Codes can also be stepped and offset without decoding them, by doing the
+// carries only through the bits of one axis ("dilated" arithmetic).
+
+namespace esdm {
+
+namespace morton {
+
+// Bits of "axis" in a Rank dimensional code
+template <size_t Rank>
+constexpr uint64_t axisMask(size_t axis) {
+    static_assert(Rank == 2 || Rank == 3, "Morton codes are only defined for 2 and 3 dimensions");
+    return (Rank == 2 ? 0x5555555555555555 : 0x1249249249249249) << axis;
+}
+
+namespace detail {
+
+// Spreads the low bits of v out to every Rank-th bit
+template <size_t Rank>
+constexpr uint64_t spreadMagic(uint64_t v) {
+    if constexpr (Rank == 2) {
+        v &= 0xFFFFFFFF;
+        v = (v | v << 16) & 0x0000FFFF0000FFFF;
+        v = (v | v << 8) & 0x00FF00FF00FF00FF;
+        v = (v | v << 4) & 0x0F0F0F0F0F0F0F0F;
+        v = (v | v << 2) & 0x3333333333333333;
+        v = (v | v << 1) & 0x5555555555555555;
+    } else {
+        v &= 0x1FFFFF;
+        v = (v | v << 32) & 0x001F00000000FFFF;
+        v = (v | v << 16) & 0x001F0000FF0000FF;
+        v = (v | v << 8) & 0x100F00F00F00F00F;
+        v = (v | v << 4) & 0x10C30C30C30C30C3;
+        v = (v | v << 2) & 0x1249249249249249;
+    }
+    return v;
+}
+
+// Inverse of spreadMagic, gathering every Rank-th bit back to the bottom
+template <size_t Rank>
+constexpr uint64_t compactMagic(uint64_t v) {
+    if constexpr (Rank == 2) {
+        v &= 0x5555555555555555;
+        v = (v | v >> 1) & 0x3333333333333333;
+        v = (v | v >> 2) & 0x0F0F0F0F0F0F0F0F;
+        v = (v | v >> 4) & 0x00FF00FF00FF00FF;
+        v = (v | v >> 8) & 0x0000FFFF0000FFFF;
+        v = (v | v >> 16) & 0x00000000FFFFFFFF;
+    } else {
+        v &= 0x1249249249249249;
+        v = (v | v >> 2) & 0x10C30C30C30C30C3;
+        v = (v | v >> 4) & 0x100F00F00F00F00F;
+        v = (v | v >> 8) & 0x001F0000FF0000FF;
+        v = (v | v >> 16) & 0x001F00000000FFFF;
+        v = (v | v >> 32) & 0x00000000001FFFFF;
+    }
+    return v;
+}
+
+template <size_t Rank>
+constexpr uint64_t spread(uint64_t v) {
+#if defined(ESDM_SIMD_BMI2)
+    if (!ESDM_IS_CONSTANT_EVALUATED())
+        return _pdep_u64(v, axisMask<Rank>(0));
+#endif
+    return spreadMagic<Rank>(v);
+}
+
+template <size_t Rank>
+constexpr uint64_t compact(uint64_t v) {
+#if defined(ESDM_SIMD_BMI2)
+    if (!ESDM_IS_CONSTANT_EVALUATED())
+        return _pext_u64(v, axisMask<Rank>(0));
+#endif
+    return compactMagic<Rank>(v);
+}
+
+}
+
+constexpr uint64_t encode(uint32_t x, uint32_t y) {
+    return detail::spread<2>(x) | detail::spread<2>(y) << 1;
+}
+
+// x, y and z below 2^21
+constexpr uint64_t encode(uint32_t x, uint32_t y, uint32_t z) {
+    return detail::spread<3>(x) | detail::spread<3>(y) << 1 | detail::spread<3>(z) << 2;
+}
+
+constexpr uint64_t encode(const Vec2<uint32_t> &c) {
+    return encode(c[0], c[1]);
+}
+
+constexpr uint64_t encode(const Vec3<uint32_t> &c) {
+    return encode(c[0], c[1], c[2]);
+}
+
+constexpr Vec2<uint32_t> decode2(uint64_t code) {
+    return Vec2<uint32_t>(uint32_t(detail::compact<2>(code)), uint32_t(detail::compact<2>(code >> 1)));
+}
+
+constexpr Vec3<uint32_t> decode3(uint64_t code) {
+    return Vec3<uint32_t>(uint32_t(detail::compact<3>(code)), uint32_t(detail::compact<3>(code >> 1)), uint32_t(detail::compact<3>(code >> 2)));
+}
+
+// Dilated arithmetic
+// Every axis wraps around independently at 2^(64 / Rank) (2^32 / 2^21)
+
+// Sum of the coordinates of a and b, per axis
+template <size_t Rank>
+constexpr uint64_t add(uint64_t a, uint64_t b) {
+    uint64_t out = 0;
+    for (size_t axis = 0; axis < Rank; axis++) {
+        const uint64_t m = axisMask<Rank>(axis);
+        // Setting the other axes' bits carries straight through them
+        out |= ((a | ~m) + (b & m)) & m;
+    }
+    return out;
+}
+
+// Difference of the coordinates of a and b, per axis
+template <size_t Rank>
+constexpr uint64_t sub(uint64_t a, uint64_t b) {
+    uint64_t out = 0;
+    for (size_t axis = 0; axis < Rank; axis++) {
+        const uint64_t m = axisMask<Rank>(axis);
+        out |= ((a & m) - (b & m)) & m;
+    }
+    return out;
+}
+
+// The cell one step forward or back along an axis
+template <size_t Rank>
+constexpr uint64_t increment(uint64_t code, size_t axis) {
+    const uint64_t m = axisMask<Rank>(axis);
+    return (((code | ~m) + 1) & m) | (code & ~m);
+}
+
+template <size_t Rank>
+constexpr uint64_t decrement(uint64_t code, size_t axis) {
+    const uint64_t m = axisMask<Rank>(axis);
+    return (((code & m) - 1) & m) | (code & ~m);
+}
+
+// "step" cells along an axis, negative steps going back
+template <size_t Rank>
+constexpr uint64_t offset(uint64_t code, size_t axis, int64_t step) {
+    const uint64_t m = axisMask<Rank>(axis);
+    const uint64_t delta = detail::spread<Rank>(uint64_t(step < 0 ? -step : step)) << axis;
+    const uint64_t moved = step < 0 ? ((code & m) - delta) & m : ((code | ~m) + delta) & m;
+    return moved | (code & ~m);
+}
+
+}
+
+}
\ No newline at end of file
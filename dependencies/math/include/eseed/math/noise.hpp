@@ -0,0 +1,235 @@
+#pragma once
+
+#include "vecbatch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU port of the simplex noise in resources/shaders/test/test.frag
+// (Ian McEwan / Ashima Arts, with the same permute / taylorInvSqrt
+// formulation), so terrain can be sampled without the GPU
+//
+// simplex3 follows the shader operation for operation in float, and stays
+// within 1e-6 of a direct float transcription of the GLSL for |v| < 4096
+// when both are evaluated the same way. The exception is inputs where
+// v + dot(v, 1/3) lands on an integer, lattice points included: there the
+// cell picked by floor depends on rounding (FMA contraction, dot product
+// order), and the shader's 0.6 kernel radius makes the noise discontinuous
+// across cells, so any two implementations, GPUs included, can disagree
+// there by up to about 0.6.
+
+namespace esdm {
+
+namespace noise {
+
+namespace detail {
+
+// mod(x, 289) as GLSL defines it, exact for the integral x seen here
+template <typename P>
+inline P mod289(P x) {
+    const P n = P::splat(289.f);
+    return x - simd::floor(x / n) * n;
+}
+
+template <typename P>
+inline P permute(P x) {
+    return mod289(madd(x, P::splat(34.f), P::splat(1.f)) * x);
+}
+
+template <typename P>
+inline P taylorInvSqrt(P r) {
+    return madd(r, P::splat(-0.85373472095314f), P::splat(1.79284291400159f));
+}
+
+// step(edge, x)
+template <typename P>
+inline P step(P edge, P x) {
+    return simd::selectLess(x, edge, P::splat(0.f), P::splat(1.f));
+}
+
+// Contribution of one simplex corner, given its hash and offset from v
+template <typename P>
+inline P corner(P hash, P x, P y, P z) {
+    constexpr float n = 1.f / 7.f;
+    const P nsX = P::splat(n * 2.f);
+    const P nsY = P::splat(n * .5f - 1.f);
+    const P nsZ = P::splat(n);
+
+    // Gradients: 7 * 7 points over a square, mapped onto an octahedron
+    P j = hash - P::splat(49.f) * simd::floor(hash * nsZ * nsZ);
+    P gx = simd::floor(j * nsZ);
+    P gy = simd::floor(j - P::splat(7.f) * gx);
+    gx = madd(gx, nsX, nsY);
+    gy = madd(gy, nsX, nsY);
+    P gz = P::splat(1.f) - simd::abs(gx) - simd::abs(gy);
+
+    P sh = P::splat(0.f) - step(gz, P::splat(0.f));
+    gx = madd(madd(simd::floor(gx), P::splat(2.f), P::splat(1.f)), sh, gx);
+    gy = madd(madd(simd::floor(gy), P::splat(2.f), P::splat(1.f)), sh, gy);
+
+    P norm = taylorInvSqrt(gx * gx + gy * gy + gz * gz);
+
+    P m = simd::max(P::splat(.6f) - (x * x + y * y + z * z), P::splat(0.f));
+    m = m * m;
+    return m * m * (gx * x + gy * y + gz * z) * norm;
+}
+
+}
+
+// Roughly in [-1, 1]
+template <typename T, size_t W>
+inline simd::Pack<T, W> simplex3(simd::Pack<T, W> vx, simd::Pack<T, W> vy, simd::Pack<T, W> vz) {
+    using P = simd::Pack<T, W>;
+    using namespace detail;
+    const P cx = P::splat(1.f / 6.f);
+    const P cy = P::splat(1.f / 3.f);
+    const P one = P::splat(1.f);
+
+    // First corner
+    P s = vx * cy + vy * cy + vz * cy;
+    P ix = simd::floor(vx + s);
+    P iy = simd::floor(vy + s);
+    P iz = simd::floor(vz + s);
+    P t = ix * cx + iy * cx + iz * cx;
+    P x0 = vx - ix + t;
+    P y0 = vy - iy + t;
+    P z0 = vz - iz + t;
+
+    // Other corners
+    P gx = step(y0, x0);
+    P gy = step(z0, y0);
+    P gz = step(x0, z0);
+    P lx = one - gx;
+    P ly = one - gy;
+    P lz = one - gz;
+    P i1x = simd::min(gx, lz), i1y = simd::min(gy, lx), i1z = simd::min(gz, ly);
+    P i2x = simd::max(gx, lz), i2y = simd::max(gy, lx), i2z = simd::max(gz, ly);
+
+    P x1 = x0 - i1x + cx, y1 = y0 - i1y + cx, z1 = z0 - i1z + cx;
+    P x2 = x0 - i2x + P::splat(2.f / 6.f), y2 = y0 - i2y + P::splat(2.f / 6.f), z2 = z0 - i2z + P::splat(2.f / 6.f);
+    const P c3 = P::splat(3.f * (1.f / 6.f)) - one;
+    P x3 = x0 + c3, y3 = y0 + c3, z3 = z0 + c3;
+
+    // Permutations
+    ix = mod289(ix);
+    iy = mod289(iy);
+    iz = mod289(iz);
+    P p0 = permute(permute(permute(iz) + iy) + ix);
+    P p1 = permute(permute(permute(iz + i1z) + iy + i1y) + ix + i1x);
+    P p2 = permute(permute(permute(iz + i2z) + iy + i2y) + ix + i2x);
+    P p3 = permute(permute(permute(iz + one) + iy + one) + ix + one);
+
+    P sum = corner(p0, x0, y0, z0) + corner(p1, x1, y1, z1) + corner(p2, x2, y2, z2) + corner(p3, x3, y3, z3);
+    return sum * P::splat(42.f);
+}
+
+inline float simplex3(const Vec3<float> &v) {
+    using P = simd::Pack<float, 1>;
+    return simplex3(P{v[0]}, P{v[1]}, P{v[2]}).v;
+}
+
+// Fractal Brownian motion: "octaves" layers of simplex3, each at
+// "lacunarity" times the frequency and "gain" times the amplitude of the last
+// Not normalized, the range grows towards 1 / (1 - gain)
+template <typename T, size_t W>
+inline simd::Pack<T, W> fbm3(simd::Pack<T, W> x, simd::Pack<T, W> y, simd::Pack<T, W> z, size_t octaves, float lacunarity = 2.f, float gain = .5f) {
+    using P = simd::Pack<T, W>;
+    P sum = P::splat(0.f);
+    float frequency = 1.f;
+    float amplitude = 1.f;
+    for (size_t i = 0; i < octaves; i++) {
+        const P f = P::splat(frequency);
+        sum = madd(simplex3(x * f, y * f, z * f), P::splat(amplitude), sum);
+        frequency *= lacunarity;
+        amplitude *= gain;
+    }
+    return sum;
+}
+
+inline float fbm3(const Vec3<float> &v, size_t octaves, float lacunarity = 2.f, float gain = .5f) {
+    using P = simd::Pack<float, 1>;
+    return fbm3(P{v[0]}, P{v[1]}, P{v[2]}, octaves, lacunarity, gain).v;
+}
+
+// Batch versions, threaded like the VecBatch kernels
+// out is resized to the input size
+
+inline void simplex3(const VecBatch<3, float> &in, std::vector<float> &out) {
+    out.resize(in.size());
+    batchFor<float>(in.size(), [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        simplex3(P::load(in.x() + i), P::load(in.y() + i), P::load(in.z() + i)).store(out.data() + i);
+    });
+}
+
+inline void fbm3(const VecBatch<3, float> &in, std::vector<float> &out, size_t octaves, float lacunarity = 2.f, float gain = .5f) {
+    out.resize(in.size());
+    batchFor<float>(in.size(), [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        fbm3(P::load(in.x() + i), P::load(in.y() + i), P::load(in.z() + i), octaves, lacunarity, gain).store(out.data() + i);
+    });
+}
+
+// Heightmaps
+
+// One layer of a heightmap: simplex3(x / scale, z / scale, w) * amplitude
+// at integer column (x, z), w picking an independent slice of the noise
+struct HeightLayer {
+    float scale;
+    float w;
+    float amplitude;
+};
+
+// The groundHeight layers of getVoxel in test.frag
+inline std::vector<HeightLayer> shaderTerrain() {
+    return { { 64.f, 0.f, 16.f }, { 32.f, 1.f, 8.f } };
+}
+
+template <typename P>
+inline P height(const std::vector<HeightLayer> &layers, P x, P z) {
+    P sum = P::splat(0.f);
+    for (const HeightLayer &layer : layers) {
+        const P scale = P::splat(layer.scale);
+        sum = madd(simplex3(x / scale, z / scale, P::splat(layer.w)), P::splat(layer.amplitude), sum);
+    }
+    return sum;
+}
+
+// Height of column (x, z), the top of the ground being the highest y below it
+inline float height(const std::vector<HeightLayer> &layers, int32_t x, int32_t z) {
+    using P = simd::Pack<float, 1>;
+    return height(layers, P{float(x)}, P{float(z)}).v;
+}
+
+// Fills a width * depth tile of heights starting at column "origin", with
+// out[z * width + x] holding column origin + (x, z)
+// Rows are split across threads; out is resized to width * depth
+inline void fillHeightmap(const std::vector<HeightLayer> &layers, const Vec2<int32_t> &origin, size_t width, size_t depth, std::vector<float> &out) {
+    out.resize(width * depth);
+    const size_t rowGrain = std::max<size_t>(1, batchGrain / std::max<size_t>(width, 1));
+    parallelFor(depth, rowGrain, [&](size_t rowBegin, size_t rowEnd) {
+        for (size_t row = rowBegin; row < rowEnd; row++) {
+            const float z = float(origin[1] + int32_t(row));
+            float *rowOut = out.data() + row * width;
+
+            using P = simd::NativePack<float>;
+            float offsets[P::width];
+            for (size_t i = 0; i < P::width; i++)
+                offsets[i] = float(i);
+            const P laneOffsets = P::load(offsets);
+
+            size_t i = 0;
+            for (; i + P::width <= width; i += P::width) {
+                P x = laneOffsets + P::splat(float(origin[0] + int32_t(i)));
+                height(layers, x, P::splat(z)).store(rowOut + i);
+            }
+            for (; i < width; i++)
+                rowOut[i] = height(layers, origin[0] + int32_t(i), origin[1] + int32_t(row));
+        }
+    });
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,449 @@
+#pragma once
+
+#include "quat.hpp"
+#include "packed.hpp"
+#include "vecbatch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Compressed unit vectors and tangent frames for vertex and G-buffer data,
+// decoded on the GPU by resources/shaders/include/normals.glsl
+//
+// Octahedral normals fold the unit sphere onto the [-1, 1] square and store
+// the two square coordinates as signed normalized integers:
+//   Oct16   8 bits each   VK_FORMAT_R8G8_SNORM      max error ~0.95 deg
+//   Oct24  12 bits each   low 24 bits of a uint     max error ~0.059 deg
+//   Oct32  16 bits each   VK_FORMAT_R16G16_SNORM    max error ~0.0037 deg
+// against 12 bytes for a Vec3<float> (16 padded).
+//
+// QTangent stores a whole tangent frame (normal, tangent and the bitangent
+// handedness) as a rotation quaternion in VK_FORMAT_R16G16B16A16_SNORM,
+// 8 bytes instead of 28, with the handedness in the sign of w. Each axis
+// decodes to within ~0.005 deg of the frame made orthonormal, for tangents
+// well away from the normal; one within a few degrees of it also carries
+// the float error of orthogonalizing it (up to ~0.02 deg).
+//
+// Encoding rounds to nearest, matching packSnorm2x16 / packSnorm4x8 in
+// GLSL. The errors above are the largest angles between a unit vector and
+// its decoded encoding, measured over dense sphere samples.
+
+namespace esdm {
+
+namespace detail {
+
+// Normalized::fromFloat for any bit count up to 16, scale being
+// 2^(bits - 1) - 1
+constexpr int32_t snormFromFloat(float f, float scale) {
+    float v = f == f ? f : 0.f;
+    v = v > -1.f ? v : -1.f;
+    v = v < 1.f ? v : 1.f;
+    return roundEven(v * scale);
+}
+
+constexpr float snormToFloat(int32_t bits, float scale) {
+    const float f = float(bits) / scale;
+    return f > -1.f ? f : -1.f;
+}
+
+constexpr float signNotZero(float f) {
+    return f < 0.f ? -1.f : 1.f;
+}
+
+}
+
+// Octahedral mapping of a unit vector onto [-1, 1]^2: the upper half
+// projected straight down, the lower half folded over the diagonals
+inline Vec2<float> octEncode(const Vec3<float> &n) {
+    const float rcp = 1.f / (abs(n[0]) + abs(n[1]) + abs(n[2]));
+    const float u = n[0] * rcp;
+    const float v = n[1] * rcp;
+    if (n[2] >= 0.f)
+        return Vec2<float>(u, v);
+    return Vec2<float>((1.f - abs(v)) * detail::signNotZero(u), (1.f - abs(u)) * detail::signNotZero(v));
+}
+
+// Inverse of octEncode, unit length for any point of the square
+inline Vec3<float> octDecode(const Vec2<float> &e) {
+    float x = e[0], y = e[1];
+    const float z = 1.f - abs(x) - abs(y);
+    // Unfolding the lower half moves each coordinate back toward the axis
+    // by the depth below the equator
+    const float t = z < 0.f ? -z : 0.f;
+    x += x < 0.f ? t : -t;
+    y += y < 0.f ? t : -t;
+    return normalize(Vec3<float>(x, y, z));
+}
+
+// Octahedral normal in 2 * Bits bits, Bits bits per coordinate
+template <size_t Bits>
+class OctNormal;
+
+template <>
+class OctNormal<8> {
+public:
+    static constexpr float scale = 127.f;
+
+    // x in the low byte, like R8G8_SNORM and packSnorm4x8
+    uint16_t bits;
+
+    constexpr OctNormal() : bits(0) {}
+
+    OctNormal(const Vec3<float> &n) : bits(0) {
+        const Vec2<float> e = octEncode(n);
+        setCoords(detail::snormFromFloat(e[0], scale), detail::snormFromFloat(e[1], scale));
+    }
+
+    operator Vec3<float>() const {
+        return octDecode(Vec2<float>(detail::snormToFloat(u(), scale), detail::snormToFloat(v(), scale)));
+    }
+
+    int32_t u() const { return int8_t(bits & 0xFF); }
+    int32_t v() const { return int8_t(bits >> 8); }
+
+    void setCoords(int32_t u, int32_t v) {
+        bits = uint16_t((uint32_t(u) & 0xFF) | (uint32_t(v) & 0xFF) << 8);
+    }
+};
+
+template <>
+class OctNormal<12> {
+public:
+    static constexpr float scale = 2047.f;
+
+    // x in bits 0 - 11 and y in bits 12 - 23 of a little endian uint, read
+    // back in GLSL with bitfieldExtract
+    uint8_t bytes[3];
+
+    constexpr OctNormal() : bytes{0, 0, 0} {}
+
+    OctNormal(const Vec3<float> &n) : bytes{0, 0, 0} {
+        const Vec2<float> e = octEncode(n);
+        setCoords(detail::snormFromFloat(e[0], scale), detail::snormFromFloat(e[1], scale));
+    }
+
+    operator Vec3<float>() const {
+        return octDecode(Vec2<float>(detail::snormToFloat(u(), scale), detail::snormToFloat(v(), scale)));
+    }
+
+    uint32_t packed() const {
+        return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16;
+    }
+
+    // Sign extended from 12 bits by shifting up to the top and back
+    int32_t u() const { return int32_t(packed() << 20) >> 20; }
+    int32_t v() const { return int32_t(packed() << 8) >> 20; }
+
+    void setCoords(int32_t u, int32_t v) {
+        const uint32_t p = (uint32_t(u) & 0xFFF) | (uint32_t(v) & 0xFFF) << 12;
+        bytes[0] = uint8_t(p);
+        bytes[1] = uint8_t(p >> 8);
+        bytes[2] = uint8_t(p >> 16);
+    }
+};
+
+template <>
+class OctNormal<16> {
+public:
+    static constexpr float scale = 32767.f;
+
+    // R16G16_SNORM, packSnorm2x16
+    int16_t coords[2];
+
+    constexpr OctNormal() : coords{0, 0} {}
+
+    OctNormal(const Vec3<float> &n) : coords{0, 0} {
+        const Vec2<float> e = octEncode(n);
+        setCoords(detail::snormFromFloat(e[0], scale), detail::snormFromFloat(e[1], scale));
+    }
+
+    operator Vec3<float>() const {
+        return octDecode(Vec2<float>(detail::snormToFloat(u(), scale), detail::snormToFloat(v(), scale)));
+    }
+
+    int32_t u() const { return coords[0]; }
+    int32_t v() const { return coords[1]; }
+
+    void setCoords(int32_t u, int32_t v) {
+        coords[0] = int16_t(u);
+        coords[1] = int16_t(v);
+    }
+};
+
+using Oct16 = OctNormal<8>;
+using Oct24 = OctNormal<12>;
+using Oct32 = OctNormal<16>;
+
+static_assert(sizeof(Oct16) == 2 && sizeof(Oct24) == 3 && sizeof(Oct32) == 4, "OctNormal must be tightly packed");
+
+// Tangent frame as a rotation taking x to the tangent, y to the bitangent
+// and z to the normal, with w kept away from 0 so its sign can carry the
+// handedness: w < 0 means the bitangent is -cross(normal, tangent)
+class QTangent {
+public:
+    static constexpr float scale = 32767.f;
+    // Smallest |w| kept, one quantization step
+    static constexpr float bias = 1.f / scale;
+
+    // R16G16B16A16_SNORM [ x, y, z, w ]
+    int16_t coords[4];
+
+    constexpr QTangent() : coords{0, 0, 0, int16_t(scale)} {}
+
+    // Unit normal, tangent (made orthogonal to the normal here) and
+    // handedness of the bitangent, +1 or -1
+    QTangent(const Vec3<float> &normal, const Vec3<float> &tangent, float handedness) : coords{0, 0, 0, 0} {
+        const Vec3<float> t = normalize(tangent - normal * dot(normal, tangent));
+        const Vec3<float> b = cross(normal, t);
+        Quat<float> q = quatFromMat3(Mat3<float>(
+            t[0], t[1], t[2],
+            b[0], b[1], b[2],
+            normal[0], normal[1], normal[2]
+        ));
+        set(q, handedness);
+    }
+
+    Quat<float> quat() const {
+        return normalize(Quat<float>(
+            detail::snormToFloat(coords[0], scale),
+            detail::snormToFloat(coords[1], scale),
+            detail::snormToFloat(coords[2], scale),
+            detail::snormToFloat(coords[3], scale)
+        ));
+    }
+
+    // Rows of toMat3(quat()), which doesn't depend on the sign of the quat
+
+    Vec3<float> normal() const {
+        return quat().toMat3()[2];
+    }
+
+    Vec3<float> tangent() const {
+        return quat().toMat3()[0];
+    }
+
+    float handedness() const {
+        return coords[3] < 0 ? -1.f : 1.f;
+    }
+
+    Vec3<float> bitangent() const {
+        const Mat3<float> m = quat().toMat3();
+        return cross(m[2], m[0]) * handedness();
+    }
+
+    // q with w >= 0, as quatFromMat3 returns
+    void set(Quat<float> q, float handedness) {
+        if (q.data[3] < bias) {
+            const float s = sqrt(1.f - bias * bias);
+            q = Quat<float>(q.data[0] * s, q.data[1] * s, q.data[2] * s, bias);
+        }
+        const float sign = detail::signNotZero(handedness);
+        for (size_t c = 0; c < 4; c++)
+            coords[c] = int16_t(detail::snormFromFloat(q.data[c] * sign, scale));
+    }
+};
+
+static_assert(sizeof(QTangent) == 8, "QTangent must be tightly packed");
+
+// Batch kernels
+// Written once over simd::Pack like the VecBatch kernels, following the
+// per element constructors and conversions above operation for operation,
+// so they agree up to float rounding (FMA contraction, rsqrt-free division)
+// Inputs of at least batchGrain elements per thread are split across threads
+
+namespace detail {
+
+template <typename P>
+inline P signNotZero(P p) {
+    return simd::selectLess(p, P::splat(0.f), P::splat(-1.f), P::splat(1.f));
+}
+
+template <typename P>
+inline P snormFromFloat(P p, float scale) {
+    p = simd::min(simd::max(p, P::splat(-1.f)), P::splat(1.f));
+    return simd::round(p * P::splat(scale));
+}
+
+template <typename P>
+inline P snormToFloat(P p, float scale) {
+    return simd::max(p / P::splat(scale), P::splat(-1.f));
+}
+
+template <typename P>
+inline void octEncode(P x, P y, P z, P &u, P &v) {
+    const P zero = P::splat(0.f);
+    const P rcp = P::splat(1.f) / (simd::abs(x) + simd::abs(y) + simd::abs(z));
+    const P pu = x * rcp;
+    const P pv = y * rcp;
+    const P fu = (P::splat(1.f) - simd::abs(pv)) * signNotZero(pu);
+    const P fv = (P::splat(1.f) - simd::abs(pu)) * signNotZero(pv);
+    u = simd::selectLess(z, zero, fu, pu);
+    v = simd::selectLess(z, zero, fv, pv);
+}
+
+template <typename P>
+inline void octDecode(P u, P v, P &x, P &y, P &z) {
+    const P zero = P::splat(0.f);
+    z = P::splat(1.f) - simd::abs(u) - simd::abs(v);
+    const P t = simd::max(zero - z, zero);
+    x = u + simd::selectLess(u, zero, t, zero - t);
+    y = v + simd::selectLess(v, zero, t, zero - t);
+    const P rcp = P::splat(1.f) / simd::sqrt(x * x + y * y + z * z);
+    x = x * rcp;
+    y = y * rcp;
+    z = z * rcp;
+}
+
+// Quantized lanes of a pack as integers
+template <typename P>
+inline void storeInts(P p, int32_t *out) {
+    simd::storeTrunc(p, out);
+}
+
+template <typename P>
+inline P loadInts(const int32_t *in) {
+    float f[P::width];
+    for (size_t l = 0; l < P::width; l++)
+        f[l] = float(in[l]);
+    return P::load(f);
+}
+
+}
+
+template <size_t Bits>
+void encodeOct(const VecBatch<3, float> &normals, OctNormal<Bits> *out) {
+    constexpr float scale = OctNormal<Bits>::scale;
+    batchFor<float>(normals.size(), [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        P u, v;
+        detail::octEncode(P::load(normals.x() + i), P::load(normals.y() + i), P::load(normals.z() + i), u, v);
+        int32_t qu[P::width], qv[P::width];
+        detail::storeInts(detail::snormFromFloat(u, scale), qu);
+        detail::storeInts(detail::snormFromFloat(v, scale), qv);
+        for (size_t l = 0; l < P::width; l++)
+            out[i + l].setCoords(qu[l], qv[l]);
+    });
+}
+
+template <size_t Bits>
+void decodeOct(const OctNormal<Bits> *in, size_t count, VecBatch<3, float> &normals) {
+    constexpr float scale = OctNormal<Bits>::scale;
+    normals.resize(count);
+    batchFor<float>(count, [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        int32_t qu[P::width], qv[P::width];
+        for (size_t l = 0; l < P::width; l++) {
+            qu[l] = in[i + l].u();
+            qv[l] = in[i + l].v();
+        }
+        P x, y, z;
+        detail::octDecode(detail::snormToFloat(detail::loadInts<P>(qu), scale), detail::snormToFloat(detail::loadInts<P>(qv), scale), x, y, z);
+        x.store(normals.x() + i);
+        y.store(normals.y() + i);
+        z.store(normals.z() + i);
+    });
+}
+
+// handedness may be null for all right handed (+1) frames
+inline void encodeQTangents(const VecBatch<3, float> &normals, const VecBatch<3, float> &tangents, const float *handedness, QTangent *out) {
+    constexpr float scale = QTangent::scale;
+    batchFor<float>(normals.size(), [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        const P zero = P::splat(0.f);
+        const P nx = P::load(normals.x() + i), ny = P::load(normals.y() + i), nz = P::load(normals.z() + i);
+        P tx = P::load(tangents.x() + i), ty = P::load(tangents.y() + i), tz = P::load(tangents.z() + i);
+
+        // Gram-Schmidt, then b = cross(n, t)
+        const P nt = nx * tx + ny * ty + nz * tz;
+        tx = tx - nx * nt;
+        ty = ty - ny * nt;
+        tz = tz - nz * nt;
+        const P rcp = P::splat(1.f) / simd::sqrt(tx * tx + ty * ty + tz * tz);
+        tx = tx * rcp;
+        ty = ty * rcp;
+        tz = tz * rcp;
+        const P bx = ny * tz - nz * ty;
+        const P by = nz * tx - nx * tz;
+        const P bz = nx * ty - ny * tx;
+
+        // quatFromMat3 of the rows t, b, n, with the pivot picked by selects
+        const P one = P::splat(1.f);
+        const P sw = one + tx + by + nz;
+        const P sx = one + tx - by - nz;
+        const P sy = one - tx + by - nz;
+        const P sz = one - tx - by + nz;
+        const P xw = bz - ny, yw = nx - tz, zw = ty - bx;
+        const P xy = ty + bx, xz = tz + nx, yz = bz + ny;
+
+        P s = sw, qx = xw, qy = yw, qz = zw, qw = sw;
+        const auto pivot = [&](P sn, P cx, P cy, P cz, P cw) {
+            qx = simd::selectLess(s, sn, cx, qx);
+            qy = simd::selectLess(s, sn, cy, qy);
+            qz = simd::selectLess(s, sn, cz, qz);
+            qw = simd::selectLess(s, sn, cw, qw);
+            s = simd::selectLess(s, sn, sn, s);
+        };
+        pivot(sx, sx, xy, xz, xw);
+        pivot(sy, xy, sy, yz, yw);
+        pivot(sz, xz, yz, sz, zw);
+
+        P r = P::splat(.5f) / simd::sqrt(s);
+        r = simd::selectLess(qw, zero, zero - r, r);
+        qx = qx * r;
+        qy = qy * r;
+        qz = qz * r;
+        qw = qw * r;
+
+        // QTangent::set
+        const P bias = P::splat(QTangent::bias);
+        const P shrink = simd::selectLess(qw, bias, P::splat(sqrt(1.f - QTangent::bias * QTangent::bias)), one);
+        qw = simd::max(qw, bias);
+        P sign = one;
+        if (handedness)
+            sign = detail::signNotZero(P::load(handedness + i));
+        const P scaled[4] = { qx * shrink * sign, qy * shrink * sign, qz * shrink * sign, qw * sign };
+
+        int32_t q[4][P::width];
+        for (size_t c = 0; c < 4; c++)
+            detail::storeInts(detail::snormFromFloat(scaled[c], scale), q[c]);
+        for (size_t l = 0; l < P::width; l++)
+            for (size_t c = 0; c < 4; c++)
+                out[i + l].coords[c] = int16_t(q[c][l]);
+    });
+}
+
+// handedness may be null when it isn't needed
+inline void decodeQTangents(const QTangent *in, size_t count, VecBatch<3, float> &normals, VecBatch<3, float> &tangents, float *handedness) {
+    constexpr float scale = QTangent::scale;
+    normals.resize(count);
+    tangents.resize(count);
+    batchFor<float>(count, [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        int32_t q[4][P::width];
+        for (size_t l = 0; l < P::width; l++)
+            for (size_t c = 0; c < 4; c++)
+                q[c][l] = in[i + l].coords[c];
+        P x = detail::snormToFloat(detail::loadInts<P>(q[0]), scale);
+        P y = detail::snormToFloat(detail::loadInts<P>(q[1]), scale);
+        P z = detail::snormToFloat(detail::loadInts<P>(q[2]), scale);
+        P w = detail::snormToFloat(detail::loadInts<P>(q[3]), scale);
+        const P rcp = P::splat(1.f) / simd::sqrt(x * x + y * y + z * z + w * w);
+        x = x * rcp;
+        y = y * rcp;
+        z = z * rcp;
+        w = w * rcp;
+
+        // Rows 0 and 2 of toMat3
+        const P one = P::splat(1.f), two = P::splat(2.f);
+        (one - two * (y * y + z * z)).store(tangents.x() + i);
+        (two * (x * y + w * z)).store(tangents.y() + i);
+        (two * (x * z - w * y)).store(tangents.z() + i);
+        (two * (x * z + w * y)).store(normals.x() + i);
+        (two * (y * z - w * x)).store(normals.y() + i);
+        (one - two * (x * x + y * y)).store(normals.z() + i);
+        if (handedness)
+            detail::signNotZero(w).store(handedness + i);
+    });
+}
+
+}
\ No newline at end of file
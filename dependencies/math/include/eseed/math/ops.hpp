@@ -1,6 +1,10 @@
 #pragma once
 
+#include "cxmath.hpp"
+
 #include <cstddef>
+#include <cmath>
+#include <type_traits>
 #include <algorithm>
 
 namespace esdm {
@@ -11,27 +15,38 @@ constexpr T pi() {
 }
 
 template <typename T>
-inline T abs(T n) {
+constexpr T abs(T n) {
     return n < 0 ? -n : n;
 }
 
+// The functions below evaluate through cxmath.hpp in constant expressions
+// and through the std functions at runtime
+
 template <typename T>
-inline T trunc(T n) {
+constexpr T trunc(T n) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cx::trunc(n);
     return std::trunc(n);
 }
 
 template <typename T>
-inline T floor(T n) {
+constexpr T floor(T n) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cx::floor(n);
     return std::floor(n);
 }
 
 template <typename T>
-inline T ceil(T n) {
+constexpr T ceil(T n) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cx::ceil(n);
     return std::ceil(n);
 }
 
 template <typename T>
-inline T round(T n) {
+constexpr T round(T n) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cx::round(n);
     return std::round(n);
 }
 
@@ -41,55 +56,79 @@ inline T round(T n) {
 // Warning: NaN becomes 0, Inifinity becomes 1, -Infinity becomes -1
 
 template <typename I, typename T, typename = std::enable_if_t<std::is_integral_v<I>>>
-inline I itrunc(T n) {
+constexpr I itrunc(T n) {
     return (I)n;
 }
 
 template <typename I, typename T, typename = std::enable_if_t<std::is_integral_v<I>>>
-inline I ifloor(T n) {
+constexpr I ifloor(T n) {
     I ni = (I)n;
     return n < ni ? ni - 1 : ni;
 }
 
 template <typename I, typename T, typename = std::enable_if_t<std::is_integral_v<I>>>
-inline I iceil(T n) {
+constexpr I iceil(T n) {
     I ni = (I)n;
     return n > ni ? ni + 1 : ni;
 }
 
 template <typename I, typename T, typename = std::enable_if_t<std::is_integral_v<I>>>
-inline I iround(T n) {
+constexpr I iround(T n) {
     I ni = (I)n;
     return n > 0 ? (n - ni >= 0.5 ? ni + 1 : ni) : (n - ni <= -0.5 ? ni - 1 : ni);
 }
 
 template <typename T, typename = std::enable_if_t<std::is_floating_point_v<T>>>
-inline T sin(T n) {
+constexpr T sqrt(T n) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cx::sqrt(n);
+    return std::sqrt(n);
+}
+
+template <typename T>
+constexpr T lerp(T a, T b, T t) {
+    return a + (b - a) * t;
+}
+
+template <typename T, typename = std::enable_if_t<std::is_floating_point_v<T>>>
+constexpr T sin(T n) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cx::sin(n);
     return std::sin(n);
 }
 
 template <typename T, typename = std::enable_if_t<std::is_floating_point_v<T>>>
-inline T cos(T n) {
+constexpr T cos(T n) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cx::cos(n);
     return std::cos(n);
 }
 
 template <typename T, typename = std::enable_if_t<std::is_floating_point_v<T>>>
-inline T tan(T n) {
+constexpr T tan(T n) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cx::tan(n);
     return std::tan(n);
 }
 
 template <typename T, typename = std::enable_if_t<std::is_floating_point_v<T>>>
-inline T asin(T n) {
+constexpr T asin(T n) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cx::asin(n);
     return std::asin(n);
 }
 
 template <typename T, typename = std::enable_if_t<std::is_floating_point_v<T>>>
-inline T acos(T n) {
+constexpr T acos(T n) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cx::acos(n);
     return std::acos(n);
 }
 
 template <typename T, typename = std::enable_if_t<std::is_floating_point_v<T>>>
-inline T atan(T n) {
+constexpr T atan(T n) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cx::atan(n);
     return std::atan(n);
 }
 
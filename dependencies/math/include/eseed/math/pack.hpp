@@ -0,0 +1,479 @@
+#pragma once
+
+#include "simd.hpp"
+#include "parallel.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+// Fixed-width SIMD packs for writing a batch kernel once and instantiating
+// it at the native width and at width 1 for the loop tail
+// Pack<T, 1> works for any arithmetic T, wider packs only exist for float
+
+namespace esdm {
+
+namespace simd {
+
+template <typename T, size_t W>
+struct Pack;
+
+template <typename T>
+struct Pack<T, 1> {
+    static constexpr size_t width = 1;
+    T v;
+
+    static Pack load(const T *p) {
+        return {*p};
+    }
+
+    static Pack splat(T s) {
+        return {s};
+    }
+
+    void store(T *p) const {
+        *p = v;
+    }
+};
+
+template <typename T>
+inline Pack<T, 1> operator+(Pack<T, 1> a, Pack<T, 1> b) {
+    return {a.v + b.v};
+}
+
+template <typename T>
+inline Pack<T, 1> operator-(Pack<T, 1> a, Pack<T, 1> b) {
+    return {a.v - b.v};
+}
+
+template <typename T>
+inline Pack<T, 1> operator*(Pack<T, 1> a, Pack<T, 1> b) {
+    return {a.v * b.v};
+}
+
+template <typename T>
+inline Pack<T, 1> operator/(Pack<T, 1> a, Pack<T, 1> b) {
+    return {a.v / b.v};
+}
+
+// a * b + c
+template <typename T>
+inline Pack<T, 1> madd(Pack<T, 1> a, Pack<T, 1> b, Pack<T, 1> c) {
+    return {a.v * b.v + c.v};
+}
+
+template <typename T>
+inline Pack<T, 1> sqrt(Pack<T, 1> a) {
+    return {std::sqrt(a.v)};
+}
+
+template <typename T>
+inline Pack<T, 1> min(Pack<T, 1> a, Pack<T, 1> b) {
+    return {std::min(a.v, b.v)};
+}
+
+template <typename T>
+inline Pack<T, 1> max(Pack<T, 1> a, Pack<T, 1> b) {
+    return {std::max(a.v, b.v)};
+}
+
+// The rounding functions below assume |a| < 2^31 for float, the range the
+// SSE2 conversions handle
+
+template <typename T>
+inline Pack<T, 1> floor(Pack<T, 1> a) {
+#if defined(ESDM_SIMD_SSE2)
+    if constexpr (std::is_same_v<T, float>) {
+        float t = float(int32_t(a.v));
+        return {a.v < t ? t - 1.f : t};
+    }
+#endif
+    return {std::floor(a.v)};
+}
+
+// Nearest integer, ties to even
+template <typename T>
+inline Pack<T, 1> round(Pack<T, 1> a) {
+#if defined(ESDM_SIMD_SSE2)
+    if constexpr (std::is_same_v<T, float>)
+        return {float(_mm_cvtss_si32(_mm_set_ss(a.v)))};
+#endif
+    return {std::nearbyint(a.v)};
+}
+
+template <typename T>
+inline Pack<T, 1> abs(Pack<T, 1> a) {
+    return {std::abs(a.v)};
+}
+
+// Magnitude of a with the sign of b
+template <typename T>
+inline Pack<T, 1> copysign(Pack<T, 1> a, Pack<T, 1> b) {
+    return {std::copysign(a.v, b.v)};
+}
+
+// a < b ? x : y per lane
+template <typename T>
+inline Pack<T, 1> selectLess(Pack<T, 1> a, Pack<T, 1> b, Pack<T, 1> x, Pack<T, 1> y) {
+    return {a.v < b.v ? x.v : y.v};
+}
+
+// Bit i set when a < b in lane i
+template <typename T>
+inline uint32_t lessBits(Pack<T, 1> a, Pack<T, 1> b) {
+    return a.v < b.v ? 1u : 0u;
+}
+
+// 2^n for an integral n in the normal exponent range
+template <typename T>
+inline Pack<T, 1> pow2(Pack<T, 1> n) {
+    if constexpr (std::is_same_v<T, float>) {
+        int32_t bits = (int32_t(n.v) + 127) << 23;
+        float out;
+        std::memcpy(&out, &bits, sizeof(out));
+        return {out};
+    } else {
+        return {std::ldexp(T(1), int(n.v))};
+    }
+}
+
+// floor(log2(a)) for a positive normal a
+template <typename T>
+inline Pack<T, 1> exponent(Pack<T, 1> a) {
+    if constexpr (std::is_same_v<T, float>) {
+        int32_t bits;
+        std::memcpy(&bits, &a.v, sizeof(bits));
+        return {float((bits >> 23) & 0xff) - 127.f};
+    } else {
+        return {T(std::ilogb(a.v))};
+    }
+}
+
+// a / 2^exponent(a), in [1, 2) for a positive normal a
+template <typename T>
+inline Pack<T, 1> mantissa(Pack<T, 1> a) {
+    if constexpr (std::is_same_v<T, float>) {
+        int32_t bits;
+        std::memcpy(&bits, &a.v, sizeof(bits));
+        bits = (bits & 0x007fffff) | 0x3f800000;
+        float out;
+        std::memcpy(&out, &bits, sizeof(out));
+        return {out};
+    } else {
+        int e;
+        return {std::frexp(a.v, &e) * T(2)};
+    }
+}
+
+// Hardware estimates of 1 / sqrt(a) and 1 / a, good to about 12 bits on SSE
+// Exact without SSE, so a Newton step on top is harmless either way
+
+template <typename T>
+inline Pack<T, 1> rsqrtEstimate(Pack<T, 1> a) {
+#if defined(ESDM_SIMD_SSE2)
+    if constexpr (std::is_same_v<T, float>)
+        return {_mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(a.v)))};
+#endif
+    return {T(1) / std::sqrt(a.v)};
+}
+
+template <typename T>
+inline Pack<T, 1> rcpEstimate(Pack<T, 1> a) {
+#if defined(ESDM_SIMD_SSE2)
+    if constexpr (std::is_same_v<T, float>)
+        return {_mm_cvtss_f32(_mm_rcp_ss(_mm_set_ss(a.v)))};
+#endif
+    return {T(1) / a.v};
+}
+
+// Stores each lane truncated toward zero
+template <typename T>
+inline void storeTrunc(Pack<T, 1> a, int32_t *p) {
+    *p = int32_t(a.v);
+}
+
+#if defined(ESDM_SIMD_SSE2)
+
+template <>
+struct Pack<float, 4> {
+    static constexpr size_t width = 4;
+    __m128 v;
+
+    static Pack load(const float *p) {
+        return {_mm_loadu_ps(p)};
+    }
+
+    static Pack splat(float s) {
+        return {_mm_set1_ps(s)};
+    }
+
+    void store(float *p) const {
+        _mm_storeu_ps(p, v);
+    }
+};
+
+inline Pack<float, 4> operator+(Pack<float, 4> a, Pack<float, 4> b) {
+    return {_mm_add_ps(a.v, b.v)};
+}
+
+inline Pack<float, 4> operator-(Pack<float, 4> a, Pack<float, 4> b) {
+    return {_mm_sub_ps(a.v, b.v)};
+}
+
+inline Pack<float, 4> operator*(Pack<float, 4> a, Pack<float, 4> b) {
+    return {_mm_mul_ps(a.v, b.v)};
+}
+
+inline Pack<float, 4> operator/(Pack<float, 4> a, Pack<float, 4> b) {
+    return {_mm_div_ps(a.v, b.v)};
+}
+
+inline Pack<float, 4> madd(Pack<float, 4> a, Pack<float, 4> b, Pack<float, 4> c) {
+#if defined(ESDM_SIMD_FMA)
+    return {_mm_fmadd_ps(a.v, b.v, c.v)};
+#else
+    return {_mm_add_ps(_mm_mul_ps(a.v, b.v), c.v)};
+#endif
+}
+
+inline Pack<float, 4> sqrt(Pack<float, 4> a) {
+    return {_mm_sqrt_ps(a.v)};
+}
+
+inline Pack<float, 4> min(Pack<float, 4> a, Pack<float, 4> b) {
+    return {_mm_min_ps(a.v, b.v)};
+}
+
+inline Pack<float, 4> max(Pack<float, 4> a, Pack<float, 4> b) {
+    return {_mm_max_ps(a.v, b.v)};
+}
+
+inline Pack<float, 4> floor(Pack<float, 4> a) {
+#if defined(ESDM_SIMD_SSE41)
+    return {_mm_floor_ps(a.v)};
+#else
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    return {_mm_sub_ps(t, _mm_and_ps(_mm_cmplt_ps(a.v, t), _mm_set1_ps(1.f)))};
+#endif
+}
+
+inline Pack<float, 4> round(Pack<float, 4> a) {
+#if defined(ESDM_SIMD_SSE41)
+    return {_mm_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)};
+#else
+    return {_mm_cvtepi32_ps(_mm_cvtps_epi32(a.v))};
+#endif
+}
+
+inline Pack<float, 4> abs(Pack<float, 4> a) {
+    return {_mm_andnot_ps(_mm_set1_ps(-0.f), a.v)};
+}
+
+inline Pack<float, 4> copysign(Pack<float, 4> a, Pack<float, 4> b) {
+    const __m128 sign = _mm_set1_ps(-0.f);
+    return {_mm_or_ps(_mm_andnot_ps(sign, a.v), _mm_and_ps(sign, b.v))};
+}
+
+inline Pack<float, 4> selectLess(Pack<float, 4> a, Pack<float, 4> b, Pack<float, 4> x, Pack<float, 4> y) {
+    __m128 mask = _mm_cmplt_ps(a.v, b.v);
+#if defined(ESDM_SIMD_SSE41)
+    return {_mm_blendv_ps(y.v, x.v, mask)};
+#else
+    return {_mm_or_ps(_mm_and_ps(mask, x.v), _mm_andnot_ps(mask, y.v))};
+#endif
+}
+
+inline uint32_t lessBits(Pack<float, 4> a, Pack<float, 4> b) {
+    return uint32_t(_mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)));
+}
+
+// (n + 127) * 2^23 is exact in float, and truncating it gives the bits
+inline Pack<float, 4> pow2(Pack<float, 4> n) {
+    __m128 bits = _mm_mul_ps(_mm_add_ps(n.v, _mm_set1_ps(127.f)), _mm_set1_ps(8388608.f));
+    return {_mm_castsi128_ps(_mm_cvttps_epi32(bits))};
+}
+
+inline Pack<float, 4> exponent(Pack<float, 4> a) {
+    __m128 bits = _mm_and_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(0x7f800000)));
+    __m128 e = _mm_cvtepi32_ps(_mm_castps_si128(bits));
+    return {_mm_sub_ps(_mm_mul_ps(e, _mm_set1_ps(1.f / 8388608.f)), _mm_set1_ps(127.f))};
+}
+
+inline Pack<float, 4> mantissa(Pack<float, 4> a) {
+    __m128 bits = _mm_and_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(0x007fffff)));
+    return {_mm_or_ps(bits, _mm_set1_ps(1.f))};
+}
+
+inline Pack<float, 4> rsqrtEstimate(Pack<float, 4> a) {
+    return {_mm_rsqrt_ps(a.v)};
+}
+
+inline Pack<float, 4> rcpEstimate(Pack<float, 4> a) {
+    return {_mm_rcp_ps(a.v)};
+}
+
+inline void storeTrunc(Pack<float, 4> a, int32_t *p) {
+    _mm_storeu_si128((__m128i *)p, _mm_cvttps_epi32(a.v));
+}
+
+#endif
+
+#if defined(ESDM_SIMD_AVX)
+
+template <>
+struct Pack<float, 8> {
+    static constexpr size_t width = 8;
+    __m256 v;
+
+    static Pack load(const float *p) {
+        return {_mm256_loadu_ps(p)};
+    }
+
+    static Pack splat(float s) {
+        return {_mm256_set1_ps(s)};
+    }
+
+    void store(float *p) const {
+        _mm256_storeu_ps(p, v);
+    }
+};
+
+inline Pack<float, 8> operator+(Pack<float, 8> a, Pack<float, 8> b) {
+    return {_mm256_add_ps(a.v, b.v)};
+}
+
+inline Pack<float, 8> operator-(Pack<float, 8> a, Pack<float, 8> b) {
+    return {_mm256_sub_ps(a.v, b.v)};
+}
+
+inline Pack<float, 8> operator*(Pack<float, 8> a, Pack<float, 8> b) {
+    return {_mm256_mul_ps(a.v, b.v)};
+}
+
+inline Pack<float, 8> operator/(Pack<float, 8> a, Pack<float, 8> b) {
+    return {_mm256_div_ps(a.v, b.v)};
+}
+
+inline Pack<float, 8> madd(Pack<float, 8> a, Pack<float, 8> b, Pack<float, 8> c) {
+#if defined(ESDM_SIMD_FMA)
+    return {_mm256_fmadd_ps(a.v, b.v, c.v)};
+#else
+    return {_mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v)};
+#endif
+}
+
+inline Pack<float, 8> sqrt(Pack<float, 8> a) {
+    return {_mm256_sqrt_ps(a.v)};
+}
+
+inline Pack<float, 8> min(Pack<float, 8> a, Pack<float, 8> b) {
+    return {_mm256_min_ps(a.v, b.v)};
+}
+
+inline Pack<float, 8> max(Pack<float, 8> a, Pack<float, 8> b) {
+    return {_mm256_max_ps(a.v, b.v)};
+}
+
+inline Pack<float, 8> floor(Pack<float, 8> a) {
+    return {_mm256_floor_ps(a.v)};
+}
+
+inline Pack<float, 8> round(Pack<float, 8> a) {
+    return {_mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)};
+}
+
+inline Pack<float, 8> abs(Pack<float, 8> a) {
+    return {_mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v)};
+}
+
+inline Pack<float, 8> copysign(Pack<float, 8> a, Pack<float, 8> b) {
+    const __m256 sign = _mm256_set1_ps(-0.f);
+    return {_mm256_or_ps(_mm256_andnot_ps(sign, a.v), _mm256_and_ps(sign, b.v))};
+}
+
+inline Pack<float, 8> selectLess(Pack<float, 8> a, Pack<float, 8> b, Pack<float, 8> x, Pack<float, 8> y) {
+    return {_mm256_blendv_ps(y.v, x.v, _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ))};
+}
+
+inline uint32_t lessBits(Pack<float, 8> a, Pack<float, 8> b) {
+    return uint32_t(_mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)));
+}
+
+// Same float-side bit tricks as the SSE versions, since AVX without AVX2
+// has no 256-bit integer shifts or adds
+inline Pack<float, 8> pow2(Pack<float, 8> n) {
+    __m256 bits = _mm256_mul_ps(_mm256_add_ps(n.v, _mm256_set1_ps(127.f)), _mm256_set1_ps(8388608.f));
+    return {_mm256_castsi256_ps(_mm256_cvttps_epi32(bits))};
+}
+
+inline Pack<float, 8> exponent(Pack<float, 8> a) {
+    __m256 bits = _mm256_and_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(0x7f800000)));
+    __m256 e = _mm256_cvtepi32_ps(_mm256_castps_si256(bits));
+    return {_mm256_sub_ps(_mm256_mul_ps(e, _mm256_set1_ps(1.f / 8388608.f)), _mm256_set1_ps(127.f))};
+}
+
+inline Pack<float, 8> mantissa(Pack<float, 8> a) {
+    __m256 bits = _mm256_and_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(0x007fffff)));
+    return {_mm256_or_ps(bits, _mm256_set1_ps(1.f))};
+}
+
+inline Pack<float, 8> rsqrtEstimate(Pack<float, 8> a) {
+    return {_mm256_rsqrt_ps(a.v)};
+}
+
+inline Pack<float, 8> rcpEstimate(Pack<float, 8> a) {
+    return {_mm256_rcp_ps(a.v)};
+}
+
+inline void storeTrunc(Pack<float, 8> a, int32_t *p) {
+    _mm256_storeu_si256((__m256i *)p, _mm256_cvttps_epi32(a.v));
+}
+
+#endif
+
+// Widest pack available for T in this build
+
+template <typename T>
+struct NativeWidth {
+    static constexpr size_t value = 1;
+};
+
+#if defined(ESDM_SIMD_AVX)
+template <>
+struct NativeWidth<float> {
+    static constexpr size_t value = 8;
+};
+#elif defined(ESDM_SIMD_SSE2)
+template <>
+struct NativeWidth<float> {
+    static constexpr size_t value = 4;
+};
+#endif
+
+template <typename T>
+using NativePack = Pack<T, NativeWidth<T>::value>;
+
+}
+
+// Inputs of at least batchGrain elements per thread are split across threads
+constexpr size_t batchGrain = 1 << 15;
+
+// Runs body(pack, i) over [0, count) with the native SIMD width, finishing
+// each range with width 1, where "pack" is a tag value of the pack type
+template <typename T, typename F>
+void batchFor(size_t count, F &&body) {
+    using P = simd::NativePack<T>;
+    using P1 = simd::Pack<T, 1>;
+    parallelFor(count, batchGrain, [&body](size_t begin, size_t end) {
+        size_t i = begin;
+        for (; i + P::width <= end; i += P::width)
+            body(P{}, i);
+        for (; i < end; i++)
+            body(P1{}, i);
+    }, P::width);
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,358 @@
+#pragma once
+
+#include "vec.hpp"
+#include "parallel.hpp"
+#include "pack.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+// Compact storage types for vertex and voxel data, laid out like the Vulkan
+// formats they are read through:
+//   F16            VK_FORMAT_R16_SFLOAT (Vec2<F16> R16G16_SFLOAT, ...)
+//   UNorm8         VK_FORMAT_R8_UNORM   (Vec4<UNorm8> R8G8B8A8_UNORM)
+//   SNorm8         VK_FORMAT_R8_SNORM
+//   UNorm16        VK_FORMAT_R16_UNORM
+//   SNorm16        VK_FORMAT_R16_SNORM  (Vec2<SNorm16> R16G16_SNORM)
+//
+// They convert implicitly to and from float, one at a time, and in bulk
+// with convert(in, out, count), which uses F16C for halves and SSE2 / AVX2
+// for the normalized types. Both give bit-identical results.
+
+namespace esdm {
+
+// IEEE 754 binary16, converted with round to nearest even
+class F16 {
+public:
+    uint16_t bits;
+
+    constexpr F16() : bits(0) {}
+
+    F16(float f) : bits(fromFloat(f)) {}
+
+    static constexpr F16 fromBits(uint16_t bits) {
+        F16 out;
+        out.bits = bits;
+        return out;
+    }
+
+    operator float() const {
+        return toFloat(bits);
+    }
+
+    // Overflow gives infinity, NaN payloads are kept as far as they fit, the
+    // way F16C converts
+    static uint16_t fromFloat(float f) {
+        uint32_t u;
+        std::memcpy(&u, &f, 4);
+        const uint32_t sign = (u >> 16) & 0x8000;
+        u &= 0x7FFFFFFF;
+
+        uint32_t h;
+        if (u >= 0x47800000) {
+            // 2^16 and up, infinity and NaN
+            h = u > 0x7F800000 ? 0x7E00 | ((u >> 13) & 0x3FF) : 0x7C00;
+        } else if (u < 0x38800000) {
+            // Below 2^-14, subnormal or zero: adding 0.5 lines the 10 bits up
+            // at the bottom of the mantissa, with the float add doing the
+            // rounding
+            float a;
+            std::memcpy(&a, &u, 4);
+            a += 0.5f;
+            std::memcpy(&h, &a, 4);
+            h -= 0x3F000000;
+        } else {
+            // Rebias the exponent and round to nearest even in the integer
+            // add, a carry out of the mantissa correctly bumping the exponent
+            const uint32_t odd = (u >> 13) & 1;
+            h = (u - 0x38000000 + 0xFFF + odd) >> 13;
+        }
+        return uint16_t(h | sign);
+    }
+
+    static float toFloat(uint16_t h) {
+        const uint32_t exponent = h & 0x7C00;
+        uint32_t u = uint32_t(h & 0x7FFF) << 13;
+        if (exponent == 0x7C00) {
+            // Infinity, or NaN made quiet
+            u += 0x70000000;
+            if (u & 0x7FFFFF)
+                u |= 0x400000;
+        } else if (exponent == 0) {
+            // Subnormal or zero, renormalized by a float subtract
+            u += 0x38800000;
+            float f;
+            std::memcpy(&f, &u, 4);
+            f -= 6.103515625e-05f;
+            std::memcpy(&u, &f, 4);
+        } else {
+            u += 0x38000000;
+        }
+        u |= uint32_t(h & 0x8000) << 16;
+        float f;
+        std::memcpy(&f, &u, 4);
+        return f;
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, F16 h) {
+        return out << float(h);
+    }
+};
+
+namespace detail {
+
+// Nearest integer, ties to even like the SSE conversions, for |v| < 2^31
+constexpr int32_t roundEven(float v) {
+    const float t = trunc(v);
+    const float d = v - t;
+    int32_t i = int32_t(t);
+    if (d > 0.5f || (d == 0.5f && i % 2 != 0))
+        i++;
+    else if (d < -0.5f || (d == -0.5f && i % 2 != 0))
+        i--;
+    return i;
+}
+
+}
+
+// Fixed point in [0, 1] (unsigned I) or [-1, 1] (signed I), using the
+// Vulkan conversion rules: floats are clamped and rounded to nearest, NaN
+// becomes 0, and the most negative signed value reads as -1 like the one
+// above it
+template <typename I>
+class Normalized {
+public:
+    static_assert(std::is_integral_v<I> && sizeof(I) <= 2, "Normalized needs an 8 or 16 bit integer");
+
+    static constexpr float scale = float(std::numeric_limits<I>::max());
+    static constexpr float lowest = std::is_signed_v<I> ? -1.f : 0.f;
+
+    I bits;
+
+    constexpr Normalized() : bits(0) {}
+
+    constexpr Normalized(float f) : bits(fromFloat(f)) {}
+
+    static constexpr Normalized fromBits(I bits) {
+        Normalized out;
+        out.bits = bits;
+        return out;
+    }
+
+    constexpr operator float() const {
+        return toFloat(bits);
+    }
+
+    // Written as the compares the SIMD min / max / and instructions make, so
+    // the bulk conversions give the same bits
+    static constexpr I fromFloat(float f) {
+        float v = f == f ? f : 0.f;
+        v = v > lowest ? v : lowest;
+        v = v < 1.f ? v : 1.f;
+        return I(detail::roundEven(v * scale));
+    }
+
+    static constexpr float toFloat(I bits) {
+        const float f = float(bits) / scale;
+        return f > lowest ? f : lowest;
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, Normalized n) {
+        return out << float(n);
+    }
+};
+
+using UNorm8 = Normalized<uint8_t>;
+using SNorm8 = Normalized<int8_t>;
+using UNorm16 = Normalized<uint16_t>;
+using SNorm16 = Normalized<int16_t>;
+
+// Bulk conversion
+// out[i] = in[i] converted, threaded like the VecBatch kernels
+
+namespace detail {
+
+// Runs fn(begin, end) over [0, count) on one or more threads, each range
+// but the last a multiple of 32 elements
+template <typename F>
+inline void convertRanges(size_t count, F &&fn) {
+    parallelFor(count, batchGrain, fn, 32);
+}
+
+}
+
+// Any pair of float and the types above, element by element
+template <typename From, typename To>
+inline void convert(const From *in, To *out, size_t count) {
+    detail::convertRanges(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            out[i] = To(float(in[i]));
+    });
+}
+
+inline void convert(const float *in, F16 *out, size_t count) {
+    detail::convertRanges(count, [&](size_t begin, size_t end) {
+        size_t i = begin;
+#if defined(ESDM_SIMD_F16C)
+        for (; i + 8 <= end; i += 8)
+            _mm_storeu_si128((__m128i *)(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+        for (; i < end; i++)
+            out[i] = F16(in[i]);
+    });
+}
+
+inline void convert(const F16 *in, float *out, size_t count) {
+    detail::convertRanges(count, [&](size_t begin, size_t end) {
+        size_t i = begin;
+#if defined(ESDM_SIMD_F16C)
+        for (; i + 8 <= end; i += 8)
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(in + i))));
+#endif
+        for (; i < end; i++)
+            out[i] = float(in[i]);
+    });
+}
+
+inline void convert(const float *in, UNorm8 *out, size_t count) {
+    detail::convertRanges(count, [&](size_t begin, size_t end) {
+        size_t i = begin;
+#if defined(ESDM_SIMD_AVX2)
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.f);
+        const __m256 scale = _mm256_set1_ps(UNorm8::scale);
+        for (; i + 32 <= end; i += 32) {
+            __m256i n[4];
+            for (size_t j = 0; j < 4; j++) {
+                const __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i + j * 8), zero), one);
+                n[j] = _mm256_cvtps_epi32(_mm256_mul_ps(v, scale));
+            }
+            // The packs work within 128 bit halves, leaving 4 byte groups
+            // in the order 0 2 4 6 1 3 5 7
+            const __m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(n[0], n[1]), _mm256_packs_epi32(n[2], n[3]));
+            _mm256_storeu_si256((__m256i *)(out + i), _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+        }
+#elif defined(ESDM_SIMD_SSE2)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 scale = _mm_set1_ps(UNorm8::scale);
+        for (; i + 16 <= end; i += 16) {
+            __m128i n[4];
+            for (size_t j = 0; j < 4; j++) {
+                const __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + j * 4), zero), one);
+                n[j] = _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+            }
+            const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(n[0], n[1]), _mm_packs_epi32(n[2], n[3]));
+            _mm_storeu_si128((__m128i *)(out + i), bytes);
+        }
+#endif
+        for (; i < end; i++)
+            out[i] = UNorm8(in[i]);
+    });
+}
+
+inline void convert(const UNorm8 *in, float *out, size_t count) {
+    detail::convertRanges(count, [&](size_t begin, size_t end) {
+        size_t i = begin;
+#if defined(ESDM_SIMD_AVX2)
+        const __m256 scale = _mm256_set1_ps(UNorm8::scale);
+        for (; i + 8 <= end; i += 8) {
+            const __m256i n = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(in + i)));
+            _mm256_storeu_ps(out + i, _mm256_div_ps(_mm256_cvtepi32_ps(n), scale));
+        }
+#elif defined(ESDM_SIMD_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 scale = _mm_set1_ps(UNorm8::scale);
+        for (; i + 16 <= end; i += 16) {
+            const __m128i bytes = _mm_loadu_si128((const __m128i *)(in + i));
+            const __m128i words[2] = { _mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero) };
+            for (size_t j = 0; j < 2; j++) {
+                _mm_storeu_ps(out + i + j * 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words[j], zero)), scale));
+                _mm_storeu_ps(out + i + j * 8 + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words[j], zero)), scale));
+            }
+        }
+#endif
+        for (; i < end; i++)
+            out[i] = float(in[i]);
+    });
+}
+
+inline void convert(const float *in, SNorm16 *out, size_t count) {
+    detail::convertRanges(count, [&](size_t begin, size_t end) {
+        size_t i = begin;
+#if defined(ESDM_SIMD_AVX2)
+        const __m256 minusOne = _mm256_set1_ps(-1.f);
+        const __m256 one = _mm256_set1_ps(1.f);
+        const __m256 scale = _mm256_set1_ps(SNorm16::scale);
+        for (; i + 16 <= end; i += 16) {
+            __m256i n[2];
+            for (size_t j = 0; j < 2; j++) {
+                __m256 v = _mm256_loadu_ps(in + i + j * 8);
+                v = _mm256_and_ps(v, _mm256_cmp_ps(v, v, _CMP_ORD_Q));
+                v = _mm256_min_ps(_mm256_max_ps(v, minusOne), one);
+                n[j] = _mm256_cvtps_epi32(_mm256_mul_ps(v, scale));
+            }
+            // Undo the per 128 bit half interleave of the pack
+            _mm256_storeu_si256((__m256i *)(out + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(n[0], n[1]), 0xD8));
+        }
+#elif defined(ESDM_SIMD_SSE2)
+        const __m128 minusOne = _mm_set1_ps(-1.f);
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 scale = _mm_set1_ps(SNorm16::scale);
+        for (; i + 8 <= end; i += 8) {
+            __m128i n[2];
+            for (size_t j = 0; j < 2; j++) {
+                __m128 v = _mm_loadu_ps(in + i + j * 4);
+                v = _mm_and_ps(v, _mm_cmpord_ps(v, v));
+                v = _mm_min_ps(_mm_max_ps(v, minusOne), one);
+                n[j] = _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+            }
+            _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(n[0], n[1]));
+        }
+#endif
+        for (; i < end; i++)
+            out[i] = SNorm16(in[i]);
+    });
+}
+
+inline void convert(const SNorm16 *in, float *out, size_t count) {
+    detail::convertRanges(count, [&](size_t begin, size_t end) {
+        size_t i = begin;
+#if defined(ESDM_SIMD_AVX2)
+        const __m256 minusOne = _mm256_set1_ps(-1.f);
+        const __m256 scale = _mm256_set1_ps(SNorm16::scale);
+        for (; i + 8 <= end; i += 8) {
+            const __m256i n = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(in + i)));
+            _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_div_ps(_mm256_cvtepi32_ps(n), scale), minusOne));
+        }
+#elif defined(ESDM_SIMD_SSE2)
+        const __m128 minusOne = _mm_set1_ps(-1.f);
+        const __m128 scale = _mm_set1_ps(SNorm16::scale);
+        for (; i + 8 <= end; i += 8) {
+            const __m128i words = _mm_loadu_si128((const __m128i *)(in + i));
+            // Sign extend by shifting each word down from the top half
+            const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+            const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+            _mm_storeu_ps(out + i, _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(lo), scale), minusOne));
+            _mm_storeu_ps(out + i + 4, _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(hi), scale), minusOne));
+        }
+#endif
+        for (; i < end; i++)
+            out[i] = float(in[i]);
+    });
+}
+
+// Vec arrays, component by component, e.g. Vec4<float> colors to the
+// Vec4<UNorm8> a R8G8B8A8_UNORM attribute reads
+// Vec3<float> is padded in SIMD builds, so it can't be converted this way
+template <size_t L, typename From, typename To>
+inline void convert(const Vec<L, From> *in, Vec<L, To> *out, size_t count) {
+    static_assert(sizeof(Vec<L, From>) == L * sizeof(From) && sizeof(Vec<L, To>) == L * sizeof(To), "Vec components must be tightly packed");
+    convert(reinterpret_cast<const From *>(in), reinterpret_cast<To *>(out), count * L);
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace esdm {
+
+// Cached, since hardware_concurrency can cost microseconds per call
+inline size_t hardwareThreadCount() {
+    static const size_t count = std::max<size_t>(1, std::thread::hardware_concurrency());
+    return count;
+}
+
+namespace detail {
+
+// Worker threads kept alive for parallelFor, one less than the hardware
+// threads since the calling thread works too. Started on first use.
+class WorkerPool {
+public:
+    static WorkerPool &instance() {
+        static WorkerPool pool(hardwareThreadCount() - 1);
+        return pool;
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    size_t getWorkerCount() const {
+        return threads.size();
+    }
+
+    // Calls task(k) for every k in [0, count), on the workers and the
+    // calling thread. Returns false without calling anything if the pool is
+    // already running a job, e.g. for a parallelFor inside a parallelFor.
+    // If a task throws, the ones not yet started are skipped, and the first
+    // exception is rethrown here once every running task has finished.
+    template <typename F>
+    bool run(size_t count, F &task) {
+        std::unique_lock<std::mutex> runLock(runMutex, std::try_to_lock);
+        if (!runLock.owns_lock())
+            return false;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            invoke = [](void *context, size_t k) { (*static_cast<F *>(context))(k); };
+            context = &task;
+            taskCount = count;
+            next.store(0, std::memory_order_relaxed);
+            busy = threads.size();
+            generation++;
+        }
+        wake.notify_all();
+
+        work();
+
+        // The task lives on this stack, so wait for every worker to let go
+        std::exception_ptr thrown;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&] { return busy == 0; });
+            std::swap(thrown, error);
+        }
+        if (thrown)
+            std::rethrow_exception(thrown);
+        return true;
+    }
+
+private:
+    // Held for the whole of a run()
+    std::mutex runMutex;
+
+    // Guards the job, busy and error
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation = 0;
+    bool stopping = false;
+    void (*invoke)(void *, size_t) = nullptr;
+    void *context = nullptr;
+    size_t taskCount = 0;
+    // Workers still on the current job
+    size_t busy = 0;
+    // First exception a task of the current job threw
+    std::exception_ptr error;
+
+    std::atomic<size_t> next { 0 };
+
+    std::vector<std::thread> threads;
+
+    explicit WorkerPool(size_t workerCount) {
+        for (size_t i = 0; i < workerCount; i++)
+            threads.emplace_back([this] { loop(); });
+    }
+
+    void work() {
+        for (size_t k; (k = next.fetch_add(1, std::memory_order_relaxed)) < taskCount;) {
+            try {
+                invoke(context, k);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+                next.store(taskCount, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void loop() {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+
+            work();
+
+            bool last;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                last = --busy == 0;
+            }
+            if (last)
+                done.notify_one();
+        }
+    }
+};
+
+}
+
+// Splits [0, count) into contiguous ranges of at least "grain" elements and
+// calls fn(begin, end) for each, one range per hardware thread, spread over
+// a pool of persistent workers and the calling thread. Every range except
+// the last starts and ends on a multiple of "align", so SIMD loops only ever
+// see one tail.
+// Small inputs run inline without waking anything, as do calls made while
+// the pool is busy (from inside fn, or from another thread at once).
+// An exception from fn reaches the caller, after the other ranges already
+// running have finished; ranges not yet started are skipped.
+template <typename F>
+void parallelFor(size_t count, size_t grain, F &&fn, size_t align = 1) {
+    size_t threadCount = hardwareThreadCount();
+    size_t rangeCount = std::min(threadCount, count / std::max<size_t>(grain, 1));
+    if (rangeCount <= 1) {
+        fn(size_t(0), count);
+        return;
+    }
+
+    size_t rangeSize = (count + rangeCount - 1) / rangeCount;
+    rangeSize = (rangeSize + align - 1) / align * align;
+    rangeCount = (count + rangeSize - 1) / rangeSize;
+
+    auto range = [&](size_t k) {
+        size_t begin = k * rangeSize;
+        fn(begin, std::min(count, begin + rangeSize));
+    };
+    if (!detail::WorkerPool::instance().run(rangeCount, range))
+        fn(size_t(0), count);
+}
+
+}
\ No newline at end of file
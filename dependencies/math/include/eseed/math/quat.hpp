@@ -0,0 +1,243 @@
+#pragma once
+
+#include "mat.hpp"
+
+namespace esdm {
+
+template <typename T>
+class Quat;
+
+template <typename T>
+constexpr Vec3<T> rotate(const Quat<T> &q, const Vec3<T> &v);
+
+template <typename T>
+constexpr Mat3<T> toMat3(const Quat<T> &q);
+
+template <typename T>
+constexpr Mat4<T> toMat4(const Quat<T> &q);
+
+// Rotation quaternion stored as [ x, y, z, w ], w being the scalar part
+// Shares VecData with Vec4, so Quat<float> is a single __m128 on SSE
+//
+// Rotations follow matRotate: toMat4(quatRotate(axis, angle)) equals
+// matRotate(axis, angle). Since matrices here transform row vectors
+// (v * m), b * a applies a first, matching matmul(toMat4(a), toMat4(b)).
+template <typename T>
+class Quat : public VecData<4, T> {
+public:
+    // Identity rotation: [ 0, 0, 0, 1 ]
+    constexpr Quat() : VecData<4, T>{T(0), T(0), T(0), T(1)} {}
+
+    constexpr Quat(T x, T y, T z, T w) : VecData<4, T>{x, y, z, w} {}
+
+    // Rotation of "angle" radians around a unit length axis
+    constexpr Quat(const Vec3<T> &axis, T angle) : VecData<4, T>{T(0), T(0), T(0), T(1)} {
+        const T s = sin(angle / T(2));
+        this->data[0] = axis[0] * s;
+        this->data[1] = axis[1] * s;
+        this->data[2] = axis[2] * s;
+        this->data[3] = cos(angle / T(2));
+    }
+
+    constexpr Vec3<T> rotate(const Vec3<T> &v) const {
+        using esdm::rotate;
+        return rotate(*this, v);
+    }
+
+    constexpr Mat3<T> toMat3() const {
+        using esdm::toMat3;
+        return toMat3(*this);
+    }
+
+    constexpr Mat4<T> toMat4() const {
+        using esdm::toMat4;
+        return toMat4(*this);
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const Quat &q) {
+        return out << "[" << q.data[0] << ", " << q.data[1] << ", " << q.data[2] << ", " << q.data[3] << "]";
+    }
+};
+
+template <typename T>
+constexpr Quat<T> quatRotate(const Vec3<T> &axis, T angle) {
+    return Quat<T>(axis, angle);
+}
+
+// Applies the x rotation, then y, then z (around the fixed axes), same as
+// quatRotate(Z, angles.z) * quatRotate(Y, angles.y) * quatRotate(X, angles.x)
+template <typename T>
+constexpr Quat<T> quatEuler(const Vec3<T> &angles) {
+    const T cx = cos(angles[0] / T(2)), sx = sin(angles[0] / T(2));
+    const T cy = cos(angles[1] / T(2)), sy = sin(angles[1] / T(2));
+    const T cz = cos(angles[2] / T(2)), sz = sin(angles[2] / T(2));
+    return Quat<T>(
+        sx * cy * cz - cx * sy * sz,
+        cx * sy * cz + sx * cy * sz,
+        cx * cy * sz - sx * sy * cz,
+        cx * cy * cz + sx * sy * sz
+    );
+}
+
+// Rotation of a matrix laid out like toMat3 (orthonormal, determinant 1),
+// with w >= 0
+// Solves for the largest of |x|, |y|, |z|, |w| first (Shepperd's method)
+// and divides the off-diagonal terms by it, so it stays accurate near 180
+// degree rotations. Every candidate is 2 * pivot * q, leaving one sqrt and
+// one divide whichever pivot wins.
+template <typename T>
+constexpr Quat<T> quatFromMat3(const Mat3<T> &m) {
+    const auto &d = m.data;
+    // 4w^2, 4x^2, 4y^2, 4z^2
+    const T sw = T(1) + d[0][0] + d[1][1] + d[2][2];
+    const T sx = T(1) + d[0][0] - d[1][1] - d[2][2];
+    const T sy = T(1) - d[0][0] + d[1][1] - d[2][2];
+    const T sz = T(1) - d[0][0] - d[1][1] + d[2][2];
+    // 4xw, 4yw, 4zw, 4xy, 4xz, 4yz
+    const T xw = d[1][2] - d[2][1], yw = d[2][0] - d[0][2], zw = d[0][1] - d[1][0];
+    const T xy = d[0][1] + d[1][0], xz = d[0][2] + d[2][0], yz = d[1][2] + d[2][1];
+
+    T s = sw;
+    Quat<T> q(xw, yw, zw, sw);
+    if (s < sx) {
+        s = sx;
+        q = Quat<T>(sx, xy, xz, xw);
+    }
+    if (s < sy) {
+        s = sy;
+        q = Quat<T>(xy, sy, yz, yw);
+    }
+    if (s < sz) {
+        s = sz;
+        q = Quat<T>(xz, yz, sz, zw);
+    }
+
+    T r = T(0.5) / sqrt(s);
+    if (q.data[3] < T(0))
+        r = -r;
+    return Quat<T>(q.data[0] * r, q.data[1] * r, q.data[2] * r, q.data[3] * r);
+}
+
+// Functions
+
+// Hamilton product: the rotation b followed by a
+template <typename T>
+constexpr Quat<T> operator*(const Quat<T> &a, const Quat<T> &b) {
+    const auto &p = a.data;
+    const auto &q = b.data;
+    return Quat<T>(
+        p[3] * q[0] + p[0] * q[3] + p[1] * q[2] - p[2] * q[1],
+        p[3] * q[1] - p[0] * q[2] + p[1] * q[3] + p[2] * q[0],
+        p[3] * q[2] + p[0] * q[1] - p[1] * q[0] + p[2] * q[3],
+        p[3] * q[3] - p[0] * q[0] - p[1] * q[1] - p[2] * q[2]
+    );
+}
+
+template <typename T>
+constexpr Quat<T> &operator*=(Quat<T> &a, const Quat<T> &b) {
+    return a = a * b;
+}
+
+template <typename T>
+constexpr T dot(const Quat<T> &a, const Quat<T> &b) {
+    return a.data[0] * b.data[0] + a.data[1] * b.data[1] + a.data[2] * b.data[2] + a.data[3] * b.data[3];
+}
+
+template <typename T>
+constexpr T length(const Quat<T> &q) {
+    return sqrt(dot(q, q));
+}
+
+template <typename T>
+constexpr Quat<T> normalize(const Quat<T> &q) {
+    const T rcp = T(1) / length(q);
+    return Quat<T>(q.data[0] * rcp, q.data[1] * rcp, q.data[2] * rcp, q.data[3] * rcp);
+}
+
+template <typename T>
+constexpr Quat<T> conjugate(const Quat<T> &q) {
+    return Quat<T>(-q.data[0], -q.data[1], -q.data[2], q.data[3]);
+}
+
+// Same as conjugate for unit quaternions
+template <typename T>
+constexpr Quat<T> inverse(const Quat<T> &q) {
+    const T rcp = T(1) / dot(q, q);
+    return Quat<T>(-q.data[0] * rcp, -q.data[1] * rcp, -q.data[2] * rcp, q.data[3] * rcp);
+}
+
+// v + 2w(u x v) + 2u x (u x v), for a unit quaternion [ u, w ]
+template <typename T>
+constexpr Vec3<T> rotate(const Quat<T> &q, const Vec3<T> &v) {
+    const Vec3<T> u(q.data[0], q.data[1], q.data[2]);
+    const Vec3<T> t = cross(u, v) * T(2);
+    return v + t * q.data[3] + cross(u, t);
+}
+
+// Upper 3x3 of toMat4, laid out like matRotate
+template <typename T>
+constexpr Mat3<T> toMat3(const Quat<T> &q) {
+    const T x = q.data[0], y = q.data[1], z = q.data[2], w = q.data[3];
+    const T xx = x * x, yy = y * y, zz = z * z;
+    const T xy = x * y, xz = x * z, yz = y * z;
+    const T wx = w * x, wy = w * y, wz = w * z;
+    return Mat3<T>(
+        T(1) - T(2) * (yy + zz), T(2) * (xy + wz), T(2) * (xz - wy),
+        T(2) * (xy - wz), T(1) - T(2) * (xx + zz), T(2) * (yz + wx),
+        T(2) * (xz + wy), T(2) * (yz - wx), T(1) - T(2) * (xx + yy)
+    );
+}
+
+template <typename T>
+constexpr Mat4<T> toMat4(const Quat<T> &q) {
+    const Mat3<T> r = toMat3(q);
+    Mat4<T> out(T(1));
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+            out.data[i][j] = r.data[i][j];
+    return out;
+}
+
+// Normalized linear interpolation along the shortest arc
+// Much cheaper than slerp, but the angular speed isn't constant (the
+// error peaks at t = 0.25 / 0.75 and grows with the angle between a and b)
+template <typename T>
+constexpr Quat<T> nlerp(const Quat<T> &a, const Quat<T> &b, T t) {
+    const T tb = dot(a, b) < T(0) ? -t : t;
+    const T ta = T(1) - t;
+    return normalize(Quat<T>(
+        a.data[0] * ta + b.data[0] * tb,
+        a.data[1] * ta + b.data[1] * tb,
+        a.data[2] * ta + b.data[2] * tb,
+        a.data[3] * ta + b.data[3] * tb
+    ));
+}
+
+// Spherical linear interpolation along the shortest arc
+// Nearly parallel inputs fall back to nlerp, where the two are equivalent
+template <typename T>
+constexpr Quat<T> slerp(const Quat<T> &a, const Quat<T> &b, T t) {
+    T cosAngle = dot(a, b);
+    T sign = T(1);
+    if (cosAngle < T(0)) {
+        cosAngle = -cosAngle;
+        sign = T(-1);
+    }
+    if (cosAngle > T(0.9995))
+        return nlerp(a, b, t);
+
+    const T angle = acos(cosAngle);
+    const T rcpSin = T(1) / sqrt(T(1) - cosAngle * cosAngle);
+    const T ta = sin((T(1) - t) * angle) * rcpSin;
+    const T tb = sin(t * angle) * rcpSin * sign;
+    return Quat<T>(
+        a.data[0] * ta + b.data[0] * tb,
+        a.data[1] * ta + b.data[1] * tb,
+        a.data[2] * ta + b.data[2] * tb,
+        a.data[3] * ta + b.data[3] * tb
+    );
+}
+
+}
+
+#include "quatsimd.hpp"
\ No newline at end of file
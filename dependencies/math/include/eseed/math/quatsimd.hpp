@@ -0,0 +1,85 @@
+#pragma once
+
+#include "quat.hpp"
+
+// SIMD overloads for Quat<float>, see vecsimd.hpp for how these take
+// priority over the generic templates
+
+#if defined(ESDM_SIMD_SSE2)
+
+namespace esdm {
+
+namespace simd {
+
+inline Quat<float> toQuat(__m128 v) {
+    Quat<float> out;
+    out.simd = v;
+    return out;
+}
+
+// Hamilton product as four broadcast multiply-adds over shuffled,
+// sign-flipped copies of b
+inline __m128 quatMul(__m128 a, __m128 b) {
+    __m128 out = _mm_mul_ps(splat<3>(a), b);
+    out = madd(splat<0>(a), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3)), _mm_setr_ps(0.f, -0.f, 0.f, -0.f)), out);
+    out = madd(splat<1>(a), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)), _mm_setr_ps(0.f, 0.f, -0.f, -0.f)), out);
+    return madd(splat<2>(a), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)), _mm_setr_ps(-0.f, 0.f, 0.f, -0.f)), out);
+}
+
+inline __m128 quatNormalize(__m128 q) {
+    return _mm_div_ps(q, _mm_sqrt_ps(_mm_set1_ps(hsum(_mm_mul_ps(q, q)))));
+}
+
+}
+
+constexpr Quat<float> operator*(const Quat<float> &a, const Quat<float> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator*<float>(a, b);
+    return simd::toQuat(simd::quatMul(a.simd, b.simd));
+}
+
+constexpr Quat<float> &operator*=(Quat<float> &a, const Quat<float> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator*=<float>(a, b);
+    a.simd = simd::quatMul(a.simd, b.simd);
+    return a;
+}
+
+constexpr float dot(const Quat<float> &a, const Quat<float> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return dot<float>(a, b);
+    return simd::hsum(_mm_mul_ps(a.simd, b.simd));
+}
+
+constexpr Quat<float> normalize(const Quat<float> &q) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return normalize<float>(q);
+    return simd::toQuat(simd::quatNormalize(q.simd));
+}
+
+constexpr Quat<float> conjugate(const Quat<float> &q) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return conjugate<float>(q);
+    return simd::toQuat(_mm_xor_ps(q.simd, _mm_setr_ps(-0.f, -0.f, -0.f, 0.f)));
+}
+
+constexpr Vec3<float> rotate(const Quat<float> &q, const Vec3<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return rotate<float>(q, v);
+    // The Vec3 pad lane must stay 0, so w is masked out of u
+    const Vec3<float> u = simd::toVec3(simd::maskXyz(q.simd));
+    const Vec3<float> t = cross(u, v) * 2.f;
+    return simd::toVec3(simd::madd(t.simd, simd::splat<3>(q.simd), v.simd)) + cross(u, t);
+}
+
+constexpr Quat<float> nlerp(const Quat<float> &a, const Quat<float> &b, float t) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return nlerp<float>(a, b, t);
+    const __m128 tb = _mm_set1_ps(dot(a, b) < 0.f ? -t : t);
+    const __m128 out = simd::madd(b.simd, tb, _mm_mul_ps(a.simd, _mm_set1_ps(1.f - t)));
+    return simd::toQuat(simd::quatNormalize(out));
+}
+
+}
+
+#endif
\ No newline at end of file
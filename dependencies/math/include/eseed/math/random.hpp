@@ -0,0 +1,573 @@
+#pragma once
+
+#include "fastops.hpp"
+#include "vec.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Random number generators
+//
+// Philox4x32-10 (Salmon et al., Random123) and Squares (Widynski) are
+// counter-based: number n of a stream is a pure function of (key, n), so
+// any range can be computed on any thread, and jumping ahead is free. The
+// fill functions rely on that, and give the same output whatever the
+// thread count or how the range is split. Philox fills run 4 (SSE2) or 8
+// (AVX2) counter blocks at a time.
+//
+// Xoshiro256++ (Blackman and Vigna) is a small, fast sequential generator,
+// split into per-thread streams with jump() (2^128 numbers apart) or
+// longJump() (2^192).
+//
+// All three are UniformRandomBitGenerators, usable with <random>
+// distributions as well as with uniform / randomUnitVec3 / randomInSphere
+
+namespace esdm {
+
+namespace rng {
+
+namespace detail {
+
+constexpr uint32_t philoxM0 = 0xD2511F53;
+constexpr uint32_t philoxM1 = 0xCD9E8D57;
+constexpr uint32_t philoxW0 = 0x9E3779B9;
+constexpr uint32_t philoxW1 = 0xBB67AE85;
+
+constexpr uint64_t splitMix64(uint64_t &state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+}
+
+constexpr uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+}
+
+class Philox {
+public:
+    using result_type = uint32_t;
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    // Streams of one seed are independent sequences of 2^66 numbers
+    constexpr explicit Philox(uint64_t seed = 0, uint64_t stream = 0) :
+        key{ uint32_t(seed), uint32_t(seed >> 32) },
+        stream{ uint32_t(stream), uint32_t(stream >> 32) } {}
+
+    // Numbers 4n to 4n + 3 of the stream
+    constexpr std::array<uint32_t, 4> block(uint64_t n) const {
+        uint32_t c0 = uint32_t(n);
+        uint32_t c1 = uint32_t(n >> 32);
+        uint32_t c2 = stream[0];
+        uint32_t c3 = stream[1];
+        uint32_t k0 = key[0];
+        uint32_t k1 = key[1];
+        for (int round = 0; round < 10; round++) {
+            const uint64_t p0 = uint64_t(detail::philoxM0) * c0;
+            const uint64_t p1 = uint64_t(detail::philoxM1) * c2;
+            c0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+            c1 = uint32_t(p1);
+            c2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+            c3 = uint32_t(p0);
+            k0 += detail::philoxW0;
+            k1 += detail::philoxW1;
+        }
+        return { c0, c1, c2, c3 };
+    }
+
+    // Number "index" of the stream
+    constexpr uint32_t at(uint64_t index) const {
+        return block(index / 4)[index % 4];
+    }
+
+    // The same seed on another stream
+    constexpr Philox withStream(uint64_t s) const {
+        return Philox(uint64_t(key[0]) | uint64_t(key[1]) << 32, s);
+    }
+
+    // Sequential use, starting at index 0
+
+    uint32_t operator()() {
+        const uint64_t n = position / 4;
+        if (n != cachedBlock) {
+            cache = block(n);
+            cachedBlock = n;
+        }
+        return cache[position++ % 4];
+    }
+
+    void discard(uint64_t count) {
+        position += count;
+    }
+
+    void seek(uint64_t index) {
+        position = index;
+    }
+
+    uint64_t getPosition() const {
+        return position;
+    }
+
+    friend constexpr bool operator==(const Philox &a, const Philox &b) {
+        return a.key[0] == b.key[0] && a.key[1] == b.key[1] && a.stream[0] == b.stream[0] && a.stream[1] == b.stream[1] && a.position == b.position;
+    }
+
+    friend constexpr bool operator!=(const Philox &a, const Philox &b) {
+        return !(a == b);
+    }
+
+    uint32_t key[2];
+    uint32_t stream[2];
+
+private:
+    uint64_t position = 0;
+    uint64_t cachedBlock = std::numeric_limits<uint64_t>::max();
+    std::array<uint32_t, 4> cache{};
+};
+
+// Squares is cheaper than Philox per number in scalar code but needs 64
+// bit multiplies, which x86 SIMD lacks before AVX-512
+class Squares {
+public:
+    using result_type = uint32_t;
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    // Scrambles seed into a key; the key needs to be irregular, which small
+    // seeds like 0, 1, 2 aren't
+    constexpr explicit Squares(uint64_t seed = 0) : key(0) {
+        uint64_t state = seed;
+        key = detail::splitMix64(state) | 1;
+    }
+
+    constexpr uint32_t at(uint64_t index) const {
+        uint64_t x = index * key;
+        const uint64_t y = x;
+        const uint64_t z = y + key;
+        x = x * x + y;
+        x = (x >> 32) | (x << 32);
+        x = x * x + z;
+        x = (x >> 32) | (x << 32);
+        x = x * x + y;
+        x = (x >> 32) | (x << 32);
+        return uint32_t((x * x + z) >> 32);
+    }
+
+    uint32_t operator()() {
+        return at(position++);
+    }
+
+    void discard(uint64_t count) {
+        position += count;
+    }
+
+    void seek(uint64_t index) {
+        position = index;
+    }
+
+    uint64_t getPosition() const {
+        return position;
+    }
+
+    uint64_t key;
+
+private:
+    uint64_t position = 0;
+};
+
+class Xoshiro256pp {
+public:
+    using result_type = uint64_t;
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    // State from SplitMix64, as the authors recommend
+    constexpr explicit Xoshiro256pp(uint64_t seed = 0) : state{} {
+        for (auto &s : state)
+            s = detail::splitMix64(seed);
+    }
+
+    constexpr uint64_t operator()() {
+        const uint64_t result = detail::rotl(state[0] + state[3], 23) + state[0];
+        const uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = detail::rotl(state[3], 45);
+        return result;
+    }
+
+    // Advances by 2^128 numbers, so jumping a copy k times gives stream k
+    constexpr void jump() {
+        constexpr uint64_t polynomial[] = { 0x180EC6D33CFD0ABA, 0xD5A61266F0C9392C, 0xA9582618E03FC9AA, 0x39ABDC4529B1661C };
+        advance(polynomial);
+    }
+
+    // Advances by 2^192 numbers, for streams that each jump() further
+    constexpr void longJump() {
+        constexpr uint64_t polynomial[] = { 0x76E15D3EFEFDCBBF, 0xC5004E441C522FB3, 0x77710069854EE241, 0x39109BB02ACBE635 };
+        advance(polynomial);
+    }
+
+    void discard(uint64_t count) {
+        for (uint64_t i = 0; i < count; i++)
+            (*this)();
+    }
+
+    friend constexpr bool operator==(const Xoshiro256pp &a, const Xoshiro256pp &b) {
+        return a.state[0] == b.state[0] && a.state[1] == b.state[1] && a.state[2] == b.state[2] && a.state[3] == b.state[3];
+    }
+
+    friend constexpr bool operator!=(const Xoshiro256pp &a, const Xoshiro256pp &b) {
+        return !(a == b);
+    }
+
+    uint64_t state[4];
+
+private:
+    constexpr void advance(const uint64_t (&polynomial)[4]) {
+        uint64_t s[4] = {};
+        for (uint64_t word : polynomial) {
+            for (int b = 0; b < 64; b++) {
+                if (word & (uint64_t(1) << b)) {
+                    for (size_t i = 0; i < 4; i++)
+                        s[i] ^= state[i];
+                }
+                (*this)();
+            }
+        }
+        for (size_t i = 0; i < 4; i++)
+            state[i] = s[i];
+    }
+};
+
+// Uniform [0, 1) from the top 24 (float) or 53 (double) bits of gen's
+// output, drawing two 32 bit numbers for a double
+template <typename T = float, typename G>
+constexpr T uniform(G &gen) {
+    static_assert(std::is_floating_point_v<T>, "uniform needs float or double");
+    using R = typename G::result_type;
+    constexpr int bits = std::numeric_limits<T>::digits;
+    if constexpr (std::numeric_limits<R>::digits >= bits) {
+        return T(gen() >> (std::numeric_limits<R>::digits - bits)) * (T(1) / T(uint64_t(1) << bits));
+    } else {
+        const uint64_t hi = uint64_t(gen());
+        const uint64_t lo = uint64_t(gen());
+        return T(((hi << 32) | lo) >> (64 - bits)) * (T(1) / T(uint64_t(1) << bits));
+    }
+}
+
+// Uniform on the unit sphere, from two numbers of gen
+template <typename T = float, typename G>
+Vec3<T> randomUnitVec3(G &gen) {
+    const T z = T(1) - T(2) * uniform<T>(gen);
+    const T phi = T(2) * pi<T>() * uniform<T>(gen);
+    const T r = sqrt(std::max(T(0), T(1) - z * z));
+    return Vec3<T>(r * cos(phi), r * sin(phi), z);
+}
+
+// Uniform in the unit ball, from three numbers of gen
+template <typename T = float, typename G>
+Vec3<T> randomInSphere(G &gen) {
+    const Vec3<T> direction = randomUnitVec3<T>(gen);
+    return direction * T(std::cbrt(uniform<T>(gen)));
+}
+
+// Counter-based fills
+
+namespace detail {
+
+// Philox4x32-10 on W counter blocks at once, one per lane
+// Each vector type has the 32 bit lane operations the rounds need, and
+// writes its blocks back interleaved, the order the numbers are indexed in
+
+#if defined(ESDM_SIMD_SSE2)
+struct PhiloxLanesSse2 {
+    using V = __m128i;
+    static constexpr size_t width = 4;
+
+    static V set1(uint32_t x) {
+        return _mm_set1_epi32(int32_t(x));
+    }
+
+    static V load(const uint32_t *p) {
+        return _mm_loadu_si128((const __m128i *)p);
+    }
+
+    static V bitXor(V a, V b) {
+        return _mm_xor_si128(a, b);
+    }
+
+    static void mulHiLo(V a, V m, V &hi, V &lo) {
+        // Products of lanes 0 and 2, then 1 and 3, as 64 bit halves
+        const V even = _mm_shuffle_epi32(_mm_mul_epu32(a, m), _MM_SHUFFLE(3, 1, 2, 0));
+        const V odd = _mm_shuffle_epi32(_mm_mul_epu32(_mm_srli_epi64(a, 32), m), _MM_SHUFFLE(3, 1, 2, 0));
+        lo = _mm_unpacklo_epi32(even, odd);
+        hi = _mm_unpackhi_epi32(even, odd);
+    }
+
+    static void storeInterleaved(V c0, V c1, V c2, V c3, uint32_t *out) {
+        const V t0 = _mm_unpacklo_epi32(c0, c1);
+        const V t1 = _mm_unpacklo_epi32(c2, c3);
+        const V t2 = _mm_unpackhi_epi32(c0, c1);
+        const V t3 = _mm_unpackhi_epi32(c2, c3);
+        _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128((__m128i *)(out + 4), _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128((__m128i *)(out + 8), _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128((__m128i *)(out + 12), _mm_unpackhi_epi64(t2, t3));
+    }
+};
+#endif
+
+#if defined(ESDM_SIMD_AVX2)
+struct PhiloxLanesAvx2 {
+    using V = __m256i;
+    static constexpr size_t width = 8;
+
+    static V set1(uint32_t x) {
+        return _mm256_set1_epi32(int32_t(x));
+    }
+
+    static V load(const uint32_t *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+
+    static V bitXor(V a, V b) {
+        return _mm256_xor_si256(a, b);
+    }
+
+    static void mulHiLo(V a, V m, V &hi, V &lo) {
+        const V even = _mm256_shuffle_epi32(_mm256_mul_epu32(a, m), _MM_SHUFFLE(3, 1, 2, 0));
+        const V odd = _mm256_shuffle_epi32(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), m), _MM_SHUFFLE(3, 1, 2, 0));
+        lo = _mm256_unpacklo_epi32(even, odd);
+        hi = _mm256_unpackhi_epi32(even, odd);
+    }
+
+    // 4x4 transposes within each 128 bit half give lanes 0 to 3 in the low
+    // halves and 4 to 7 in the high ones
+    static void storeInterleaved(V c0, V c1, V c2, V c3, uint32_t *out) {
+        const V t0 = _mm256_unpacklo_epi32(c0, c1);
+        const V t1 = _mm256_unpacklo_epi32(c2, c3);
+        const V t2 = _mm256_unpackhi_epi32(c0, c1);
+        const V t3 = _mm256_unpackhi_epi32(c2, c3);
+        const V r0 = _mm256_unpacklo_epi64(t0, t1);
+        const V r1 = _mm256_unpackhi_epi64(t0, t1);
+        const V r2 = _mm256_unpacklo_epi64(t2, t3);
+        const V r3 = _mm256_unpackhi_epi64(t2, t3);
+        _mm256_storeu_si256((__m256i *)out, _mm256_permute2x128_si256(r0, r1, 0x20));
+        _mm256_storeu_si256((__m256i *)(out + 8), _mm256_permute2x128_si256(r2, r3, 0x20));
+        _mm256_storeu_si256((__m256i *)(out + 16), _mm256_permute2x128_si256(r0, r1, 0x31));
+        _mm256_storeu_si256((__m256i *)(out + 24), _mm256_permute2x128_si256(r2, r3, 0x31));
+    }
+};
+#endif
+
+// Blocks n to n + philoxGroups * L::width - 1 into out, several vectors of
+// blocks at once as one alone is bound by the multiply latency
+constexpr size_t philoxGroups = 4;
+
+template <typename L>
+inline void philoxBlocks(const Philox &gen, uint64_t n, uint32_t *out) {
+    using V = typename L::V;
+    constexpr size_t lanes = philoxGroups * L::width;
+    uint32_t lo[lanes], hi[lanes];
+    for (size_t i = 0; i < lanes; i++) {
+        lo[i] = uint32_t(n + i);
+        hi[i] = uint32_t((n + i) >> 32);
+    }
+
+    const V m0 = L::set1(philoxM0);
+    const V m1 = L::set1(philoxM1);
+    V c0[philoxGroups], c1[philoxGroups], c2[philoxGroups], c3[philoxGroups];
+    for (size_t g = 0; g < philoxGroups; g++) {
+        c0[g] = L::load(lo + g * L::width);
+        c1[g] = L::load(hi + g * L::width);
+        c2[g] = L::set1(gen.stream[0]);
+        c3[g] = L::set1(gen.stream[1]);
+    }
+    uint32_t k0 = gen.key[0];
+    uint32_t k1 = gen.key[1];
+    for (int round = 0; round < 10; round++) {
+        const V key0 = L::set1(k0);
+        const V key1 = L::set1(k1);
+        for (size_t g = 0; g < philoxGroups; g++) {
+            V hi0, lo0, hi1, lo1;
+            L::mulHiLo(c0[g], m0, hi0, lo0);
+            L::mulHiLo(c2[g], m1, hi1, lo1);
+            c0[g] = L::bitXor(L::bitXor(hi1, c1[g]), key0);
+            c1[g] = lo1;
+            c2[g] = L::bitXor(L::bitXor(hi0, c3[g]), key1);
+            c3[g] = lo0;
+        }
+        k0 += philoxW0;
+        k1 += philoxW1;
+    }
+    for (size_t g = 0; g < philoxGroups; g++)
+        L::storeInterleaved(c0[g], c1[g], c2[g], c3[g], out + g * 4 * L::width);
+}
+
+// Numbers [first, first + count) of a counter-based generator
+template <typename G>
+inline void fillBits(const G &gen, uint64_t first, uint32_t *out, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        out[i] = gen.at(first + i);
+}
+
+inline void fillBits(const Philox &gen, uint64_t first, uint32_t *out, size_t count) {
+    size_t i = 0;
+    // Whole blocks only through the SIMD path, the partial ones at the ends
+    // one block at a time
+    const auto copyBlock = [&] {
+        const std::array<uint32_t, 4> b = gen.block((first + i) / 4);
+        for (size_t w = (first + i) % 4; w < 4 && i < count; w++)
+            out[i++] = b[w];
+    };
+    if (first % 4 != 0)
+        copyBlock();
+
+#if defined(ESDM_SIMD_SSE2)
+#if defined(ESDM_SIMD_AVX2)
+    using L = PhiloxLanesAvx2;
+#else
+    using L = PhiloxLanesSse2;
+#endif
+    for (; i + 4 * philoxGroups * L::width <= count; i += 4 * philoxGroups * L::width)
+        philoxBlocks<L>(gen, (first + i) / 4, out + i);
+#endif
+
+    while (i < count)
+        copyBlock();
+}
+
+// Runs fn(begin, bits, n) over [0, count) in chunks of at most chunkSize,
+// bits holding numbers [first + begin * per, first + (begin + n) * per)
+template <typename G, typename F>
+inline void forChunks(const G &gen, uint64_t first, size_t count, size_t per, F &&fn) {
+    constexpr size_t chunkSize = 256;
+    parallelFor(count, batchGrain / per, [&](size_t begin, size_t end) {
+        uint32_t bits[chunkSize * 3];
+        for (size_t i = begin; i < end; i += chunkSize) {
+            const size_t n = std::min(chunkSize, end - i);
+            fillBits(gen, (first + i) * per, bits, n * per);
+            fn(i, bits, n);
+        }
+    }, 64);
+}
+
+// Unit vectors from (u, v) pairs, the same formula as randomUnitVec3
+template <typename P>
+inline void unitVec3(const uint32_t *bits, Vec3<float> *out, const float *radius) {
+    float z[P::width], phi[P::width];
+    for (size_t i = 0; i < P::width; i++) {
+        z[i] = 1.f - 2.f * (float(bits[i * 2] >> 8) * (1.f / 16777216.f));
+        phi[i] = 2.f * pi<float>() * (float(bits[i * 2 + 1] >> 8) * (1.f / 16777216.f));
+    }
+    const P zp = P::load(z);
+    P s, c;
+    fast::sincos(P::load(phi), s, c);
+    P r = sqrt(max(P::splat(0.f), P::splat(1.f) - zp * zp));
+
+    float xs[P::width], ys[P::width];
+    (r * c).store(xs);
+    (r * s).store(ys);
+    for (size_t i = 0; i < P::width; i++) {
+        const float scale = radius ? radius[i] : 1.f;
+        out[i] = Vec3<float>(xs[i] * scale, ys[i] * scale, z[i] * scale);
+    }
+}
+
+}
+
+// Numbers [first, first + count) of gen, threaded for large counts
+
+template <typename G>
+inline void fill(const G &gen, uint64_t first, uint32_t *out, size_t count) {
+    parallelFor(count, batchGrain, [&](size_t begin, size_t end) {
+        detail::fillBits(gen, first + begin, out + begin, end - begin);
+    }, 64);
+}
+
+// Uniform [0, 1) floats from numbers [first, first + count), as
+// uniform<float> would give them
+template <typename G>
+inline void fillUniform(const G &gen, uint64_t first, float *out, size_t count) {
+    detail::forChunks(gen, first, count, 1, [&](size_t begin, const uint32_t *bits, size_t n) {
+        for (size_t i = 0; i < n; i++)
+            out[begin + i] = float(bits[i] >> 8) * (1.f / 16777216.f);
+    });
+}
+
+// Vector i from numbers 2 (first + i) and 2 (first + i) + 1, like
+// randomUnitVec3 from a generator at that position (up to the rounding of
+// the fast sin / cos used here)
+template <typename G>
+inline void fillUnitVec3(const G &gen, uint64_t first, Vec3<float> *out, size_t count) {
+    using P = simd::NativePack<float>;
+    using P1 = simd::Pack<float, 1>;
+    detail::forChunks(gen, first, count, 2, [&](size_t begin, const uint32_t *bits, size_t n) {
+        size_t i = 0;
+        for (; i + P::width <= n; i += P::width)
+            detail::unitVec3<P>(bits + i * 2, out + begin + i, nullptr);
+        for (; i < n; i++)
+            detail::unitVec3<P1>(bits + i * 2, out + begin + i, nullptr);
+    });
+}
+
+// Vector i from numbers 3 (first + i) to 3 (first + i) + 2, like
+// randomInSphere from a generator at that position
+template <typename G>
+inline void fillInSphere(const G &gen, uint64_t first, Vec3<float> *out, size_t count) {
+    using P = simd::NativePack<float>;
+    using P1 = simd::Pack<float, 1>;
+    detail::forChunks(gen, first, count, 3, [&](size_t begin, const uint32_t *bits, size_t n) {
+        // Regroup each (u, v, w) as (u, v) pairs and radii
+        uint32_t pairs[P::width * 2];
+        float radius[P::width];
+        size_t i = 0;
+        const auto group = [&](size_t width) {
+            for (size_t j = 0; j < width; j++) {
+                pairs[j * 2] = bits[(i + j) * 3];
+                pairs[j * 2 + 1] = bits[(i + j) * 3 + 1];
+                radius[j] = std::cbrt(float(bits[(i + j) * 3 + 2] >> 8) * (1.f / 16777216.f));
+            }
+        };
+        for (; i + P::width <= n; i += P::width) {
+            group(P::width);
+            detail::unitVec3<P>(pairs, out + begin + i, radius);
+        }
+        for (; i < n; i++) {
+            group(1);
+            detail::unitVec3<P1>(pairs, out + begin + i, radius);
+        }
+    });
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "bounds.hpp"
+#include "pack.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace esdm {
+
+template <typename T>
+class Ray {
+public:
+    Vec3<T> origin;
+    Vec3<T> direction;
+
+    constexpr Ray() : origin(), direction() {}
+
+    constexpr Ray(const Vec3<T> &origin, const Vec3<T> &direction) : origin(origin), direction(direction) {}
+
+    constexpr Vec3<T> at(T t) const {
+        return origin + direction * t;
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const Ray &ray) {
+        return out << "[" << ray.origin << ", " << ray.direction << "]";
+    }
+};
+
+// W rays stored component by component, with what the box and triangle
+// tests need precomputed per ray
+// Lanes past "count" repeat the last ray, or hold a placeholder when count
+// is 0, and are left out of "active" so they never report a hit
+template <typename T, size_t W>
+class RayPacket {
+public:
+    static constexpr size_t width = W;
+
+    T origin[3][W];
+    T direction[3][W];
+    // 1 / direction, with zero components nudged away from 0 so a box test
+    // never computes 0 * inf
+    T invDirection[3][W];
+    // Watertight triangle test setup (see intersect below): axis indices
+    // kx, ky, kz as T, and -dx / dz, -dy / dz, 1 / dz along them
+    T axis[3][W];
+    T shear[3][W];
+    // Bit i set for each lane holding one of the rays given
+    uint32_t active;
+
+    RayPacket(const Ray<T> *rays, size_t count = W) {
+        static_assert(W >= 1 && W <= 32, "Hit bits are returned as a uint32_t");
+        const Ray<T> placeholder(Vec3<T>(), Vec3<T>(T(0), T(0), T(1)));
+        for (size_t i = 0; i < W; i++)
+            set(i, count > 0 ? rays[std::min(i, count - 1)] : placeholder);
+        active = count < W ? (1u << count) - 1u : ~0u >> (32 - W);
+    }
+
+    void set(size_t lane, const Ray<T> &ray) {
+        constexpr T tiny = std::numeric_limits<T>::min();
+        for (size_t c = 0; c < 3; c++) {
+            const T d = ray.direction[c];
+            origin[c][lane] = ray.origin[c];
+            direction[c][lane] = d;
+            invDirection[c][lane] = T(1) / (abs(d) < tiny ? (d < T(0) ? -tiny : tiny) : d);
+        }
+
+        // Project along the largest direction axis, swapping the other two
+        // when it points backwards so triangle winding is kept
+        const Vec3<T> a = abs(ray.direction);
+        size_t kz = a[0] > a[1] ? (a[0] > a[2] ? 0 : 2) : (a[1] > a[2] ? 1 : 2);
+        size_t kx = (kz + 1) % 3;
+        size_t ky = (kx + 1) % 3;
+        if (ray.direction[kz] < T(0))
+            std::swap(kx, ky);
+
+        axis[0][lane] = T(kx);
+        axis[1][lane] = T(ky);
+        axis[2][lane] = T(kz);
+        shear[0][lane] = -ray.direction[kx] / ray.direction[kz];
+        shear[1][lane] = -ray.direction[ky] / ray.direction[kz];
+        shear[2][lane] = T(1) / ray.direction[kz];
+    }
+};
+
+namespace simd {
+
+// The pack a RayPacket<T, W> is processed with, several per packet when W
+// is wider than the build's SIMD
+template <typename T, size_t W>
+using RayPack = Pack<T, std::min(W, NativeWidth<T>::value)>;
+
+// v[k] per lane, for k holding 0, 1 or 2
+template <typename P>
+inline P selectAxis(P k, P x, P y, P z) {
+    return selectLess(k, P::splat(0.5f), x, selectLess(k, P::splat(1.5f), y, z));
+}
+
+// Slab test of lanes [lane, lane + P::width) against box, tNear getting the
+// entry distance (clamped to 0) of each lane
+template <typename P, typename T, size_t W>
+inline uint32_t intersect(const RayPacket<T, W> &rays, size_t lane, const AABB<T> &box, const T *tMax, T *tNear) {
+    P enter = P::splat(T(0));
+    P exit = P::load(tMax + lane);
+    for (size_t c = 0; c < 3; c++) {
+        const P o = P::load(rays.origin[c] + lane);
+        const P inv = P::load(rays.invDirection[c] + lane);
+        const P t0 = (P::splat(box.min[c]) - o) * inv;
+        const P t1 = (P::splat(box.max[c]) - o) * inv;
+        enter = max(enter, min(t0, t1));
+        exit = min(exit, max(t0, t1));
+    }
+    enter.store(tNear + lane);
+    return ~lessBits(exit, enter) & (rays.active >> lane) & ((1u << P::width) - 1u);
+}
+
+// Watertight ray-triangle test (Woop, Benthin and Wald 2013) of lanes
+// [lane, lane + P::width), a hit being closer than t[lane + i], which is
+// then replaced by the hit distance
+template <typename P, typename T, size_t W>
+inline uint32_t intersect(const RayPacket<T, W> &rays, size_t lane, const Vec3<T> &a, const Vec3<T> &b, const Vec3<T> &c, T *t) {
+    const P zero = P::splat(T(0));
+    const P kx = P::load(rays.axis[0] + lane);
+    const P ky = P::load(rays.axis[1] + lane);
+    const P kz = P::load(rays.axis[2] + lane);
+    const P sx = P::load(rays.shear[0] + lane);
+    const P sy = P::load(rays.shear[1] + lane);
+    const P sz = P::load(rays.shear[2] + lane);
+    const P ox = P::load(rays.origin[0] + lane);
+    const P oy = P::load(rays.origin[1] + lane);
+    const P oz = P::load(rays.origin[2] + lane);
+
+    // Vertices relative to the origin, sheared so the ray is +z
+    P x[3], y[3], z[3];
+    const Vec3<T> *v[3] = { &a, &b, &c };
+    for (size_t i = 0; i < 3; i++) {
+        const P vx = P::splat((*v[i])[0]) - ox;
+        const P vy = P::splat((*v[i])[1]) - oy;
+        const P vz = P::splat((*v[i])[2]) - oz;
+        const P along = selectAxis(kz, vx, vy, vz);
+        x[i] = madd(sx, along, selectAxis(kx, vx, vy, vz));
+        y[i] = madd(sy, along, selectAxis(ky, vx, vy, vz));
+        z[i] = sz * along;
+    }
+
+    // Scaled barycentrics, all of one sign (or 0) on a hit
+    // An edge shared by two triangles must give both exactly opposite
+    // values, so each edge is evaluated with its vertices in one fixed order
+    // whichever triangle it's in, as the compiler may fuse the multiply and
+    // subtract into an asymmetric FMA
+    const auto edge = [&](size_t i, size_t j) {
+        const Vec3<T> &p = *v[i];
+        const Vec3<T> &q = *v[j];
+        const bool swapped = p[0] != q[0] ? q[0] < p[0] : p[1] != q[1] ? q[1] < p[1] : q[2] < p[2];
+        if (swapped)
+            return zero - (x[j] * y[i] - y[j] * x[i]);
+        return x[i] * y[j] - y[i] * x[j];
+    };
+    const P u = edge(2, 1);
+    const P w = edge(0, 2);
+    const P s = edge(1, 0);
+    const uint32_t negative = lessBits(u, zero) | lessBits(w, zero) | lessBits(s, zero);
+    const uint32_t positive = lessBits(zero, u) | lessBits(zero, w) | lessBits(zero, s);
+
+    const P det = u + w + s;
+    const uint32_t nonZero = lessBits(det, zero) | lessBits(zero, det);
+    const P hit = (u * z[0] + w * z[1] + s * z[2]) / det;
+
+    const P current = P::load(t + lane);
+    const uint32_t closer = ~lessBits(hit, zero) & lessBits(hit, current);
+    const uint32_t bits = ~(negative & positive) & nonZero & closer & (rays.active >> lane) & ((1u << P::width) - 1u);
+
+    if (bits) {
+        T hits[P::width];
+        hit.store(hits);
+        for (size_t i = 0; i < P::width; i++)
+            if (bits & (1u << i))
+                t[lane + i] = hits[i];
+    }
+    return bits;
+}
+
+}
+
+// Packet functions
+// Bit i of the result is set for a hit by ray i
+
+// Slab test against box over [0, tMax[i]], tNear[i] getting the entry
+// distance, 0 when ray i starts inside
+template <typename T, size_t W>
+inline uint32_t intersect(const RayPacket<T, W> &rays, const AABB<T> &box, const T *tMax, T *tNear) {
+    using P = simd::RayPack<T, W>;
+    uint32_t bits = 0;
+    for (size_t lane = 0; lane < W; lane += P::width)
+        bits |= simd::intersect<P>(rays, lane, box, tMax, tNear) << lane;
+    return bits;
+}
+
+// Watertight triangle test, t[i] being the distance to beat on input and
+// the hit distance on output where bit i is set
+// Both windings hit, and triangles sharing an edge never let a ray through
+template <typename T, size_t W>
+inline uint32_t intersect(const RayPacket<T, W> &rays, const Vec3<T> &a, const Vec3<T> &b, const Vec3<T> &c, T *t) {
+    using P = simd::RayPack<T, W>;
+    uint32_t bits = 0;
+    for (size_t lane = 0; lane < W; lane += P::width)
+        bits |= simd::intersect<P>(rays, lane, a, b, c, t) << lane;
+    return bits;
+}
+
+// Single ray functions, the same tests as a one ray packet
+// When testing one ray against many things, make the RayPacket<T, 1> once
+
+template <typename T>
+inline bool intersect(const Ray<T> &ray, const AABB<T> &box, T tMax, T &tNear) {
+    return intersect(RayPacket<T, 1>(&ray), box, &tMax, &tNear) != 0;
+}
+
+template <typename T>
+inline bool intersect(const Ray<T> &ray, const Vec3<T> &a, const Vec3<T> &b, const Vec3<T> &c, T &t) {
+    return intersect(RayPacket<T, 1>(&ray), a, b, c, &t) != 0;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+// Compile-time SIMD feature detection for esdm
+// Every SIMD path has a scalar fallback; define ESDM_NO_SIMD to force it
+
+#if !defined(ESDM_NO_SIMD)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ESDM_SIMD_SSE2
+#endif
+
+#if defined(ESDM_SIMD_SSE2) && (defined(__SSE4_1__) || defined(__AVX__))
+#define ESDM_SIMD_SSE41
+#endif
+
+#if defined(ESDM_SIMD_SSE41) && defined(__AVX__)
+#define ESDM_SIMD_AVX
+#endif
+
+#if defined(ESDM_SIMD_AVX) && defined(__AVX2__)
+#define ESDM_SIMD_AVX2
+#endif
+
+// MSVC has no __FMA__, but every AVX2 target it emits code for has FMA3
+#if defined(ESDM_SIMD_AVX2) && (defined(__FMA__) || defined(_MSC_VER))
+#define ESDM_SIMD_FMA
+#endif
+
+// Likewise for F16C, which every AVX2 CPU has
+#if defined(ESDM_SIMD_AVX2) && (defined(__F16C__) || defined(_MSC_VER))
+#define ESDM_SIMD_F16C
+#endif
+
+// And BMI2 (pdep / pext)
+#if defined(ESDM_SIMD_AVX2) && (defined(__BMI2__) || defined(_MSC_VER))
+#define ESDM_SIMD_BMI2
+#endif
+
+#endif
+
+#if defined(ESDM_SIMD_SSE2)
+#include <immintrin.h>
+#endif
\ No newline at end of file
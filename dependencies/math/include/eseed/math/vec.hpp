@@ -1,16 +1,23 @@
 #pragma once
 
 #include "ops.hpp"
+#include "simd.hpp"
 
 #include <cstddef>
+#include <cstdint>
+#include <stdexcept>
 #include <initializer_list>
 #include <type_traits>
 #include <ostream>
 #include <array>
 #include <algorithm>
+#include <utility>
 
 namespace esdm {
 
+// Constant expressions may only read the union member that was initialized,
+// so compile-time code indexes components (v[0] or v.data) rather than v.x
+
 template <size_t L, typename T>
 class VecData {
 public:
@@ -71,6 +78,91 @@ public:
     };
 };
 
+#if defined(ESDM_SIMD_SSE2)
+
+// SIMD storage, operators are overloaded in vecsimd.hpp
+// The unions keep the same data / x y z w / r g b a API as above
+
+template <>
+class alignas(16) VecData<4, float> {
+public:
+    union {
+        std::array<float, 4> data;
+        struct {
+            float x, y, z, w;
+        };
+
+        struct {
+            float r, g, b, a;
+        };
+
+        __m128 simd;
+    };
+};
+
+// Padded to a full register, the fourth lane is always kept at 0
+template <>
+class alignas(16) VecData<3, float> {
+public:
+    union {
+        struct {
+            std::array<float, 3> data;
+            float pad;
+        };
+
+        struct {
+            float x, y, z;
+        };
+
+        struct {
+            float r, g, b;
+        };
+
+        __m128 simd;
+    };
+};
+
+template <>
+class alignas(16) VecData<4, int32_t> {
+public:
+    union {
+        std::array<int32_t, 4> data;
+        struct {
+            int32_t x, y, z, w;
+        };
+
+        struct {
+            int32_t r, g, b, a;
+        };
+
+        __m128i simd;
+    };
+};
+
+#endif
+
+namespace detail {
+
+// Whether VecData<L, T> has a pad lane after its L components
+template <size_t L, typename T>
+struct VecDataPadded : std::false_type {};
+
+#if defined(ESDM_SIMD_SSE2)
+template <>
+struct VecDataPadded<3, float> : std::true_type {};
+#endif
+
+// VecData from all L components, with the pad lane (if any) set to 0
+template <size_t L, typename T, typename... Ts>
+constexpr VecData<L, T> makeVecData(const Ts &... components) {
+    if constexpr (VecDataPadded<L, T>::value)
+        return VecData<L, T>{components..., T(0)};
+    else
+        return VecData<L, T>{components...};
+}
+
+}
+
 // Forward declaration for shorthand aliases
 template <size_t L, typename T>
 class Vec;
@@ -89,45 +181,211 @@ using Vec3 = Vec<3, T>;
 template <typename T>
 using Vec4 = Vec<4, T>;
 
+template <size_t L, typename T, size_t... I>
+class SwizzleRef;
+
+namespace detail {
+
+// Reads and writes the components I... of a Vec<L, T>, one at a time
+// vecsimd.hpp specializes Swizzle to do the same with shuffles
+template <size_t L, typename T, size_t... I>
+struct SwizzleComponents {
+    static constexpr Vec<sizeof...(I), T> get(const Vec<L, T> &v) {
+        return Vec<sizeof...(I), T>(v.data[I]...);
+    }
+
+    static constexpr void set(Vec<L, T> &v, const Vec<sizeof...(I), T> &s) {
+        size_t k = 0;
+        ((v.data[I] = s.data[k++]), ...);
+    }
+};
+
+template <size_t L, typename T, size_t... I>
+struct Swizzle : SwizzleComponents<L, T, I...> {};
+
+template <size_t... I>
+constexpr bool swizzleDistinct() {
+    const size_t indices[] = { I... };
+    for (size_t a = 0; a < sizeof...(I); a++)
+        for (size_t b = a + 1; b < sizeof...(I); b++)
+            if (indices[a] == indices[b])
+                return false;
+    return true;
+}
+
+}
+
+// Swizzle members: xy() ... wwww(), each one a swizzle<I...>() with x, y,
+// z, w being components 0 - 3. They return a Vec, also on a non-const Vec,
+// so they work with dot, length, etc. like any other; writing goes through
+// swizzleRef<I...>().
+#define ESEED_VEC_SWIZZLE_INDEX_x 0
+#define ESEED_VEC_SWIZZLE_INDEX_y 1
+#define ESEED_VEC_SWIZZLE_INDEX_z 2
+#define ESEED_VEC_SWIZZLE_INDEX_w 3
+
+#define ESEED_VEC_SWIZZLE(name, ...) \
+    constexpr auto name() const { return swizzle<__VA_ARGS__>(); }
+
+#define ESEED_VEC_SWIZZLE2(a, b) \
+    ESEED_VEC_SWIZZLE(a##b, ESEED_VEC_SWIZZLE_INDEX_##a, ESEED_VEC_SWIZZLE_INDEX_##b)
+#define ESEED_VEC_SWIZZLE3(a, b, c) \
+    ESEED_VEC_SWIZZLE(a##b##c, ESEED_VEC_SWIZZLE_INDEX_##a, ESEED_VEC_SWIZZLE_INDEX_##b, ESEED_VEC_SWIZZLE_INDEX_##c)
+#define ESEED_VEC_SWIZZLE4(a, b, c, d) \
+    ESEED_VEC_SWIZZLE(a##b##c##d, ESEED_VEC_SWIZZLE_INDEX_##a, ESEED_VEC_SWIZZLE_INDEX_##b, ESEED_VEC_SWIZZLE_INDEX_##c, ESEED_VEC_SWIZZLE_INDEX_##d)
+
+// Every last component for the given leading ones
+#define ESEED_VEC_SWIZZLE2_X(a) \
+    ESEED_VEC_SWIZZLE2(a, x) ESEED_VEC_SWIZZLE2(a, y) ESEED_VEC_SWIZZLE2(a, z) ESEED_VEC_SWIZZLE2(a, w)
+#define ESEED_VEC_SWIZZLE3_X(a, b) \
+    ESEED_VEC_SWIZZLE3(a, b, x) ESEED_VEC_SWIZZLE3(a, b, y) ESEED_VEC_SWIZZLE3(a, b, z) ESEED_VEC_SWIZZLE3(a, b, w)
+#define ESEED_VEC_SWIZZLE3_XX(a) \
+    ESEED_VEC_SWIZZLE3_X(a, x) ESEED_VEC_SWIZZLE3_X(a, y) ESEED_VEC_SWIZZLE3_X(a, z) ESEED_VEC_SWIZZLE3_X(a, w)
+#define ESEED_VEC_SWIZZLE4_X(a, b, c) \
+    ESEED_VEC_SWIZZLE4(a, b, c, x) ESEED_VEC_SWIZZLE4(a, b, c, y) ESEED_VEC_SWIZZLE4(a, b, c, z) ESEED_VEC_SWIZZLE4(a, b, c, w)
+#define ESEED_VEC_SWIZZLE4_XX(a, b) \
+    ESEED_VEC_SWIZZLE4_X(a, b, x) ESEED_VEC_SWIZZLE4_X(a, b, y) ESEED_VEC_SWIZZLE4_X(a, b, z) ESEED_VEC_SWIZZLE4_X(a, b, w)
+#define ESEED_VEC_SWIZZLE4_XXX(a) \
+    ESEED_VEC_SWIZZLE4_XX(a, x) ESEED_VEC_SWIZZLE4_XX(a, y) ESEED_VEC_SWIZZLE4_XX(a, z) ESEED_VEC_SWIZZLE4_XX(a, w)
+
 template <size_t L, typename T>
 class Vec : public VecData<L, T> {
 public:
     // Vec<3, T>(): [ 0, 0, 0 ]
-    Vec() : VecData{0} {}
+    constexpr Vec() : VecData<L, T>{} {}
 
     // Vec<3, T>(arr) => [ arr[0], arr[1], arr[2] ]
-    Vec(const T *data) {
-        std::copy(data, data + L, &data[0]);
+    constexpr Vec(const T *arr) : VecData<L, T>{} {
+        for (size_t i = 0; i < L; i++)
+            this->data[i] = arr[i];
     }
 
     // Vec<3, T>(a, b, c) => [ a, b, c ]
     template <typename... Ts, typename std::enable_if_t<std::conjunction_v<std::is_convertible<Ts, T>...> && (sizeof...(Ts) == L)> * = nullptr>
-    Vec(const Ts &... components) : VecData{((T)components)...} {}
+    constexpr Vec(const Ts &... components) : VecData<L, T>(detail::makeVecData<L, T>(((T)components)...)) {}
 
     // Vec<3, T>(v) => [ v, v, v ]
-    explicit Vec(const T &component) {
+    constexpr explicit Vec(const T &component) : VecData<L, T>{} {
         for (size_t i = 0; i < L; i++)
-            data[i] = component;
+            this->data[i] = component;
     }
 
     // Vec<3, T>(/*Vec<2, U>*/ other) => [ (T)other.x, (T)other.y, 0 ]
     template <typename T1, size_t L1>
-    explicit Vec(const Vec<L1, T1> &other) {
+    constexpr explicit Vec(const Vec<L1, T1> &other) : VecData<L, T>{} {
         for (size_t i = 0; i < std::min(L, L1); i++)
-            data[i] = (T)other[i];
+            this->data[i] = (T)other[i];
     }
 
-    const T &operator[](size_t i) const {
+    constexpr const T &operator[](size_t i) const {
         if (i >= L)
             throw std::out_of_range("Index is larger than Vec length");
-        return data[i];
+        return this->data[i];
     }
 
-    T &operator[](size_t i) {
+    constexpr T &operator[](size_t i) {
         if (i >= L)
             throw std::out_of_range("Index is larger than Vec length");
-        return data[i];
+        return this->data[i];
+    }
+
+    // Vec<4, T>(x, y, z, w).swizzle<2, 1, 0>() => [ z, y, x ]
+    template <size_t... I>
+    constexpr Vec<sizeof...(I), T> swizzle() const {
+        static_assert(((I < L) && ...), "Swizzle component is past the end of the Vec");
+        return detail::Swizzle<L, T, I...>::get(*this);
+    }
+
+    // v.swizzleRef<2, 1, 0>() = w => [ w.z, w.y, w.x, v.w ]
+    // Writes components I... of this Vec, see SwizzleRef
+    template <size_t... I>
+    constexpr SwizzleRef<L, T, I...> swizzleRef() {
+        static_assert(((I < L) && ...), "Swizzle component is past the end of the Vec");
+        return SwizzleRef<L, T, I...>(*this);
+    }
+
+    ESEED_VEC_SWIZZLE2_X(x) ESEED_VEC_SWIZZLE2_X(y) ESEED_VEC_SWIZZLE2_X(z) ESEED_VEC_SWIZZLE2_X(w)
+    ESEED_VEC_SWIZZLE3_XX(x) ESEED_VEC_SWIZZLE3_XX(y) ESEED_VEC_SWIZZLE3_XX(z) ESEED_VEC_SWIZZLE3_XX(w)
+    ESEED_VEC_SWIZZLE4_XXX(x) ESEED_VEC_SWIZZLE4_XXX(y) ESEED_VEC_SWIZZLE4_XXX(z) ESEED_VEC_SWIZZLE4_XXX(w)
+};
+
+#undef ESEED_VEC_SWIZZLE_INDEX_x
+#undef ESEED_VEC_SWIZZLE_INDEX_y
+#undef ESEED_VEC_SWIZZLE_INDEX_z
+#undef ESEED_VEC_SWIZZLE_INDEX_w
+#undef ESEED_VEC_SWIZZLE
+#undef ESEED_VEC_SWIZZLE2
+#undef ESEED_VEC_SWIZZLE3
+#undef ESEED_VEC_SWIZZLE4
+#undef ESEED_VEC_SWIZZLE2_X
+#undef ESEED_VEC_SWIZZLE3_X
+#undef ESEED_VEC_SWIZZLE3_XX
+#undef ESEED_VEC_SWIZZLE4_X
+#undef ESEED_VEC_SWIZZLE4_XX
+#undef ESEED_VEC_SWIZZLE4_XXX
+
+// Assignable view of components I... of a Vec, from Vec::swizzleRef,
+// e.g. v.swizzleRef<2, 1, 0>() = w or v.swizzleRef<0, 2>() += d
+// It holds only a reference to the source. It converts to a Vec and has
+// operator[] and the arithmetic below for reading back, though the plain
+// swizzles are the way to read. Assignments only work on the temporary
+// swizzleRef returns, so "auto t = v.swizzleRef<0, 2>(); t += d;" doesn't
+// compile instead of writing to v.
+template <size_t L, typename T, size_t... I>
+class SwizzleRef {
+public:
+    static constexpr size_t size = sizeof...(I);
+    using Value = Vec<size, T>;
+
+    constexpr explicit SwizzleRef(Vec<L, T> &source) : source(source) {}
+
+    constexpr operator Value() const {
+        return detail::Swizzle<L, T, I...>::get(source);
+    }
+
+    constexpr T operator[](size_t k) const {
+        constexpr size_t lanes[] = { I... };
+        if (k >= size)
+            throw std::out_of_range("Index is larger than swizzle length");
+        return source.data[lanes[k]];
     }
+
+    constexpr SwizzleRef &&operator=(const Value &s) && {
+        static_assert(detail::swizzleDistinct<I...>(), "Can't assign to a swizzle that repeats a component");
+        detail::Swizzle<L, T, I...>::set(source, s);
+        return std::move(*this);
+    }
+
+    constexpr SwizzleRef &&operator=(const SwizzleRef &s) && {
+        return std::move(*this) = Value(s);
+    }
+
+    constexpr SwizzleRef &&operator+=(const Value &s) && { return std::move(*this) = Value(*this) + s; }
+    constexpr SwizzleRef &&operator-=(const Value &s) && { return std::move(*this) = Value(*this) - s; }
+    constexpr SwizzleRef &&operator*=(const Value &s) && { return std::move(*this) = Value(*this) * s; }
+    constexpr SwizzleRef &&operator/=(const Value &s) && { return std::move(*this) = Value(*this) / s; }
+    constexpr SwizzleRef &&operator+=(T s) && { return std::move(*this) = Value(*this) + s; }
+    constexpr SwizzleRef &&operator-=(T s) && { return std::move(*this) = Value(*this) - s; }
+    constexpr SwizzleRef &&operator*=(T s) && { return std::move(*this) = Value(*this) * s; }
+    constexpr SwizzleRef &&operator/=(T s) && { return std::move(*this) = Value(*this) / s; }
+
+    // Template operators can't see through the conversion, so the common
+    // ones are spelled out
+    friend constexpr Value operator+(const SwizzleRef &a, const Value &b) { return Value(a) + b; }
+    friend constexpr Value operator-(const SwizzleRef &a, const Value &b) { return Value(a) - b; }
+    friend constexpr Value operator*(const SwizzleRef &a, const Value &b) { return Value(a) * b; }
+    friend constexpr Value operator/(const SwizzleRef &a, const Value &b) { return Value(a) / b; }
+    friend constexpr Value operator+(const Value &a, const SwizzleRef &b) { return a + Value(b); }
+    friend constexpr Value operator-(const Value &a, const SwizzleRef &b) { return a - Value(b); }
+    friend constexpr Value operator*(const Value &a, const SwizzleRef &b) { return a * Value(b); }
+    friend constexpr Value operator/(const Value &a, const SwizzleRef &b) { return a / Value(b); }
+    friend constexpr Value operator*(const SwizzleRef &a, T b) { return Value(a) * b; }
+    friend constexpr Value operator/(const SwizzleRef &a, T b) { return Value(a) / b; }
+    friend constexpr Value operator*(T a, const SwizzleRef &b) { return a * Value(b); }
+    friend constexpr Value operator-(const SwizzleRef &a) { return -Value(a); }
+
+private:
+    Vec<L, T> &source;
 };
 
 template <size_t L, typename T>
@@ -145,7 +403,7 @@ std::ostream &operator<<(std::ostream &out, const Vec<L, T> &v) {
 // Functions
 
 template <size_t L, typename T>
-Vec<L, T> abs(const Vec<L, T> &v) {
+constexpr Vec<L, T> abs(const Vec<L, T> &v) {
     Vec<L, T> out;
     for (size_t i = 0; i < L; i++)
         out[i] = abs(v[i]);
@@ -153,7 +411,7 @@ Vec<L, T> abs(const Vec<L, T> &v) {
 }
 
 template <size_t L, typename T>
-Vec<L, T> trunc(const Vec<L, T> &v) {
+constexpr Vec<L, T> trunc(const Vec<L, T> &v) {
     Vec<L, T> out;
     for (size_t i = 0; i < L; i++)
         out[i] = trunc(v[i]);
@@ -161,7 +419,7 @@ Vec<L, T> trunc(const Vec<L, T> &v) {
 }
 
 template <size_t L, typename T>
-Vec<L, T> floor(const Vec<L, T> &v) {
+constexpr Vec<L, T> floor(const Vec<L, T> &v) {
     Vec<L, T> out;
     for (size_t i = 0; i < L; i++)
         out[i] = floor(v[i]);
@@ -169,7 +427,7 @@ Vec<L, T> floor(const Vec<L, T> &v) {
 }
 
 template <size_t L, typename T>
-Vec<L, T> ceil(const Vec<L, T> &v) {
+constexpr Vec<L, T> ceil(const Vec<L, T> &v) {
     Vec<L, T> out;
     for (size_t i = 0; i < L; i++)
         out[i] = ceil(v[i]);
@@ -177,7 +435,7 @@ Vec<L, T> ceil(const Vec<L, T> &v) {
 }
 
 template <size_t L, typename T>
-Vec<L, T> round(const Vec<L, T> &v) {
+constexpr Vec<L, T> round(const Vec<L, T> &v) {
     Vec<L, T> out;
     for (size_t i = 0; i < L; i++)
         out[i] = round(v[i]);
@@ -187,7 +445,7 @@ Vec<L, T> round(const Vec<L, T> &v) {
 // See ops.hpp for "i" functions explanation
 
 template <typename I, size_t L, typename T>
-Vec<L, I> itrunc(const Vec<L, T> &v) {
+constexpr Vec<L, I> itrunc(const Vec<L, T> &v) {
     Vec<L, I> out;
     for (size_t i = 0; i < L; i++)
         out[i] = itrunc<I>(v[i]);
@@ -195,7 +453,7 @@ Vec<L, I> itrunc(const Vec<L, T> &v) {
 }
 
 template <typename I, size_t L, typename T>
-Vec<L, I> ifloor(const Vec<L, T> &v) {
+constexpr Vec<L, I> ifloor(const Vec<L, T> &v) {
     Vec<L, I> out;
     for (size_t i = 0; i < L; i++)
         out[i] = ifloor<I>(v[i]);
@@ -203,7 +461,7 @@ Vec<L, I> ifloor(const Vec<L, T> &v) {
 }
 
 template <typename I, size_t L, typename T>
-Vec<L, I> iceil(const Vec<L, T> &v) {
+constexpr Vec<L, I> iceil(const Vec<L, T> &v) {
     Vec<L, I> out;
     for (size_t i = 0; i < L; i++)
         out[i] = iceil<I>(v[i]);
@@ -211,7 +469,7 @@ Vec<L, I> iceil(const Vec<L, T> &v) {
 }
 
 template <typename I, size_t L, typename T>
-Vec<L, I> iround(const Vec<L, T> &v) {
+constexpr Vec<L, I> iround(const Vec<L, T> &v) {
     Vec<L, I> out;
     for (size_t i = 0; i < L; i++)
         out[i] = iround<I>(v[i]);
@@ -219,7 +477,7 @@ Vec<L, I> iround(const Vec<L, T> &v) {
 }
 
 template <size_t L, typename T0, typename T1>
-decltype(T0(0) * T1(0)) dot(const Vec<L, T0> &a, const Vec<L, T1> &b) {
+constexpr decltype(T0(0) * T1(0)) dot(const Vec<L, T0> &a, const Vec<L, T1> &b) {
     decltype(T0(0) * T1(0)) out = 0;
     for (size_t i = 0; i < L; i++)
         out += a[i] * b[i];
@@ -227,18 +485,33 @@ decltype(T0(0) * T1(0)) dot(const Vec<L, T0> &a, const Vec<L, T1> &b) {
 }
 
 template <typename T0, typename T1>
-Vec3<decltype(T0(0) * T1(0))> cross(const Vec3<T0> &a, const Vec3<T1> &b) {
+constexpr Vec3<decltype(T0(0) * T1(0))> cross(const Vec3<T0> &a, const Vec3<T1> &b) {
     return Vec3<decltype(T0(0) * T1(0))>(
-        a.y * b.z - a.z * b.y,
-        a.z * b.x - a.x * b.z,
-        a.x * b.y - a.y * b.x);
+        a[1] * b[2] - a[2] * b[1],
+        a[2] * b[0] - a[0] * b[2],
+        a[0] * b[1] - a[1] * b[0]);
+}
+
+template <size_t L, typename T>
+constexpr T length(const Vec<L, T> &v) {
+    return sqrt(dot(v, v));
+}
+
+template <size_t L, typename T>
+constexpr Vec<L, T> normalize(const Vec<L, T> &v) {
+    return v / length(v);
+}
+
+template <size_t L, typename T>
+constexpr Vec<L, T> lerp(const Vec<L, T> &a, const Vec<L, T> &b, T t) {
+    return a + (b - a) * t;
 }
 
 // Operators
 
 #define ESEED_VEC_PRE(op)                                                 \
     template <size_t L, typename T, typename = decltype((*(new T(0)))op)> \
-    Vec<L, T> &operator op(Vec<L, T> &v) {                                \
+    constexpr Vec<L, T> &operator op(Vec<L, T> &v) {                                \
         for (size_t i = 0; i < L; i++)                                    \
             op v[i];                                                      \
         return v;                                                         \
@@ -246,7 +519,7 @@ Vec3<decltype(T0(0) * T1(0))> cross(const Vec3<T0> &a, const Vec3<T1> &b) {
 
 #define ESEED_VEC_POST(op)                                                \
     template <size_t L, typename T, typename = decltype((*(new T(0)))op)> \
-    Vec<L, T> operator op(Vec<L, T> &v, int) {                            \
+    constexpr Vec<L, T> operator op(Vec<L, T> &v, int) {                            \
         Vec<L, T> out = v;                                                \
         for (size_t i = 0; i < L; i++)                                    \
             v[i] op;                                                      \
@@ -255,7 +528,7 @@ Vec3<decltype(T0(0) * T1(0))> cross(const Vec3<T0> &a, const Vec3<T1> &b) {
 
 #define ESEED_VEC_UN(op)                                          \
     template <size_t L, typename T, typename = decltype(op T(0))> \
-    Vec<L, T> operator op(const Vec<L, T> &v) {                   \
+    constexpr Vec<L, T> operator op(const Vec<L, T> &v) {                   \
         Vec<L, T> out;                                            \
         for (size_t i = 0; i < L; i++)                            \
             out[i] = op v[i];                                     \
@@ -264,7 +537,7 @@ Vec3<decltype(T0(0) * T1(0))> cross(const Vec3<T0> &a, const Vec3<T1> &b) {
 
 #define ESEED_VEC_BIN_VV(op)                                                                \
     template <size_t L, typename T0, typename T1, typename TRes = decltype(T0(0) op T1(0))> \
-    Vec<L, TRes> operator op(const Vec<L, T0> &a, const Vec<L, T1> &b) {                    \
+    constexpr Vec<L, TRes> operator op(const Vec<L, T0> &a, const Vec<L, T1> &b) {                    \
         Vec<L, TRes> out;                                                                   \
         for (size_t i = 0; i < L; i++)                                                      \
             out[i] = a[i] op b[i];                                                          \
@@ -273,7 +546,7 @@ Vec3<decltype(T0(0) * T1(0))> cross(const Vec3<T0> &a, const Vec3<T1> &b) {
 
 #define ESEED_VEC_BIN_VS(op)                                                                \
     template <size_t L, typename T0, typename T1, typename TRes = decltype(T0(0) op T1(0))> \
-    Vec<L, TRes> operator op(const Vec<L, T0> &a, T1 b) {                                   \
+    constexpr Vec<L, TRes> operator op(const Vec<L, T0> &a, T1 b) {                                   \
         Vec<L, TRes> out;                                                                   \
         for (size_t i = 0; i < L; i++)                                                      \
             out[i] = a[i] op b;                                                             \
@@ -282,7 +555,7 @@ Vec3<decltype(T0(0) * T1(0))> cross(const Vec3<T0> &a, const Vec3<T1> &b) {
 
 #define ESEED_VEC_BIN_SV(op)                                                                \
     template <size_t L, typename T0, typename T1, typename TRes = decltype(T0(0) op T1(0))> \
-    Vec<L, TRes> operator op(const T0 &a, const Vec<L, T1> &b) {                            \
+    constexpr Vec<L, TRes> operator op(const T0 &a, const Vec<L, T1> &b) {                            \
         Vec<L, TRes> out;                                                                   \
         for (size_t i = 0; i < L; i++)                                                      \
             out[i] = a op b[i];                                                             \
@@ -291,7 +564,7 @@ Vec3<decltype(T0(0) * T1(0))> cross(const Vec3<T0> &a, const Vec3<T1> &b) {
 
 #define ESEED_VEC_ASSN_VV(op)                                                          \
     template <size_t L, typename T0, typename T1, typename = decltype(T0(0) op T1(0))> \
-    Vec<L, T0> &operator op##=(Vec<L, T0> &a, const Vec<L, T1> &b) {                   \
+    constexpr Vec<L, T0> &operator op##=(Vec<L, T0> &a, const Vec<L, T1> &b) {                   \
         for (size_t i = 0; i < L; i++)                                                 \
             a[i] op##= b[i];                                                           \
         return a;                                                                      \
@@ -299,7 +572,7 @@ Vec3<decltype(T0(0) * T1(0))> cross(const Vec3<T0> &a, const Vec3<T1> &b) {
 
 #define ESEED_VEC_ASSN_VS(op)                                                          \
     template <size_t L, typename T0, typename T1, typename = decltype(T0(0) op T1(0))> \
-    Vec<L, T0> &operator op##=(Vec<L, T0> &a, T1 b) {                                  \
+    constexpr Vec<L, T0> &operator op##=(Vec<L, T0> &a, T1 b) {                                  \
         for (size_t i = 0; i < L; i++)                                                 \
             a[i] op##= b;                                                              \
         return a;                                                                      \
@@ -377,4 +650,6 @@ ESEED_VEC_ASSN_VS(^)
 ESEED_VEC_ASSN_VS(<<)
 ESEED_VEC_ASSN_VS(>>)
 
-}
\ No newline at end of file
+}
+
+#include "vecsimd.hpp"
\ No newline at end of file
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "mat.hpp"
+#include "pack.hpp"
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace esdm {
+
+// Structure-of-arrays storage for many Vec<L, T>: one contiguous array per
+// component (x[], y[], z[], ...) so batch kernels can load a full SIMD
+// register of x components at once
+template <size_t L, typename T>
+class VecBatch {
+public:
+    VecBatch() {}
+
+    explicit VecBatch(size_t size) {
+        resize(size);
+    }
+
+    explicit VecBatch(const std::vector<Vec<L, T>> &vecs) {
+        resize(vecs.size());
+        for (size_t i = 0; i < vecs.size(); i++)
+            set(i, vecs[i]);
+    }
+
+    size_t size() const {
+        return lanes[0].size();
+    }
+
+    void resize(size_t size) {
+        for (auto &lane : lanes)
+            lane.resize(size);
+    }
+
+    // Contiguous array holding component "c" of every vector
+    T *lane(size_t c) {
+        return lanes[c].data();
+    }
+
+    const T *lane(size_t c) const {
+        return lanes[c].data();
+    }
+
+    T *x() { return lane(0); }
+    T *y() { static_assert(L > 1, "VecBatch has no y lane"); return lane(1); }
+    T *z() { static_assert(L > 2, "VecBatch has no z lane"); return lane(2); }
+    T *w() { static_assert(L > 3, "VecBatch has no w lane"); return lane(3); }
+
+    const T *x() const { return lane(0); }
+    const T *y() const { static_assert(L > 1, "VecBatch has no y lane"); return lane(1); }
+    const T *z() const { static_assert(L > 2, "VecBatch has no z lane"); return lane(2); }
+    const T *w() const { static_assert(L > 3, "VecBatch has no w lane"); return lane(3); }
+
+    Vec<L, T> get(size_t i) const {
+        Vec<L, T> v;
+        for (size_t c = 0; c < L; c++)
+            v[c] = lanes[c][i];
+        return v;
+    }
+
+    void set(size_t i, const Vec<L, T> &v) {
+        for (size_t c = 0; c < L; c++)
+            lanes[c][i] = v[c];
+    }
+
+    std::vector<Vec<L, T>> toVecs() const {
+        std::vector<Vec<L, T>> vecs(size());
+        for (size_t i = 0; i < vecs.size(); i++)
+            vecs[i] = get(i);
+        return vecs;
+    }
+
+private:
+    std::array<std::vector<T>, L> lanes;
+};
+
+using Vec3Stream = VecBatch<3, float>;
+
+template <size_t L, typename T>
+VecBatch<L, T> toBatch(const std::vector<Vec<L, T>> &vecs) {
+    return VecBatch<L, T>(vecs);
+}
+
+template <size_t L, typename T>
+std::vector<Vec<L, T>> toVecs(const VecBatch<L, T> &batch) {
+    return batch.toVecs();
+}
+
+namespace detail {
+
+template <typename A, typename B>
+void checkBatchSizes(const A &a, const B &b) {
+    if (a.size() != b.size())
+        throw std::invalid_argument("Batch kernel inputs have different sizes");
+}
+
+}
+
+// Batch kernels
+// Each output is resized to the input size and may alias an input
+// Kernels taking two batches throw std::invalid_argument if their sizes
+// differ
+// Inputs of at least batchGrain elements per thread are split across threads
+
+// out[i] = [ in[i], 1 ] * m, without perspective divide
+template <typename T>
+void transformPoints(const Mat4<T> &m, const VecBatch<3, T> &in, VecBatch<3, T> &out) {
+    out.resize(in.size());
+    batchFor<T>(in.size(), [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        P x = P::load(in.x() + i);
+        P y = P::load(in.y() + i);
+        P z = P::load(in.z() + i);
+        for (size_t c = 0; c < 3; c++) {
+            P r = madd(x, P::splat(m.data[0][c]), P::splat(m.data[3][c]));
+            r = madd(y, P::splat(m.data[1][c]), r);
+            r = madd(z, P::splat(m.data[2][c]), r);
+            r.store(out.lane(c) + i);
+        }
+    });
+}
+
+// out[i] = [ in[i], 0 ] * m
+template <typename T>
+void transformDirections(const Mat4<T> &m, const VecBatch<3, T> &in, VecBatch<3, T> &out) {
+    out.resize(in.size());
+    batchFor<T>(in.size(), [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        P x = P::load(in.x() + i);
+        P y = P::load(in.y() + i);
+        P z = P::load(in.z() + i);
+        for (size_t c = 0; c < 3; c++) {
+            P r = x * P::splat(m.data[0][c]);
+            r = madd(y, P::splat(m.data[1][c]), r);
+            r = madd(z, P::splat(m.data[2][c]), r);
+            r.store(out.lane(c) + i);
+        }
+    });
+}
+
+template <size_t L, typename T>
+void dot(const VecBatch<L, T> &a, const VecBatch<L, T> &b, std::vector<T> &out) {
+    detail::checkBatchSizes(a, b);
+    out.resize(a.size());
+    batchFor<T>(a.size(), [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        P r = P::load(a.lane(0) + i) * P::load(b.lane(0) + i);
+        for (size_t c = 1; c < L; c++)
+            r = madd(P::load(a.lane(c) + i), P::load(b.lane(c) + i), r);
+        r.store(out.data() + i);
+    });
+}
+
+template <typename T>
+void cross(const VecBatch<3, T> &a, const VecBatch<3, T> &b, VecBatch<3, T> &out) {
+    detail::checkBatchSizes(a, b);
+    out.resize(a.size());
+    batchFor<T>(a.size(), [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        P ax = P::load(a.x() + i), ay = P::load(a.y() + i), az = P::load(a.z() + i);
+        P bx = P::load(b.x() + i), by = P::load(b.y() + i), bz = P::load(b.z() + i);
+        (ay * bz - az * by).store(out.x() + i);
+        (az * bx - ax * bz).store(out.y() + i);
+        (ax * by - ay * bx).store(out.z() + i);
+    });
+}
+
+// Zero-length inputs produce NaN, same as esdm::normalize
+template <size_t L, typename T>
+void normalize(const VecBatch<L, T> &in, VecBatch<L, T> &out) {
+    out.resize(in.size());
+    batchFor<T>(in.size(), [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        P v[L];
+        P lengthSq = P::splat(T(0));
+        for (size_t c = 0; c < L; c++) {
+            v[c] = P::load(in.lane(c) + i);
+            lengthSq = madd(v[c], v[c], lengthSq);
+        }
+        P length = sqrt(lengthSq);
+        for (size_t c = 0; c < L; c++)
+            (v[c] / length).store(out.lane(c) + i);
+    });
+}
+
+// out[i] = a[i] + (b[i] - a[i]) * t
+template <size_t L, typename T>
+void lerp(const VecBatch<L, T> &a, const VecBatch<L, T> &b, T t, VecBatch<L, T> &out) {
+    detail::checkBatchSizes(a, b);
+    out.resize(a.size());
+    batchFor<T>(a.size(), [&](auto pack, size_t i) {
+        using P = decltype(pack);
+        P pt = P::splat(t);
+        for (size_t c = 0; c < L; c++) {
+            P pa = P::load(a.lane(c) + i);
+            madd(P::load(b.lane(c) + i) - pa, pt, pa).store(out.lane(c) + i);
+        }
+    });
+}
+
+}
\ No newline at end of file
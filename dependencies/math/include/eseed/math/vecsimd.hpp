@@ -0,0 +1,490 @@
+#pragma once
+
+#include "vec.hpp"
+
+// SIMD overloads for Vec4<float>, Vec3<float> and Vec4<int32_t>
+// These are plain (non-template) overloads, so overload resolution picks
+// them over the generic ESEED_VEC_* templates whenever both operands match
+// exactly. Mixed-type expressions (e.g. Vec4<float> * double) still go
+// through the generic templates and keep their promotion rules.
+// Intrinsics can't run during constant evaluation, so there every overload
+// falls back to the generic template it replaces.
+
+#if defined(ESDM_SIMD_SSE2)
+
+namespace esdm {
+
+namespace simd {
+
+inline Vec4<float> toVec4(__m128 v) {
+    Vec4<float> out;
+    out.simd = v;
+    return out;
+}
+
+inline Vec3<float> toVec3(__m128 v) {
+    Vec3<float> out;
+    out.simd = v;
+    return out;
+}
+
+inline Vec4<int32_t> toVec4(__m128i v) {
+    Vec4<int32_t> out;
+    out.simd = v;
+    return out;
+}
+
+// Broadcast a scalar to x, y and z, leaving the Vec3 pad lane at 0
+inline __m128 splat3(float s) {
+    return _mm_setr_ps(s, s, s, 0.f);
+}
+
+// Clears the Vec3 pad lane (e.g. after a 0 / 0)
+inline __m128 maskXyz(__m128 v) {
+    return _mm_and_ps(v, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+}
+
+inline float hsum(__m128 v) {
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+inline __m128 abs(__m128 v) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.f), v);
+}
+
+inline __m128 neg(__m128 v) {
+    return _mm_xor_ps(_mm_set1_ps(-0.f), v);
+}
+
+}
+
+// Vec4<float>
+
+#define ESEED_VEC4F_BIN(op, intrin)                                                  \
+    constexpr Vec4<float> operator op(const Vec4<float> &a, const Vec4<float> &b) { \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                            \
+            return operator op<4, float, float>(a, b);                               \
+        return simd::toVec4(intrin(a.simd, b.simd));                                 \
+    }                                                                                \
+    constexpr Vec4<float> operator op(const Vec4<float> &a, float b) {              \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                            \
+            return operator op<4, float, float>(a, b);                               \
+        return simd::toVec4(intrin(a.simd, _mm_set1_ps(b)));                         \
+    }                                                                                \
+    constexpr Vec4<float> operator op(float a, const Vec4<float> &b) {              \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                            \
+            return operator op<4, float, float>(a, b);                               \
+        return simd::toVec4(intrin(_mm_set1_ps(a), b.simd));                         \
+    }                                                                                \
+    constexpr Vec4<float> &operator op##=(Vec4<float> &a, const Vec4<float> &b) {   \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                            \
+            return operator op##=<4, float, float>(a, b);                            \
+        a.simd = intrin(a.simd, b.simd);                                             \
+        return a;                                                                    \
+    }                                                                                \
+    constexpr Vec4<float> &operator op##=(Vec4<float> &a, float b) {                \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                            \
+            return operator op##=<4, float, float>(a, b);                            \
+        a.simd = intrin(a.simd, _mm_set1_ps(b));                                     \
+        return a;                                                                    \
+    }
+
+ESEED_VEC4F_BIN(+, _mm_add_ps)
+ESEED_VEC4F_BIN(-, _mm_sub_ps)
+ESEED_VEC4F_BIN(*, _mm_mul_ps)
+ESEED_VEC4F_BIN(/, _mm_div_ps)
+
+#undef ESEED_VEC4F_BIN
+
+constexpr Vec4<float> operator-(const Vec4<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator-<4, float>(v);
+    return simd::toVec4(simd::neg(v.simd));
+}
+
+constexpr Vec4<float> operator+(const Vec4<float> &v) {
+    return v;
+}
+
+constexpr float dot(const Vec4<float> &a, const Vec4<float> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return dot<4, float, float>(a, b);
+    return simd::hsum(_mm_mul_ps(a.simd, b.simd));
+}
+
+constexpr Vec4<float> abs(const Vec4<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return abs<4, float>(v);
+    return simd::toVec4(simd::abs(v.simd));
+}
+
+// Vec3<float>
+// Every operation keeps the pad lane at 0, so horizontal ops can use all
+// four lanes without masking
+
+#define ESEED_VEC3F_BIN(op, intrin, fix)                                             \
+    constexpr Vec3<float> operator op(const Vec3<float> &a, const Vec3<float> &b) { \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                            \
+            return operator op<3, float, float>(a, b);                               \
+        return simd::toVec3(fix(intrin(a.simd, b.simd)));                            \
+    }                                                                                \
+    constexpr Vec3<float> operator op(const Vec3<float> &a, float b) {              \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                            \
+            return operator op<3, float, float>(a, b);                               \
+        return simd::toVec3(fix(intrin(a.simd, simd::splat3(b))));                   \
+    }                                                                                \
+    constexpr Vec3<float> operator op(float a, const Vec3<float> &b) {              \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                            \
+            return operator op<3, float, float>(a, b);                               \
+        return simd::toVec3(fix(intrin(simd::splat3(a), b.simd)));                   \
+    }                                                                                \
+    constexpr Vec3<float> &operator op##=(Vec3<float> &a, const Vec3<float> &b) {   \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                            \
+            return operator op##=<3, float, float>(a, b);                            \
+        a.simd = fix(intrin(a.simd, b.simd));                                        \
+        return a;                                                                    \
+    }                                                                                \
+    constexpr Vec3<float> &operator op##=(Vec3<float> &a, float b) {                \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                            \
+            return operator op##=<3, float, float>(a, b);                            \
+        a.simd = fix(intrin(a.simd, simd::splat3(b)));                               \
+        return a;                                                                    \
+    }
+
+#define ESEED_VEC3F_NOFIX(v) (v)
+
+ESEED_VEC3F_BIN(+, _mm_add_ps, ESEED_VEC3F_NOFIX)
+ESEED_VEC3F_BIN(-, _mm_sub_ps, ESEED_VEC3F_NOFIX)
+ESEED_VEC3F_BIN(*, _mm_mul_ps, ESEED_VEC3F_NOFIX)
+ESEED_VEC3F_BIN(/, _mm_div_ps, simd::maskXyz)
+
+#undef ESEED_VEC3F_NOFIX
+#undef ESEED_VEC3F_BIN
+
+constexpr Vec3<float> operator-(const Vec3<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator-<3, float>(v);
+    return simd::toVec3(_mm_sub_ps(_mm_setzero_ps(), v.simd));
+}
+
+constexpr Vec3<float> operator+(const Vec3<float> &v) {
+    return v;
+}
+
+constexpr float dot(const Vec3<float> &a, const Vec3<float> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return dot<3, float, float>(a, b);
+    return simd::hsum(_mm_mul_ps(a.simd, b.simd));
+}
+
+constexpr Vec3<float> cross(const Vec3<float> &a, const Vec3<float> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return cross<float, float>(a, b);
+    __m128 aYzx = _mm_shuffle_ps(a.simd, a.simd, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 bYzx = _mm_shuffle_ps(b.simd, b.simd, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 c = _mm_sub_ps(_mm_mul_ps(a.simd, bYzx), _mm_mul_ps(aYzx, b.simd));
+    return simd::toVec3(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+}
+
+constexpr Vec3<float> abs(const Vec3<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return abs<3, float>(v);
+    return simd::toVec3(simd::abs(v.simd));
+}
+
+#if defined(ESDM_SIMD_SSE41)
+
+constexpr Vec4<float> trunc(const Vec4<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return trunc<4, float>(v);
+    return simd::toVec4(_mm_round_ps(v.simd, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+}
+
+constexpr Vec4<float> floor(const Vec4<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return floor<4, float>(v);
+    return simd::toVec4(_mm_floor_ps(v.simd));
+}
+
+constexpr Vec4<float> ceil(const Vec4<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return ceil<4, float>(v);
+    return simd::toVec4(_mm_ceil_ps(v.simd));
+}
+
+constexpr Vec3<float> trunc(const Vec3<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return trunc<3, float>(v);
+    return simd::toVec3(_mm_round_ps(v.simd, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+}
+
+constexpr Vec3<float> floor(const Vec3<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return floor<3, float>(v);
+    return simd::toVec3(_mm_floor_ps(v.simd));
+}
+
+constexpr Vec3<float> ceil(const Vec3<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return ceil<3, float>(v);
+    return simd::toVec3(_mm_ceil_ps(v.simd));
+}
+
+#endif
+
+// See ops.hpp for "i" functions explanation
+// These specialize the generic templates, so the compile-time path is
+// spelled out per lane
+
+template <>
+constexpr Vec4<int32_t> itrunc<int32_t, 4, float>(const Vec4<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return Vec4<int32_t>(itrunc<int32_t>(v[0]), itrunc<int32_t>(v[1]), itrunc<int32_t>(v[2]), itrunc<int32_t>(v[3]));
+    return simd::toVec4(_mm_cvttps_epi32(v.simd));
+}
+
+template <>
+constexpr Vec4<int32_t> ifloor<int32_t, 4, float>(const Vec4<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return Vec4<int32_t>(ifloor<int32_t>(v[0]), ifloor<int32_t>(v[1]), ifloor<int32_t>(v[2]), ifloor<int32_t>(v[3]));
+    __m128i t = _mm_cvttps_epi32(v.simd);
+    // Compare mask is all ones (-1) in every lane that truncated upwards
+    __m128 above = _mm_cmplt_ps(v.simd, _mm_cvtepi32_ps(t));
+    return simd::toVec4(_mm_add_epi32(t, _mm_castps_si128(above)));
+}
+
+template <>
+constexpr Vec4<int32_t> iceil<int32_t, 4, float>(const Vec4<float> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return Vec4<int32_t>(iceil<int32_t>(v[0]), iceil<int32_t>(v[1]), iceil<int32_t>(v[2]), iceil<int32_t>(v[3]));
+    __m128i t = _mm_cvttps_epi32(v.simd);
+    __m128 below = _mm_cmpgt_ps(v.simd, _mm_cvtepi32_ps(t));
+    return simd::toVec4(_mm_sub_epi32(t, _mm_castps_si128(below)));
+}
+
+// Vec4<int32_t>
+
+#define ESEED_VEC4I_BIN(op, intrin)                                                        \
+    constexpr Vec4<int32_t> operator op(const Vec4<int32_t> &a, const Vec4<int32_t> &b) { \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                                  \
+            return operator op<4, int32_t, int32_t>(a, b);                                 \
+        return simd::toVec4(intrin(a.simd, b.simd));                                       \
+    }                                                                                      \
+    constexpr Vec4<int32_t> operator op(const Vec4<int32_t> &a, int32_t b) {              \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                                  \
+            return operator op<4, int32_t, int32_t>(a, b);                                 \
+        return simd::toVec4(intrin(a.simd, _mm_set1_epi32(b)));                            \
+    }                                                                                      \
+    constexpr Vec4<int32_t> operator op(int32_t a, const Vec4<int32_t> &b) {              \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                                  \
+            return operator op<4, int32_t, int32_t>(a, b);                                 \
+        return simd::toVec4(intrin(_mm_set1_epi32(a), b.simd));                            \
+    }                                                                                      \
+    constexpr Vec4<int32_t> &operator op##=(Vec4<int32_t> &a, const Vec4<int32_t> &b) {   \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                                  \
+            return operator op##=<4, int32_t, int32_t>(a, b);                              \
+        a.simd = intrin(a.simd, b.simd);                                                   \
+        return a;                                                                          \
+    }                                                                                      \
+    constexpr Vec4<int32_t> &operator op##=(Vec4<int32_t> &a, int32_t b) {                \
+        if (ESDM_IS_CONSTANT_EVALUATED())                                                  \
+            return operator op##=<4, int32_t, int32_t>(a, b);                              \
+        a.simd = intrin(a.simd, _mm_set1_epi32(b));                                        \
+        return a;                                                                          \
+    }
+
+ESEED_VEC4I_BIN(+, _mm_add_epi32)
+ESEED_VEC4I_BIN(-, _mm_sub_epi32)
+ESEED_VEC4I_BIN(&, _mm_and_si128)
+ESEED_VEC4I_BIN(|, _mm_or_si128)
+ESEED_VEC4I_BIN(^, _mm_xor_si128)
+#if defined(ESDM_SIMD_SSE41)
+ESEED_VEC4I_BIN(*, _mm_mullo_epi32)
+#endif
+
+#undef ESEED_VEC4I_BIN
+
+// Shifts by a scalar count, matching int32_t semantics for counts in [0, 32)
+
+constexpr Vec4<int32_t> operator<<(const Vec4<int32_t> &a, int32_t b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator<< <4, int32_t, int32_t>(a, b);
+    return simd::toVec4(_mm_sll_epi32(a.simd, _mm_cvtsi32_si128(b)));
+}
+
+constexpr Vec4<int32_t> operator>>(const Vec4<int32_t> &a, int32_t b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator>> <4, int32_t, int32_t>(a, b);
+    return simd::toVec4(_mm_sra_epi32(a.simd, _mm_cvtsi32_si128(b)));
+}
+
+constexpr Vec4<int32_t> &operator<<=(Vec4<int32_t> &a, int32_t b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator<<= <4, int32_t, int32_t>(a, b);
+    a.simd = _mm_sll_epi32(a.simd, _mm_cvtsi32_si128(b));
+    return a;
+}
+
+constexpr Vec4<int32_t> &operator>>=(Vec4<int32_t> &a, int32_t b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator>>= <4, int32_t, int32_t>(a, b);
+    a.simd = _mm_sra_epi32(a.simd, _mm_cvtsi32_si128(b));
+    return a;
+}
+
+#if defined(ESDM_SIMD_AVX2)
+
+constexpr Vec4<int32_t> operator<<(const Vec4<int32_t> &a, const Vec4<int32_t> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator<< <4, int32_t, int32_t>(a, b);
+    return simd::toVec4(_mm_sllv_epi32(a.simd, b.simd));
+}
+
+constexpr Vec4<int32_t> operator>>(const Vec4<int32_t> &a, const Vec4<int32_t> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator>> <4, int32_t, int32_t>(a, b);
+    return simd::toVec4(_mm_srav_epi32(a.simd, b.simd));
+}
+
+constexpr Vec4<int32_t> &operator<<=(Vec4<int32_t> &a, const Vec4<int32_t> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator<<= <4, int32_t, int32_t>(a, b);
+    a.simd = _mm_sllv_epi32(a.simd, b.simd);
+    return a;
+}
+
+constexpr Vec4<int32_t> &operator>>=(Vec4<int32_t> &a, const Vec4<int32_t> &b) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator>>= <4, int32_t, int32_t>(a, b);
+    a.simd = _mm_srav_epi32(a.simd, b.simd);
+    return a;
+}
+
+#endif
+
+constexpr Vec4<int32_t> operator-(const Vec4<int32_t> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator-<4, int32_t>(v);
+    return simd::toVec4(_mm_sub_epi32(_mm_setzero_si128(), v.simd));
+}
+
+constexpr Vec4<int32_t> operator~(const Vec4<int32_t> &v) {
+    if (ESDM_IS_CONSTANT_EVALUATED())
+        return operator~<4, int32_t>(v);
+    return simd::toVec4(_mm_xor_si128(v.simd, _mm_set1_epi32(-1)));
+}
+
+constexpr Vec4<int32_t> operator+(const Vec4<int32_t> &v) {
+    return v;
+}
+
+// Swizzles
+// Reads to a 3 or 4 component Vec are one shuffle (plus a mask to clear the
+// pad lane when a Vec4 becomes a Vec3); writes from one are a shuffle and
+// a blend. Two component swizzles have no SIMD storage and stay generic.
+
+namespace detail {
+
+// _MM_SHUFFLE immediate moving source lane I[k] to lane k, "fill" to the
+// lanes past the end
+template <size_t Fill, size_t... I>
+constexpr int swizzleReadMask() {
+    size_t lanes[4] = { Fill, Fill, Fill, Fill };
+    size_t k = 0;
+    ((lanes[k++] = I), ...);
+    return int(lanes[0] | lanes[1] << 2 | lanes[2] << 4 | lanes[3] << 6);
+}
+
+// Inverse of the above, moving lane k of the swizzled value back to lane
+// I[k], lanes not written taking lane "fill"
+template <size_t Fill, size_t... I>
+constexpr int swizzleWriteMask() {
+    size_t lanes[4] = { Fill, Fill, Fill, Fill };
+    size_t k = 0;
+    ((lanes[I] = k++), ...);
+    return int(lanes[0] | lanes[1] << 2 | lanes[2] << 4 | lanes[3] << 6);
+}
+
+template <size_t... I>
+inline __m128i swizzleWritten() {
+    int32_t lanes[4] = { 0, 0, 0, 0 };
+    ((lanes[I] = -1), ...);
+    return _mm_setr_epi32(lanes[0], lanes[1], lanes[2], lanes[3]);
+}
+
+template <size_t L, size_t... I>
+struct Swizzle<L, float, I...> : SwizzleComponents<L, float, I...> {
+    static constexpr size_t size = sizeof...(I);
+    static constexpr bool simd = (L == 3 || L == 4) && (size == 3 || size == 4);
+
+    static constexpr Vec<size, float> get(const Vec<L, float> &v) {
+        if constexpr (simd) {
+            if (!ESDM_IS_CONSTANT_EVALUATED()) {
+                // A Vec3 source fills the Vec3 pad lane from its own, which
+                // is already 0
+                constexpr int mask = swizzleReadMask<3, I...>();
+                Vec<size, float> out;
+                out.simd = _mm_shuffle_ps(v.simd, v.simd, mask);
+                if constexpr (L == 4 && size == 3)
+                    out.simd = simd::maskXyz(out.simd);
+                return out;
+            }
+        }
+        return SwizzleComponents<L, float, I...>::get(v);
+    }
+
+    static constexpr void set(Vec<L, float> &v, const Vec<size, float> &s) {
+        if constexpr (simd) {
+            if (!ESDM_IS_CONSTANT_EVALUATED()) {
+                // Writing every component of a Vec3 moves the 0 pad lane of
+                // s into the pad, so only partial writes need the blend
+                constexpr int mask = swizzleWriteMask<3, I...>();
+                const __m128 moved = _mm_shuffle_ps(s.simd, s.simd, mask);
+                if constexpr (size == L) {
+                    v.simd = moved;
+                } else {
+                    const __m128 written = _mm_castsi128_ps(swizzleWritten<I...>());
+                    v.simd = _mm_or_ps(_mm_and_ps(written, moved), _mm_andnot_ps(written, v.simd));
+                }
+                return;
+            }
+        }
+        SwizzleComponents<L, float, I...>::set(v, s);
+    }
+};
+
+template <size_t... I>
+struct Swizzle<4, int32_t, I...> : SwizzleComponents<4, int32_t, I...> {
+    static constexpr size_t size = sizeof...(I);
+
+    static constexpr Vec<size, int32_t> get(const Vec<4, int32_t> &v) {
+        if constexpr (size == 4) {
+            if (!ESDM_IS_CONSTANT_EVALUATED()) {
+                constexpr int mask = swizzleReadMask<0, I...>();
+                return simd::toVec4(_mm_shuffle_epi32(v.simd, mask));
+            }
+        }
+        return SwizzleComponents<4, int32_t, I...>::get(v);
+    }
+
+    static constexpr void set(Vec<4, int32_t> &v, const Vec<size, int32_t> &s) {
+        if constexpr (size == 4) {
+            if (!ESDM_IS_CONSTANT_EVALUATED()) {
+                constexpr int mask = swizzleWriteMask<0, I...>();
+                v.simd = _mm_shuffle_epi32(s.simd, mask);
+                return;
+            }
+        }
+        SwizzleComponents<4, int32_t, I...>::set(v, s);
+    }
+};
+
+}
+
+}
+
+#endif
\ No newline at end of file
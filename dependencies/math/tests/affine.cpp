@@ -0,0 +1,115 @@
+// Affine3 against the Mat4 it stands for: construction, compose, point and
+// direction transforms and both inverses, and the Affine3<float> SIMD
+// overloads against the generic templates
+
+#include <eseed/math/affine.hpp>
+#include <eseed/math/matops.hpp>
+#include <eseed/math/cxmath.hpp>
+
+#include "check.hpp"
+
+using namespace esdm;
+using test::equal;
+using test::near;
+
+namespace {
+
+// Known answers, through the generic path during constant evaluation
+constexpr Affine3<float> shift(Mat3<float>(1.f), Vec3<float>(1.f, 2.f, 3.f));
+static_assert(equal(transformPoint(shift, Vec3<float>(1.f, 1.f, 1.f)), Vec3<float>(2.f, 3.f, 4.f)));
+static_assert(equal(transformDirection(shift, Vec3<float>(1.f, 1.f, 1.f)), Vec3<float>(1.f, 1.f, 1.f)));
+static_assert(equal(toMat4(shift), matTranslate(Vec3<float>(1.f, 2.f, 3.f))));
+static_assert(equal(toMat4(Affine3<float>()), Mat4<float>(1.f)));
+
+constexpr Mat4<double> turn = matRotate(Vec3<double>(0., 0., 1.), double(cx::widePi / 2));
+constexpr Affine3<double> turnThenShift = matmul(Affine3<double>(turn), Affine3<double>(Mat3<double>(1.), Vec3<double>(1., 2., 3.)));
+static_assert(near(transformPoint(turnThenShift, Vec3<double>(1., 0., 0.)), Vec3<double>(1., 3., 3.), 1e-12));
+static_assert(near(toMat4(turnThenShift), matmul(turn, matTranslate(Vec3<double>(1., 2., 3.))), 1e-12));
+static_assert(near(toMat4(matmul(turnThenShift, inverseRigid(turnThenShift))), Mat4<double>(1.), 1e-12));
+static_assert(near(toMat4(matmul(turnThenShift, inverse(turnThenShift))), Mat4<double>(1.), 1e-12));
+
+Vec3<float> randomVec3(float lo, float hi) {
+    return Vec3<float>(test::randomFloat(lo, hi), test::randomFloat(lo, hi), test::randomFloat(lo, hi));
+}
+
+Affine3<float> randomRigid() {
+    const Vec3<float> axis = normalize(randomVec3(-1.f, 1.f) + Vec3<float>(0.f, 0.f, 2.f));
+    return Affine3<float>(matmul(matRotate(axis, test::randomFloat(-3.f, 3.f)), matTranslate(randomVec3(-10.f, 10.f))));
+}
+
+Affine3<float> randomAffine() {
+    Affine3<float> a;
+    for (size_t r = 0; r < 3; r++)
+        for (size_t i = 0; i < 4; i++)
+            a.data[r][i] = test::randomFloat(-2.f, 2.f);
+    return a;
+}
+
+bool nearAffine(const Affine3<float> &a, const Affine3<float> &b, float tolerance) {
+    return near(toMat4(a), toMat4(b), tolerance);
+}
+
+float linearDeterminant(const Affine3<float> &a) {
+    Mat3<float> linear;
+    for (size_t r = 0; r < 3; r++)
+        for (size_t i = 0; i < 3; i++)
+            linear.data[r][i] = a.data[r][i];
+    return determinant(linear);
+}
+
+// Exact unless FMA lets one side round once where the other rounds twice
+template <typename V>
+bool matches(const V &a, const V &b) {
+#if defined(ESDM_SIMD_FMA)
+    return near(a, b, 1e-5f);
+#else
+    return test::same(a, b);
+#endif
+}
+
+void testAgainstMat4() {
+    for (int n = 0; n < 1000; n++) {
+        const Affine3<float> a = randomAffine();
+        const Affine3<float> b = randomAffine();
+        const Vec3<float> p = randomVec3(-10.f, 10.f);
+        const Mat4<float> ma = toMat4(a);
+
+        CHECK(test::same(toMat4(a), toMat4<float>(a)));
+        CHECK(test::same(toMat4(Affine3<float>(ma)), ma));
+        CHECK(near(toMat4(matmul(a, b)), matmul(ma, toMat4(b)), 1e-4f));
+        CHECK(near(transformPoint(a, p), Vec3<float>(matmul(Vec4<float>(p[0], p[1], p[2], 1.f), ma).xyz()), 1e-4f));
+        CHECK(near(transformDirection(a, p), Vec3<float>(matmul(Vec4<float>(p[0], p[1], p[2], 0.f), ma).xyz()), 1e-4f));
+
+        // The SIMD overloads against the templates they replace
+        CHECK(matches(toMat4(matmul(a, b)), toMat4(matmul<float>(a, b))));
+        CHECK(near(transformPoint(a, p), transformPoint<float>(a, p), 1e-5f));
+        CHECK(near(transformDirection(a, p), transformDirection<float>(a, p), 1e-5f));
+
+        // Skip the nearly singular ones, where the inverse loses most digits
+        if (std::abs(linearDeterminant(a)) < 0.1f)
+            continue;
+        CHECK(nearAffine(matmul(a, inverse(a)), Affine3<float>(), 1e-3f));
+        CHECK(near(toMat4(inverse(a)), inverse(ma), 1e-3f));
+    }
+}
+
+void testRigid() {
+    for (int n = 0; n < 1000; n++) {
+        const Affine3<float> a = randomRigid();
+        const Vec3<float> p = randomVec3(-10.f, 10.f);
+        CHECK(nearAffine(inverseRigid(a), inverseRigid<float>(a), 1e-5f));
+        CHECK(nearAffine(inverseRigid(a), inverse(a), 1e-4f));
+        CHECK(near(toMat4(inverseRigid(a)), inverseRigid(toMat4(a)), 1e-4f));
+        CHECK(near(transformPoint(inverseRigid(a), transformPoint(a, p)), p, 1e-4f));
+        // Rotations keep lengths and angles
+        CHECK_NEAR(length(transformDirection(a, p)), length(p), 1e-4f);
+    }
+}
+
+}
+
+int main() {
+    testAgainstMat4();
+    testRigid();
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,274 @@
+// Arrays and views: known offsets for each layout, every layout mapping its
+// extents one to one into its storage with the runs it reports really
+// contiguous, and forEach / forEachSpan / transform / fill visiting each
+// element of views and sub-views exactly once, threaded or not
+
+#include <eseed/math/array.hpp>
+
+#include "check.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace esdm;
+using test::equal;
+
+namespace {
+
+// x-major, like CHUNK_SIZE volumes
+constexpr LayoutStrided<3> strided(Index<3>(4, 5, 6));
+static_assert(equal(strided.strides, Index<3>(1, 4, 20)));
+static_assert(strided.size() == 120);
+static_assert(strided.offset(Index<3>(3, 2, 1)) == 3 + 2 * 4 + 1 * 20);
+static_assert(strided.run(Index<3>(1, 0, 0), 3) == 3);
+static_assert(LayoutStrided<2>(Index<2>(5, 1), 10).run(Index<2>(0, 0), 4) == 1);
+
+// Two 8^3 bricks along x, one along y and z
+constexpr LayoutTiled<3> tiled(Index<3>(9, 8, 1));
+static_assert(equal(tiled.tiles, Index<3>(2, 1, 1)));
+static_assert(tiled.size() == 1024);
+static_assert(tiled.offset(Index<3>(7, 0, 0)) == 7);
+static_assert(tiled.offset(Index<3>(8, 0, 0)) == 512);
+static_assert(tiled.offset(Index<3>(1, 2, 0)) == 17);
+static_assert(tiled.run(Index<3>(5, 0, 0), 100) == 3);
+static_assert(tiled.run(Index<3>(8, 0, 0), 1) == 1);
+
+// Bits interleaved x, y, z from the bottom
+constexpr LayoutMorton<3> morton3(Index<3>(5, 3, 2));
+static_assert(morton3.side == 8 && morton3.size() == 512);
+static_assert(morton3.offset(Index<3>(1, 0, 0)) == 1);
+static_assert(morton3.offset(Index<3>(0, 1, 0)) == 2);
+static_assert(morton3.offset(Index<3>(0, 0, 1)) == 4);
+static_assert(morton3.offset(Index<3>(3, 3, 3)) == 63);
+static_assert(morton3.offset(Index<3>(4, 0, 0)) == 64);
+static_assert(morton3.run(Index<3>(2, 0, 0), 5) == 2);
+static_assert(morton3.run(Index<3>(3, 0, 0), 5) == 1);
+static_assert(LayoutMorton<2>(Index<2>(3, 3)).offset(Index<2>(3, 1)) == 7);
+
+// Views move the origin and keep the layout
+constexpr ArrayView<const int, 3> window(nullptr, strided, Index<3>(1, 1, 1), Index<3>(2, 2, 2));
+static_assert(window.size() == 8);
+static_assert(window.subview(Index<3>(1, 0, 1), Index<3>(1, 2, 1)).getOrigin().data[2] == 2);
+static_assert(window.run(Index<3>(1, 0, 0)) == 1);
+
+// Every index inside the extents gets its own offset below size(), and each
+// run it reports covers consecutive offsets
+template <typename Layout>
+void checkLayout(const Index<3> &extents) {
+    const Layout layout(extents);
+    std::vector<int> hits(layout.size(), 0);
+    size_t badRuns = 0;
+    for (size_t z = 0; z < extents[2]; z++) {
+        for (size_t y = 0; y < extents[1]; y++) {
+            for (size_t x = 0; x < extents[0]; x++) {
+                const Index<3> c(x, y, z);
+                const size_t offset = layout.offset(c);
+                if (offset < hits.size())
+                    hits[offset]++;
+                else
+                    badRuns++;
+                const size_t n = layout.run(c, extents[0] - x);
+                if (n == 0 || x + n > extents[0])
+                    badRuns++;
+                for (size_t i = 1; i < n; i++)
+                    if (layout.offset(Index<3>(x + i, y, z)) != offset + i)
+                        badRuns++;
+            }
+        }
+    }
+    size_t used = 0, repeated = 0;
+    for (int h : hits) {
+        used += h > 0;
+        repeated += h > 1;
+    }
+    CHECK(used == extents[0] * extents[1] * extents[2]);
+    CHECK(repeated == 0);
+    CHECK(badRuns == 0);
+}
+
+void testLayouts() {
+    for (const Index<3> &extents : { Index<3>(1, 1, 1), Index<3>(7, 3, 5), Index<3>(16, 16, 16), Index<3>(17, 9, 2) }) {
+        checkLayout<LayoutStrided<3>>(extents);
+        checkLayout<LayoutTiled<3>>(extents);
+        checkLayout<LayoutTiled<3, 4>>(extents);
+        checkLayout<LayoutMorton<3>>(extents);
+    }
+}
+
+// Unique value per index, to tell elements apart after copies
+uint32_t tag(const Index<3> &c) {
+    return uint32_t(c[0] | c[1] << 10 | c[2] << 20);
+}
+
+template <typename Layout>
+Array3D<uint32_t, Layout> tagged(const Index<3> &extents) {
+    Array3D<uint32_t, Layout> a(extents);
+    for (size_t z = 0; z < extents[2]; z++)
+        for (size_t y = 0; y < extents[1]; y++)
+            for (size_t x = 0; x < extents[0]; x++)
+                a(x, y, z) = tag(Index<3>(x, y, z));
+    return a;
+}
+
+// forEach and forEachSpan over a view, counting visits per element and
+// checking the index handed out is the element's
+template <typename Layout>
+void checkIteration(const ArrayView3D<uint32_t, Layout> &view, const Index<3> &origin) {
+    std::vector<std::atomic<int>> visits(view.size());
+    std::atomic<size_t> wrong(0);
+    const Index<3> &e = view.getExtents();
+    auto visit = [&](uint32_t value, const Index<3> &c) {
+        if (value != tag(origin + c))
+            wrong++;
+        visits[detail::linearOffset(c, e)]++;
+    };
+
+    forEach(view, [&](uint32_t &value, const Index<3> &c) {
+        visit(value, c);
+    });
+    forEachSpan(view, [&](uint32_t *p, size_t n, Index<3> c) {
+        for (size_t i = 0; i < n; i++, c.data[0]++) {
+            if (&p[i] != &view[c])
+                wrong++;
+            visit(p[i], c);
+        }
+    });
+
+    size_t missed = 0;
+    for (const auto &v : visits)
+        missed += v != 2;
+    CHECK(missed == 0);
+    CHECK(wrong == 0);
+}
+
+template <typename Layout>
+void checkViews(const Index<3> &extents) {
+    Array3D<uint32_t, Layout> a = tagged<Layout>(extents);
+    checkIteration<Layout>(a.view(), Index<3>());
+
+    const Index<3> origin(1, 2, 1);
+    const Index<3> sub = extents - Index<3>(3, 3, 2);
+    checkIteration<Layout>(a.view().subview(origin, sub), origin);
+
+    // fill reaches the sub-view and nothing else
+    fill(a.view().subview(origin, sub), 0u);
+    size_t wrong = 0;
+    for (size_t z = 0; z < extents[2]; z++) {
+        for (size_t y = 0; y < extents[1]; y++) {
+            for (size_t x = 0; x < extents[0]; x++) {
+                const Index<3> c(x, y, z);
+                const bool inside = x >= 1 && x < 1 + sub[0] && y >= 2 && y < 2 + sub[1] && z >= 1 && z < 1 + sub[2];
+                if (a[c] != (inside ? 0u : tag(c)))
+                    wrong++;
+            }
+        }
+    }
+    CHECK(wrong == 0);
+}
+
+void testViews() {
+    // Small enough to run on one thread, and large enough to be split
+    for (const Index<3> &extents : { Index<3>(7, 5, 4), Index<3>(33, 17, 9), Index<3>(64, 64, 64) }) {
+        checkViews<LayoutStrided<3>>(extents);
+        checkViews<LayoutTiled<3>>(extents);
+        checkViews<LayoutMorton<3>>(extents);
+    }
+}
+
+// Copying through every pair of layouts keeps each element at its index
+template <typename From, typename To>
+void checkTransform(const Index<3> &extents) {
+    const Array3D<uint32_t, From> in = tagged<From>(extents);
+    Array3D<uint64_t, To> out(extents);
+    transform(in.view(), out.view(), [](uint32_t v) { return uint64_t(v) + 1; });
+    size_t wrong = 0;
+    forEach(out.view(), [&](uint64_t &v, const Index<3> &c) {
+        if (v != uint64_t(tag(c)) + 1)
+            wrong++;
+    });
+    CHECK(wrong == 0);
+}
+
+template <typename From>
+void checkTransformsFrom(const Index<3> &extents) {
+    checkTransform<From, LayoutStrided<3>>(extents);
+    checkTransform<From, LayoutTiled<3>>(extents);
+    checkTransform<From, LayoutMorton<3>>(extents);
+}
+
+void testTransform() {
+    for (const Index<3> &extents : { Index<3>(9, 10, 11), Index<3>(40, 40, 40) }) {
+        checkTransformsFrom<LayoutStrided<3>>(extents);
+        checkTransformsFrom<LayoutTiled<3>>(extents);
+        checkTransformsFrom<LayoutMorton<3>>(extents);
+    }
+
+    Array3D<int> a(Index<3>(4, 4, 4)), b(Index<3>(4, 4, 5));
+    bool threw = false;
+    try {
+        transform(a.view(), b.view(), [](int v) { return v; });
+    } catch (const std::invalid_argument &) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+// Ranks other than 3, strides that aren't contiguous, empty views and the
+// checks on sub-view bounds
+void testOtherShapes() {
+    std::vector<int> line(100000);
+    for (size_t i = 0; i < line.size(); i++)
+        line[i] = int(i);
+    const ArrayView<int, 1> view1(line.data(), LayoutStrided<1>(Index<1>(line.size())), Index<1>(line.size()));
+    std::atomic<long long> sum(0);
+    forEachSpan(view1, [&](int *p, size_t n, const Index<1> &c) {
+        long long s = 0;
+        for (size_t i = 0; i < n; i++)
+            s += p[i] == int(c[0] + i) ? p[i] : -1000000000;
+        sum += s;
+    });
+    CHECK(sum == 99999LL * 100000 / 2);
+
+    // A 2D view of the transpose, x stepping by rows of 10
+    std::vector<int> grid(60);
+    for (size_t i = 0; i < grid.size(); i++)
+        grid[i] = int(i);
+    const ArrayView<int, 2> transposed(grid.data(), LayoutStrided<2>(Index<2>(10, 1), grid.size()), Index<2>(6, 10));
+    CHECK(transposed(2, 3) == 23);
+    size_t wrong = 0, runs = 0;
+    forEachSpan(transposed, [&](int *p, size_t n, const Index<2> &c) {
+        runs++;
+        if (n != 1 || *p != int(c[0] * 10 + c[1]))
+            wrong++;
+    });
+    CHECK(wrong == 0 && runs == 60);
+
+    const Array<int, 2, LayoutMorton<2>> square(Index<2>(5, 6), 7);
+    const ArrayView<const int, 2, LayoutMorton<2>> readOnly = square;
+    CHECK(square.storageSize() == 64 && readOnly(4, 5) == 7);
+
+    size_t calls = 0;
+    forEach(Array3D<int>(Index<3>(5, 0, 3)).view(), [&](int &, const Index<3> &) { calls++; });
+    forEach(Array3D<int>(Index<3>(5, 3, 0)).view(), [&](int &, const Index<3> &) { calls++; });
+    CHECK(calls == 0);
+
+    Array3D<int> a(Index<3>(4, 4, 4));
+    bool threw = false;
+    try {
+        a.view().subview(Index<3>(1, 1, 1), Index<3>(2, 2, 2)).subview(Index<3>(1, 0, 0), Index<3>(2, 1, 1));
+    } catch (const std::out_of_range &) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+}
+
+int main() {
+    testLayouts();
+    testViews();
+    testTransform();
+    testOtherShapes();
+    return test::finish();
+}
\ No newline at end of file
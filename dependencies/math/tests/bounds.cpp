@@ -0,0 +1,138 @@
+// AABB, Sphere and Frustum tests, the frustum from a matrix against
+// frustumFromCamera, and the batch cullAABBs against intersects(f, box)
+
+#include <eseed/math/bounds.hpp>
+#include <eseed/math/matops.hpp>
+
+#include "check.hpp"
+
+#include <vector>
+
+using namespace esdm;
+using test::equal;
+using test::near;
+
+namespace {
+
+constexpr AABB<float> unit(Vec3<float>(-1.f, -1.f, -1.f), Vec3<float>(1.f, 1.f, 1.f));
+constexpr AABB<float> offset(Vec3<float>(.5f, .5f, .5f), Vec3<float>(3.f, 2.f, 4.f));
+constexpr AABB<float> apart(Vec3<float>(2.f, -1.f, -1.f), Vec3<float>(3.f, 1.f, 1.f));
+
+static_assert(equal(merge(AABB<float>(), unit).min, unit.min));
+static_assert(equal(merge(unit, offset).max, Vec3<float>(3.f, 2.f, 4.f)));
+static_assert(equal(merge(unit, Vec3<float>(0.f, -5.f, 0.f)).min, Vec3<float>(-1.f, -5.f, -1.f)));
+static_assert(equal(offset.getCenter(), Vec3<float>(1.75f, 1.25f, 2.25f)));
+static_assert(equal(offset.getExtents(), Vec3<float>(1.25f, .75f, 1.75f)));
+static_assert(contains(unit, Vec3<float>(1.f, 0.f, -1.f)));
+static_assert(!contains(unit, Vec3<float>(1.5f, 0.f, 0.f)));
+static_assert(intersects(unit, offset));
+static_assert(!intersects(unit, apart));
+static_assert(!intersects(AABB<float>(), unit));
+
+static_assert(boundingSphere(AABB<float>(Vec3<float>(0.f, 0.f, 0.f), Vec3<float>(2.f, 4.f, 4.f))).radius == 3.f);
+static_assert(contains(Sphere<float>(Vec3<float>(1.f, 0.f, 0.f), 1.f), Vec3<float>(1.f, 1.f, 0.f)));
+static_assert(!contains(Sphere<float>(Vec3<float>(1.f, 0.f, 0.f), 1.f), Vec3<float>(2.f, 1.f, 0.f)));
+static_assert(intersects(Sphere<float>(Vec3<float>(0.f, 0.f, 0.f), 1.f), Sphere<float>(Vec3<float>(3.f, 0.f, 0.f), 2.f)));
+static_assert(!intersects(Sphere<float>(Vec3<float>(0.f, 0.f, 0.f), 1.f), Sphere<float>(Vec3<float>(3.5f, 0.f, 0.f), 2.f)));
+
+// A 90 degree square camera at the origin looking down -z
+constexpr Frustum<double> camera = frustumFromCamera(Vec3<double>(), Mat4<double>(1.), 1., double(cx::widePi / 2), 1., 10.);
+static_assert(contains(camera, Vec3<double>(0., 0., -5.)));
+static_assert(contains(camera, Vec3<double>(4.9, -4.9, -5.)));
+static_assert(!contains(camera, Vec3<double>(5.1, 0., -5.)));
+static_assert(!contains(camera, Vec3<double>(0., 0., -.5)));
+static_assert(!contains(camera, Vec3<double>(0., 0., -10.5)));
+static_assert(!contains(camera, Vec3<double>(0., 0., 5.)));
+static_assert(intersects(camera, AABB<double>(Vec3<double>(5.5, -1., -6.), Vec3<double>(6.5, 1., -4.))));
+static_assert(!intersects(camera, AABB<double>(Vec3<double>(6.5, -1., -6.), Vec3<double>(7.5, 1., -4.))));
+static_assert(intersects(camera, Sphere<double>(Vec3<double>(0., 0., -11.), 1.5)));
+static_assert(!intersects(camera, Sphere<double>(Vec3<double>(0., 0., -12.), 1.5)));
+
+// Planes taken from view * perspective match frustumFromCamera's. In double,
+// since pulling the far plane out of a float matrix cancels most digits
+void testFrustumFromMatrix() {
+    for (int n = 0; n < 100; n++) {
+        Vec3<double> axis = normalize(Vec3<double>(test::randomFloat(-1.f, 1.f), test::randomFloat(-1.f, 1.f), 1.));
+        Mat4<double> rotation = matRotate(axis, double(test::randomFloat(-3.f, 3.f)));
+        Vec3<double> position(test::randomFloat(-50.f, 50.f), test::randomFloat(-50.f, 50.f), test::randomFloat(-50.f, 50.f));
+        double aspect = test::randomFloat(.5f, 2.5f);
+        double fov = test::randomFloat(.5f, 2.5f);
+
+        Frustum<double> fromCamera = frustumFromCamera(position, rotation, aspect, fov, .1, 500.);
+        Mat4<double> view = matmul(matTranslate(-position), transpose(rotation));
+        Frustum<double> fromMatrix(matmul(view, perspective(fov, aspect, .1, 500.)));
+        for (size_t i = 0; i < 6; i++)
+            CHECK(near(fromMatrix.planes[i], fromCamera.planes[i], 1e-9));
+    }
+}
+
+// How far inside the frustum the test in intersects(f, box) puts the box,
+// in double, to tell real disagreements from ones within rounding
+double margin(const Frustum<float> &f, const AABB<float> &box) {
+    Vec3<float> c = box.getCenter();
+    Vec3<float> e = box.getExtents();
+    double out = std::numeric_limits<double>::infinity();
+    for (const auto &plane : f.planes) {
+        double d = plane[3];
+        for (size_t i = 0; i < 3; i++)
+            d += double(plane[i]) * c[i] + std::abs(double(plane[i])) * e[i];
+        out = std::min(out, d);
+    }
+    return out;
+}
+
+// Random boxes, many of them straddling or just touching a plane, through
+// the batch path at every offset against the scalar test
+void testCullAABBs() {
+    for (int n = 0; n < 20; n++) {
+        Vec3<float> axis = normalize(Vec3<float>(test::randomFloat(-1.f, 1.f), 1.f, test::randomFloat(-1.f, 1.f)));
+        Frustum<float> f = frustumFromCamera(Vec3<float>(), matRotate(axis, test::randomFloat(-3.f, 3.f)), 16.f / 9.f, 1.5f, .1f, 200.f);
+
+        std::vector<AABB<float>> boxes(5000 + size_t(n));
+        for (auto &box : boxes) {
+            Vec3<float> c(test::randomFloat(-250.f, 250.f), test::randomFloat(-250.f, 250.f), test::randomFloat(-250.f, 250.f));
+            Vec3<float> e(test::randomFloat(0.f, 20.f), test::randomFloat(0.f, 20.f), test::randomFloat(0.f, 20.f));
+            box = AABB<float>(c - e, c + e);
+        }
+        // Shift some onto a plane, so the test result hangs on rounding
+        for (size_t i = 0; i < boxes.size(); i += 7) {
+            const Vec4<float> &plane = f.planes[i % 6];
+            float d = float(margin(f, boxes[i]));
+            if (std::abs(d) < 1e3f) {
+                Vec3<float> shift = Vec3<float>(plane[0], plane[1], plane[2]) * -d;
+                boxes[i] = AABB<float>(boxes[i].min + shift, boxes[i].max + shift);
+            }
+        }
+
+        std::vector<uint64_t> visible;
+        cullAABBs(f, boxes, visible);
+        CHECK(visible.size() == (boxes.size() + 63) / 64);
+
+        size_t mismatches = 0;
+        size_t roundingMismatches = 0;
+        for (size_t i = 0; i < boxes.size(); i++) {
+            bool batch = (visible[i / 64] >> (i % 64)) & 1;
+            if (batch == intersects(f, boxes[i]))
+                continue;
+            if (std::abs(margin(f, boxes[i])) < 1e-3)
+                roundingMismatches++;
+            else
+                mismatches++;
+        }
+        CHECK(mismatches == 0);
+#if !defined(ESDM_SIMD_FMA)
+        CHECK(roundingMismatches == 0);
+#endif
+        // Bits past the last box stay clear
+        if (boxes.size() % 64 != 0)
+            CHECK((visible.back() >> (boxes.size() % 64)) == 0);
+    }
+}
+
+}
+
+int main() {
+    testFrustumFromMatrix();
+    testCullAABBs();
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#pragma once
+
+// Minimal checks shared by the esdm tests, using only the standard library
+//
+// Each test is an executable run by ctest. CHECK and CHECK_NEAR report a
+// failure with its file and line and carry on; the test's main returns
+// test::finish(), non-zero if anything failed. Compile-time results are
+// checked with static_assert next to their runtime counterparts.
+
+#include <eseed/math/vec.hpp>
+#include <eseed/math/mat.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace esdm {
+
+namespace test {
+
+inline int failures = 0;
+
+inline void check(bool condition, const char *expression, const char *file, int line) {
+    if (condition)
+        return;
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    failures++;
+}
+
+inline void checkNear(double a, double b, double tolerance, const char *expression, const char *file, int line) {
+    if (std::abs(a - b) <= tolerance)
+        return;
+    std::fprintf(stderr, "%s:%d: check failed: %s (%.9g vs %.9g, tolerance %.3g)\n", file, line, expression, a, b, tolerance);
+    failures++;
+}
+
+// Exact equality, telling -0 from 0 and treating every NaN as equal
+inline bool same(float a, float b) {
+    if (a != a && b != b)
+        return true;
+    uint32_t ua, ub;
+    std::memcpy(&ua, &a, 4);
+    std::memcpy(&ub, &b, 4);
+    return ua == ub;
+}
+
+// Units in the last place between two finite floats
+inline uint32_t ulpDistance(float a, float b) {
+    int32_t ia, ib;
+    std::memcpy(&ia, &a, 4);
+    std::memcpy(&ib, &b, 4);
+    if (ia < 0)
+        ia = INT32_MIN - ia;
+    if (ib < 0)
+        ib = INT32_MIN - ib;
+    return ia > ib ? uint32_t(ia) - uint32_t(ib) : uint32_t(ib) - uint32_t(ia);
+}
+
+inline uint64_t ulpDistance(double a, double b) {
+    int64_t ia, ib;
+    std::memcpy(&ia, &a, 8);
+    std::memcpy(&ib, &b, 8);
+    if (ia < 0)
+        ia = INT64_MIN - ia;
+    if (ib < 0)
+        ib = INT64_MIN - ib;
+    return ia > ib ? uint64_t(ia) - uint64_t(ib) : uint64_t(ib) - uint64_t(ia);
+}
+
+template <size_t L, typename T>
+constexpr bool equal(const Vec<L, T> &a, const Vec<L, T> &b) {
+    for (size_t i = 0; i < L; i++)
+        if (a[i] != b[i])
+            return false;
+    return true;
+}
+
+template <size_t M, size_t N, typename T>
+constexpr bool equal(const Mat<M, N, T> &a, const Mat<M, N, T> &b) {
+    for (size_t i = 0; i < M; i++)
+        if (!equal(a.data[i], b.data[i]))
+            return false;
+    return true;
+}
+
+template <size_t L, typename T>
+constexpr bool near(const Vec<L, T> &a, const Vec<L, T> &b, T tolerance) {
+    for (size_t i = 0; i < L; i++)
+        if (a[i] - b[i] > tolerance || b[i] - a[i] > tolerance)
+            return false;
+    return true;
+}
+
+template <size_t M, size_t N, typename T>
+constexpr bool near(const Mat<M, N, T> &a, const Mat<M, N, T> &b, T tolerance) {
+    for (size_t i = 0; i < M; i++)
+        if (!near(a.data[i], b.data[i], tolerance))
+            return false;
+    return true;
+}
+
+template <size_t L>
+inline bool same(const Vec<L, float> &a, const Vec<L, float> &b) {
+    for (size_t i = 0; i < L; i++)
+        if (!same(a[i], b[i]))
+            return false;
+    return true;
+}
+
+template <size_t M, size_t N>
+inline bool same(const Mat<M, N, float> &a, const Mat<M, N, float> &b) {
+    for (size_t i = 0; i < M; i++)
+        if (!same(a.data[i], b.data[i]))
+            return false;
+    return true;
+}
+
+// Same seed every run, so a failure reproduces
+inline std::mt19937 &random() {
+    static std::mt19937 generator(12345);
+    return generator;
+}
+
+inline float randomFloat(float lo, float hi) {
+    return std::uniform_real_distribution<float>(lo, hi)(random());
+}
+
+inline int finish() {
+    if (failures > 0)
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures > 0 ? 1 : 0;
+}
+
+}
+
+}
+
+#define CHECK(...) esdm::test::check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+#define CHECK_NEAR(a, b, tolerance) esdm::test::checkNear(double(a), double(b), double(tolerance), #a " ~ " #b, __FILE__, __LINE__)
\ No newline at end of file
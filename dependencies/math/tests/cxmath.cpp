@@ -0,0 +1,75 @@
+// esdm::cx against the std functions: the rounding functions exactly, the
+// rest within the documented 1 ulp, for float and (where long double is
+// wider than double) double
+
+#include <eseed/math/ops.hpp>
+
+#include "check.hpp"
+
+#include <cfloat>
+#include <cmath>
+
+using namespace esdm;
+
+namespace {
+
+// The ops.hpp wrappers switch to cx:: in constant expressions
+static_assert(esdm::sqrt(16.f) == 4.f);
+static_assert(esdm::floor(-1.5) == -2.);
+static_assert(esdm::round(2.5f) == 3.f);
+static_assert(esdm::abs(esdm::sin(pi<double>() / 6.) - .5) < 1e-15);
+static_assert(esdm::abs(esdm::cos(pi<double>() / 3.) - .5) < 1e-15);
+static_assert(esdm::abs(esdm::atan(1.) - pi<double>() / 4.) < 1e-15);
+
+constexpr bool wideLongDouble = LDBL_MANT_DIG > DBL_MANT_DIG;
+
+// Checks every function at x, for T = float and double
+template <typename T>
+void checkAt(T x) {
+    // Sign of zero included
+    CHECK(test::same(float(cx::trunc(x)), float(std::trunc(x))));
+    CHECK(test::same(float(cx::floor(x)), float(std::floor(x))));
+    CHECK(test::same(float(cx::ceil(x)), float(std::ceil(x))));
+    CHECK(test::same(float(cx::round(x)), float(std::round(x))));
+
+    if (std::is_same_v<T, double> && !wideLongDouble)
+        return;
+
+    auto checkUlp = [&](T cxValue, T stdValue, const char *name) {
+        if (test::ulpDistance(cxValue, stdValue) <= 1)
+            return;
+        std::fprintf(stderr, "%s(%.17g): %.17g vs std %.17g\n", name, double(x), double(cxValue), double(stdValue));
+        test::failures++;
+    };
+    if (std::abs(x) <= T(2147483648.)) {
+        checkUlp(cx::sin(x), std::sin(x), "sin");
+        checkUlp(cx::cos(x), std::cos(x), "cos");
+        checkUlp(cx::tan(x), std::tan(x), "tan");
+    }
+    checkUlp(cx::atan(x), std::atan(x), "atan");
+    checkUlp(cx::sqrt(std::abs(x)), std::sqrt(std::abs(x)), "sqrt");
+    T unit = x / (T(1) + std::abs(x));
+    checkUlp(cx::asin(unit), std::asin(unit), "asin");
+    checkUlp(cx::acos(unit), std::acos(unit), "acos");
+}
+
+template <typename T>
+void sweep() {
+    for (int n = 0; n < 20000; n++) {
+        checkAt(T(test::randomFloat(-1.f, 1.f)));
+        checkAt(T(test::randomFloat(-100.f, 100.f)));
+        checkAt(T(test::randomFloat(-1e5f, 1e5f)));
+        checkAt(T(test::randomFloat(-2e9f, 2e9f)));
+    }
+    const T edges[] = { T(0), T(-0.), T(0.5), T(-0.5), T(1), T(-1), T(2.5), T(1e-30), T(1e30), pi<T>(), pi<T>() / 2, T(355), T(103993) };
+    for (T x : edges)
+        checkAt(x);
+}
+
+}
+
+int main() {
+    sweep<float>();
+    sweep<double>();
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+// Lazy expressions against the same eager arithmetic, including the
+// destination appearing in its own expression, for Vec and Mat of sizes on
+// both sides of where lazy starts to pay off
+
+#include <eseed/math/expr.hpp>
+
+#include "check.hpp"
+
+#include <type_traits>
+#include <utility>
+
+using namespace esdm;
+using test::equal;
+
+namespace {
+
+// Temporaries can't become leaves
+template <typename V, typename = void>
+struct LazyAccepts : std::false_type {};
+
+template <typename V>
+struct LazyAccepts<V, std::void_t<decltype(lazy(std::declval<V>()))>> : std::true_type {};
+
+static_assert(LazyAccepts<Vec4<float> &>::value);
+static_assert(LazyAccepts<const Mat3<float> &>::value);
+static_assert(!LazyAccepts<Vec4<float>>::value);
+static_assert(!LazyAccepts<Mat3<float>>::value);
+
+// Evaluates during constant evaluation too, in place included
+constexpr Vec4<int> a4(1, 2, 3, 4);
+constexpr Vec4<int> b4(10, 20, 30, 40);
+static_assert(equal(Vec4<int>(lazy(a4) * b4 + lazy(b4) / 10 - 1), Vec4<int>(10, 41, 92, 163)));
+
+constexpr Vec4<int> addInPlace() {
+    Vec4<int> v = a4;
+    v += lazy(v) * 2 + b4;
+    return v;
+}
+static_assert(equal(addInPlace(), Vec4<int>(13, 26, 39, 52)));
+
+constexpr Mat2<int> assignInPlace() {
+    Mat2<int> m(1, 2, 3, 4);
+    assign(m, lazy(m) * m - 1);
+    return m;
+}
+static_assert(equal(assignInPlace(), Mat2<int>(0, 3, 8, 15)));
+
+// Exact unless FMA lets the compiler contract one side and not the other
+template <typename V>
+bool matches(const V &a, const V &b) {
+#if defined(ESDM_SIMD_FMA)
+    return test::near(a, b, 1e-4f);
+#else
+    return test::same(a, b);
+#endif
+}
+
+template <size_t L>
+Vec<L, float> randomVec() {
+    Vec<L, float> v;
+    for (size_t i = 0; i < L; i++)
+        v[i] = test::randomFloat(-10.f, 10.f);
+    return v;
+}
+
+template <size_t M, size_t N>
+Mat<M, N, float> randomMat() {
+    Mat<M, N, float> m;
+    for (size_t i = 0; i < M; i++)
+        m.data[i] = randomVec<N>();
+    return m;
+}
+
+// The chain from bench/vecexpr.cpp, then each way the destination can
+// also be an operand: compound assignment, assign(), and conversion
+template <typename V>
+void checkExpressions(V (*random)()) {
+    for (int n = 0; n < 50; n++) {
+        const V a = random(), b = random(), c = random(), d = random();
+
+        V eager = a * b + c * d - (a - d) * 0.5f + b / 3.f;
+        V lazyChain = lazy(a) * b + lazy(c) * d - (lazy(a) - d) * 0.5f + lazy(b) / 3.f;
+        CHECK(matches(lazyChain, eager));
+
+        V v = a;
+        v += lazy(v) * 2.f;
+        CHECK(matches(v, V(a + a * 2.f)));
+
+        v = a;
+        v -= lazy(b) - v;
+        CHECK(matches(v, V(a - (b - a))));
+
+        v = a;
+        v *= lazy(v) + b;
+        CHECK(matches(v, V(a * (a + b))));
+
+        v = a;
+        v /= -lazy(v) * c;
+        CHECK(matches(v, V(a / (-a * c))));
+
+        v = a;
+        assign(v, lazy(v) * v + lazy(b) * v);
+        CHECK(matches(v, V(a * a + b * a)));
+
+        v = a;
+        v = lazy(d) - lazy(v) * v;
+        CHECK(matches(v, V(d - a * a)));
+    }
+}
+
+}
+
+int main() {
+    checkExpressions<Vec4<float>>(randomVec<4>);
+    checkExpressions<Vec<8, float>>(randomVec<8>);
+    checkExpressions<Vec<256, float>>(randomVec<256>);
+    checkExpressions<Mat4<float>>(randomMat<4, 4>);
+    checkExpressions<Mat<8, 8, float>>(randomMat<8, 8>);
+    checkExpressions<Mat<3, 5, float>>(randomMat<3, 5>);
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,194 @@
+// esdm::fast against double precision libm over dense sweeps, asserting the
+// error bounds documented in fastops.hpp, and the array versions against
+// the scalar ones, which must match bit for bit
+
+#include <eseed/math/fastops.hpp>
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace esdm;
+
+namespace {
+
+// Spacing of floats at the exact result v, for errors in ulp
+double ulpAt(double v) {
+    int e;
+    std::frexp(std::max(std::abs(v), 1.17549435e-38), &e);
+    return std::ldexp(1., e - 24);
+}
+
+// Worst error seen, reported with the input that gave it
+struct MaxError {
+    const char *name;
+    double bound;
+    double worst = 0.;
+    double worstAt = 0.;
+
+    void add(double error, double at) {
+        if (error > worst) {
+            worst = error;
+            worstAt = at;
+        }
+    }
+
+    ~MaxError() {
+        std::printf("%-8s max error %.3g at %.9g (bound %.3g)\n", name, worst, worstAt, bound);
+        CHECK(worst <= bound);
+    }
+};
+
+// Every float in [lo, hi) at a stride keeping the sweep to ~2M values
+std::vector<float> sweep(float lo, float hi) {
+    std::vector<float> out;
+    float step = (hi - lo) / 2e6f;
+    for (float x = lo; x < hi; x += step)
+        out.push_back(x);
+    return out;
+}
+
+// Every n-th float bit pattern between two positive floats
+std::vector<float> sweepBits(float lo, float hi, uint32_t stride) {
+    std::vector<float> out;
+    uint32_t a, b;
+    std::memcpy(&a, &lo, 4);
+    std::memcpy(&b, &hi, 4);
+    for (uint32_t bits = a; bits < b; bits += stride) {
+        float x;
+        std::memcpy(&x, &bits, 4);
+        out.push_back(x);
+    }
+    return out;
+}
+
+void testSinCos() {
+    MaxError sinError{"sin", 1.3e-7};
+    MaxError cosError{"cos", 1.3e-7};
+    MaxError sincosError{"sincos", 1e-7};
+    for (float x : sweep(-8192.f, 8192.f)) {
+        double s = std::sin(double(x));
+        double c = std::cos(double(x));
+        sinError.add(std::abs(fast::sin(x) - s), x);
+        cosError.add(std::abs(fast::cos(x) - c), x);
+        float fs, fc;
+        fast::sincos(x, fs, fc);
+        sincosError.add(std::max(std::abs(fs - s), std::abs(fc - c)), x);
+    }
+}
+
+void testRsqrtRcp() {
+    MaxError rsqrtError{"rsqrt", 3e-7};
+    MaxError rcpError{"rcp", 2e-7};
+    for (float x : sweepBits(1.17549435e-38f, 3.4e38f, 997)) {
+        double r = 1. / std::sqrt(double(x));
+        rsqrtError.add(std::abs(fast::rsqrt(x) - r) / r, x);
+    }
+    for (float x : sweepBits(1.17549435e-38f, 8.50705917e37f, 997)) {
+        rcpError.add(std::abs(fast::rcp(x) - 1. / x) * x, x);
+        rcpError.add(std::abs(fast::rcp(-x) + 1. / x) * x, -x);
+    }
+}
+
+void testExp2Log2() {
+    MaxError exp2Error{"exp2", 1.2};
+    MaxError log2Error{"log2", 3.};
+    for (float x : sweep(-126.f, 127.f)) {
+        double e = std::exp2(double(x));
+        exp2Error.add(std::abs(fast::exp2(x) - e) / ulpAt(e), x);
+    }
+    for (float x : sweepBits(1.17549435e-38f, 3.4e38f, 997)) {
+        double l = std::log2(double(x));
+        log2Error.add(std::abs(fast::log2(x) - l) / ulpAt(l), x);
+    }
+    // Clamped rather than denormal or infinite
+    CHECK(fast::exp2(-200.f) == std::exp2(-126.f));
+    CHECK(fast::exp2(200.f) == std::exp2(127.f));
+}
+
+void testAtan2() {
+    MaxError atan2Error{"atan2", 3.3e-7};
+    for (int n = 0; n < 2000000; n++) {
+        float y = test::randomFloat(-1.f, 1.f) * std::exp2(float(n % 40 - 20));
+        float x = test::randomFloat(-1.f, 1.f) * std::exp2(float(n / 40 % 40 - 20));
+        atan2Error.add(std::abs(fast::atan2(y, x) - std::atan2(double(y), double(x))), y);
+    }
+    CHECK(fast::atan2(0.f, 0.f) == 0.f);
+    CHECK(fast::atan2(0.f, -1.f) == pi<float>());
+    CHECK(fast::atan2(1.f, 0.f) == pi<float>() / 2.f);
+}
+
+// The array versions run the packs at the native width and width 1 for the
+// tail, which must give the same bits as the scalar versions
+void testArrays() {
+    std::vector<float> in(4099);
+    std::vector<float> positive(in.size());
+    for (size_t i = 0; i < in.size(); i++) {
+        in[i] = test::randomFloat(-100.f, 100.f);
+        positive[i] = test::randomFloat(1e-3f, 1e3f);
+    }
+    std::vector<float> out(in.size()), out2(in.size());
+
+    auto checkArray = [&](const char *name, auto array, auto scalar, const std::vector<float> &x) {
+        array(x.data(), out.data(), x.size());
+        size_t mismatches = 0;
+        for (size_t i = 0; i < x.size(); i++)
+            if (!test::same(out[i], scalar(x[i])))
+                mismatches++;
+        if (mismatches > 0) {
+            std::fprintf(stderr, "%s: %zu array results differ from the scalar ones\n", name, mismatches);
+            test::failures++;
+        }
+    };
+    checkArray("sin", [](auto... a) { fast::sin(a...); }, [](float x) { return fast::sin(x); }, in);
+    checkArray("cos", [](auto... a) { fast::cos(a...); }, [](float x) { return fast::cos(x); }, in);
+    checkArray("rsqrt", [](auto... a) { fast::rsqrt(a...); }, [](float x) { return fast::rsqrt(x); }, positive);
+    checkArray("rcp", [](auto... a) { fast::rcp(a...); }, [](float x) { return fast::rcp(x); }, in);
+    checkArray("exp2", [](auto... a) { fast::exp2(a...); }, [](float x) { return fast::exp2(x); }, in);
+    checkArray("log2", [](auto... a) { fast::log2(a...); }, [](float x) { return fast::log2(x); }, positive);
+
+    fast::sincos(in.data(), out.data(), out2.data(), in.size());
+    size_t mismatches = 0;
+    for (size_t i = 0; i < in.size(); i++) {
+        float s, c;
+        fast::sincos(in[i], s, c);
+        if (!test::same(out[i], s) || !test::same(out2[i], c))
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+
+    fast::atan2(in.data(), positive.data(), out.data(), in.size());
+    mismatches = 0;
+    for (size_t i = 0; i < in.size(); i++)
+        if (!test::same(out[i], fast::atan2(in[i], positive[i])))
+            mismatches++;
+    CHECK(mismatches == 0);
+}
+
+void testIntegerRounding() {
+    std::vector<float> in = sweep(-1e6f, 1e6f);
+    const float halves[] = { -2.5f, -1.5f, -.5f, -0.f, .5f, 1.5f, 2.5f, 8388607.5f };
+    in.insert(in.end(), std::begin(halves), std::end(halves));
+    std::vector<int32_t> floors(in.size()), rounds(in.size());
+    ifloor(in.data(), floors.data(), in.size());
+    iround(in.data(), rounds.data(), in.size());
+    size_t mismatches = 0;
+    for (size_t i = 0; i < in.size(); i++)
+        if (floors[i] != int32_t(std::floor(in[i])) || rounds[i] != int32_t(std::round(in[i])))
+            mismatches++;
+    CHECK(mismatches == 0);
+}
+
+}
+
+int main() {
+    testSinCos();
+    testRsqrtRcp();
+    testExp2Log2();
+    testAtan2();
+    testArrays();
+    testIntegerRounding();
+    return test::finish();
+}
\ No newline at end of file
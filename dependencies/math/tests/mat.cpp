@@ -0,0 +1,156 @@
+// Mat constructors and operators, the generic matmul / transpose /
+// determinant / inverse, and the Mat4<float> SIMD overloads against them
+
+#include <eseed/math/mat.hpp>
+#include <eseed/math/matops.hpp>
+#include <eseed/math/cxmath.hpp>
+
+#include "check.hpp"
+
+#include <cmath>
+
+using namespace esdm;
+using test::equal;
+using test::near;
+
+namespace {
+
+constexpr Mat2<int> m2(1, 2, 3, 4);
+
+// Unary operators
+static_assert(equal(-m2, Mat2<int>(-1, -2, -3, -4)));
+static_assert(equal(+m2, m2));
+static_assert(equal(~m2, Mat2<int>(~1, ~2, ~3, ~4)));
+static_assert(equal(!Mat2<int>(0, 1, 0, 2), Mat2<int>(1, 0, 1, 0)));
+
+// Compound assignment, matrix and scalar
+constexpr Mat2<int> addAssign() {
+    Mat2<int> m = m2;
+    m += Mat2<int>(10, 20, 30, 40);
+    return m;
+}
+static_assert(equal(addAssign(), Mat2<int>(11, 22, 33, 44)));
+
+constexpr Mat2<int> mulAssign() {
+    Mat2<int> m = m2;
+    m *= 3;
+    m -= 1;
+    return m;
+}
+static_assert(equal(mulAssign(), Mat2<int>(2, 5, 8, 11)));
+
+constexpr Mat2<float> divAssign() {
+    Mat2<float> m(2.f, 4.f, 6.f, 8.f);
+    m /= Mat2<float>(2.f, 2.f, 3.f, 4.f);
+    return m;
+}
+static_assert(equal(divAssign(), Mat2<float>(1.f, 2.f, 2.f, 2.f)));
+
+// The diagonal constructor stays inside non-square matrices
+constexpr Mat<2, 3, int> wide(5);
+static_assert(equal(wide, Mat<2, 3, int>(5, 0, 0, 0, 5, 0)));
+constexpr Mat<3, 2, int> tall(5);
+static_assert(equal(tall, Mat<3, 2, int>(5, 0, 0, 5, 0, 0)));
+
+// Element-wise binary operators
+static_assert(equal(m2 + m2, Mat2<int>(2, 4, 6, 8)));
+static_assert(equal(m2 * 2, 2 * m2));
+static_assert(equal(m2 % 2, Mat2<int>(1, 0, 1, 0)));
+
+// matmul, transpose, determinant and inverse
+static_assert(equal(matmul(m2, Mat2<int>(5, 6, 7, 8)), Mat2<int>(19, 22, 43, 50)));
+static_assert(equal(matmul(m2, Vec2<int>(1, 1)), Vec2<int>(3, 7)));
+static_assert(equal(matmul(Vec2<int>(1, 1), m2), Vec2<int>(4, 6)));
+static_assert(equal(transpose(Mat<2, 3, int>(1, 2, 3, 4, 5, 6)), Mat<3, 2, int>(1, 4, 2, 5, 3, 6)));
+static_assert(determinant(Mat3<double>(2., 0., 0., 0., 3., 0., 1., 0., 4.)) == 24.);
+static_assert(determinant(Mat2<double>(0., 1., 1., 0.)) == -1.);
+static_assert(near(inverse(Mat2<double>(4., 7., 2., 6.)), Mat2<double>(.6, -.7, -.2, .4), 1e-12));
+
+// Mat4<float> takes the generic path during constant evaluation
+constexpr Mat4<float> rotation = matRotate(Vec3<float>(0.f, 0.f, 1.f), float(cx::widePi / 2));
+constexpr Mat4<float> translation = matTranslate(Vec3<float>(1.f, 2.f, 3.f));
+static_assert(near(
+    matmul(Vec4<float>(1.f, 0.f, 0.f, 1.f), matmul(rotation, translation)),
+    Vec4<float>(1.f, 3.f, 3.f, 1.f),
+    1e-6f
+));
+static_assert(near(matmul(translation, inverse(translation)), Mat4<float>(1.f), 1e-6f));
+static_assert(near(inverseRigid(matmul(rotation, translation)), matmul(inverse(translation), inverse(rotation)), 1e-6f));
+static_assert(determinant(translation) == 1.f);
+
+Mat4<float> randomMat4() {
+    Mat4<float> m;
+    for (size_t i = 0; i < 4; i++)
+        for (size_t j = 0; j < 4; j++)
+            m.data[i][j] = test::randomFloat(-2.f, 2.f);
+    return m;
+}
+
+// Largest component, to scale tolerances by
+float maxAbs(const Mat4<float> &m) {
+    float out = 0.f;
+    for (size_t i = 0; i < 4; i++)
+        for (size_t j = 0; j < 4; j++)
+            out = std::max(out, std::abs(m.data[i][j]));
+    return out;
+}
+
+void testRuntimeOperators() {
+    Mat2<int> m = m2;
+    CHECK(equal(-m, Mat2<int>(-1, -2, -3, -4)));
+    m += m2;
+    m *= 2;
+    CHECK(equal(m, Mat2<int>(4, 8, 12, 16)));
+    CHECK(equal(Mat<2, 3, int>(5), wide));
+    CHECK(equal(Mat<3, 2, int>(5), tall));
+}
+
+// The SIMD overloads against the generic templates they replace. The
+// products and transposes match exactly unless FMA changes the rounding;
+// determinant and inverse use a different elimination, so are compared
+// with a tolerance relative to the result's size.
+void testMat4Simd() {
+    for (int n = 0; n < 1000; n++) {
+        Mat4<float> a = randomMat4();
+        Mat4<float> b = randomMat4();
+        Vec4<float> v(a.data[0][0], a.data[1][1], b.data[2][2], b.data[3][3]);
+
+        CHECK(test::same(transpose(a), transpose<4, 4, float>(a)));
+#if defined(ESDM_SIMD_FMA)
+        CHECK(near(matmul(a, b), matmul<4, 4, 4, float, float>(a, b), 1e-5f));
+        CHECK(near(matmul(v, a), matmul<4, 4, float, float>(v, a), 1e-5f));
+#else
+        CHECK(test::same(matmul(a, b), matmul<4, 4, 4, float, float>(a, b)));
+        CHECK(test::same(matmul(v, a), matmul<4, 4, float, float>(v, a)));
+#endif
+        CHECK(near(matmul(a, v), matmul<4, 4, float, float>(a, v), 1e-5f));
+
+        float det = determinant<4, float>(a);
+        CHECK_NEAR(determinant(a), det, 1e-4f * std::max(1.f, std::abs(det)));
+
+        // Skip the nearly singular ones, where both lose most digits
+        if (std::abs(det) < 1e-2f)
+            continue;
+        Mat4<float> inv = inverse<4, float>(a);
+        CHECK(near(inverse(a), inv, 1e-4f * std::max(1.f, maxAbs(inv))));
+        CHECK(near(matmul(a, inverse(a)), Mat4<float>(1.f), 1e-3f * std::max(1.f, maxAbs(inv))));
+    }
+
+    for (int n = 0; n < 100; n++) {
+        Vec3<float> axis = normalize(Vec3<float>(test::randomFloat(-1.f, 1.f), test::randomFloat(-1.f, 1.f), 1.f));
+        Mat4<float> m = matmul(
+            matRotate(axis, test::randomFloat(-3.f, 3.f)),
+            matTranslate(Vec3<float>(test::randomFloat(-10.f, 10.f), 1.f, 2.f))
+        );
+        CHECK(near(inverseRigid(m), inverseRigid<float>(m), 1e-5f));
+        CHECK(near(inverseRigid(m), inverse<4, float>(m), 1e-4f));
+    }
+}
+
+}
+
+int main() {
+    testRuntimeOperators();
+    testMat4Simd();
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+// Morton codes and MortonChunk: known codes, encode / decode (pdep / pext
+// where BMI2 is on) against a bit by bit interleave and the magic bits
+// fallback, the dilated arithmetic against decoding, doing the arithmetic
+// and encoding again, and chunk neighbors at and inside the edges
+
+#include <eseed/math/chunk.hpp>
+
+#include "check.hpp"
+
+#include <cstdint>
+
+using namespace esdm;
+using test::equal;
+
+namespace {
+
+static_assert(morton::axisMask<2>(1) == 0xAAAAAAAAAAAAAAAA);
+static_assert(morton::axisMask<3>(2) == 0x4924924924924924);
+
+static_assert(morton::encode(1, 0) == 1);
+static_assert(morton::encode(0, 1) == 2);
+static_assert(morton::encode(3, 3) == 15);
+static_assert(morton::encode(5, 9) == 0b10010011);
+static_assert(morton::encode(0xFFFFFFFF, 0) == 0x5555555555555555);
+static_assert(morton::encode(1, 0, 0) == 1);
+static_assert(morton::encode(0, 1, 0) == 2);
+static_assert(morton::encode(0, 0, 1) == 4);
+static_assert(morton::encode(7, 7, 7) == 511);
+static_assert(morton::encode(Vec3<uint32_t>(2, 1, 4)) == 0b100001010);
+static_assert(morton::encode(0x1FFFFF, 0, 0) == 0x1249249249249249);
+static_assert(morton::encode(0, 0, 0x1FFFFF) == 0x4924924924924924);
+static_assert(equal(morton::decode2(0b10010011), Vec2<uint32_t>(5, 9)));
+static_assert(equal(morton::decode3(0b100001010), Vec3<uint32_t>(2, 1, 4)));
+
+// Per axis, with each axis wrapping on its own
+constexpr uint64_t c = morton::encode(3, 5, 7);
+static_assert(morton::add<3>(c, morton::encode(1, 2, 3)) == morton::encode(4, 7, 10));
+static_assert(morton::sub<3>(c, morton::encode(1, 2, 3)) == morton::encode(2, 3, 4));
+static_assert(morton::sub<3>(c, morton::encode(4, 0, 0)) == morton::encode(0x1FFFFF, 5, 7));
+static_assert(morton::increment<3>(c, 0) == morton::encode(4, 5, 7));
+static_assert(morton::decrement<3>(c, 2) == morton::encode(3, 5, 6));
+static_assert(morton::decrement<2>(morton::encode(0, 8), 0) == morton::encode(0xFFFFFFFF, 8));
+static_assert(morton::offset<3>(c, 1, 100) == morton::encode(3, 105, 7));
+static_assert(morton::offset<3>(c, 2, -7) == morton::encode(3, 5, 0));
+static_assert(morton::offset<2>(morton::encode(10, 20), 1, -21) == morton::encode(10, 0xFFFFFFFF));
+
+// Chunk codes, and steps out of the chunk failing contains()
+using Chunk = MortonChunk<int, 32>;
+static_assert(Chunk::volume == 32768);
+static_assert(Chunk::code(31, 31, 31) == 32767);
+static_assert(equal(Chunk::position(Chunk::code(3, 17, 30)), Vec3<uint32_t>(3, 17, 30)));
+static_assert(Chunk::neighbor(Chunk::code(4, 5, 6), 1, 1) == Chunk::code(4, 6, 6));
+static_assert(Chunk::neighbor(Chunk::code(4, 5, 6), 0, -1) == Chunk::code(3, 5, 6));
+static_assert(!Chunk::contains(Chunk::neighbor(Chunk::code(31, 5, 6), 0, 1)));
+static_assert(!Chunk::contains(Chunk::neighbor(Chunk::code(4, 0, 6), 1, -1)));
+static_assert(!Chunk::contains(Chunk::neighbor(Chunk::code(4, 5, 31), 2, 1)));
+
+// Bit i of each coordinate moved to bit i * Rank + axis
+template <size_t Rank>
+uint64_t interleave(const uint32_t (&v)[Rank]) {
+    constexpr size_t bits = 64 / Rank;
+    uint64_t out = 0;
+    for (size_t axis = 0; axis < Rank; axis++)
+        for (size_t i = 0; i < bits; i++)
+            out |= uint64_t((v[axis] >> i) & 1) << (i * Rank + axis);
+    return out;
+}
+
+uint32_t randomBits(uint32_t bits) {
+    const uint32_t v = test::random()();
+    return bits == 32 ? v : v & ((1u << bits) - 1);
+}
+
+void testEncoding() {
+    size_t mismatches = 0;
+    for (int n = 0; n < 200000; n++) {
+        const uint64_t wide = uint64_t(test::random()()) << 32 | test::random()();
+
+        // Whichever path spread / compact take against the fallback
+        if (morton::detail::spread<2>(wide) != morton::detail::spreadMagic<2>(wide)
+            || morton::detail::spread<3>(wide) != morton::detail::spreadMagic<3>(wide)
+            || morton::detail::compact<2>(wide) != morton::detail::compactMagic<2>(wide)
+            || morton::detail::compact<3>(wide) != morton::detail::compactMagic<3>(wide))
+            mismatches++;
+
+        const uint32_t v2[2] = { randomBits(32), randomBits(32) };
+        const uint64_t code2 = morton::encode(v2[0], v2[1]);
+        if (code2 != interleave<2>(v2) || !equal(morton::decode2(code2), Vec2<uint32_t>(v2[0], v2[1])))
+            mismatches++;
+
+        const uint32_t v3[3] = { randomBits(21), randomBits(21), randomBits(21) };
+        const uint64_t code3 = morton::encode(v3[0], v3[1], v3[2]);
+        if (code3 != interleave<3>(v3) || !equal(morton::decode3(code3), Vec3<uint32_t>(v3[0], v3[1], v3[2])))
+            mismatches++;
+
+        // Decoding any 63 bit pattern and encoding again gives it back
+        const uint64_t any = wide & 0x7FFFFFFFFFFFFFFF;
+        if (morton::encode(morton::decode3(any)) != any || morton::encode(morton::decode2(wide)) != wide)
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+}
+
+// The dilated operations against the same arithmetic on decoded
+// coordinates, each axis taken modulo 2^21
+void testDilated() {
+    constexpr uint32_t mask = 0x1FFFFF;
+    auto encoded = [](const Vec3<uint32_t> &v) {
+        return morton::encode(v[0] & mask, v[1] & mask, v[2] & mask);
+    };
+    size_t mismatches = 0;
+    for (int n = 0; n < 200000; n++) {
+        // Mostly near the ends of the range, where the carries wrap
+        const uint32_t bits = n % 4 == 0 ? 21 : 3;
+        Vec3<uint32_t> a(randomBits(bits), randomBits(bits), randomBits(bits));
+        Vec3<uint32_t> b(randomBits(bits), randomBits(bits), randomBits(bits));
+        if (n % 8 == 1)
+            a = Vec3<uint32_t>(mask) - a;
+        const uint64_t ca = encoded(a), cb = encoded(b);
+
+        if (morton::add<3>(ca, cb) != encoded(a + b) || morton::sub<3>(ca, cb) != encoded(a - b))
+            mismatches++;
+
+        const size_t axis = size_t(n % 3);
+        Vec3<uint32_t> up = a, down = a;
+        up[axis]++;
+        down[axis]--;
+        if (morton::increment<3>(ca, axis) != encoded(up) || morton::decrement<3>(ca, axis) != encoded(down))
+            mismatches++;
+
+        const int64_t step = int64_t(randomBits(bits)) * (n % 2 == 0 ? 1 : -1);
+        Vec3<uint32_t> moved = a;
+        moved[axis] += uint32_t(step);
+        if (morton::offset<3>(ca, axis, step) != encoded(moved))
+            mismatches++;
+
+        // 2D wraps at 2^32, which uint32_t arithmetic does by itself
+        const uint32_t x = randomBits(32), y = randomBits(32), dx = randomBits(bits), dy = randomBits(32);
+        if (morton::add<2>(morton::encode(x, y), morton::encode(dx, dy)) != morton::encode(x + dx, y + dy)
+            || morton::sub<2>(morton::encode(x, y), morton::encode(dx, dy)) != morton::encode(x - dx, y - dy)
+            || morton::offset<2>(morton::encode(x, y), 1, -int64_t(dx)) != morton::encode(x, y - dx))
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+}
+
+// Every cell's 6 neighbors by code against the ones by position, and the
+// chunk's array view seeing cells where operator() puts them
+void testChunk() {
+    Chunk chunk;
+    for (uint32_t z = 0; z < Chunk::side; z++)
+        for (uint32_t y = 0; y < Chunk::side; y++)
+            for (uint32_t x = 0; x < Chunk::side; x++)
+                chunk(x, y, z) = int(x | y << 8 | z << 16);
+
+    size_t mismatches = 0;
+    for (uint64_t code = 0; code < Chunk::volume; code++) {
+        const Vec3<uint32_t> p = Chunk::position(code);
+        if (chunk[code] != int(p[0] | p[1] << 8 | p[2] << 16))
+            mismatches++;
+        for (size_t axis = 0; axis < 3; axis++) {
+            for (int dir : { -1, 1 }) {
+                Vec3<uint32_t> q = p;
+                q[axis] += uint32_t(dir);
+                const bool inside = q[axis] < Chunk::side;
+                const uint64_t next = Chunk::neighbor(code, axis, dir);
+                if (Chunk::contains(next) != inside || (inside && next != Chunk::code(q[0], q[1], q[2])))
+                    mismatches++;
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+
+    size_t wrong = 0;
+    forEach(chunk.view(), [&](int &cell, const Index<3> &c) {
+        if (cell != int(c[0] | c[1] << 8 | c[2] << 16))
+            wrong++;
+    });
+    CHECK(wrong == 0);
+
+    fill(chunk.view().subview(Index<3>(0, 0, 0), Index<3>(2, 2, 2)), -1);
+    CHECK(chunk[0] == -1 && chunk[7] == -1 && chunk[8] != -1);
+
+    const MortonChunk<uint8_t, 4> small(uint8_t(9));
+    CHECK(small(3, 3, 3) == 9 && small.data()[63] == 9);
+}
+
+}
+
+int main() {
+    testEncoding();
+    testDilated();
+    testChunk();
+    return test::finish();
+}
\ No newline at end of file
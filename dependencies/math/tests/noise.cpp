@@ -0,0 +1,229 @@
+// noise::simplex3 against a line by line float transcription of simplex()
+// in resources/shaders/test/test.frag, the batch and heightmap paths
+// against the scalar ones, and fbm3's layering
+
+#include <eseed/math/noise.hpp>
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace esdm;
+
+namespace {
+
+// The GLSL, one component at a time, vec4 p and friends as arrays
+namespace glsl {
+
+float mod(float x, float y) {
+    return x - y * std::floor(x / y);
+}
+
+float permute(float x) {
+    return mod((x * 34.f + 1.f) * x, 289.f);
+}
+
+float taylorInvSqrt(float r) {
+    return 1.79284291400159f - 0.85373472095314f * r;
+}
+
+float step(float edge, float x) {
+    return x < edge ? 0.f : 1.f;
+}
+
+float dot3(const float *a, const float *b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+float simplex(const float v[3]) {
+    const float cx = 1.f / 6.f, cy = 1.f / 3.f;
+
+    const float s = v[0] * cy + v[1] * cy + v[2] * cy;
+    float i[3], x0[3];
+    for (int c = 0; c < 3; c++)
+        i[c] = std::floor(v[c] + s);
+    const float t = i[0] * cx + i[1] * cx + i[2] * cx;
+    for (int c = 0; c < 3; c++)
+        x0[c] = v[c] - i[c] + t;
+
+    float g[3], l[3], i1[3], i2[3], x1[3], x2[3], x3[3];
+    for (int c = 0; c < 3; c++) {
+        g[c] = step(x0[(c + 1) % 3], x0[c]);
+        l[c] = 1.f - g[c];
+    }
+    for (int c = 0; c < 3; c++) {
+        i1[c] = std::min(g[c], l[(c + 2) % 3]);
+        i2[c] = std::max(g[c], l[(c + 2) % 3]);
+        x1[c] = x0[c] - i1[c] + 1.f * cx;
+        x2[c] = x0[c] - i2[c] + 2.f * cx;
+        x3[c] = x0[c] - 1.f + 3.f * cx;
+    }
+
+    for (int c = 0; c < 3; c++)
+        i[c] = mod(i[c], 289.f);
+    const float oz[4] = { 0.f, i1[2], i2[2], 1.f };
+    const float oy[4] = { 0.f, i1[1], i2[1], 1.f };
+    const float ox[4] = { 0.f, i1[0], i2[0], 1.f };
+    float p[4];
+    for (int k = 0; k < 4; k++)
+        p[k] = permute(permute(permute(i[2] + oz[k]) + i[1] + oy[k]) + i[0] + ox[k]);
+
+    const float n = 1.f / 7.f;
+    const float ns[3] = { n * 2.f, n * .5f - 1.f, n };
+    float x[4], y[4], h[4];
+    for (int k = 0; k < 4; k++) {
+        const float j = p[k] - 49.f * std::floor(p[k] * ns[2] * ns[2]);
+        const float xf = std::floor(j * ns[2]);
+        const float yf = std::floor(j - 7.f * xf);
+        x[k] = xf * ns[0] + ns[1];
+        y[k] = yf * ns[0] + ns[1];
+        h[k] = 1.f - std::abs(x[k]) - std::abs(y[k]);
+    }
+
+    const float *corners[4] = { x0, x1, x2, x3 };
+    float sum = 0.f;
+    for (int k = 0; k < 4; k++) {
+        const float sh = -step(h[k], 0.f);
+        float grad[3] = {
+            x[k] + (std::floor(x[k]) * 2.f + 1.f) * sh,
+            y[k] + (std::floor(y[k]) * 2.f + 1.f) * sh,
+            h[k]
+        };
+        const float norm = taylorInvSqrt(dot3(grad, grad));
+        for (float &component : grad)
+            component *= norm;
+        float m = std::max(.6f - dot3(corners[k], corners[k]), 0.f);
+        m = m * m;
+        sum += m * m * dot3(grad, corners[k]);
+    }
+    return 42.f * sum;
+}
+
+}
+
+Vec3<float> randomVec3(float lo, float hi) {
+    return Vec3<float>(test::randomFloat(lo, hi), test::randomFloat(lo, hi), test::randomFloat(lo, hi));
+}
+
+// Whether the simplex cell v is in hangs on rounding, see noise.hpp
+bool nearCellEdge(const Vec3<float> &v) {
+    const double s = (double(v[0]) + v[1] + v[2]) / 3.;
+    for (size_t c = 0; c < 3; c++) {
+        const double skewed = v[c] + s;
+        if (std::abs(skewed - std::round(skewed)) < 1e-3)
+            return true;
+    }
+    return false;
+}
+
+// Within 1e-6 when both sides round the same way. With FMA the compiler
+// contracts the two differently, and far from the origin the offsets from
+// the cell corner lose digits to the subtraction, so the difference grows
+// with |v|
+void checkAgainstShader(float range, float bound) {
+    float worst = 0.f;
+    float largest = 0.f;
+    for (int n = 0; n < 100000; n++) {
+        const Vec3<float> v = randomVec3(-range, range);
+        if (nearCellEdge(v))
+            continue;
+        const float components[3] = { v[0], v[1], v[2] };
+        const float value = noise::simplex3(v);
+        worst = std::max(worst, std::abs(value - glsl::simplex(components)));
+        largest = std::max(largest, std::abs(value));
+    }
+    std::printf("|v| < %-5g max difference from the shader %.3g (bound %.3g), max |value| %.3g\n", range, worst, bound, largest);
+    CHECK(worst <= bound);
+    CHECK(largest <= 1.f);
+    CHECK(largest > .8f);
+}
+
+void testAgainstShader() {
+#if defined(ESDM_SIMD_FMA)
+    checkAgainstShader(8.f, 1e-5f);
+    checkAgainstShader(4096.f, 5e-3f);
+#else
+    checkAgainstShader(8.f, 1e-6f);
+    checkAgainstShader(4096.f, 1e-6f);
+#endif
+}
+
+// Exact unless FMA lets the compiler contract the scalar path differently
+bool matches(float a, float b) {
+#if defined(ESDM_SIMD_FMA)
+    return std::abs(a - b) <= 1e-5f;
+#else
+    return test::same(a, b);
+#endif
+}
+
+void testBatch() {
+    const size_t count = 10007;
+    VecBatch<3, float> points(count);
+    for (size_t i = 0; i < count; i++)
+        points.set(i, randomVec3(-100.f, 100.f));
+
+    std::vector<float> out;
+    noise::simplex3(points, out);
+    CHECK(out.size() == count);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; i++)
+        if (!matches(out[i], noise::simplex3(points.get(i))))
+            mismatches++;
+    CHECK(mismatches == 0);
+
+    noise::fbm3(points, out, 5, 1.9f, .45f);
+    mismatches = 0;
+    for (size_t i = 0; i < count; i++)
+        if (!matches(out[i], noise::fbm3(points.get(i), 5, 1.9f, .45f)))
+            mismatches++;
+    CHECK(mismatches == 0);
+}
+
+void testFbm() {
+    for (int n = 0; n < 1000; n++) {
+        const Vec3<float> v = randomVec3(-50.f, 50.f);
+        CHECK(noise::fbm3(v, 0) == 0.f);
+        CHECK(matches(noise::fbm3(v, 1), noise::simplex3(v)));
+        const float two = noise::simplex3(v) + noise::simplex3(v * 3.f) * .25f;
+        CHECK_NEAR(noise::fbm3(v, 2, 3.f, .25f), two, 1e-6f);
+    }
+}
+
+// Odd sizes, so every row has a scalar tail
+void testHeightmap() {
+    const std::vector<noise::HeightLayer> layers = noise::shaderTerrain();
+    const Vec2<int32_t> origin(-37, 1021);
+    const size_t width = 203, depth = 67;
+    std::vector<float> heights;
+    noise::fillHeightmap(layers, origin, width, depth, heights);
+    CHECK(heights.size() == width * depth);
+
+    size_t mismatches = 0;
+    for (size_t z = 0; z < depth; z++) {
+        for (size_t x = 0; x < width; x++) {
+            const int32_t cx = origin[0] + int32_t(x), cz = origin[1] + int32_t(z);
+            if (!matches(heights[z * width + x], noise::height(layers, cx, cz)))
+                mismatches++;
+            // getVoxel's groundHeight
+            const float a[3] = { float(cx) / 64.f, float(cz) / 64.f, 0.f };
+            const float b[3] = { float(cx) / 32.f, float(cz) / 32.f, 1.f };
+            const float shader = glsl::simplex(a) * 16.f + glsl::simplex(b) * 8.f;
+            if (!nearCellEdge(Vec3<float>(a[0], a[1], a[2])) && !nearCellEdge(Vec3<float>(b[0], b[1], b[2])))
+                CHECK_NEAR(noise::height(layers, cx, cz), shader, 1e-4f);
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+}
+
+int main() {
+    testAgainstShader();
+    testBatch();
+    testFbm();
+    testHeightmap();
+    return test::finish();
+}
\ No newline at end of file
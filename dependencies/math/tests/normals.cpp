@@ -0,0 +1,297 @@
+// Octahedral normals and QTangents: known encodings, the largest decode
+// errors over dense sphere samples against the bounds documented in
+// normals.hpp, and the batch kernels against the per element conversions
+
+#include <eseed/math/normals.hpp>
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace esdm;
+using test::equal;
+
+namespace {
+
+constexpr float degrees = float(180. / 3.14159265358979323846);
+
+// Angle between two unit vectors in degrees, in double so it stays
+// meaningful well below a float ulp of the dot product
+double angle(const Vec3<float> &a, const Vec3<float> &b) {
+    const double x = double(a[1]) * b[2] - double(a[2]) * b[1];
+    const double y = double(a[2]) * b[0] - double(a[0]) * b[2];
+    const double z = double(a[0]) * b[1] - double(a[1]) * b[0];
+    const double d = double(a[0]) * b[0] + double(a[1]) * b[1] + double(a[2]) * b[2];
+    return std::atan2(std::sqrt(x * x + y * y + z * z), d) * degrees;
+}
+
+// Points spread evenly over the sphere, on a Fibonacci spiral, plus the
+// axes and the octahedron's edges, where the folding changes sides
+std::vector<Vec3<float>> sphereSamples(size_t count) {
+    std::vector<Vec3<float>> out;
+    const double golden = 3.14159265358979323846 * (3. - std::sqrt(5.));
+    for (size_t i = 0; i < count; i++) {
+        const double z = 1. - 2. * (double(i) + .5) / double(count);
+        const double r = std::sqrt(1. - z * z);
+        out.emplace_back(float(r * std::cos(golden * double(i))), float(r * std::sin(golden * double(i))), float(z));
+    }
+    for (size_t a = 0; a < 3; a++) {
+        for (float s : { -1.f, 1.f }) {
+            Vec3<float> axis;
+            axis[a] = s;
+            out.push_back(axis);
+        }
+    }
+    for (int i = 0; i < 1000; i++) {
+        const float t = float(i) / 1000.f * 6.2831853f;
+        out.push_back(normalize(Vec3<float>(std::cos(t), std::sin(t), 0.f)));
+        out.push_back(normalize(Vec3<float>(std::cos(t), 0.f, std::sin(t))));
+        out.push_back(normalize(Vec3<float>(0.f, std::cos(t), std::sin(t))));
+    }
+    return out;
+}
+
+void testOctKnownAnswers() {
+    CHECK(equal(octEncode(Vec3<float>(0.f, 0.f, 1.f)), Vec2<float>(0.f, 0.f)));
+    CHECK(equal(octEncode(Vec3<float>(0.f, 0.f, -1.f)), Vec2<float>(1.f, 1.f)));
+    CHECK(equal(octEncode(Vec3<float>(1.f, 0.f, 0.f)), Vec2<float>(1.f, 0.f)));
+    CHECK(equal(octEncode(Vec3<float>(0.f, -1.f, 0.f)), Vec2<float>(0.f, -1.f)));
+    CHECK(equal(octDecode(Vec2<float>(0.f, 0.f)), Vec3<float>(0.f, 0.f, 1.f)));
+    CHECK(equal(octDecode(Vec2<float>(-1.f, -1.f)), Vec3<float>(0.f, 0.f, -1.f)));
+    CHECK(equal(octDecode(Vec2<float>(0.f, 1.f)), Vec3<float>(0.f, 1.f, 0.f)));
+    CHECK(angle(octDecode(Vec2<float>(.5f, -.5f)), Vec3<float>(1.f, -1.f, 0.f) / std::sqrt(2.f)) < 1e-5);
+
+    // Any point of the square decodes to a unit vector
+    for (int n = 0; n < 1000; n++) {
+        const Vec3<float> d = octDecode(Vec2<float>(test::randomFloat(-1.f, 1.f), test::randomFloat(-1.f, 1.f)));
+        CHECK_NEAR(length(d), 1.f, 1e-6f);
+    }
+
+    // The axes quantize exactly
+    const Oct16 x(Vec3<float>(1.f, 0.f, 0.f));
+    CHECK(x.u() == 127 && x.v() == 0 && x.bits == 0x007F);
+    CHECK(equal(Vec3<float>(x), Vec3<float>(1.f, 0.f, 0.f)));
+    const Oct32 down(Vec3<float>(0.f, 0.f, -1.f));
+    CHECK(down.u() == 32767 && down.v() == 32767);
+    CHECK(equal(Vec3<float>(down), Vec3<float>(0.f, 0.f, -1.f)));
+    const Oct24 y(Vec3<float>(0.f, -1.f, 0.f));
+    CHECK(y.u() == 0 && y.v() == -2047 && y.packed() == 0x801000);
+    CHECK(equal(Vec3<float>(y), Vec3<float>(0.f, -1.f, 0.f)));
+
+    // 12 bit fields sign extend from either half of the packed bytes
+    Oct24 p;
+    p.setCoords(-1, 2047);
+    CHECK(p.u() == -1 && p.v() == 2047 && p.packed() == 0x7FFFFF);
+    p.setCoords(-2048, -5);
+    CHECK(p.u() == -2048 && p.v() == -5);
+    Oct16 q;
+    q.setCoords(-128, 5);
+    CHECK(q.u() == -128 && q.v() == 5 && q.bits == 0x0580);
+}
+
+// The documented errors are rounded, so allow them 1%
+template <typename O>
+void checkOctError(const char *name, const std::vector<Vec3<float>> &samples, double bound) {
+    double worst = 0.;
+    for (const auto &n : samples)
+        worst = std::max(worst, angle(n, Vec3<float>(O(n))));
+    std::printf("%-6s max error %.4g deg (bound %.4g)\n", name, worst, bound);
+    CHECK(worst <= bound * 1.01);
+}
+
+void testOctErrors() {
+    const std::vector<Vec3<float>> samples = sphereSamples(1000000);
+    checkOctError<Oct16>("Oct16", samples, .95);
+    checkOctError<Oct24>("Oct24", samples, .059);
+    checkOctError<Oct32>("Oct32", samples, .0037);
+}
+
+// A unit tangent at least minAngle degrees away from n
+Vec3<float> randomTangent(const Vec3<float> &n, double minAngle) {
+    for (;;) {
+        const Vec3<float> t = normalize(Vec3<float>(test::randomFloat(-1.f, 1.f), test::randomFloat(-1.f, 1.f), test::randomFloat(-1.f, 1.f)));
+        const double a = angle(n, t);
+        if (a >= minAngle && a <= 180. - minAngle)
+            return t;
+    }
+}
+
+Vec3<float> orthogonalized(const Vec3<float> &n, const Vec3<float> &t) {
+    return normalize(t - n * dot(n, t));
+}
+
+void testQTangentKnownAnswers() {
+    const Vec3<float> x(1.f, 0.f, 0.f), y(0.f, 1.f, 0.f), z(0.f, 0.f, 1.f);
+
+    const QTangent identity(z, x, 1.f);
+    CHECK(identity.coords[0] == 0 && identity.coords[1] == 0 && identity.coords[2] == 0 && identity.coords[3] == 32767);
+    CHECK(equal(identity.normal(), z) && equal(identity.tangent(), x) && equal(identity.bitangent(), y));
+    CHECK(identity.handedness() == 1.f);
+
+    const QTangent mirrored(z, x, -1.f);
+    CHECK(mirrored.coords[3] == -32767 && mirrored.handedness() == -1.f);
+    CHECK(equal(mirrored.normal(), z) && equal(mirrored.tangent(), x) && equal(mirrored.bitangent(), -y));
+
+    const QTangent defaulted;
+    CHECK(equal(defaulted.normal(), z) && defaulted.handedness() == 1.f);
+
+    // Half turns about x and about y leave w at 0, kept at the bias so its
+    // sign still carries the handedness
+    for (float h : { -1.f, 1.f }) {
+        const QTangent flipped(-z, x, h);
+        CHECK(flipped.handedness() == h);
+        CHECK(std::abs(flipped.coords[3]) == 1);
+        CHECK(angle(flipped.normal(), -z) < .005 && angle(flipped.tangent(), x) < .005);
+        CHECK(angle(flipped.bitangent(), y * -h) < .005);
+
+        const QTangent turned(-z, -x, h);
+        CHECK(turned.handedness() == h);
+        CHECK(angle(turned.normal(), -z) < .005 && angle(turned.tangent(), -x) < .005);
+    }
+}
+
+// Axis errors against the frame made orthonormal: the documented ~0.005
+// deg for tangents well away from the normal, and the orthogonalization's
+// own float error on top for ones within a few degrees of it
+void testQTangentErrors() {
+    double worst = 0., worstClose = 0.;
+    size_t flips = 0;
+    for (int n = 0; n < 200000; n++) {
+        const bool close = n % 10 == 0;
+        const Vec3<float> normal = normalize(Vec3<float>(test::randomFloat(-1.f, 1.f), test::randomFloat(-1.f, 1.f), test::randomFloat(-1.f, 1.f)));
+        Vec3<float> tangent = randomTangent(normal, 30.);
+        if (close)
+            tangent = normalize(normal + (tangent - normal * dot(normal, tangent)) * test::randomFloat(.02f, .1f));
+        const float h = n % 3 == 0 ? -1.f : 1.f;
+
+        const QTangent q(normal, tangent, h);
+        const Vec3<float> t = orthogonalized(normal, tangent);
+        const Vec3<float> b = cross(normal, t) * h;
+        const double error = std::max({ angle(q.normal(), normal), angle(q.tangent(), t), angle(q.bitangent(), b) });
+        double &bound = close ? worstClose : worst;
+        bound = std::max(bound, error);
+        if (q.handedness() != h)
+            flips++;
+    }
+    std::printf("QTangent max error %.4g deg (bound .005), %.4g deg near the normal (bound .02)\n", worst, worstClose);
+    CHECK(worst <= .005);
+    CHECK(worstClose <= .02);
+    CHECK(flips == 0);
+}
+
+// Largest difference of two quantized coordinates
+template <typename A, typename B>
+int32_t stepsApart(const A &a, const B &b) {
+    return std::max(std::abs(a.u() - b.u()), std::abs(a.v() - b.v()));
+}
+
+// Counts exercising the pack tails and, for the largest, the threading
+const size_t counts[] = { 1, 7, 9, 17, 1001, 70001 };
+
+// The batch kernels follow the scalar code operation for operation, so
+// they agree exactly unless FMA contracts one side, which can move a
+// rounding by a step
+template <size_t Bits>
+void checkOctBatch(const std::vector<Vec3<float>> &samples) {
+    for (size_t count : counts) {
+        VecBatch<3, float> normals;
+        normals.resize(count);
+        for (size_t i = 0; i < count; i++)
+            normals.set(i, samples[i]);
+        std::vector<OctNormal<Bits>> encoded(count);
+        encodeOct(normals, encoded.data());
+
+        VecBatch<3, float> decoded;
+        decodeOct(encoded.data(), count, decoded);
+        CHECK(decoded.size() == count);
+
+        int32_t worstSteps = 0;
+        float worstDecode = 0.f;
+        for (size_t i = 0; i < count; i++) {
+            const OctNormal<Bits> scalar(samples[i]);
+            worstSteps = std::max(worstSteps, stepsApart(encoded[i], scalar));
+            const Vec3<float> d = decoded.get(i), s = Vec3<float>(encoded[i]);
+            for (size_t c = 0; c < 3; c++)
+                worstDecode = std::max(worstDecode, std::abs(d[c] - s[c]));
+        }
+#if defined(ESDM_SIMD_FMA)
+        CHECK(worstSteps <= 1);
+#else
+        CHECK(worstSteps == 0);
+#endif
+        CHECK(worstDecode <= 2e-7f);
+    }
+}
+
+void testOctBatch() {
+    std::vector<Vec3<float>> samples = sphereSamples(70001);
+    std::shuffle(samples.begin(), samples.end(), test::random());
+    checkOctBatch<8>(samples);
+    checkOctBatch<12>(samples);
+    checkOctBatch<16>(samples);
+}
+
+// The batch quatFromMat3 picks its pivot by selects and can land on a
+// different one than the scalar code for nearly tied diagonals, and the
+// division differs from the scalar sqrt, so coordinates are allowed a
+// couple of steps, each turning the decoded axes by up to 2 / 32767 rad
+void testQTangentBatch() {
+    const double stepAngle = 2. / 32767. * degrees;
+    for (size_t count : counts) {
+        VecBatch<3, float> normals, tangents;
+        normals.resize(count);
+        tangents.resize(count);
+        std::vector<float> handedness(count);
+        for (size_t i = 0; i < count; i++) {
+            const Vec3<float> n = normalize(Vec3<float>(test::randomFloat(-1.f, 1.f), test::randomFloat(-1.f, 1.f), test::randomFloat(-1.f, 1.f)));
+            normals.set(i, n);
+            tangents.set(i, randomTangent(n, 30.));
+            handedness[i] = i % 3 == 0 ? -1.f : 1.f;
+        }
+        // Half turns, where w sits at the bias
+        normals.set(0, Vec3<float>(0.f, 0.f, -1.f));
+        tangents.set(0, Vec3<float>(1.f, 0.f, 0.f));
+
+        std::vector<QTangent> encoded(count), rightHanded(count);
+        encodeQTangents(normals, tangents, handedness.data(), encoded.data());
+        encodeQTangents(normals, tangents, nullptr, rightHanded.data());
+
+        VecBatch<3, float> decodedNormals, decodedTangents;
+        std::vector<float> decodedHandedness(count);
+        decodeQTangents(encoded.data(), count, decodedNormals, decodedTangents, decodedHandedness.data());
+
+        int32_t worstSteps = 0;
+        double worstAngle = 0.;
+        size_t mismatches = 0;
+        for (size_t i = 0; i < count; i++) {
+            const QTangent scalar(normals.get(i), tangents.get(i), handedness[i]);
+            for (size_t c = 0; c < 4; c++)
+                worstSteps = std::max(worstSteps, std::abs(encoded[i].coords[c] - scalar.coords[c]));
+            if (encoded[i].handedness() != handedness[i] || rightHanded[i].handedness() != 1.f || decodedHandedness[i] != handedness[i])
+                mismatches++;
+            worstAngle = std::max({ worstAngle, angle(decodedNormals.get(i), scalar.normal()), angle(decodedTangents.get(i), scalar.tangent()) });
+        }
+        CHECK(worstSteps <= 2);
+        CHECK(worstAngle <= 2. * stepAngle);
+        CHECK(mismatches == 0);
+
+        // A null handedness is skipped on decode too
+        decodeQTangents(encoded.data(), count, decodedNormals, decodedTangents, nullptr);
+        CHECK(decodedNormals.size() == count && decodedTangents.size() == count);
+    }
+}
+
+}
+
+int main() {
+    testOctKnownAnswers();
+    testOctErrors();
+    testQTangentKnownAnswers();
+    testQTangentErrors();
+    testOctBatch();
+    testQTangentBatch();
+    return test::finish();
+}
\ No newline at end of file
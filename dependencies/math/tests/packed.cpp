@@ -0,0 +1,280 @@
+// F16 and the normalized integer types: known answers, every half through
+// toFloat and back, float to half against a rounding done by search over
+// the half values, and the bulk convert overloads against the scalar
+// conversions, which must match bit for bit
+
+#include <eseed/math/packed.hpp>
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace esdm;
+
+namespace {
+
+static_assert(detail::roundEven(2.5f) == 2);
+static_assert(detail::roundEven(3.5f) == 4);
+static_assert(detail::roundEven(-2.5f) == -2);
+static_assert(detail::roundEven(-3.5f) == -4);
+static_assert(detail::roundEven(-.4f) == 0);
+static_assert(detail::roundEven(7.6f) == 8);
+
+constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+constexpr float inf = std::numeric_limits<float>::infinity();
+
+// Clamped, rounded to nearest even, NaN to 0, and both of the most negative
+// signed values reading as -1
+static_assert(UNorm8(1.f).bits == 255);
+static_assert(UNorm8(.5f).bits == 128);
+static_assert(UNorm8(-3.f).bits == 0);
+static_assert(UNorm8(nan).bits == 0);
+static_assert(UNorm8(inf).bits == 255);
+static_assert(float(UNorm8::fromBits(255)) == 1.f);
+static_assert(float(UNorm8::fromBits(51)) == .2f);
+static_assert(SNorm8(-1.f).bits == -127);
+static_assert(SNorm8(-2.f).bits == -127);
+static_assert(SNorm8(nan).bits == 0);
+static_assert(float(SNorm8::fromBits(-128)) == -1.f);
+static_assert(float(SNorm8::fromBits(-127)) == -1.f);
+static_assert(UNorm16(2.f).bits == 65535);
+static_assert(SNorm16(.5f).bits == 16384);
+static_assert(SNorm16(-inf).bits == -32767);
+static_assert(float(SNorm16::fromBits(-32768)) == -1.f);
+
+// Bit patterns equal, NaNs included
+bool sameBits(float a, float b) {
+    return std::memcmp(&a, &b, 4) == 0;
+}
+
+void testF16KnownAnswers() {
+    CHECK(F16::fromFloat(1.f) == 0x3C00);
+    CHECK(F16::fromFloat(-2.f) == 0xC000);
+    CHECK(F16::fromFloat(-0.f) == 0x8000);
+    CHECK(F16::fromFloat(65504.f) == 0x7BFF);
+    CHECK(F16::fromFloat(65519.99f) == 0x7BFF);
+    CHECK(F16::fromFloat(65520.f) == 0x7C00);
+    CHECK(F16::fromFloat(1e9f) == 0x7C00);
+    CHECK(F16::fromFloat(-inf) == 0xFC00);
+    CHECK(F16::fromFloat(std::ldexp(1.f, -14)) == 0x0400);
+    CHECK(F16::fromFloat(std::ldexp(1.f, -24)) == 0x0001);
+    CHECK(F16::fromFloat(std::ldexp(1.f, -25)) == 0x0000);
+    CHECK(F16::fromFloat(std::ldexp(1.5f, -25)) == 0x0001);
+    CHECK(F16::fromFloat(std::ldexp(3.f, -25)) == 0x0002);
+
+    // Ties between 1 and the half above it, and the one above that
+    CHECK(F16::fromFloat(1.f + std::ldexp(1.f, -11)) == 0x3C00);
+    CHECK(F16::fromFloat(1.f + std::ldexp(3.f, -11)) == 0x3C02);
+
+    const uint16_t quiet = F16::fromFloat(nan);
+    CHECK((quiet & 0x7C00) == 0x7C00 && (quiet & 0x3FF) != 0);
+
+    CHECK(F16::toFloat(0x3C00) == 1.f);
+    CHECK(F16::toFloat(0x3555) == .333251953125f);
+    CHECK(F16::toFloat(0x7BFF) == 65504.f);
+    CHECK(F16::toFloat(0x0001) == std::ldexp(1.f, -24));
+    CHECK(F16::toFloat(0x03FF) == std::ldexp(1023.f, -24));
+    CHECK(F16::toFloat(0x7C00) == inf);
+    CHECK(sameBits(F16::toFloat(0x8000), -0.f));
+    CHECK(F16::toFloat(0x7C01) != F16::toFloat(0x7C01));
+
+    F16 h = 2.5f;
+    CHECK(h.bits == 0x4100 && float(h) == 2.5f);
+}
+
+// Every non-NaN half survives toFloat and fromFloat, and NaNs stay NaN
+// with the quiet bit set
+void testF16RoundTrip() {
+    size_t mismatches = 0;
+    for (uint32_t bits = 0; bits < 0x10000; bits++) {
+        const float f = F16::toFloat(uint16_t(bits));
+        const bool isNan = (bits & 0x7C00) == 0x7C00 && (bits & 0x3FF) != 0;
+        if (isNan) {
+            if (f == f || F16::fromFloat(f) != (bits | 0x200))
+                mismatches++;
+        } else if (F16::fromFloat(f) != bits) {
+            mismatches++;
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+// Every positive half as a float, in order, with infinity standing in as
+// the next value up from 65504 so overflow rounds like any other step
+struct HalfTable {
+    std::vector<float> values;
+
+    HalfTable() {
+        for (uint32_t bits = 0; bits < 0x7C00; bits++)
+            values.push_back(F16::toFloat(uint16_t(bits)));
+        values.push_back(65536.f);
+    }
+
+    // Nearest half to a non-negative, non-NaN float, ties to the even bits
+    uint16_t nearest(float f) const {
+        if (f >= 65536.f)
+            return 0x7C00;
+        const size_t above = size_t(std::lower_bound(values.begin(), values.end(), f) - values.begin());
+        if (values[above] == f || above == 0)
+            return uint16_t(above);
+        const size_t below = above - 1;
+        const double up = double(values[above]) - f;
+        const double down = f - double(values[below]);
+        if (up != down)
+            return uint16_t(up < down ? above : below);
+        return uint16_t(below % 2 == 0 ? below : above);
+    }
+};
+
+uint16_t referenceHalf(const HalfTable &table, float f) {
+    return uint16_t((std::signbit(f) ? 0x8000 : 0) | table.nearest(std::abs(f)));
+}
+
+// Each half, the floats either side of its midpoint with the next, the
+// midpoint itself, then a stride through all the float bit patterns
+void testF16Rounding() {
+    const HalfTable table;
+    size_t mismatches = 0;
+    auto check = [&](float f) {
+        if (F16::fromFloat(f) != referenceHalf(table, f) || F16::fromFloat(-f) != referenceHalf(table, -f))
+            mismatches++;
+    };
+    for (size_t i = 0; i + 1 < table.values.size(); i++) {
+        const float mid = float((double(table.values[i]) + table.values[i + 1]) / 2.);
+        check(table.values[i]);
+        check(mid);
+        check(std::nextafter(mid, 0.f));
+        check(std::nextafter(mid, inf));
+    }
+    for (uint32_t bits = 0; bits < 0x7F800000; bits += 4093) {
+        float f;
+        std::memcpy(&f, &bits, 4);
+        check(f);
+    }
+    CHECK(mismatches == 0);
+}
+
+// Everything the conversions treat specially, then random values a little
+// past the range of the normalized types
+std::vector<float> conversionInputs(size_t count) {
+    std::vector<float> out = {
+        0.f, -0.f, 1.f, -1.f, .5f, -.5f, 2.f, -2.f, nan, -nan, inf, -inf,
+        65504.f, 65520.f, 1e-7f, -1e-7f, std::ldexp(1.f, -24), std::ldexp(1.f, -25),
+        127.5f / 255.f, 128.5f / 255.f, 16383.5f / 32767.f, -16383.5f / 32767.f,
+    };
+    while (out.size() < count) {
+        if (out.size() % 5 == 0)
+            out.push_back(test::randomFloat(-70000.f, 70000.f));
+        else
+            out.push_back(test::randomFloat(-1.25f, 1.25f));
+    }
+    return out;
+}
+
+// Whole runs, odd counts for the scalar tails, and offsets for misaligned
+// starts; the largest is split over threads
+const size_t counts[] = { 0, 1, 7, 8, 9, 15, 16, 17, 31, 33, 100, 1000, 100003 };
+
+template <typename From, typename To, typename Bits>
+void checkConvert(const char *name, const std::vector<From> &in, Bits bits) {
+    size_t mismatches = 0;
+    for (size_t count : counts) {
+        for (size_t offset = 0; offset < 3; offset++) {
+            if (offset + count > in.size())
+                continue;
+            std::vector<To> out(count + 1);
+            const To guard = out[count];
+            convert(in.data() + offset, out.data(), count);
+            for (size_t i = 0; i < count; i++)
+                if (bits(out[i]) != bits(To(in[offset + i])))
+                    mismatches++;
+            if (bits(out[count]) != bits(guard))
+                mismatches++;
+        }
+    }
+    if (mismatches > 0) {
+        std::fprintf(stderr, "%s: %zu bulk results differ from the scalar ones\n", name, mismatches);
+        test::failures++;
+    }
+}
+
+uint32_t floatBits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, 4);
+    return u;
+}
+
+template <typename T>
+auto packedBits(T v) {
+    return v.bits;
+}
+
+void testBulk() {
+    const std::vector<float> floats = conversionInputs(100010);
+
+    std::vector<F16> halves(0x10000 + 10);
+    for (size_t i = 0; i < halves.size(); i++)
+        halves[i] = F16::fromBits(uint16_t(i));
+    std::vector<UNorm8> unorm8s(100010);
+    for (size_t i = 0; i < unorm8s.size(); i++)
+        unorm8s[i] = UNorm8::fromBits(uint8_t(i * 7));
+    std::vector<SNorm16> snorm16s(100010);
+    for (size_t i = 0; i < snorm16s.size(); i++)
+        snorm16s[i] = SNorm16::fromBits(int16_t(i * 13));
+
+    // The specialized overloads
+    checkConvert<float, F16>("float to F16", floats, packedBits<F16>);
+    checkConvert<F16, float>("F16 to float", halves, floatBits);
+    checkConvert<float, UNorm8>("float to UNorm8", floats, packedBits<UNorm8>);
+    checkConvert<UNorm8, float>("UNorm8 to float", unorm8s, floatBits);
+    checkConvert<float, SNorm16>("float to SNorm16", floats, packedBits<SNorm16>);
+    checkConvert<SNorm16, float>("SNorm16 to float", snorm16s, floatBits);
+
+    // The generic one, element by element through float
+    checkConvert<float, SNorm8>("float to SNorm8", floats, packedBits<SNorm8>);
+    checkConvert<float, UNorm16>("float to UNorm16", floats, packedBits<UNorm16>);
+    checkConvert<F16, UNorm8>("F16 to UNorm8", halves, packedBits<UNorm8>);
+    checkConvert<SNorm16, F16>("SNorm16 to F16", snorm16s, packedBits<F16>);
+}
+
+// Colors to the Vec4<UNorm8> of a R8G8B8A8_UNORM attribute and back
+void testVecConvert() {
+    static_assert(sizeof(Vec4<UNorm8>) == 4);
+    static_assert(sizeof(Vec2<F16>) == 4);
+
+    std::vector<Vec4<float>> colors(1001);
+    for (auto &c : colors)
+        c = Vec4<float>(test::randomFloat(-.1f, 1.1f), test::randomFloat(0.f, 1.f), test::randomFloat(0.f, 1.f), 1.f);
+    std::vector<Vec4<UNorm8>> packed(colors.size());
+    std::vector<Vec4<float>> unpacked(colors.size());
+    convert(colors.data(), packed.data(), colors.size());
+    convert(packed.data(), unpacked.data(), colors.size());
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < colors.size(); i++) {
+        for (size_t j = 0; j < 4; j++) {
+            if (packed[i][j].bits != UNorm8(colors[i][j]).bits)
+                mismatches++;
+            const float clamped = std::min(std::max(colors[i][j], 0.f), 1.f);
+            if (std::abs(unpacked[i][j] - clamped) > .5f / 255.f + 1e-7f)
+                mismatches++;
+        }
+        if (packed[i][3].bits != 255)
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+}
+
+}
+
+int main() {
+    testF16KnownAnswers();
+    testF16RoundTrip();
+    testF16Rounding();
+    testBulk();
+    testVecConvert();
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+// parallelFor covering every index once with aligned ranges, nested calls
+// running inline, and exceptions from fn reaching the caller with the pool
+// still usable afterwards. The pool itself is driven directly as well, since
+// parallelFor runs inline on a single hardware thread.
+
+#include <eseed/math/parallel.hpp>
+
+#include "check.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace esdm;
+
+namespace {
+
+void testCoverage() {
+    for (size_t count : { size_t(0), size_t(1), size_t(7), size_t(1000), size_t(100003) }) {
+        std::vector<std::atomic<int>> hits(count);
+        std::atomic<size_t> misaligned { 0 };
+        parallelFor(count, 16, [&](size_t begin, size_t end) {
+            if (begin % 8 != 0 || (end % 8 != 0 && end != count))
+                misaligned++;
+            for (size_t i = begin; i < end; i++)
+                hits[i]++;
+        }, 8);
+        size_t wrong = 0;
+        for (auto &hit : hits)
+            if (hit != 1)
+                wrong++;
+        CHECK(wrong == 0);
+        CHECK(misaligned == 0);
+    }
+}
+
+void testNested() {
+    std::atomic<size_t> total { 0 };
+    parallelFor(64, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            parallelFor(100, 1, [&](size_t innerBegin, size_t innerEnd) {
+                total += innerEnd - innerBegin;
+            });
+    });
+    CHECK(total == 6400);
+}
+
+// Throws from one task of the job
+template <typename Run>
+bool rethrows(Run run) {
+    try {
+        run();
+    } catch (const std::runtime_error &e) {
+        return std::string(e.what()) == "task 3";
+    }
+    return false;
+}
+
+void testExceptions() {
+    auto &pool = detail::WorkerPool::instance();
+    std::atomic<size_t> ran { 0 };
+    auto task = [&](size_t k) {
+        ran++;
+        if (k == 3)
+            throw std::runtime_error("task 3");
+    };
+    CHECK(rethrows([&] { pool.run(1000, task); }));
+    // The tasks after the throw that nobody had started are skipped
+    CHECK(ran >= 4 && ran < 1000);
+
+    // Nothing left over from the failed job
+    ran = 0;
+    auto count = [&](size_t) { ran++; };
+    CHECK(pool.run(1000, count));
+    CHECK(ran == 1000);
+
+    CHECK(rethrows([] {
+        parallelFor(1 << 20, 1, [](size_t begin, size_t end) {
+            if (begin <= 3 && 3 < end)
+                throw std::runtime_error("task 3");
+        });
+    }));
+    std::atomic<size_t> total { 0 };
+    parallelFor(1 << 20, 1, [&](size_t begin, size_t end) { total += end - begin; });
+    CHECK(total == size_t(1) << 20);
+}
+
+}
+
+int main() {
+    testCoverage();
+    testNested();
+    testExceptions();
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+// perspective, perspectiveReverseZInfinite, orthographic and lookAt: known
+// points through each at compile time, and the closed form inverses against
+// the matrices and against the generic inverse
+
+#include <eseed/math/matops.hpp>
+#include <eseed/math/cxmath.hpp>
+
+#include "check.hpp"
+
+#include <cmath>
+
+using namespace esdm;
+using test::equal;
+using test::near;
+
+namespace {
+
+// [ p, 1 ] * m, divided by w
+template <typename T>
+constexpr Vec3<T> project(const Mat4<T> &m, const Vec3<T> &p) {
+    const Vec4<T> clip = matmul(Vec4<T>(p[0], p[1], p[2], T(1)), m);
+    return Vec3<T>(clip[0] / clip[3], clip[1] / clip[3], clip[2] / clip[3]);
+}
+
+constexpr double quarterTurn = double(cx::widePi / 2);
+
+// 90 degrees across, twice as wide as tall: the frustum corners at the near
+// and far planes land on the corners of Vulkan's clip volume, +y down
+constexpr Mat4<double> wide = perspective(quarterTurn, 2., 1., 10.);
+static_assert(near(project(wide, Vec3<double>(0., 0., -1.)), Vec3<double>(0., 0., 0.), 1e-12));
+static_assert(near(project(wide, Vec3<double>(0., 0., -10.)), Vec3<double>(0., 0., 1.), 1e-12));
+static_assert(near(project(wide, Vec3<double>(1., .5, -1.)), Vec3<double>(1., -1., 0.), 1e-12));
+static_assert(near(project(wide, Vec3<double>(-10., -5., -10.)), Vec3<double>(-1., 1., 1.), 1e-12));
+static_assert(near(matmul(wide, perspectiveInverse(quarterTurn, 2., 1., 10.)), Mat4<double>(1.), 1e-12));
+
+// Depth 1 at the near plane, halving as the distance doubles
+constexpr Mat4<double> reverse = perspectiveReverseZInfinite(quarterTurn, 1., .5);
+static_assert(near(project(reverse, Vec3<double>(0., 0., -.5)), Vec3<double>(0., 0., 1.), 1e-12));
+static_assert(near(project(reverse, Vec3<double>(0., 0., -1.)), Vec3<double>(0., 0., .5), 1e-12));
+static_assert(near(project(reverse, Vec3<double>(2., -2., -2.)), Vec3<double>(1., 1., .25), 1e-12));
+static_assert(near(matmul(reverse, perspectiveReverseZInfiniteInverse(quarterTurn, 1., .5)), Mat4<double>(1.), 1e-12));
+
+// The box's corners map to clip space's, no divide needed
+constexpr Mat4<float> box = orthographic(-2.f, 6.f, -1.f, 3.f, 1.f, 5.f);
+static_assert(equal(project(box, Vec3<float>(-2.f, -1.f, -1.f)), Vec3<float>(-1.f, 1.f, 0.f)));
+static_assert(equal(project(box, Vec3<float>(6.f, 3.f, -5.f)), Vec3<float>(1.f, -1.f, 1.f)));
+static_assert(equal(project(box, Vec3<float>(2.f, 1.f, -3.f)), Vec3<float>(0.f, 0.f, .5f)));
+static_assert(equal(matmul(box, orthographicInverse(-2.f, 6.f, -1.f, 3.f, 1.f, 5.f)), Mat4<float>(1.f)));
+
+// The eye goes to the origin and the target onto -z, up staying up
+constexpr Vec3<double> eye(3., 2., 1.);
+constexpr Vec3<double> target(3., 2., -4.);
+constexpr Mat4<double> view = lookAt(eye, target, Vec3<double>(0., 1., 0.));
+static_assert(near(project(view, eye), Vec3<double>(), 1e-12));
+static_assert(near(project(view, target), Vec3<double>(0., 0., -5.), 1e-12));
+static_assert(near(project(view, Vec3<double>(3., 3., 1.)), Vec3<double>(0., 1., 0.), 1e-12));
+static_assert(near(matmul(view, lookAtInverse(eye, target, Vec3<double>(0., 1., 0.))), Mat4<double>(1.), 1e-12));
+
+Vec3<double> randomVec3(float lo, float hi) {
+    return Vec3<double>(test::randomFloat(lo, hi), test::randomFloat(lo, hi), test::randomFloat(lo, hi));
+}
+
+// The closed form inverses against inverse(m), in double, and round trips
+// of view space points through each matrix and back
+void testInverses() {
+    for (int n = 0; n < 1000; n++) {
+        const double fov = test::randomFloat(.3f, 2.8f);
+        const double aspect = test::randomFloat(.3f, 3.f);
+        const double zNear = test::randomFloat(.01f, 1.f);
+        const double zFar = zNear + test::randomFloat(1.f, 1000.f);
+        const Vec3<double> p(test::randomFloat(-1.f, 1.f), test::randomFloat(-1.f, 1.f), -test::randomFloat(float(zNear), float(zFar)));
+
+        const Mat4<double> proj = perspective(fov, aspect, zNear, zFar);
+        const Mat4<double> projInv = perspectiveInverse(fov, aspect, zNear, zFar);
+        CHECK(near(projInv, inverse(proj), 1e-9 * zFar));
+        CHECK(near(project(projInv, project(proj, p)), p, 1e-9 * zFar));
+
+        const Mat4<double> reverseZ = perspectiveReverseZInfinite(fov, aspect, zNear);
+        const Mat4<double> reverseZInv = perspectiveReverseZInfiniteInverse(fov, aspect, zNear);
+        CHECK(near(reverseZInv, inverse(reverseZ), 1e-9));
+        CHECK(near(project(reverseZInv, project(reverseZ, p)), p, 1e-9 * zFar));
+
+        const double left = test::randomFloat(-10.f, 0.f), right = left + test::randomFloat(1.f, 10.f);
+        const double bottom = test::randomFloat(-10.f, 0.f), top = bottom + test::randomFloat(1.f, 10.f);
+        const Mat4<double> ortho = orthographic(left, right, bottom, top, zNear, zFar);
+        CHECK(near(orthographicInverse(left, right, bottom, top, zNear, zFar), inverse(ortho), 1e-9 * zFar));
+
+        const Vec3<double> from = randomVec3(-50.f, 50.f);
+        const Vec3<double> to = from + randomVec3(-1.f, 1.f) + Vec3<double>(0., 0., 2.);
+        const Vec3<double> up = Vec3<double>(0., 1., 0.);
+        const Mat4<double> look = lookAt(from, to, up);
+        const Mat4<double> lookInv = lookAtInverse(from, to, up);
+        CHECK(near(lookInv, inverse(look), 1e-9));
+        CHECK(near(project(look, to), Vec3<double>(0., 0., -length(to - from)), 1e-9));
+        CHECK(near(project(lookInv, Vec3<double>(0., 0., -1.)), from + normalize(to - from), 1e-9));
+    }
+}
+
+// Float depth keeps distances far past the near plane apart, and in order,
+// with reverse-Z, where a standard projection has long since run out of
+// values and rounds neighbours together or even out of order
+void testReverseZPrecision() {
+    const Mat4<float> standard = perspective(1.5f, 1.f, .1f, 1e5f);
+    const Mat4<float> reverseZ = perspectiveReverseZInfinite(1.5f, 1.f, .1f);
+    size_t standardCollisions = 0, reverseCollisions = 0;
+    float previousStandard = -1.f, previousReverse = 2.f;
+    for (float z = 1000.f; z < 1e5f; z *= 1.001f) {
+        const float depthStandard = project(standard, Vec3<float>(0.f, 0.f, -z))[2];
+        const float depthReverse = project(reverseZ, Vec3<float>(0.f, 0.f, -z))[2];
+        standardCollisions += depthStandard <= previousStandard;
+        reverseCollisions += depthReverse >= previousReverse;
+        previousStandard = depthStandard;
+        previousReverse = depthReverse;
+    }
+    CHECK(reverseCollisions == 0);
+    CHECK(standardCollisions > 100);
+}
+
+}
+
+int main() {
+    testInverses();
+    testReverseZPrecision();
+    return test::finish();
+}
\ No newline at end of file
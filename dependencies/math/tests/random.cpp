@@ -0,0 +1,178 @@
+// The generators against published known answers, sequential use against
+// indexed use, the threaded SIMD fills against the scalar functions they
+// match, and some sanity on the distributions
+
+#include <eseed/math/random.hpp>
+
+#include "check.hpp"
+
+#include <random>
+#include <vector>
+
+using namespace esdm;
+
+namespace {
+
+// Philox4x32-10 known answers from Random123 (kat_vectors): counter
+// (c0, c1, c2, c3) is block (c1 << 32 | c0) of stream (c3 << 32 | c2),
+// and key (k0, k1) is seed (k1 << 32 | k0)
+constexpr bool blockIs(const std::array<uint32_t, 4> &b, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3) {
+    return b[0] == r0 && b[1] == r1 && b[2] == r2 && b[3] == r3;
+}
+static_assert(blockIs(rng::Philox(0, 0).block(0), 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8));
+static_assert(blockIs(rng::Philox(~uint64_t(0), ~uint64_t(0)).block(~uint64_t(0)), 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd));
+static_assert(blockIs(rng::Philox(0x299f31d0a4093822, 0x0370734413198a2e).block(0x85a308d3243f6a88), 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1));
+static_assert(rng::Philox(0, 0).at(2) == 0xbc57ac4c);
+
+// Xoshiro256++ from the reference implementation's state { 1, 2, 3, 4 }
+constexpr bool xoshiroKnownAnswers() {
+    rng::Xoshiro256pp gen;
+    gen.state[0] = 1;
+    gen.state[1] = 2;
+    gen.state[2] = 3;
+    gen.state[3] = 4;
+    return gen() == 41943041 && gen() == 58720359 && gen() == 3588806011781223 && gen() == 3591011842654386;
+}
+static_assert(xoshiroKnownAnswers());
+
+// Jumps work at compile time and go somewhere else
+constexpr bool jumpsMove() {
+    rng::Xoshiro256pp a(7), b(7), c(7);
+    b.jump();
+    c.longJump();
+    return a != b && b != c && a != c;
+}
+static_assert(jumpsMove());
+
+// Usable with the standard distributions
+static_assert(std::is_same_v<decltype(std::uniform_int_distribution<int>(0, 9)(std::declval<rng::Philox &>())), int>);
+static_assert(std::is_same_v<decltype(std::normal_distribution<float>()(std::declval<rng::Squares &>())), float>);
+static_assert(std::is_same_v<decltype(std::bernoulli_distribution()(std::declval<rng::Xoshiro256pp &>())), bool>);
+
+void testSequential() {
+    rng::Philox philox(42, 3);
+    rng::Squares squares(42);
+    for (uint64_t i = 0; i < 1000; i++) {
+        CHECK(philox() == philox.withStream(3).at(i));
+        CHECK(squares() == squares.at(i));
+    }
+    CHECK(philox.getPosition() == 1000);
+    philox.seek(7);
+    CHECK(philox() == philox.at(7));
+    philox.discard(5);
+    CHECK(philox() == philox.at(13));
+    CHECK(philox.withStream(4).at(0) != philox.at(0));
+    CHECK(rng::Squares(1).key != rng::Squares(2).key);
+    CHECK(rng::Squares(0).key % 2 == 1);
+
+    // discard(n) is n calls
+    rng::Xoshiro256pp a(5), b(5);
+    a.discard(100);
+    for (int i = 0; i < 100; i++)
+        b();
+    CHECK(a == b);
+}
+
+// Every alignment of the first index and every tail length around the
+// SIMD block groups, and a count large enough to be threaded
+template <typename G>
+void checkFill(const G &gen) {
+    std::vector<uint32_t> out;
+    size_t mismatches = 0;
+    for (uint64_t first : { uint64_t(0), uint64_t(1), uint64_t(2), uint64_t(3), uint64_t(1) << 33 }) {
+        for (size_t count : { size_t(0), size_t(1), size_t(5), size_t(63), size_t(64), size_t(129), size_t(1000), size_t(300007) }) {
+            out.assign(count + 1, 0xDEADBEEF);
+            rng::fill(gen, first, out.data(), count);
+            for (size_t i = 0; i < count; i++)
+                if (out[i] != gen.at(first + i))
+                    mismatches++;
+            CHECK(out[count] == 0xDEADBEEF);
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+void testFills() {
+    checkFill(rng::Philox(0x0123456789ABCDEF, 9));
+    checkFill(rng::Squares(77));
+
+    const rng::Philox gen(11, 1);
+    const size_t count = 100003;
+    const uint64_t first = 5;
+
+    std::vector<float> uniforms(count);
+    rng::fillUniform(gen, first, uniforms.data(), count);
+    rng::Philox sequential = gen;
+    sequential.seek(first);
+    size_t mismatches = 0;
+    double sum = 0.;
+    for (size_t i = 0; i < count; i++) {
+        const float u = rng::uniform(sequential);
+        if (!test::same(uniforms[i], u) || u < 0.f || u >= 1.f)
+            mismatches++;
+        sum += u;
+    }
+    CHECK(mismatches == 0);
+    CHECK_NEAR(sum / double(count), .5, .01);
+
+    // fast::sincos against std::sin / cos in randomUnitVec3
+    std::vector<Vec3<float>> vectors(count);
+    rng::fillUnitVec3(gen, first, vectors.data(), count);
+    sequential.seek(2 * first);
+    mismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+        const Vec3<float> v = rng::randomUnitVec3(sequential);
+        if (!test::near(vectors[i], v, 1e-6f) || std::abs(length(vectors[i]) - 1.f) > 1e-6f)
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+
+    rng::fillInSphere(gen, first, vectors.data(), count);
+    sequential.seek(3 * first);
+    mismatches = 0;
+    Vec3<double> mean;
+    for (size_t i = 0; i < count; i++) {
+        const Vec3<float> v = rng::randomInSphere(sequential);
+        if (!test::near(vectors[i], v, 1e-6f) || length(vectors[i]) > 1.f + 1e-6f)
+            mismatches++;
+        mean += Vec3<double>(v[0], v[1], v[2]) / double(count);
+    }
+    CHECK(mismatches == 0);
+    CHECK(length(mean) < .01);
+}
+
+void testUniform() {
+    rng::Xoshiro256pp gen(3);
+    double sum = 0.;
+    for (int i = 0; i < 100000; i++) {
+        const double u = rng::uniform<double>(gen);
+        CHECK(u >= 0. && u < 1.);
+        sum += u;
+    }
+    CHECK_NEAR(sum / 100000., .5, .01);
+
+    // Doubles from a 32 bit generator take two numbers, the first high
+    rng::Philox philox(1);
+    const double d = rng::uniform<double>(philox);
+    CHECK(philox.getPosition() == 2);
+    CHECK(d == double((uint64_t(philox.at(0)) << 32 | philox.at(1)) >> 11) / 9007199254740992.);
+
+    // The top bits decide, so all ones is just under 1
+    struct AllOnes {
+        using result_type = uint32_t;
+        static constexpr uint32_t min() { return 0; }
+        static constexpr uint32_t max() { return ~0u; }
+        uint32_t operator()() { return ~0u; }
+    } ones;
+    CHECK(rng::uniform(ones) == 1.f - 1.f / 16777216.f);
+    CHECK(rng::uniform<double>(ones) < 1.);
+}
+
+}
+
+int main() {
+    testSequential();
+    testFills();
+    testUniform();
+    return test::finish();
+}
\ No newline at end of file
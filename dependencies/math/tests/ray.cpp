@@ -0,0 +1,168 @@
+// Ray-AABB and ray-triangle tests: known answers, packets against one ray
+// at a time, rays through the shared edges of a mesh never slipping
+// between triangles, and packets of fewer than W rays, empty ones included
+
+#include <eseed/math/ray.hpp>
+
+#include "check.hpp"
+
+#include <vector>
+
+using namespace esdm;
+using test::equal;
+
+namespace {
+
+static_assert(equal(Ray<int>(Vec3<int>(1, 2, 3), Vec3<int>(0, 1, -1)).at(2), Vec3<int>(1, 4, 1)));
+
+const Ray<float> forward(Vec3<float>(), Vec3<float>(0.f, 0.f, -1.f));
+
+void testKnownAnswers() {
+    const AABB<float> box(Vec3<float>(-1.f, -1.f, -6.f), Vec3<float>(1.f, 1.f, -4.f));
+    float tNear = -1.f;
+    CHECK(intersect(forward, box, 100.f, tNear));
+    CHECK(tNear == 4.f);
+    // Too short to reach it, aimed beside it, and pointing away
+    CHECK(!intersect(forward, box, 3.f, tNear));
+    CHECK(!intersect(Ray<float>(Vec3<float>(2.f, 0.f, 0.f), Vec3<float>(0.f, 0.f, -1.f)), box, 100.f, tNear));
+    CHECK(!intersect(Ray<float>(Vec3<float>(), Vec3<float>(0.f, 0.f, 1.f)), box, 100.f, tNear));
+    // Starting inside
+    CHECK(intersect(Ray<float>(Vec3<float>(0.f, 0.f, -5.f), Vec3<float>(1.f, 0.f, 0.f)), box, 100.f, tNear));
+    CHECK(tNear == 0.f);
+    // Zero direction components inside and outside the slab
+    CHECK(intersect(Ray<float>(Vec3<float>(-3.f, 0.5f, -5.f), Vec3<float>(1.f, 0.f, 0.f)), box, 100.f, tNear));
+    CHECK(tNear == 2.f);
+    CHECK(!intersect(Ray<float>(Vec3<float>(-3.f, 1.5f, -5.f), Vec3<float>(1.f, 0.f, 0.f)), box, 100.f, tNear));
+
+    const Vec3<float> a(-1.f, -1.f, -3.f), b(1.f, -1.f, -3.f), c(0.f, 1.f, -3.f);
+    float t = 100.f;
+    CHECK(intersect(forward, a, b, c, t));
+    CHECK(t == 3.f);
+    // Either winding, but not past the distance to beat
+    t = 100.f;
+    CHECK(intersect(forward, a, c, b, t));
+    CHECK(t == 3.f);
+    t = 2.f;
+    CHECK(!intersect(forward, a, b, c, t));
+    CHECK(t == 2.f);
+    // Behind the origin, beside the triangle, and in its plane
+    t = 100.f;
+    CHECK(!intersect(Ray<float>(Vec3<float>(), Vec3<float>(0.f, 0.f, 1.f)), a, b, c, t));
+    CHECK(!intersect(Ray<float>(Vec3<float>(2.f, 0.f, 0.f), Vec3<float>(0.f, 0.f, -1.f)), a, b, c, t));
+    CHECK(!intersect(Ray<float>(Vec3<float>(-5.f, 0.f, -3.f), Vec3<float>(1.f, 0.f, 0.f)), a, b, c, t));
+}
+
+Vec3<float> randomVec3(float lo, float hi) {
+    return Vec3<float>(test::randomFloat(lo, hi), test::randomFloat(lo, hi), test::randomFloat(lo, hi));
+}
+
+// A packet of 8 against its rays one at a time, which run the same tests
+// at width 1
+void testPacketsMatchSingle() {
+    size_t mismatches = 0;
+    for (int n = 0; n < 2000; n++) {
+        Ray<float> rays[8];
+        for (auto &ray : rays)
+            ray = Ray<float>(randomVec3(-2.f, 2.f), normalize(randomVec3(-1.f, 1.f)));
+        const RayPacket<float, 8> packet(rays);
+
+        const Vec3<float> center = randomVec3(-4.f, 4.f);
+        const AABB<float> box(center - randomVec3(0.f, 2.f), center + randomVec3(0.f, 2.f));
+        float tMax[8], tNear[8];
+        for (auto &t : tMax)
+            t = test::randomFloat(0.f, 10.f);
+        uint32_t bits = intersect(packet, box, tMax, tNear);
+        for (size_t i = 0; i < 8; i++) {
+            float near = -1.f;
+            bool hit = intersect(rays[i], box, tMax[i], near);
+            if (hit != bool(bits >> i & 1) || (hit && !test::same(near, tNear[i])))
+                mismatches++;
+        }
+
+        const Vec3<float> a = randomVec3(-4.f, 4.f), b = randomVec3(-4.f, 4.f), c = randomVec3(-4.f, 4.f);
+        float t[8];
+        for (auto &v : t)
+            v = test::randomFloat(0.f, 10.f);
+        float before[8];
+        std::copy(t, t + 8, before);
+        bits = intersect(packet, a, b, c, t);
+        for (size_t i = 0; i < 8; i++) {
+            float single = before[i];
+            bool hit = intersect(rays[i], a, b, c, single);
+            if (hit != bool(bits >> i & 1) || !test::same(single, t[i]))
+                mismatches++;
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+// A grid of quads split into triangles, with rays aimed exactly at the
+// grid lines, diagonals and corners, which some triangle has to stop
+void testWatertight() {
+    const int size = 8;
+    std::vector<Vec3<float>> triangles;
+    auto vertex = [&](int x, int y) {
+        return Vec3<float>(float(x) * 0.37f - 1.3f, float(y) * 0.29f - 1.1f, -4.f - float((x * 7 + y * 3) % 5) * 0.11f);
+    };
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            triangles.insert(triangles.end(), { vertex(x, y), vertex(x + 1, y), vertex(x + 1, y + 1) });
+            triangles.insert(triangles.end(), { vertex(x, y), vertex(x + 1, y + 1), vertex(x, y + 1) });
+        }
+    }
+
+    size_t leaks = 0;
+    for (int n = 0; n < 5000; n++) {
+        const int x = 1 + int(test::random()() % (size - 1));
+        const int y = 1 + int(test::random()() % (size - 1));
+        Vec3<float> target;
+        switch (n % 4) {
+        case 0: target = vertex(x, y); break;
+        case 1: target = (vertex(x, y) + vertex(x + 1, y + 1)) * 0.5f; break;
+        case 2: target = (vertex(x, y) + vertex(x, y + 1)) * 0.5f; break;
+        default: target = (vertex(x, y) + vertex(x + 1, y)) * 0.5f; break;
+        }
+        const Vec3<float> origin = randomVec3(-0.5f, 0.5f);
+        const Ray<float> ray(origin, target - origin);
+        const RayPacket<float, 1> packet(&ray);
+
+        float t = 1e30f;
+        bool hit = false;
+        for (size_t i = 0; i < triangles.size(); i += 3)
+            hit |= intersect(packet, triangles[i], triangles[i + 1], triangles[i + 2], &t) != 0;
+        if (!hit)
+            leaks++;
+    }
+    CHECK(leaks == 0);
+}
+
+// Lanes past the rays given never hit or touch t, whatever they hold
+void testPartialPackets() {
+    const Vec3<float> a(-1.f, -1.f, -3.f), b(1.f, -1.f, -3.f), c(0.f, 1.f, -3.f);
+    const AABB<float> box(Vec3<float>(-1.f, -1.f, -6.f), Vec3<float>(1.f, 1.f, -4.f));
+    const Ray<float> rays[3] = { forward, forward, forward };
+    const float far[8] = { 100.f, 100.f, 100.f, 100.f, 100.f, 100.f, 100.f, 100.f };
+
+    for (size_t count = 0; count <= 3; count++) {
+        const RayPacket<float, 8> packet(rays, count);
+        const uint32_t expected = (1u << count) - 1u;
+        CHECK(packet.active == expected);
+
+        float t[8], tNear[8];
+        std::copy(far, far + 8, t);
+        CHECK(intersect(packet, a, b, c, t) == expected);
+        for (size_t i = 0; i < 8; i++)
+            CHECK(t[i] == (i < count ? 3.f : 100.f));
+        CHECK(intersect(packet, box, far, tNear) == expected);
+    }
+}
+
+}
+
+int main() {
+    testKnownAnswers();
+    testPacketsMatchSingle();
+    testWatertight();
+    testPartialPackets();
+    return test::finish();
+}
\ No newline at end of file
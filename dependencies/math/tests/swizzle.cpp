@@ -0,0 +1,146 @@
+// Swizzles: the named and swizzle<I...>() reads returning a plain Vec,
+// so generic functions deduce from them on non-const Vecs too, writes
+// through swizzleRef<I...>(), and the shuffle paths against the component
+// by component ones
+
+#include <eseed/math/vec.hpp>
+
+#include "check.hpp"
+
+#include <type_traits>
+#include <utility>
+
+using namespace esdm;
+using test::equal;
+
+namespace {
+
+// Reads give a Vec on const and non-const Vecs alike
+static_assert(std::is_same_v<decltype(std::declval<Vec4<float> &>().xz()), Vec2<float>>);
+static_assert(std::is_same_v<decltype(std::declval<const Vec4<float> &>().xz()), Vec2<float>>);
+static_assert(std::is_same_v<decltype(std::declval<Vec3<int> &>().swizzle<2, 1, 0>()), Vec3<int>>);
+
+// So generic functions deduce from them
+template <typename V, typename = void>
+struct DeducesFromSwizzles : std::false_type {};
+
+template <typename V>
+struct DeducesFromSwizzles<V, std::void_t<
+    decltype(dot(std::declval<V &>().xz(), std::declval<V &>().yw())),
+    decltype(length(std::declval<V &>().xyz())),
+    decltype(cross(std::declval<V &>().xyz(), std::declval<V &>().zyx())),
+    decltype(normalize(std::declval<V &>().xy()))
+>> : std::true_type {};
+
+static_assert(DeducesFromSwizzles<Vec4<float>>::value);
+static_assert(DeducesFromSwizzles<Vec4<double>>::value);
+
+// swizzleRef writes only through the temporary it returns
+template <typename R, typename V, typename = void>
+struct Assignable : std::false_type {};
+
+template <typename R, typename V>
+struct Assignable<R, V, std::void_t<decltype(std::declval<R>() = std::declval<V>())>> : std::true_type {};
+
+using XzRef = decltype(std::declval<Vec4<float> &>().swizzleRef<0, 2>());
+static_assert(Assignable<XzRef, Vec2<float>>::value);
+static_assert(!Assignable<XzRef &, Vec2<float>>::value);
+
+constexpr Vec4<int> v4(1, 2, 3, 4);
+static_assert(equal(v4.wzyx(), Vec4<int>(4, 3, 2, 1)));
+static_assert(equal(v4.xxy(), Vec3<int>(1, 1, 2)));
+static_assert(equal(v4.swizzle<3, 0>(), Vec2<int>(4, 1)));
+static_assert(dot(v4.xy(), v4.zw()) == 11);
+
+constexpr Vec4<int> written() {
+    Vec4<int> v = v4;
+    v.swizzleRef<2, 0>() = Vec2<int>(7, 8);
+    v.swizzleRef<3, 1>() += Vec2<int>(10, 20);
+    return v;
+}
+static_assert(equal(written(), Vec4<int>(8, 22, 7, 14)));
+
+template <size_t L, typename T>
+Vec<L, T> randomVec() {
+    Vec<L, T> v;
+    for (size_t i = 0; i < L; i++)
+        v[i] = T(test::randomFloat(-100.f, 100.f));
+    return v;
+}
+
+// The padded Vec3<float> keeps its fourth lane at 0
+bool padClear(const Vec3<float> &v) {
+#if defined(ESDM_SIMD_SSE2)
+    return v.pad == 0.f;
+#else
+    (void)v;
+    return true;
+#endif
+}
+
+bool padClear(...) {
+    return true;
+}
+
+// Swizzle (the shuffles where vecsimd.hpp has them) against the generic
+// SwizzleComponents, reading and, for distinct lanes, writing
+template <size_t L, typename T, size_t... I>
+void checkSwizzle() {
+    using Fast = detail::Swizzle<L, T, I...>;
+    using Generic = detail::SwizzleComponents<L, T, I...>;
+    for (int n = 0; n < 100; n++) {
+        Vec<L, T> v = randomVec<L, T>();
+        Vec<sizeof...(I), T> read = v.template swizzle<I...>();
+        CHECK(equal(read, Generic::get(v)));
+        CHECK(equal(read, Fast::get(v)));
+        CHECK(padClear(read));
+
+        if constexpr (detail::swizzleDistinct<I...>()) {
+            Vec<sizeof...(I), T> s = randomVec<sizeof...(I), T>();
+            Vec<L, T> fast = v;
+            Vec<L, T> generic = v;
+            fast.template swizzleRef<I...>() = s;
+            Generic::set(generic, s);
+            CHECK(equal(fast, generic));
+            CHECK(equal(fast.template swizzle<I...>(), s));
+            CHECK(padClear(fast));
+        }
+    }
+}
+
+void testSwizzles() {
+    checkSwizzle<4, float, 2, 1, 0>();
+    checkSwizzle<4, float, 3, 2, 1, 0>();
+    checkSwizzle<4, float, 0, 2>();
+    checkSwizzle<4, float, 1, 1, 2>();
+    checkSwizzle<4, float, 3, 3, 3, 3>();
+    checkSwizzle<3, float, 2, 1, 0>();
+    checkSwizzle<3, float, 2, 0>();
+    checkSwizzle<3, float, 0, 1, 2, 2>();
+    checkSwizzle<3, float, 1, 2>();
+    checkSwizzle<4, int32_t, 3, 2, 1, 0>();
+    checkSwizzle<4, int32_t, 1, 0, 3, 2>();
+    checkSwizzle<4, int32_t, 0, 0, 1, 1>();
+    checkSwizzle<4, int32_t, 3, 1>();
+    checkSwizzle<4, double, 2, 0, 1>();
+}
+
+void testNonConstUse() {
+    Vec4<float> a(1.f, 2.f, 3.f, 4.f);
+    Vec4<float> b(0.f, 1.f, 0.f, 0.f);
+    CHECK(dot(a.xz(), b.yw()) == 1.f);
+    CHECK(length(a.xy() - Vec2<float>(4.f, 6.f)) == 5.f);
+    CHECK(equal(cross(a.xyz(), b.xyz()), Vec3<float>(-3.f, 0.f, 1.f)));
+
+    a.swizzleRef<3, 0>() = Vec2<float>(9.f, 8.f);
+    a.swizzleRef<1, 2>() *= 2.f;
+    CHECK(equal(a, Vec4<float>(8.f, 4.f, 6.f, 9.f)));
+}
+
+}
+
+int main() {
+    testSwizzles();
+    testNonConstUse();
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+// GPU side of esdm/normals.hpp: octahedral normals and QTangent frames
+// Include with GL_GOOGLE_include_directive (glslc -I resources/shaders/include)
+//
+// Attribute formats, which Vulkan unpacks to floats before these run:
+//   Oct16    VK_FORMAT_R8G8_SNORM          vec2, octDecode
+//   Oct32    VK_FORMAT_R16G16_SNORM        vec2, octDecode
+//   QTangent VK_FORMAT_R16G16B16A16_SNORM  vec4, qtangent*
+// Oct24 has no Vulkan format, so it travels as the low 24 bits of a uint
+// (VK_FORMAT_R32_UINT or a G-buffer channel) and goes through unpackOct24.
+
+#ifndef ESEED_NORMALS_GLSL
+#define ESEED_NORMALS_GLSL
+
+vec2 octSignNotZero(vec2 v) {
+    return vec2(v.x < 0.0 ? -1.0 : 1.0, v.y < 0.0 ? -1.0 : 1.0);
+}
+
+// Unit vector to the [-1, 1] square
+vec2 octEncode(vec3 n) {
+    vec2 p = n.xy / (abs(n.x) + abs(n.y) + abs(n.z));
+    return n.z >= 0.0 ? p : (1.0 - abs(p.yx)) * octSignNotZero(p);
+}
+
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += mix(vec2(-t), vec2(t), lessThan(n.xy, vec2(0.0)));
+    return normalize(n);
+}
+
+// Bit layouts match Oct16 / Oct24 / Oct32 in normals.hpp
+
+uint packOct16(vec3 n) {
+    return packSnorm4x8(vec4(octEncode(n), 0.0, 0.0)) & 0xFFFFu;
+}
+
+vec3 unpackOct16(uint bits) {
+    return octDecode(unpackSnorm4x8(bits).xy);
+}
+
+uint packOct24(vec3 n) {
+    ivec2 q = ivec2(round(clamp(octEncode(n), -1.0, 1.0) * 2047.0));
+    return (uint(q.x) & 0xFFFu) | (uint(q.y) & 0xFFFu) << 12;
+}
+
+vec3 unpackOct24(uint bits) {
+    ivec2 q = ivec2(bitfieldExtract(int(bits), 0, 12), bitfieldExtract(int(bits), 12, 12));
+    return octDecode(max(vec2(q) / 2047.0, -1.0));
+}
+
+uint packOct32(vec3 n) {
+    return packSnorm2x16(octEncode(n));
+}
+
+vec3 unpackOct32(uint bits) {
+    return octDecode(unpackSnorm2x16(bits));
+}
+
+// QTangent, a rotation taking x / y / z to tangent / bitangent / normal,
+// with the bitangent handedness in the sign of w
+
+vec3 qtangentNormal(vec4 q) {
+    q = normalize(q);
+    return vec3(
+        2.0 * (q.x * q.z + q.w * q.y),
+        2.0 * (q.y * q.z - q.w * q.x),
+        1.0 - 2.0 * (q.x * q.x + q.y * q.y)
+    );
+}
+
+vec3 qtangentTangent(vec4 q) {
+    q = normalize(q);
+    return vec3(
+        1.0 - 2.0 * (q.y * q.y + q.z * q.z),
+        2.0 * (q.x * q.y + q.w * q.z),
+        2.0 * (q.x * q.z - q.w * q.y)
+    );
+}
+
+float qtangentHandedness(vec4 q) {
+    return q.w < 0.0 ? -1.0 : 1.0;
+}
+
+// Tangent, bitangent and normal as the columns of a matrix, for moving
+// tangent space vectors (normal map samples) into object space
+mat3 qtangentFrame(vec4 q) {
+    vec3 n = qtangentNormal(q);
+    vec3 t = qtangentTangent(q);
+    return mat3(t, cross(n, t) * qtangentHandedness(q), n);
+}
+
+#endif
\ No newline at end of file
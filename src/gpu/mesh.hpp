@@ -1,11 +1,12 @@
 #pragma once
 
 #include <eseed/math/vec.hpp>
+#include <eseed/math/packed.hpp>
 #include <vector>
 
 struct Vertex {
     esdm::Vec2<float> position;
-    esdm::Vec3<float> color;
+    esdm::Vec4<esdm::UNorm8> color;
 };
 
 struct Mesh {
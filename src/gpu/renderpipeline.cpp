@@ -81,7 +81,7 @@ RenderPipeline::RenderPipeline(
             0, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, position)
         },
         vk::VertexInputAttributeDescription{
-            1, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, color)
+            1, 0, vk::Format::eR8G8B8A8Unorm, offsetof(Vertex, color)
         }
     };
 
@@ -6,6 +6,7 @@
 
 #include <vulkan/vulkan.hpp>
 #include <eseed/math/mat.hpp>
+#include <eseed/math/bounds.hpp>
 #include <map>
 
 #define ALIGN_SCLR(type) alignas(sizeof(type))
@@ -37,6 +38,11 @@ struct Camera {
     ALIGN_MAT4(float) esdm::Mat4<float> rotation;
     ALIGN_SCLR(float) float aspect;
     ALIGN_SCLR(float) float fov;
+
+    // World space frustum matching the rays test.frag casts
+    esdm::Frustum<float> getFrustum(float zNear = 0.f, float zFar = std::numeric_limits<float>::infinity()) const {
+        return esdm::frustumFromCamera(position, rotation, aspect, fov, zNear, zFar);
+    }
 };
 
 class RenderPipeline {
@@ -6,6 +6,7 @@
 #include <eseed/logging/logger.hpp>
 #include <eseed/math/mat.hpp>
 #include <eseed/math/matops.hpp>
+#include <eseed/math/quat.hpp>
 #include <vector>
 #include <chrono>
 
@@ -32,12 +33,12 @@ int main() {
     auto pipeline = renderContext.getRenderPipeline();
 
     auto objectId = pipeline->addRenderObject(Mesh({
-        {{ -1.f, -1.f }, { 1, 0, 0 }},
-        {{ 1.f, -1.f }, { 0, 1, 0 }},
-        {{ -1.f, 1.f }, { 0, 0, 1 }},
-        {{ -1.f, 1.f }, { 0, 0, 1 }},
-        {{ 1.f, -1.f }, { 0, 1, 0 }},
-        {{ 1.f, 1.f }, { 1, 1, 1 }},
+        {{ -1.f, -1.f }, { 1, 0, 0, 1 }},
+        {{ 1.f, -1.f }, { 0, 1, 0, 1 }},
+        {{ -1.f, 1.f }, { 0, 0, 1, 1 }},
+        {{ -1.f, 1.f }, { 0, 0, 1, 1 }},
+        {{ 1.f, -1.f }, { 0, 1, 0, 1 }},
+        {{ 1.f, 1.f }, { 1, 1, 1, 1 }},
     }));
 
     auto instanceId = pipeline->addRenderInstance(objectId);
@@ -83,9 +84,7 @@ int main() {
             if (window->getKey(esdw::KeySpace)) dir.y++;
 
             float speed = 10.f;
-            esdm::Vec3<float> vel = esdm::Vec3<float>(
-                esdm::matmul(esdm::Vec4<float>(dir * speed), esdm::matRotate({ 0, 1, 0 }, look.x))
-            );
+            esdm::Vec3<float> vel = esdm::quatRotate({ 0, 1, 0 }, look.x).rotate(dir * speed);
 
             playerPos += vel * delta;
         }
@@ -98,7 +97,7 @@ int main() {
 
             pipeline->setCamera(Camera{ 
                 playerPos,
-                esdm::matmul(esdm::matRotate({ 1, 0, 0 }, look.y), esdm::matRotate({ 0, 1, 0 }, look.x)),
+                esdm::toMat4(esdm::quatRotate({ 0, 1, 0 }, look.x) * esdm::quatRotate({ 1, 0, 0 }, look.y)),
                 float(window->getSize().x) / float(window->getSize().y),
                 0.25f * esdm::pi<float>() * 2.f
             });